@@ -0,0 +1,83 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+Arena::Arena(std::size_t blockSize) : blockSize(blockSize)
+{
+}
+
+Arena::~Arena()
+{
+	Release();
+}
+
+void* Arena::Allocate(std::size_t size, std::size_t alignment)
+{
+	std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(cursor) + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+	char* memory = reinterpret_cast<char*>(address);
+
+	if (cursor == nullptr || memory + size > blockEnd)
+	{
+		// Allocations larger than a block get a block of their own
+		StartBlock(std::max(blockSize, size + alignment));
+
+		address = (reinterpret_cast<std::uintptr_t>(cursor) + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+		memory = reinterpret_cast<char*>(address);
+	}
+
+	cursor = memory + size;
+	return memory;
+}
+
+void Arena::Reserve(std::size_t size)
+{
+	if (size == 0 || (cursor != nullptr && static_cast<std::size_t>(blockEnd - cursor) >= size))
+	{
+		return;
+	}
+	StartBlock(size);
+}
+
+void Arena::Deallocate(void* memory, std::size_t size)
+{
+	if (static_cast<char*>(memory) >= blockStart && static_cast<char*>(memory) + size == cursor)
+	{
+		cursor = static_cast<char*>(memory);
+	}
+}
+
+void Arena::Release()
+{
+	for (char* block : blocks)
+	{
+		std::free(block);
+	}
+	blocks.clear();
+	blockStart = nullptr;
+	cursor = nullptr;
+	blockEnd = nullptr;
+	bytesReserved = 0;
+}
+
+std::size_t Arena::GetBytesReserved() const
+{
+	return bytesReserved;
+}
+
+void Arena::StartBlock(std::size_t size)
+{
+	char* block = static_cast<char*>(std::malloc(size));
+	if (block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	blocks.push_back(block);
+	bytesReserved += size;
+
+	blockStart = block;
+	cursor = block;
+	blockEnd = block + size;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Bump allocator for short-lived scratch memory. Allocations are carved one after the other out of
+/// large blocks and are never freed one by one; all of them are freed at once by Release() or when
+/// the arena is destroyed. Not thread-safe: give each thread its own arena.
+/// </summary>
+class Arena
+{
+public:
+	/// <summary>
+	/// Creates an empty arena (no memory is reserved until the first allocation).
+	/// </summary>
+	/// <param name="blockSize">Size of the blocks the allocations are carved out of</param>
+	explicit Arena(std::size_t blockSize = 1024 * 1024);
+
+	/// <summary>
+	/// Frees every block of the arena.
+	/// </summary>
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	/// <summary>
+	/// Allocates memory from the arena.
+	/// </summary>
+	/// <param name="size">Number of bytes</param>
+	/// <param name="alignment">Alignment of the memory (a power of two)</param>
+	/// <returns>Start of the memory</returns>
+	void* Allocate(std::size_t size, std::size_t alignment);
+
+	/// <summary>
+	/// Makes room for allocations of a known total size: if what is left of the current block is too small,
+	/// a block of exactly that size is started (instead of one of the usual size), so the arena holds no more than it needs.
+	/// </summary>
+	/// <param name="size">Number of bytes, counting the padding the allocations are aligned with</param>
+	void Reserve(std::size_t size);
+
+	/// <summary>
+	/// Gives back memory if it is the most recent allocation (so a vector that grows at the end of the
+	/// arena can reuse its old space); otherwise the memory stays in use until the arena is released.
+	/// </summary>
+	/// <param name="memory">Start of the memory</param>
+	/// <param name="size">Number of bytes</param>
+	void Deallocate(void* memory, std::size_t size);
+
+	/// <summary>
+	/// Frees every block of the arena at once.
+	/// </summary>
+	void Release();
+
+	/// <summary>
+	/// Number of bytes currently reserved from the system by the arena.
+	/// </summary>
+	std::size_t GetBytesReserved() const;
+
+private:
+	/// <summary>
+	/// Allocates a new block and carves the next allocations out of it.
+	/// </summary>
+	/// <param name="size">Size of the block in bytes</param>
+	void StartBlock(std::size_t size);
+
+	std::size_t blockSize;
+	std::vector<char*> blocks;
+	char* blockStart = nullptr;
+	char* cursor = nullptr;
+	char* blockEnd = nullptr;
+	std::size_t bytesReserved = 0;
+};
+
+/// <summary>
+/// Standard library allocator that takes its memory from an Arena, so containers can be used as scratch.
+/// </summary>
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(Arena& arena) : arena(&arena)
+	{
+	}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.GetArena())
+	{
+	}
+
+	T* allocate(std::size_t count)
+	{
+		return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* memory, std::size_t count)
+	{
+		arena->Deallocate(memory, count * sizeof(T));
+	}
+
+	Arena* GetArena() const
+	{
+		return arena;
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return arena == other.GetArena();
+	}
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const
+	{
+		return arena != other.GetArena();
+	}
+
+private:
+	Arena* arena;
+};
+
+/// <summary>
+/// Vector whose memory comes from an Arena
+/// </summary>
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,351 @@
+#include "AssetArchive.h"
+
+#include "Lz4.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+	const char AssetArchiveMagic[8] = { 'A', 'S', 'S', 'E', 'T', 'P', 'A', 'K' };
+
+	/// <summary>
+	/// Version of the archive layout, increased whenever the layout or the meaning of its data changes
+	/// </summary>
+	const std::uint32_t AssetArchiveVersion = 1;
+
+	/// <summary>
+	/// Alignment of the contents of each asset inside the file
+	/// </summary>
+	const std::uint64_t AssetArchiveAlignment = 64;
+
+	/// <summary>
+	/// Start of an archive file, followed by the table of contents, the names and the contents of the assets
+	/// </summary>
+	struct ArchiveHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t entrySize;	// sizeof(ArchiveEntry) when the archive was written
+		std::uint64_t entryOffset;	// Offset of the table of contents from the start of the file
+		std::uint64_t entryCount;
+	};
+
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + AssetArchiveAlignment - 1) / AssetArchiveAlignment * AssetArchiveAlignment;
+	}
+
+	/// <summary>
+	/// Asset read and compressed, waiting to be written
+	/// </summary>
+	struct PackedAsset
+	{
+		const ArchiveSource* source = nullptr;
+		bool read = false;
+		std::vector<char> stored;	// Contents as they are going to be stored
+		std::uint64_t size = 0;		// Size of the contents once decompressed
+		ArchiveCompression compression = ArchiveCompression::None;
+	};
+
+	bool PackAsset(PackedAsset& asset, bool compress)
+	{
+		MappedFile sourceFile;
+		if (!sourceFile.Open(asset.source->filePath, MappedFileAccess::Sequential))
+		{
+			return false;
+		}
+
+		asset.size = sourceFile.GetSize();
+		if (compress && !asset.source->storeUncompressed && sourceFile.GetSize() > 0)
+		{
+			asset.stored.resize(GetLz4CompressBound(sourceFile.GetSize()));
+			std::size_t compressedSize = CompressLz4(sourceFile.GetData(), sourceFile.GetSize(), asset.stored.data());
+			if (compressedSize <= sourceFile.GetSize() - sourceFile.GetSize() / 10)
+			{
+				asset.stored.resize(compressedSize);
+				asset.stored.shrink_to_fit();
+				asset.compression = ArchiveCompression::Lz4;
+				return true;
+			}
+		}
+
+		asset.stored.assign(sourceFile.GetData(), sourceFile.GetData() + sourceFile.GetSize());
+		return true;
+	}
+}
+
+AssetArchive::~AssetArchive()
+{
+	for (std::pair<const std::string, std::future<std::unique_ptr<ArchiveAsset>>>& preload : preloads)
+	{
+		preload.second.wait();
+	}
+}
+
+bool AssetArchive::Open(const std::string& filePath)
+{
+	entries = nullptr;
+	entryCount = 0;
+	if (!file.Open(filePath, MappedFileAccess::Sequential))
+	{
+		return false;
+	}
+
+	const ArchiveHeader* header = reinterpret_cast<const ArchiveHeader*>(file.GetData());
+	std::uint64_t fileSize = file.GetSize();
+	if (fileSize < sizeof(ArchiveHeader)
+		|| std::memcmp(header->magic, AssetArchiveMagic, sizeof(AssetArchiveMagic)) != 0
+		|| header->version != AssetArchiveVersion
+		|| header->entrySize != sizeof(ArchiveEntry)
+		|| header->entryOffset % alignof(ArchiveEntry) != 0
+		|| header->entryOffset > fileSize || header->entryCount > (fileSize - header->entryOffset) / sizeof(ArchiveEntry))
+	{
+		file.Close();
+		return false;
+	}
+
+	// Lookups are binary searches, so the names have to be sorted (and unique)
+	const ArchiveEntry* tableOfContents = reinterpret_cast<const ArchiveEntry*>(file.GetData() + header->entryOffset);
+	std::string_view previousName;
+	for (std::uint64_t i = 0; i < header->entryCount; i++)
+	{
+		const ArchiveEntry& entry = tableOfContents[i];
+		bool valid = entry.nameOffset <= fileSize && entry.nameLength <= fileSize - entry.nameOffset
+			&& entry.offset % AssetArchiveAlignment == 0 && entry.offset <= fileSize && entry.storedSize <= fileSize - entry.offset
+			&& ((entry.compression == static_cast<std::uint32_t>(ArchiveCompression::None) && entry.storedSize == entry.size)
+				|| entry.compression == static_cast<std::uint32_t>(ArchiveCompression::Lz4));
+
+		std::string_view name = valid ? std::string_view(file.GetData() + entry.nameOffset, entry.nameLength) : std::string_view();
+		if (!valid || (i > 0 && !(previousName < name)))
+		{
+			file.Close();
+			return false;
+		}
+		previousName = name;
+	}
+
+	entries = tableOfContents;
+	entryCount = static_cast<std::size_t>(header->entryCount);
+	return true;
+}
+
+bool AssetArchive::IsOpen() const
+{
+	return file.IsOpen();
+}
+
+std::size_t AssetArchive::GetAssetCount() const
+{
+	return entryCount;
+}
+
+const ArchiveEntry* AssetArchive::Find(const std::string& name) const
+{
+	const char* data = file.GetData();
+	const ArchiveEntry* entry = std::lower_bound(entries, entries + entryCount, name,
+		[data](const ArchiveEntry& candidate, const std::string& name)
+		{
+			return std::string_view(data + candidate.nameOffset, candidate.nameLength) < name;
+		});
+
+	if (entry == entries + entryCount || std::string_view(data + entry->nameOffset, entry->nameLength) != name)
+	{
+		return nullptr;
+	}
+	return entry;
+}
+
+bool AssetArchive::Read(const std::string& name, ArchiveAsset& asset)
+{
+	std::future<std::unique_ptr<ArchiveAsset>> preload;
+	{
+		std::lock_guard<std::mutex> lock(preloadsMutex);
+		std::map<std::string, std::future<std::unique_ptr<ArchiveAsset>>>::iterator found = preloads.find(name);
+		if (found != preloads.end())
+		{
+			preload = std::move(found->second);
+			preloads.erase(found);
+		}
+	}
+
+	if (preload.valid())
+	{
+		std::unique_ptr<ArchiveAsset> preloaded = preload.get();
+		if (preloaded == nullptr)
+		{
+			return false;
+		}
+		asset = std::move(*preloaded);
+		return true;
+	}
+
+	const ArchiveEntry* entry = Find(name);
+	return entry != nullptr && Extract(*entry, asset);
+}
+
+void AssetArchive::Preload(const std::vector<std::string>& names, ThreadPool& threadPool)
+{
+	for (const std::string& name : names)
+	{
+		// Uncompressed assets are used straight out of the mapping, so there is nothing to do ahead of time
+		const ArchiveEntry* entry = Find(name);
+		if (entry == nullptr || entry->compression == static_cast<std::uint32_t>(ArchiveCompression::None))
+		{
+			continue;
+		}
+
+		std::future<std::unique_ptr<ArchiveAsset>> preload = threadPool.Submit([this, entry]()
+			{
+				std::unique_ptr<ArchiveAsset> asset = std::make_unique<ArchiveAsset>();
+				return Extract(*entry, *asset) ? std::move(asset) : nullptr;
+			});
+
+		std::lock_guard<std::mutex> lock(preloadsMutex);
+		preloads[name] = std::move(preload);
+	}
+}
+
+bool AssetArchive::Extract(const ArchiveEntry& entry, ArchiveAsset& asset) const
+{
+	asset = ArchiveAsset();
+	const char* storedData = file.GetData() + entry.offset;
+
+	if (entry.compression == static_cast<std::uint32_t>(ArchiveCompression::None))
+	{
+		asset.data = storedData;
+		asset.size = static_cast<std::size_t>(entry.size);
+		return true;
+	}
+
+	asset.buffer.resize(static_cast<std::size_t>(entry.size));
+	if (!DecompressLz4(storedData, static_cast<std::size_t>(entry.storedSize), asset.buffer.data(), asset.buffer.size()))
+	{
+		asset = ArchiveAsset();
+		return false;
+	}
+	asset.data = asset.buffer.data();
+	asset.size = asset.buffer.size();
+	return true;
+}
+
+bool WriteAssetArchive(const std::string& archiveFilePath, const std::vector<ArchiveSource>& sources, bool compress,
+	ThreadPool& threadPool, ArchiveWriteStats* stats)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	std::vector<PackedAsset> assets(sources.size());
+	for (std::size_t i = 0; i < sources.size(); i++)
+	{
+		assets[i].source = &sources[i];
+	}
+	std::sort(assets.begin(), assets.end(), [](const PackedAsset& a, const PackedAsset& b) { return a.source->name < b.source->name; });
+	for (std::size_t i = 1; i < assets.size(); i++)
+	{
+		if (assets[i].source->name == assets[i - 1].source->name)
+		{
+			std::cerr << "Two assets are named " << assets[i].source->name << std::endl;
+			return false;
+		}
+	}
+
+	threadPool.ParallelFor(assets.size(), [&assets, compress](std::size_t i) { assets[i].read = PackAsset(assets[i], compress); });
+
+	ArchiveWriteStats writeStats;
+	for (const PackedAsset& asset : assets)
+	{
+		if (!asset.read)
+		{
+			std::cerr << "Unable to read " << asset.source->filePath << std::endl;
+			return false;
+		}
+		writeStats.assets++;
+		writeStats.compressedAssets += asset.compression == ArchiveCompression::Lz4 ? 1 : 0;
+		writeStats.size += asset.size;
+	}
+
+	// The table of contents comes right after the header and is followed by the names, then the aligned contents
+	ArchiveHeader header = {};
+	std::memcpy(header.magic, AssetArchiveMagic, sizeof(AssetArchiveMagic));
+	header.version = AssetArchiveVersion;
+	header.entrySize = sizeof(ArchiveEntry);
+	header.entryOffset = sizeof(ArchiveHeader);
+	header.entryCount = assets.size();
+
+	std::vector<ArchiveEntry> tableOfContents(assets.size());
+	std::uint64_t offset = header.entryOffset + header.entryCount * sizeof(ArchiveEntry);
+	for (std::size_t i = 0; i < assets.size(); i++)
+	{
+		tableOfContents[i].nameOffset = offset;
+		tableOfContents[i].nameLength = static_cast<std::uint32_t>(assets[i].source->name.size());
+		offset += assets[i].source->name.size();
+	}
+	for (std::size_t i = 0; i < assets.size(); i++)
+	{
+		ArchiveEntry& entry = tableOfContents[i];
+		entry.offset = AlignOffset(offset);
+		entry.storedSize = assets[i].stored.size();
+		entry.size = assets[i].size;
+		entry.sourceHash = assets[i].source->sourceHash;
+		entry.compression = static_cast<std::uint32_t>(assets[i].compression);
+		offset = entry.offset + entry.storedSize;
+	}
+
+	// Written to a temporary file first, so an archive is never seen half-written
+	std::string temporaryFilePath = archiveFilePath + ".tmp";
+	{
+		std::ofstream archiveFile(temporaryFilePath, std::ios::binary | std::ios::trunc);
+		if (archiveFile.fail())
+		{
+			return false;
+		}
+
+		const char padding[AssetArchiveAlignment] = {};
+		archiveFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		archiveFile.write(reinterpret_cast<const char*>(tableOfContents.data()), tableOfContents.size() * sizeof(ArchiveEntry));
+		std::uint64_t position = header.entryOffset + header.entryCount * sizeof(ArchiveEntry);
+		for (const PackedAsset& asset : assets)
+		{
+			archiveFile.write(asset.source->name.data(), asset.source->name.size());
+			position += asset.source->name.size();
+		}
+		for (std::size_t i = 0; i < assets.size(); i++)
+		{
+			archiveFile.write(padding, tableOfContents[i].offset - position);
+			archiveFile.write(assets[i].stored.data(), assets[i].stored.size());
+			position = tableOfContents[i].offset + tableOfContents[i].storedSize;
+		}
+		writeStats.fileSize = position;
+
+		if (archiveFile.fail())
+		{
+			archiveFile.close();
+			std::remove(temporaryFilePath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilePath, archiveFilePath, error);
+	if (error)
+	{
+		std::remove(temporaryFilePath.c_str());
+		return false;
+	}
+
+	writeStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	if (stats != nullptr)
+	{
+		*stats = writeStats;
+	}
+	return true;
+}
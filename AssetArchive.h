@@ -0,0 +1,158 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// File name of the archive the asset cooker packs the cooked assets into, inside its output directory
+/// </summary>
+const char AssetArchiveFileName[] = "assets.pak";
+
+/// <summary>
+/// How the contents of an asset are stored in an archive
+/// </summary>
+enum class ArchiveCompression : std::uint32_t
+{
+	None = 0,	// Stored as they are, and used straight out of the mapping
+	Lz4 = 1		// Compressed as a single LZ4 block
+};
+
+/// <summary>
+/// Entry of the table of contents of an asset archive
+/// </summary>
+struct ArchiveEntry
+{
+	std::uint64_t nameOffset;	// Offset of the name (not null-terminated) from the start of the file
+	std::uint64_t offset;		// Offset of the stored contents from the start of the file
+	std::uint64_t storedSize;	// Size of the stored contents in bytes
+	std::uint64_t size;			// Size of the contents once decompressed
+	std::uint64_t sourceHash;	// HashBytes of the source file the asset was cooked from
+	std::uint32_t nameLength;	// Length of the name in bytes
+	std::uint32_t compression;	// ArchiveCompression of the stored contents
+};
+
+/// <summary>
+/// Contents of an asset read from an archive. Moving it keeps data valid, since neither the mapping nor the buffer move.
+/// </summary>
+struct ArchiveAsset
+{
+	const char* data = nullptr;	// Contents of the asset, pointing into the archive's mapping or into the buffer
+	std::size_t size = 0;		// Size of the contents in bytes
+	std::vector<char> buffer;	// Decompressed contents (empty if the asset is stored uncompressed)
+};
+
+/// <summary>
+/// File to pack into an archive
+/// </summary>
+struct ArchiveSource
+{
+	std::string name;				// Name the asset is looked up by
+	std::string filePath;			// Path to the file with the contents of the asset
+	std::uint64_t sourceHash = 0;	// HashBytes of the source file the asset was cooked from
+	bool storeUncompressed = false;	// Indicates if the asset is always stored as it is, so that pieces of it can be read straight out of the mapping
+};
+
+/// <summary>
+/// Statistics about writing an archive
+/// </summary>
+struct ArchiveWriteStats
+{
+	std::size_t assets = 0;				// Number of assets packed
+	std::size_t compressedAssets = 0;	// Number of assets stored LZ4-compressed
+	std::uint64_t size = 0;				// Total size of the assets in bytes
+	std::uint64_t fileSize = 0;			// Size of the archive file in bytes
+	double seconds = 0.0;				// Time spent compressing and writing
+};
+
+/// <summary>
+/// Read-only archive of assets, memory-mapped as a whole: a header, a table of contents sorted by name,
+/// and the contents of each asset at an aligned offset, either as they are or LZ4-compressed.
+/// Opening it is a single file open, however many assets it holds.
+/// </summary>
+class AssetArchive
+{
+public:
+	AssetArchive() = default;
+
+	/// <summary>
+	/// Waits for the assets still being preloaded, then unmaps the archive.
+	/// </summary>
+	~AssetArchive();
+
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	/// <summary>
+	/// Maps an archive and checks that its table of contents is complete and of the current version.
+	/// </summary>
+	/// <param name="filePath">Path to the archive</param>
+	/// <returns>True if the archive was opened successfully</returns>
+	bool Open(const std::string& filePath);
+
+	/// <summary>
+	/// Indicates if an archive is open.
+	/// </summary>
+	bool IsOpen() const;
+
+	/// <summary>
+	/// Number of assets in the archive.
+	/// </summary>
+	std::size_t GetAssetCount() const;
+
+	/// <summary>
+	/// Looks an asset up in the table of contents.
+	/// </summary>
+	/// <param name="name">Name of the asset</param>
+	/// <returns>Entry of the asset, or nullptr if the archive has no asset of that name</returns>
+	const ArchiveEntry* Find(const std::string& name) const;
+
+	/// <summary>
+	/// Gets the contents of an asset, decompressing them if needed (or taking them from Preload).
+	/// May be called from several threads at once, each decompressing its own asset.
+	/// </summary>
+	/// <param name="name">Name of the asset</param>
+	/// <param name="asset">Receives the contents of the asset</param>
+	/// <returns>True if the archive has the asset and its contents are valid</returns>
+	bool Read(const std::string& name, ArchiveAsset& asset);
+
+	/// <summary>
+	/// Starts decompressing assets on the worker threads, so that reading them later only waits for what is left.
+	/// Each preloaded asset is handed out by the first Read of it.
+	/// </summary>
+	/// <param name="names">Names of the assets (names missing from the archive are ignored)</param>
+	/// <param name="threadPool">Worker threads that decompress the assets</param>
+	void Preload(const std::vector<std::string>& names, ThreadPool& threadPool);
+
+private:
+	bool Extract(const ArchiveEntry& entry, ArchiveAsset& asset) const;
+
+	MappedFile file;
+	const ArchiveEntry* entries = nullptr;
+	std::size_t entryCount = 0;
+
+	std::mutex preloadsMutex;
+	std::map<std::string, std::future<std::unique_ptr<ArchiveAsset>>> preloads;	// Assets being decompressed, by name
+};
+
+/// <summary>
+/// Packs files into an archive, compressing them on the worker threads. A file is stored LZ4-compressed
+/// only if that makes it at least a tenth smaller (and it may be compressed at all); the others are stored as they are.
+/// </summary>
+/// <param name="archiveFilePath">Path to the archive to write</param>
+/// <param name="sources">Files to pack (their names have to be unique)</param>
+/// <param name="compress">Indicates if the files may be compressed</param>
+/// <param name="threadPool">Worker threads that read and compress the files</param>
+/// <param name="stats">Optionally receives statistics about the archive</param>
+/// <returns>True if the archive was written successfully</returns>
+bool WriteAssetArchive(const std::string& archiveFilePath, const std::vector<ArchiveSource>& sources, bool compress,
+	ThreadPool& threadPool, ArchiveWriteStats* stats = nullptr);
@@ -0,0 +1,504 @@
+// Offline asset cooker: turns the source models and images of the museum into the form the viewer
+// uploads as it is, and packs them with the shaders into a single archive, so the viewer no longer
+// parses .obj text, decodes images or opens a file per asset at startup
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "AssetArchive.h"
+#include "CookedAssets.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TiledTexture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+	/// <summary>
+	/// Version of the cooking steps, increased whenever they change so every asset gets cooked again
+	/// </summary>
+	const std::uint32_t CookerVersion = 5;
+
+	/// <summary>
+	/// File in the output directory that records what each cooked asset was made from
+	/// </summary>
+	const char CookDatabaseFileName[] = "cook-database.txt";
+
+	/// <summary>
+	/// Settings that can be changed from the command line
+	/// </summary>
+	struct CookerOptions
+	{
+		std::string sourceDirectory = ".";						// Directory of the source models and images
+		std::string outputDirectory = DefaultCookedDirectory;	// Directory the cooked assets are written to
+		unsigned int workerThreads = 0;							// Number of worker threads (0 uses one per hardware thread)
+		bool force = false;										// Indicates if every asset is cooked, even the up-to-date ones
+		bool compress = true;									// Indicates if the assets may be LZ4-compressed in the archive
+		bool blockCompressTextures = true;						// Indicates if the textures are stored block compressed (BC1 or BC3)
+	};
+
+	enum class AssetKind
+	{
+		Mesh,
+		Texture,
+		TiledTexture,	// Second cooked asset of a painting, paged in tile by tile (stored uncompressed in the archive)
+		Shader			// Packed into the archive as it is
+	};
+
+	/// <summary>
+	/// Source file to cook, and what became of it
+	/// </summary>
+	struct Asset
+	{
+		AssetKind kind = AssetKind::Mesh;
+		std::string sourceFilePath;
+		std::string cookedFilePath;		// Path to the cooked asset (the source itself for shaders)
+		std::string archiveName;		// Name of the cooked asset in the archive
+		std::uint64_t sourceHash = 0;	// HashBytes of the contents of the source file
+		bool upToDate = false;			// Indicates if the cooked asset was made from the same source by this version of the cooker
+		bool cooked = false;			// Indicates if the asset was cooked (or was already up to date)
+		std::string summary;			// Description of the cooked asset
+		double seconds = 0.0;			// Time spent cooking
+	};
+
+	/// <summary>
+	/// What a cooked asset was made from
+	/// </summary>
+	struct CookRecord
+	{
+		std::uint64_t sourceHash = 0;
+		std::uint32_t version = 0;
+	};
+
+	void PrintUsage(const char* programName)
+	{
+		std::cerr << "Usage: " << programName << " [options]" << std::endl
+			<< "  --source <dir>   Directory of the source .obj files and images (default: current directory)" << std::endl
+			<< "  --output <dir>   Directory the cooked assets are written to (default: cooked)" << std::endl
+			<< "  --threads <n>    Number of worker threads (default: one per hardware thread)" << std::endl
+			<< "  --force          Cook every asset, even the ones that are up to date" << std::endl
+			<< "  --no-compression Store the assets in the archive without LZ4 compression" << std::endl
+			<< "  --uncompressed-textures Store the textures as RGB or RGBA instead of block compressing them" << std::endl;
+	}
+
+	bool ParseCookerOptions(int argc, char** argv, CookerOptions& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+
+			if (argument == "--source" && i + 1 < argc)
+			{
+				options.sourceDirectory = argv[++i];
+			}
+			else if (argument == "--output" && i + 1 < argc)
+			{
+				options.outputDirectory = argv[++i];
+			}
+			else if (argument == "--threads" && i + 1 < argc)
+			{
+				char* numberEnd = nullptr;
+				unsigned long threadCount = std::strtoul(argv[++i], &numberEnd, 10);
+				if (numberEnd == argv[i] || *numberEnd != '\0')
+				{
+					std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+					PrintUsage(argv[0]);
+					return false;
+				}
+				options.workerThreads = static_cast<unsigned int>(threadCount);
+			}
+			else if (argument == "--force")
+			{
+				options.force = true;
+			}
+			else if (argument == "--no-compression")
+			{
+				options.compress = false;
+			}
+			else if (argument == "--uncompressed-textures")
+			{
+				options.blockCompressTextures = false;
+			}
+			else
+			{
+				std::cerr << "Unknown option: " << argument << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Lists the models, images and shaders in the source directory, sorted by name.
+	/// </summary>
+	bool FindAssets(const CookerOptions& options, std::vector<Asset>& assets)
+	{
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options.sourceDirectory, error))
+		{
+			if (!entry.is_regular_file(error))
+			{
+				continue;
+			}
+
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+			Asset asset;
+			asset.sourceFilePath = entry.path().string();
+			if (extension == ".obj")
+			{
+				asset.kind = AssetKind::Mesh;
+				asset.cookedFilePath = GetCookedAssetPath(options.outputDirectory, asset.sourceFilePath, CookedMeshExtension);
+				asset.archiveName = GetCookedAssetName(asset.sourceFilePath, CookedMeshExtension);
+			}
+			else if (extension == ".png" || extension == ".jpg" || extension == ".jpeg")
+			{
+				asset.kind = AssetKind::Texture;
+				asset.cookedFilePath = GetCookedAssetPath(options.outputDirectory, asset.sourceFilePath, CookedTextureExtension);
+				asset.archiveName = GetCookedAssetName(asset.sourceFilePath, CookedTextureExtension);
+
+				// Paintings also get a tiled texture, so the viewer can draw them as virtual textures
+				if (IsTiledImage(asset.sourceFilePath))
+				{
+					Asset tiledAsset = asset;
+					tiledAsset.kind = AssetKind::TiledTexture;
+					tiledAsset.cookedFilePath = GetCookedAssetPath(options.outputDirectory, asset.sourceFilePath, TiledTextureExtension);
+					tiledAsset.archiveName = GetCookedAssetName(asset.sourceFilePath, TiledTextureExtension);
+					assets.push_back(tiledAsset);
+				}
+			}
+			else if (extension == ".vsh" || extension == ".fsh")
+			{
+				asset.kind = AssetKind::Shader;
+				asset.cookedFilePath = asset.sourceFilePath;
+				asset.archiveName = entry.path().filename().string();
+			}
+			else
+			{
+				continue;
+			}
+			assets.push_back(asset);
+		}
+
+		if (error)
+		{
+			std::cerr << "Unable to list the source directory " << options.sourceDirectory << ": " << error.message() << std::endl;
+			return false;
+		}
+
+		std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.archiveName < b.archiveName; });
+		return true;
+	}
+
+	/// <summary>
+	/// Reads the cook database, one line per cooked asset: source hash (hexadecimal), cooker version, name in the archive.
+	/// A missing database is empty, so everything gets cooked.
+	/// </summary>
+	std::map<std::string, CookRecord> ReadCookDatabase(const std::string& databaseFilePath)
+	{
+		std::map<std::string, CookRecord> database;
+
+		std::ifstream databaseFile(databaseFilePath);
+		std::string line;
+		while (std::getline(databaseFile, line))
+		{
+			std::istringstream fields(line);
+			CookRecord record;
+			std::string archiveName;
+			if (fields >> std::hex >> record.sourceHash >> std::dec >> record.version && std::getline(fields >> std::ws, archiveName))
+			{
+				database[archiveName] = record;
+			}
+		}
+		return database;
+	}
+
+	/// <summary>
+	/// Writes the cook database for the assets that were cooked, so failed assets are tried again next time.
+	/// </summary>
+	bool WriteCookDatabase(const std::string& databaseFilePath, const std::vector<Asset>& assets)
+	{
+		std::ofstream databaseFile(databaseFilePath, std::ios::trunc);
+		for (const Asset& asset : assets)
+		{
+			if (asset.cooked)
+			{
+				databaseFile << std::hex << asset.sourceHash << std::dec << ' ' << CookerVersion << ' ' << asset.archiveName << '\n';
+			}
+		}
+		return !databaseFile.fail();
+	}
+
+	/// <summary>
+	/// Describes a cooked asset, which also checks that it can be loaded the way the viewer loads it
+	/// and that it was cooked with the same options.
+	/// </summary>
+	bool DescribeCookedAsset(const Asset& asset, const CookerOptions& options, std::string& summary)
+	{
+		std::ostringstream description;
+		if (asset.kind == AssetKind::Mesh)
+		{
+			LoadedMesh mesh;
+			if (!LoadCookedMesh(asset.cookedFilePath, mesh))
+			{
+				return false;
+			}
+			description << GetMeshLods(mesh.view)[0].indexCount / 3 << " triangles, " << mesh.view.vertexCount << " vertices, "
+				<< std::max<std::size_t>(1, mesh.view.lodCount) << " levels of detail, " << mesh.view.meshletCount << " meshlets";
+		}
+		else if (asset.kind == AssetKind::Texture)
+		{
+			LoadedTexture texture;
+			if (!LoadCookedTexture(asset.cookedFilePath, texture)
+				|| (texture.compression != TextureCompression::None) != options.blockCompressTextures)
+			{
+				return false;
+			}
+
+			std::size_t size = 0;
+			for (const TextureLevel& level : texture.levels)
+			{
+				size += level.size;
+			}
+			const char* format = texture.compression == TextureCompression::Bc1 ? " BC1, "
+				: texture.compression == TextureCompression::Bc3 ? " BC3, "
+				: texture.channels == 4 ? " RGBA, " : " RGB, ";
+			description << texture.width << "x" << texture.height << format << texture.levels.size() << " mip levels, "
+				<< size / 1024 << " KiB";
+		}
+		else if (asset.kind == AssetKind::TiledTexture)
+		{
+			TiledTexture texture;
+			if (!LoadCookedTiledTexture(asset.cookedFilePath, texture)
+				|| (texture.compression != TextureCompression::None) != options.blockCompressTextures)
+			{
+				return false;
+			}
+
+			std::size_t tileCount = 0;
+			for (const TiledTextureLevel& level : texture.levels)
+			{
+				tileCount += static_cast<std::size_t>(level.tilesX) * level.tilesY;
+			}
+			description << texture.width << "x" << texture.height << " in " << tileCount << " tiles of " << TileSize << "x" << TileSize
+				<< " over " << texture.levels.size() << " mip levels, " << tileCount * texture.tileBytes / 1024 << " KiB";
+		}
+		else
+		{
+			std::error_code error;
+			std::uintmax_t size = std::filesystem::file_size(asset.cookedFilePath, error);
+			if (error)
+			{
+				return false;
+			}
+			description << size << " bytes";
+		}
+		summary = description.str();
+		return true;
+	}
+
+	/// <summary>
+	/// Hashes the source of an asset and compares it with what the cooked asset was made from.
+	/// </summary>
+	bool CheckSource(Asset& asset, const std::map<std::string, CookRecord>& database, const CookerOptions& options)
+	{
+		MappedFile sourceFile;
+		if (!sourceFile.Open(asset.sourceFilePath, MappedFileAccess::Sequential))
+		{
+			std::cerr << "Unable to read " << asset.sourceFilePath << std::endl;
+			return false;
+		}
+		asset.sourceHash = HashBytes(sourceFile.GetData(), sourceFile.GetSize());
+
+		std::map<std::string, CookRecord>::const_iterator record = database.find(asset.archiveName);
+		asset.upToDate = !options.force && record != database.end() && record->second.sourceHash == asset.sourceHash
+			&& record->second.version == CookerVersion && DescribeCookedAsset(asset, options, asset.summary);
+		return true;
+	}
+
+	bool CookAsset(Asset& asset, const CookerOptions& options, ThreadPool& threadPool)
+	{
+		if (asset.upToDate)
+		{
+			asset.cooked = true;
+			return true;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		bool cooked = true;
+		if (asset.kind == AssetKind::Mesh)
+		{
+			cooked = CookMesh(asset.sourceFilePath, asset.cookedFilePath, asset.sourceHash, &threadPool);
+		}
+		else if (asset.kind == AssetKind::Texture)
+		{
+			cooked = CookTexture(asset.sourceFilePath, asset.cookedFilePath, asset.sourceHash, options.blockCompressTextures, &threadPool);
+		}
+		else if (asset.kind == AssetKind::TiledTexture)
+		{
+			cooked = CookTiledTexture(asset.sourceFilePath, asset.cookedFilePath, asset.sourceHash, options.blockCompressTextures, &threadPool);
+		}
+		asset.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		asset.cooked = cooked && DescribeCookedAsset(asset, options, asset.summary);
+		return asset.cooked;
+	}
+
+	/// <summary>
+	/// Checks that an existing archive holds exactly the given assets, made from the same sources.
+	/// </summary>
+	bool IsArchiveUpToDate(const std::string& archiveFilePath, const std::vector<ArchiveSource>& sources, bool compress)
+	{
+		AssetArchive archive;
+		if (!archive.Open(archiveFilePath) || archive.GetAssetCount() != sources.size())
+		{
+			return false;
+		}
+
+		for (const ArchiveSource& source : sources)
+		{
+			const ArchiveEntry* entry = archive.Find(source.name);
+			if (entry == nullptr || entry->sourceHash != source.sourceHash
+				|| ((!compress || source.storeUncompressed) && entry->compression != static_cast<std::uint32_t>(ArchiveCompression::None)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+/// <summary>
+/// Cooks every model and image of the source directory that changed since it was last cooked,
+/// then packs the cooked assets and the shaders into the asset archive.
+/// </summary>
+/// <param name="argc">Number of command line arguments</param>
+/// <param name="argv">Command line arguments (see PrintUsage)</param>
+/// <returns>0 if every asset was cooked, 1 otherwise</returns>
+int main(int argc, char** argv)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	CookerOptions options;
+	if (!ParseCookerOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	std::vector<Asset> assets;
+	if (!FindAssets(options, assets))
+	{
+		return 1;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(options.outputDirectory, error);
+	if (error)
+	{
+		std::cerr << "Unable to create the output directory " << options.outputDirectory << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	std::string databaseFilePath = (std::filesystem::path(options.outputDirectory) / CookDatabaseFileName).string();
+	std::map<std::string, CookRecord> database = ReadCookDatabase(databaseFilePath);
+
+	// Each asset is hashed first, and only cooked if its source changed, so unchanged assets cost one read.
+	// Assets do not depend on each other, so every asset's jobs run in parallel with the others'
+	ThreadPool threadPool(options.workerThreads);
+	TaskGraph graph;
+	for (Asset& asset : assets)
+	{
+		TaskGraph::TaskId check = graph.Add("checking " + asset.sourceFilePath,
+			[&asset, &database, &options]() { return CheckSource(asset, database, options); });
+		graph.Add("cooking " + asset.sourceFilePath, [&asset, &options, &threadPool]() { return CookAsset(asset, options, threadPool); }, { check });
+	}
+	graph.Run(threadPool);
+
+	std::size_t cookedCount = 0;
+	std::size_t upToDateCount = 0;
+	std::size_t failedCount = 0;
+	for (const Asset& asset : assets)
+	{
+		if (!asset.cooked)
+		{
+			std::cerr << "Failed to cook " << asset.sourceFilePath << std::endl;
+			failedCount++;
+		}
+		else if (asset.upToDate)
+		{
+			std::cout << asset.sourceFilePath << " is up to date (" << asset.summary << ")" << std::endl;
+			upToDateCount++;
+		}
+		else if (asset.kind == AssetKind::Shader)
+		{
+			std::cout << "Packing " << asset.sourceFilePath << " as it is (" << asset.summary << ")" << std::endl;
+			cookedCount++;
+		}
+		else
+		{
+			std::cout << "Cooked " << asset.sourceFilePath << " -> " << asset.cookedFilePath << " (" << asset.summary << ") in "
+				<< asset.seconds * 1000.0 << " ms" << std::endl;
+			cookedCount++;
+		}
+	}
+
+	// Whatever was cooked goes into the archive; assets that failed are left out, so the viewer loads their sources instead.
+	// The archive is only written again when what it would hold changed
+	std::vector<ArchiveSource> archiveSources;
+	for (const Asset& asset : assets)
+	{
+		if (asset.cooked)
+		{
+			archiveSources.push_back({ asset.archiveName, asset.cookedFilePath, asset.sourceHash, asset.kind == AssetKind::TiledTexture });
+		}
+	}
+
+	std::string archiveFilePath = (std::filesystem::path(options.outputDirectory) / AssetArchiveFileName).string();
+	if (cookedCount == 0 && !options.force && IsArchiveUpToDate(archiveFilePath, archiveSources, options.compress))
+	{
+		std::cout << archiveFilePath << " is up to date" << std::endl;
+	}
+	else
+	{
+		ArchiveWriteStats archiveStats;
+		if (!WriteAssetArchive(archiveFilePath, archiveSources, options.compress, threadPool, &archiveStats))
+		{
+			std::cerr << "Unable to write the asset archive: " << archiveFilePath << std::endl;
+			return 1;
+		}
+		std::cout << "Packed " << archiveStats.assets << " assets into " << archiveFilePath << " (" << archiveStats.compressedAssets
+			<< " LZ4-compressed, " << archiveStats.size / 1024 << " KiB -> " << archiveStats.fileSize / 1024 << " KiB) in "
+			<< archiveStats.seconds * 1000.0 << " ms" << std::endl;
+	}
+
+	if (!WriteCookDatabase(databaseFilePath, assets))
+	{
+		std::cerr << "Unable to write the cook database: " << databaseFilePath << std::endl;
+		return 1;
+	}
+
+	std::cout << "Cooked " << cookedCount << " assets (" << upToDateCount << " up to date, " << failedCount << " failed) in "
+		<< std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() * 1000.0 << " ms on "
+		<< threadPool.GetThreadCount() << " worker threads" << std::endl;
+
+	return failedCount == 0 ? 0 : 1;
+}
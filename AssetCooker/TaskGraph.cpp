@@ -0,0 +1,95 @@
+#include "TaskGraph.h"
+
+#include "ThreadPool.h"
+
+#include <iostream>
+#include <utility>
+
+TaskGraph::TaskId TaskGraph::Add(std::string name, std::function<bool()> work, const std::vector<TaskId>& dependencies)
+{
+	TaskId id = tasks.size();
+
+	Task task;
+	task.name = std::move(name);
+	task.work = std::move(work);
+	task.dependencyCount = dependencies.size();
+	tasks.push_back(std::move(task));
+
+	for (TaskId dependency : dependencies)
+	{
+		tasks[dependency].dependents.push_back(id);
+	}
+	return id;
+}
+
+bool TaskGraph::Run(ThreadPool& threadPool)
+{
+	remainingDependencies = std::make_unique<std::atomic<std::size_t>[]>(tasks.size());
+	dependencyFailed = std::make_unique<std::atomic<bool>[]>(tasks.size());
+	for (TaskId id = 0; id < tasks.size(); id++)
+	{
+		remainingDependencies[id].store(tasks[id].dependencyCount, std::memory_order_relaxed);
+		dependencyFailed[id].store(false, std::memory_order_relaxed);
+	}
+	finishedCount = 0;
+	failedCount = 0;
+
+	for (TaskId id = 0; id < tasks.size(); id++)
+	{
+		if (tasks[id].dependencyCount == 0)
+		{
+			Start(threadPool, id);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(finishedMutex);
+	finishedChanged.wait(lock, [this]() { return finishedCount == tasks.size(); });
+	return failedCount == 0;
+}
+
+void TaskGraph::Start(ThreadPool& threadPool, TaskId id)
+{
+	threadPool.Enqueue([this, &threadPool, id]()
+		{
+			Finish(threadPool, id, tasks[id].work());
+		});
+}
+
+void TaskGraph::Finish(ThreadPool& threadPool, TaskId id, bool succeeded)
+{
+	for (TaskId dependent : tasks[id].dependents)
+	{
+		if (!succeeded)
+		{
+			dependencyFailed[dependent].store(true, std::memory_order_relaxed);
+		}
+
+		// The last dependency to finish decides whether the dependent runs
+		if (remainingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			if (dependencyFailed[dependent].load(std::memory_order_relaxed))
+			{
+				{
+					std::lock_guard<std::mutex> lock(finishedMutex);
+					std::cerr << "Skipped " << tasks[dependent].name << ", since a job it depends on failed" << std::endl;
+				}
+				Finish(threadPool, dependent, false);
+			}
+			else
+			{
+				Start(threadPool, dependent);
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(finishedMutex);
+	if (!succeeded)
+	{
+		failedCount++;
+	}
+	finishedCount++;
+	if (finishedCount == tasks.size())
+	{
+		finishedChanged.notify_all();
+	}
+}
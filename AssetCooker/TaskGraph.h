@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Jobs with dependencies between them. Running the graph starts each job on the worker threads as soon as
+/// every job it depends on has succeeded, so jobs that do not depend on each other run in parallel.
+/// Since a job can only depend on jobs added before it, the graph never has cycles.
+/// </summary>
+class TaskGraph
+{
+public:
+	using TaskId = std::size_t;
+
+	/// <summary>
+	/// Adds a job to the graph.
+	/// </summary>
+	/// <param name="name">Name of the job, used to report the jobs that were skipped</param>
+	/// <param name="work">Job to run, returning false if it failed</param>
+	/// <param name="dependencies">Jobs that have to succeed before this one can start</param>
+	/// <returns>Identifier of the job, for the jobs added later to depend on</returns>
+	TaskId Add(std::string name, std::function<bool()> work, const std::vector<TaskId>& dependencies = {});
+
+	/// <summary>
+	/// Runs every job once and returns when all of them are done. A job whose dependencies failed is skipped
+	/// (and counts as failed itself). Must not be called from a job of the same pool.
+	/// </summary>
+	/// <param name="threadPool">Worker threads that run the jobs</param>
+	/// <returns>True if every job succeeded</returns>
+	bool Run(ThreadPool& threadPool);
+
+private:
+	struct Task
+	{
+		std::string name;
+		std::function<bool()> work;
+		std::vector<TaskId> dependents;		// Jobs that depend on this one
+		std::size_t dependencyCount = 0;	// Number of jobs this one depends on
+	};
+
+	void Start(ThreadPool& threadPool, TaskId id);
+	void Finish(ThreadPool& threadPool, TaskId id, bool succeeded);
+
+	std::vector<Task> tasks;
+
+	// State of the current run
+	std::unique_ptr<std::atomic<std::size_t>[]> remainingDependencies;
+	std::unique_ptr<std::atomic<bool>[]> dependencyFailed;
+	std::mutex finishedMutex;
+	std::condition_variable finishedChanged;
+	std::size_t finishedCount = 0;
+	std::size_t failedCount = 0;
+};
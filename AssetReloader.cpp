@@ -0,0 +1,397 @@
+#include "AssetReloader.h"
+
+#include "Textures.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/// <summary>
+	/// Puts new contents in a buffer: in place if they fit in its storage, otherwise in new storage.
+	/// </summary>
+	void FillBuffer(GLuint buffer, const void* data, std::size_t size)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+		GLint capacity = 0;
+		glGetBufferParameteriv(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE, &capacity);
+		if (size <= static_cast<std::size_t>(capacity))
+		{
+			glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_STATIC_DRAW);
+		}
+	}
+
+	std::string JoinFilePaths(const std::vector<std::string>& filePaths)
+	{
+		std::string joined;
+		for (const std::string& filePath : filePaths)
+		{
+			joined += (joined.empty() ? "" : ", ") + filePath;
+		}
+		return joined;
+	}
+}
+
+AssetReloader::AssetReloader(std::vector<Exhibit>& exhibits, ThreadPool& threadPool, const MeshLoadSettings& settings,
+	VertexFormat vertexFormat)
+	: exhibits(exhibits), threadPool(threadPool), settings(settings), vertexFormat(vertexFormat)
+{
+	// A changed model is parsed from its .obj file, since the one in the archive is the old version
+	this->settings.archive = nullptr;
+
+	for (std::size_t i = 0; i < exhibits.size(); i++)
+	{
+		WatchedAsset mesh;
+		mesh.kind = AssetKind::ExhibitMesh;
+		mesh.filePaths.push_back(exhibits[i].meshFilePath);
+		mesh.exhibitIndex = i;
+		AddAsset(std::move(mesh));
+
+		WatchedAsset texture;
+		texture.kind = AssetKind::Texture;
+		texture.filePaths.push_back(exhibits[i].textureFilePath);
+		texture.exhibitIndex = i;
+		texture.exhibitTexture = true;
+		AddAsset(std::move(texture));
+	}
+}
+
+AssetReloader::~AssetReloader()
+{
+	watcher.Stop();
+	for (std::future<void>& job : jobs)
+	{
+		job.wait();
+	}
+}
+
+void AssetReloader::AddTexture(const std::string& imageFilePath, GLuint texture)
+{
+	WatchedAsset asset;
+	asset.kind = AssetKind::Texture;
+	asset.filePaths.push_back(imageFilePath);
+	asset.texture = texture;
+	AddAsset(std::move(asset));
+}
+
+void AssetReloader::AddTextureLayer(const std::string& imageFilePath, const TextureArray& textureArray, GLint layer)
+{
+	WatchedAsset asset;
+	asset.kind = AssetKind::TextureLayer;
+	asset.filePaths.push_back(imageFilePath);
+	asset.textureArray = &textureArray;
+	asset.layer = layer;
+	AddAsset(std::move(asset));
+}
+
+void AssetReloader::AddShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath, GLuint& program,
+	ShaderProgramBuilder builder)
+{
+	WatchedAsset asset;
+	asset.kind = AssetKind::ShaderProgram;
+	asset.filePaths.push_back(vertexShaderFilePath);
+	asset.filePaths.push_back(fragmentShaderFilePath);
+	asset.program = &program;
+	asset.builder = std::move(builder);
+	AddAsset(std::move(asset));
+}
+
+bool AssetReloader::Start()
+{
+	std::set<std::string> directories;
+	for (const std::pair<const std::string, std::size_t>& file : assetsByFile)
+	{
+		std::string directory = std::filesystem::path(file.first).parent_path().string();
+		directories.insert(directory.empty() ? "." : directory);
+	}
+
+	if (!watcher.Start(std::vector<std::string>(directories.begin(), directories.end())))
+	{
+		return false;
+	}
+
+	std::cout << "Watching " << assetsByFile.size() << " asset files for changes" << std::endl;
+	return true;
+}
+
+void AssetReloader::Update()
+{
+	// Every asset that uses a changed file is loaded again; an asset that changes again before its
+	// last reload was applied is simply loaded once more, and only its newest reload is applied
+	std::vector<std::string> changedFiles;
+	watcher.PopChanges(changedFiles);
+	for (const std::string& filePath : changedFiles)
+	{
+		std::pair<std::multimap<std::string, std::size_t>::iterator, std::multimap<std::string, std::size_t>::iterator> users
+			= assetsByFile.equal_range(filePath);
+		for (std::multimap<std::string, std::size_t>::iterator user = users.first; user != users.second; ++user)
+		{
+			WatchedAsset& asset = assets[user->second];
+			std::size_t assetIndex = user->second;
+			unsigned int generation = ++asset.generation;
+			AssetKind kind = asset.kind;
+			std::vector<std::string> filePaths = asset.filePaths;
+			TextureCompression compression = asset.textureArray != nullptr ? asset.textureArray->compression : TextureCompression::None;
+			jobs.push_back(threadPool.Submit([this, assetIndex, generation, kind, filePaths, compression]()
+			{
+				std::unique_ptr<Reload> reload = std::make_unique<Reload>();
+				reload->assetIndex = assetIndex;
+				reload->generation = generation;
+				LoadAsset(*reload, kind, filePaths, compression);
+				arrivals.Push(std::move(reload));
+			}));
+		}
+	}
+
+	jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+		[](const std::future<void>& job) { return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }), jobs.end());
+
+	arrivals.PopAll(waiting);
+	std::vector<std::unique_ptr<Reload>> stillWaiting;
+	for (std::unique_ptr<Reload>& reload : waiting)
+	{
+		if (!Apply(*reload))
+		{
+			stillWaiting.push_back(std::move(reload));
+		}
+	}
+	waiting = std::move(stillWaiting);
+
+	// Leave the buffer and texture bindings the way the render loop expects to find them
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void AssetReloader::AddAsset(WatchedAsset asset)
+{
+	for (const std::string& filePath : asset.filePaths)
+	{
+		assetsByFile.emplace(FileWatcher::GetWatchedPath(filePath), assets.size());
+	}
+	assets.push_back(std::move(asset));
+}
+
+void AssetReloader::LoadAsset(Reload& reload, AssetKind kind, const std::vector<std::string>& filePaths, TextureCompression compression) const
+{
+	std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+
+	switch (kind)
+	{
+	case AssetKind::ExhibitMesh:
+		// A model without triangles is most likely a file caught halfway through being saved, so the old one is kept
+		reload.loaded = LoadExhibitMesh(filePaths[0], settings, vertexFormat, reload.exhibit) && reload.exhibit.mesh.view.indexCount != 0;
+		break;
+
+	case AssetKind::Texture:
+	{
+		reload.loaded = LoadTexture(filePaths[0], nullptr, reload.texture);
+		break;
+	}
+
+	case AssetKind::TextureLayer:
+		// The layer has to match the rest of the array, down to its compression and every level of its mip chain,
+		// since the array's mip chain cannot be made again for one layer alone
+		reload.loaded = LoadTexture(filePaths[0], nullptr, reload.texture);
+		if (reload.loaded)
+		{
+			BuildMipChain(reload.texture, compression, &threadPool);
+		}
+		break;
+
+	case AssetKind::ShaderProgram:
+		reload.loaded = true;
+		for (const std::string& filePath : filePaths)
+		{
+			std::ifstream file(filePath);
+			std::ostringstream source;
+			source << file.rdbuf();
+			reload.loaded = reload.loaded && !file.fail();
+			reload.sources.push_back(source.str());
+		}
+		break;
+	}
+
+	reload.seconds = SecondsSince(loadStart);
+}
+
+bool AssetReloader::Apply(Reload& reload)
+{
+	WatchedAsset& asset = assets[reload.assetIndex];
+
+	// A newer reload of the same asset is on its way
+	if (reload.generation != asset.generation)
+	{
+		return true;
+	}
+
+	if (!reload.loaded)
+	{
+		std::cerr << "Failed to reload " << JoinFilePaths(asset.filePaths) << ", keeping the previous version" << std::endl;
+		return true;
+	}
+
+	// The objects of an exhibit are only there once it has streamed in
+	bool exhibitAsset = asset.kind == AssetKind::ExhibitMesh || (asset.kind == AssetKind::Texture && asset.exhibitTexture);
+	if (exhibitAsset && !exhibits[asset.exhibitIndex].ready)
+	{
+		return false;
+	}
+
+	std::chrono::steady_clock::time_point applyStart = std::chrono::steady_clock::now();
+	switch (asset.kind)
+	{
+	case AssetKind::ExhibitMesh:
+		ApplyMesh(asset, reload);
+		break;
+	case AssetKind::Texture:
+		ApplyTexture(asset, reload);
+		break;
+	case AssetKind::TextureLayer:
+		if (!ApplyTextureLayer(asset, reload))
+		{
+			return true;
+		}
+		break;
+	case AssetKind::ShaderProgram:
+		if (!ApplyShaderProgram(asset, reload))
+		{
+			return true;
+		}
+		break;
+	}
+
+	std::cout << "Reloaded " << JoinFilePaths(asset.filePaths) << " (loaded in " << reload.seconds * 1000.0
+		<< " ms on a worker thread, updated in " << SecondsSince(applyStart) * 1000.0 << " ms)" << std::endl;
+	return true;
+}
+
+void AssetReloader::ApplyMesh(const WatchedAsset& asset, Reload& reload)
+{
+	Exhibit& exhibit = exhibits[asset.exhibitIndex];
+	const ExhibitAssets& loaded = reload.exhibit;
+	const MeshView& mesh = loaded.mesh.view;
+
+	// The buffers keep their handles, so the vertex array object still points at them
+	std::size_t vertexBytes = mesh.vertexCount * GetVertexSize(vertexFormat);
+	const void* vertexData = vertexFormat == VertexFormat::Compact ? static_cast<const void*>(loaded.compactVertices.data()) : mesh.vertices;
+	FillBuffer(exhibit.vbo, vertexData, vertexBytes);
+	FillBuffer(exhibit.ebo, mesh.indices, mesh.indexCount * sizeof(GLuint));
+
+	// The model may have gained or lost its colors
+	if (!loaded.colors.empty())
+	{
+		if (exhibit.colorVbo == 0)
+		{
+			glGenBuffers(1, &exhibit.colorVbo);
+
+			// Vertex attribute 1 - Color, from its own stream
+			glBindVertexArray(exhibit.vao);
+			glBindBuffer(GL_ARRAY_BUFFER, exhibit.colorVbo);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, 4 * sizeof(GLubyte), (void*)0);
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		FillBuffer(exhibit.colorVbo, loaded.colors.data(), loaded.colors.size());
+	}
+	else if (exhibit.colorVbo != 0)
+	{
+		glBindVertexArray(exhibit.vao);
+		glDisableVertexAttribArray(1);
+		glBindVertexArray(0);
+		glDeleteBuffers(1, &exhibit.colorVbo);
+		exhibit.colorVbo = 0;
+	}
+
+	exhibit.vertexCount = static_cast<GLsizei>(mesh.vertexCount);
+	exhibit.lods = GetMeshLods(mesh);
+	exhibit.meshlets.assign(mesh.meshlets, mesh.meshlets + mesh.meshletCount);
+	exhibit.lod = 0;
+	exhibit.bounds = mesh.bounds;
+}
+
+void AssetReloader::ApplyTexture(const WatchedAsset& asset, Reload& reload)
+{
+	GLuint texture = asset.exhibitTexture ? exhibits[asset.exhibitIndex].texture : asset.texture;
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// An image of the same size and format replaces the pixels in place; otherwise the texture gets new storage
+	// (as when a texture cooked block compressed is replaced by its uncompressed source image).
+	// Either way, the rest of the mip chain is made again from the new full-size level
+	LoadedTexture& image = reload.texture;
+	GLint width = 0;
+	GLint height = 0;
+	GLint internalFormat = 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	if (width == image.width && height == image.height && static_cast<GLenum>(internalFormat) == GetTextureInternalFormat(image))
+	{
+		// Rows of three-byte pixels are tightly packed
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, GetTextureFormat(image.channels), GL_UNSIGNED_BYTE,
+			image.levels[0].pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		CompleteMipChain(image);
+	}
+	else
+	{
+		UploadTexture(image);
+	}
+}
+
+bool AssetReloader::ApplyTextureLayer(const WatchedAsset& asset, Reload& reload)
+{
+	// The layers of an array all share one size and format
+	LoadedTexture& image = reload.texture;
+	PrepareTextureForUpload(image);
+	if (!FitsTextureArray(*asset.textureArray, image))
+	{
+		std::cerr << "The new " << JoinFilePaths(asset.filePaths) << " does not match the other layers of its texture array"
+			<< ", keeping the previous version" << std::endl;
+		return false;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, asset.textureArray->texture);
+	UploadTextureLayer(*asset.textureArray, image, asset.layer);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return true;
+}
+
+bool AssetReloader::ApplyShaderProgram(WatchedAsset& asset, Reload& reload)
+{
+	GLuint program = asset.builder(reload.sources[0], reload.sources[1]);
+
+	GLint linkStatus = GL_FALSE;
+	if (program != 0)
+	{
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+	}
+	if (linkStatus != GL_TRUE)
+	{
+		std::cerr << "The new " << JoinFilePaths(asset.filePaths) << " failed to build, keeping the previous shader program" << std::endl;
+		glDeleteProgram(program);
+		return false;
+	}
+
+	glDeleteProgram(*asset.program);
+	*asset.program = program;
+	return true;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Exhibit.h"
+#include "ExhibitStreamer.h"
+#include "FileWatcher.h"
+#include "MeshCache.h"
+#include "MpscQueue.h"
+#include "Textures.h"
+#include "VertexFormat.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Builds a shader program from the sources of its vertex and fragment shaders (called on the OpenGL thread)
+/// </summary>
+using ShaderProgramBuilder = std::function<GLuint(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)>;
+
+/// <summary>
+/// Reloads assets while the program runs, as soon as their source files change on disk: the models and textures
+/// of the exhibits, the textures of the room and the shader program. A changed file is loaded again on a worker thread
+/// from the source file (never from the asset archive, which still holds the old version), and only the OpenGL objects
+/// that come from it are updated, on the OpenGL thread: buffers are refilled in place when the new data fits,
+/// and a shader program that fails to build leaves the old one in use.
+/// </summary>
+class AssetReloader
+{
+public:
+	/// <summary>
+	/// Creates a reloader that watches the models and textures of the exhibits.
+	/// </summary>
+	/// <param name="exhibits">Exhibits to keep up to date (must outlive the reloader and keep its size)</param>
+	/// <param name="threadPool">Worker threads that load the changed assets</param>
+	/// <param name="settings">Settings for loading the models (the asset archive is ignored)</param>
+	/// <param name="vertexFormat">Format the vertices of the models were uploaded in</param>
+	AssetReloader(std::vector<Exhibit>& exhibits, ThreadPool& threadPool, const MeshLoadSettings& settings, VertexFormat vertexFormat);
+
+	/// <summary>
+	/// Stops watching and waits for the worker threads to finish the assets they are still loading.
+	/// </summary>
+	~AssetReloader();
+
+	AssetReloader(const AssetReloader&) = delete;
+	AssetReloader& operator=(const AssetReloader&) = delete;
+
+	/// <summary>
+	/// Also watches an image that a texture was created from.
+	/// </summary>
+	/// <param name="imageFilePath">Path to the image</param>
+	/// <param name="texture">OpenGL handle to the texture, which keeps its handle when the image is reloaded</param>
+	void AddTexture(const std::string& imageFilePath, GLuint texture);
+
+	/// <summary>
+	/// Also watches an image that fills a layer of a texture array. The new image is given the array's
+	/// compression and a full mip chain on the worker thread, and only replaces the layer if it still fits the array.
+	/// </summary>
+	/// <param name="imageFilePath">Path to the image</param>
+	/// <param name="textureArray">Texture array the image is a layer of (must outlive the reloader)</param>
+	/// <param name="layer">Layer the image fills</param>
+	void AddTextureLayer(const std::string& imageFilePath, const TextureArray& textureArray, GLint layer);
+
+	/// <summary>
+	/// Also watches the sources of a shader program.
+	/// </summary>
+	/// <param name="vertexShaderFilePath">Path to the vertex shader</param>
+	/// <param name="fragmentShaderFilePath">Path to the fragment shader</param>
+	/// <param name="program">Handle to the program, replaced (and the old program deleted) when a new one links successfully</param>
+	/// <param name="builder">Builds a program from the new sources</param>
+	void AddShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath, GLuint& program,
+		ShaderProgramBuilder builder);
+
+	/// <summary>
+	/// Starts watching the directories of every asset added so far.
+	/// </summary>
+	/// <returns>True if the files are being watched</returns>
+	bool Start();
+
+	/// <summary>
+	/// Starts loading the assets whose files changed, and updates the OpenGL objects of the ones that finished loading.
+	/// A model that is still streaming in keeps its reload until it is ready. Must be called on the OpenGL thread.
+	/// </summary>
+	void Update();
+
+private:
+	/// <summary>
+	/// What an asset is, which decides how it is loaded and what it updates
+	/// </summary>
+	enum class AssetKind
+	{
+		ExhibitMesh,	// Model of an exhibit
+		Texture,		// Texture of an exhibit or of the room
+		TextureLayer,	// Layer of a texture array
+		ShaderProgram	// Shader program built from a vertex and a fragment shader
+	};
+
+	/// <summary>
+	/// Asset whose files are watched
+	/// </summary>
+	struct WatchedAsset
+	{
+		AssetKind kind;
+		std::vector<std::string> filePaths;	// Files the asset is loaded from
+		std::size_t exhibitIndex = 0;		// Exhibit the model belongs to (ExhibitMesh), or the exhibit whose texture it is
+		bool exhibitTexture = false;		// Indicates if the texture belongs to an exhibit (Texture)
+		GLuint texture = 0;					// OpenGL handle to the texture (Texture, unless it belongs to an exhibit)
+		const TextureArray* textureArray = nullptr;	// Texture array (TextureLayer)
+		GLint layer = 0;					// Layer of the texture array (TextureLayer)
+		GLuint* program = nullptr;			// Handle to the shader program (ShaderProgram)
+		ShaderProgramBuilder builder;		// Builds the shader program (ShaderProgram)
+		unsigned int generation = 0;		// Number of reloads started, so that only the latest one is applied
+	};
+
+	/// <summary>
+	/// New version of an asset, loaded by a worker thread
+	/// </summary>
+	struct Reload
+	{
+		std::size_t assetIndex = 0;		// Asset the reload is for
+		unsigned int generation = 0;	// Generation of the asset when the reload started
+		bool loaded = false;			// Indicates if the files were loaded successfully
+		ExhibitAssets exhibit;			// New model (ExhibitMesh)
+		LoadedTexture texture;			// New image (Texture, TextureLayer)
+		std::vector<std::string> sources;	// New shader sources, in the order of the files (ShaderProgram)
+		double seconds = 0.0;			// Time the worker thread spent loading
+	};
+
+	void AddAsset(WatchedAsset asset);
+	void LoadAsset(Reload& reload, AssetKind kind, const std::vector<std::string>& filePaths, TextureCompression compression) const;
+	bool Apply(Reload& reload);
+	void ApplyMesh(const WatchedAsset& asset, Reload& reload);
+	void ApplyTexture(const WatchedAsset& asset, Reload& reload);
+	bool ApplyTextureLayer(const WatchedAsset& asset, Reload& reload);
+	bool ApplyShaderProgram(WatchedAsset& asset, Reload& reload);
+
+	std::vector<Exhibit>& exhibits;
+	ThreadPool& threadPool;
+	MeshLoadSettings settings;
+	VertexFormat vertexFormat;
+
+	std::vector<WatchedAsset> assets;
+	std::multimap<std::string, std::size_t> assetsByFile;	// Assets that use each watched file, by GetWatchedPath
+
+	FileWatcher watcher;
+	MpscQueue<std::unique_ptr<Reload>> arrivals;		// Reloads handed over by the worker threads
+	std::vector<std::unique_ptr<Reload>> waiting;		// Reloads of models that are still streaming in
+	std::vector<std::future<void>> jobs;
+};
@@ -0,0 +1,330 @@
+#include "Benchmarks.h"
+
+#include "LevelOfDetail.h"
+#include "Meshlets.h"
+#include "ObjLoader.h"
+#include "PixelKernels.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace
+{
+	/// <summary>
+	/// Times of loading one model repeatedly
+	/// </summary>
+	struct LoadTimes
+	{
+		double first = 0.0;
+		double best = std::numeric_limits<double>::max();
+	};
+
+	bool TimeObjLoading(const std::string& filePath, ThreadPool* threadPool, ObjFileReading reading, int repetitions, LoadTimes& times, ObjLoadStats& stats)
+	{
+		for (int i = 0; i < repetitions; i++)
+		{
+			MeshData mesh;
+			if (!LoadObjFile(filePath, mesh, &stats, threadPool, reading))
+			{
+				return false;
+			}
+
+			if (i == 0)
+			{
+				times.first = stats.seconds;
+			}
+			times.best = std::min(times.best, stats.seconds);
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// One pixel kernel, run on an image of random bytes. Kernels that work in place run on output, which holds a copy of the input
+	/// </summary>
+	struct PixelKernelCase
+	{
+		const char* name;
+		int channels;		// Bytes per pixel of the input
+		bool inPlace;		// Indicates if the kernel works in place
+		std::function<void(const std::vector<unsigned char>& input, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)> run;
+	};
+
+	std::vector<PixelKernelCase> GetPixelKernelCases()
+	{
+		return
+		{
+			{ "Flip RGB", 3, true, [](const std::vector<unsigned char>&, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					FlipRows(output.data(), width, height, 3, level);
+				} },
+			{ "Expand RGB to RGBA", 3, false, [](const std::vector<unsigned char>& input, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					output.resize(static_cast<std::size_t>(width) * height * 4);
+					ExpandRgbToRgba(input.data(), static_cast<std::size_t>(width) * height, output.data(), level);
+				} },
+			{ "Swap red and blue", 4, true, [](const std::vector<unsigned char>&, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					SwapRedBlue(output.data(), static_cast<std::size_t>(width) * height, level);
+				} },
+			{ "Premultiply alpha", 4, true, [](const std::vector<unsigned char>&, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					PremultiplyAlpha(output.data(), static_cast<std::size_t>(width) * height, level);
+				} },
+			{ "Halve sRGB RGB", 3, false, [](const std::vector<unsigned char>& input, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					output.resize(static_cast<std::size_t>(std::max(1, width / 2)) * std::max(1, height / 2) * 3);
+					HalveImageSrgb(input.data(), width, height, 3, output.data(), level);
+				} },
+			{ "Halve sRGB RGBA", 4, false, [](const std::vector<unsigned char>& input, int width, int height, PixelKernelLevel level, std::vector<unsigned char>& output)
+				{
+					output.resize(static_cast<std::size_t>(std::max(1, width / 2)) * std::max(1, height / 2) * 4);
+					HalveImageSrgb(input.data(), width, height, 4, output.data(), level);
+				} }
+		};
+	}
+
+	std::vector<unsigned char> MakeRandomImage(std::mt19937& random, int width, int height, int channels)
+	{
+		std::vector<unsigned char> pixels(static_cast<std::size_t>(width) * height * channels);
+		for (unsigned char& byte : pixels)
+		{
+			byte = static_cast<unsigned char>(random() & 0xFF);
+		}
+		return pixels;
+	}
+
+	/// <summary>
+	/// Place the camera may stand in the room
+	/// </summary>
+	struct Viewpoint
+	{
+		const char* name;
+		glm::vec3 position;
+	};
+}
+
+bool RunObjReadingBenchmark(const std::vector<Exhibit>& exhibits, ThreadPool* threadPool, int repetitions)
+{
+	repetitions = std::max(1, repetitions);
+
+	std::cout << "OBJ reading benchmark (" << repetitions << " runs per model, times in ms; "
+		<< "the first run may come from a cold page cache, later runs are warm)" << std::endl;
+	std::cout << std::left << std::setw(34) << "Model" << std::right
+		<< std::setw(10) << "MB"
+		<< std::setw(14) << "mmap first"
+		<< std::setw(13) << "mmap best"
+		<< std::setw(14) << "read first"
+		<< std::setw(13) << "read best"
+		<< std::setw(10) << "speedup" << std::endl;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (const Exhibit& exhibit : exhibits)
+	{
+		// The mapped reading runs first, so it is the one that pays for a cold page cache
+		LoadTimes mappedTimes, bufferedTimes;
+		ObjLoadStats stats;
+		if (!TimeObjLoading(exhibit.meshFilePath, threadPool, ObjFileReading::MemoryMapped, repetitions, mappedTimes, stats)
+			|| !TimeObjLoading(exhibit.meshFilePath, threadPool, ObjFileReading::Buffered, repetitions, bufferedTimes, stats))
+		{
+			return false;
+		}
+
+		std::cout << std::left << std::setw(34) << exhibit.meshFilePath << std::right
+			<< std::setw(10) << stats.bytes / (1024.0 * 1024.0)
+			<< std::setw(14) << mappedTimes.first * 1000.0
+			<< std::setw(13) << mappedTimes.best * 1000.0
+			<< std::setw(14) << bufferedTimes.first * 1000.0
+			<< std::setw(13) << bufferedTimes.best * 1000.0
+			<< std::setw(9) << bufferedTimes.best / mappedTimes.best << "x" << std::endl;
+	}
+
+	std::cout << std::defaultfloat;
+	return true;
+}
+
+bool RunLodBenchmark(std::vector<Exhibit>& exhibits, const MeshLoadSettings& settings, float maxPixelError, float verticalFieldOfView, int viewportHeight)
+{
+	std::cout << "Level of detail benchmark (at most " << maxPixelError << " pixels of error on a " << viewportHeight << "-pixel-high viewport)" << std::endl;
+
+	for (Exhibit& exhibit : exhibits)
+	{
+		LoadedMesh mesh;
+		if (!LoadMesh(exhibit.meshFilePath, mesh, settings))
+		{
+			return false;
+		}
+		exhibit.lods = GetMeshLods(mesh.view);
+		exhibit.meshlets.assign(mesh.view.meshlets, mesh.view.meshlets + mesh.view.meshletCount);
+		exhibit.bounds = mesh.view.bounds;
+
+		std::cout << "  " << exhibit.meshFilePath << ":";
+		for (std::size_t i = 0; i < exhibit.lods.size(); i++)
+		{
+			std::cout << (i == 0 ? " " : ", ") << exhibit.lods[i].indexCount / 3 << " (error " << exhibit.lods[i].error << ")";
+		}
+		std::cout << std::endl;
+	}
+
+	// The starting position, the middle of the room, and the corners the visitors can walk to
+	const Viewpoint viewpoints[] =
+	{
+		{ "Start", glm::vec3(-23.0f, -15.0f, 0.0f) },
+		{ "Center", glm::vec3(0.0f, -15.0f, 0.0f) },
+		{ "Corner (-23, -23)", glm::vec3(-23.0f, -15.0f, -23.0f) },
+		{ "Corner (-23, 23)", glm::vec3(-23.0f, -15.0f, 23.0f) },
+		{ "Corner (23, -23)", glm::vec3(23.0f, -15.0f, -23.0f) },
+		{ "Corner (23, 23)", glm::vec3(23.0f, -15.0f, 23.0f) }
+	};
+
+	std::cout << std::left << std::setw(20) << "Viewpoint" << std::setw(16) << "Levels" << std::right
+		<< std::setw(14) << "Full detail"
+		<< std::setw(14) << "With LODs"
+		<< std::setw(10) << "Saved"
+		<< std::setw(16) << "Front-facing" << std::endl;
+
+	// The benchmark looks at where each level would settle, so it picks without hysteresis
+	LodSelectionSettings lodSettings;
+	lodSettings.maxPixelError = maxPixelError;
+	lodSettings.hysteresis = 0.0f;
+
+	std::size_t totalFullTriangles = 0;
+	std::size_t totalLodTriangles = 0;
+	std::size_t totalFrontTriangles = 0;
+	for (const Viewpoint& viewpoint : viewpoints)
+	{
+		std::string levels;
+		std::size_t fullTriangles = 0;
+		std::size_t lodTriangles = 0;
+		std::size_t frontTriangles = 0;
+		for (const Exhibit& exhibit : exhibits)
+		{
+			float pixelsPerUnit = GetExhibitPixelsPerUnit(exhibit, viewpoint.position, verticalFieldOfView, viewportHeight);
+			std::size_t lod = SelectLod(exhibit.lods.data(), exhibit.lods.size(), 0, pixelsPerUnit, lodSettings);
+
+			levels += std::to_string(lod) + " ";
+			fullTriangles += exhibit.lods[0].indexCount / 3;
+			lodTriangles += exhibit.lods[lod].indexCount / 3;
+
+			// The meshlets of the level that do not face away from the viewpoint, with the model not yet spun around
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), exhibit.position), exhibit.scale);
+			glm::vec3 modelViewpoint = glm::vec3(glm::inverse(model) * glm::vec4(viewpoint.position, 1.0f));
+			std::size_t levelFrontTriangles = exhibit.lods[lod].indexCount / 3;
+			for (GLuint i = 0; i < exhibit.lods[lod].meshletCount; i++)
+			{
+				const Meshlet& meshlet = exhibit.meshlets[exhibit.lods[lod].firstMeshlet + i];
+				levelFrontTriangles -= IsMeshletBackFacing(meshlet, modelViewpoint) ? meshlet.indexCount / 3 : 0;
+			}
+			frontTriangles += levelFrontTriangles;
+		}
+
+		std::cout << std::left << std::setw(20) << viewpoint.name << std::setw(16) << levels << std::right
+			<< std::setw(14) << fullTriangles
+			<< std::setw(14) << lodTriangles
+			<< std::setw(9) << std::fixed << std::setprecision(1) << 100.0 * (fullTriangles - lodTriangles) / std::max<std::size_t>(1, fullTriangles)
+			<< "%" << std::defaultfloat
+			<< std::setw(16) << frontTriangles << std::endl;
+
+		totalFullTriangles += fullTriangles;
+		totalLodTriangles += lodTriangles;
+		totalFrontTriangles += frontTriangles;
+	}
+
+	std::cout << "Triangles saved over all viewpoints: " << totalFullTriangles - totalLodTriangles << " of " << totalFullTriangles
+		<< " (" << std::fixed << std::setprecision(1) << 100.0 * (totalFullTriangles - totalLodTriangles) / std::max<std::size_t>(1, totalFullTriangles)
+		<< "%)" << std::defaultfloat << std::endl;
+	std::cout << "Of the levels drawn, meshlets facing away from the viewpoint hold " << totalLodTriangles - totalFrontTriangles
+		<< " triangles (" << std::fixed << std::setprecision(1) << 100.0 * (totalLodTriangles - totalFrontTriangles) / std::max<std::size_t>(1, totalLodTriangles)
+		<< "%)" << std::defaultfloat << std::endl;
+	return true;
+}
+
+bool RunPixelKernelBenchmark(int repetitions)
+{
+	repetitions = std::max(1, repetitions);
+
+	std::vector<PixelKernelLevel> levels;
+	for (PixelKernelLevel level : { PixelKernelLevel::Scalar, PixelKernelLevel::Sse2, PixelKernelLevel::Avx2, PixelKernelLevel::Neon })
+	{
+		if (IsPixelKernelLevelSupported(level))
+		{
+			levels.push_back(level);
+		}
+	}
+	std::vector<PixelKernelCase> cases = GetPixelKernelCases();
+
+	// Every vectorized form must give exactly the bytes of the scalar one, tails and edge cases included
+	const int checkSizes[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 3, 5 }, { 17, 9 }, { 33, 2 }, { 64, 64 }, { 129, 67 }, { 255, 31 } };
+	std::mt19937 random(2024);
+	bool matching = true;
+	for (const PixelKernelCase& kernel : cases)
+	{
+		for (const int* size : checkSizes)
+		{
+			std::vector<unsigned char> input = MakeRandomImage(random, size[0], size[1], kernel.channels);
+			std::vector<unsigned char> expected = kernel.inPlace ? input : std::vector<unsigned char>();
+			kernel.run(input, size[0], size[1], PixelKernelLevel::Scalar, expected);
+			for (PixelKernelLevel level : levels)
+			{
+				std::vector<unsigned char> output = kernel.inPlace ? input : std::vector<unsigned char>();
+				kernel.run(input, size[0], size[1], level, output);
+				if (output != expected)
+				{
+					std::cerr << kernel.name << " with " << GetPixelKernelLevelName(level) << " differs from the scalar form on a "
+						<< size[0] << "x" << size[1] << " image" << std::endl;
+					matching = false;
+				}
+			}
+		}
+	}
+
+	const int width = 2048;
+	const int height = 2048;
+	std::cout << "Pixel kernel benchmark (" << width << "x" << height << " image, best of " << repetitions << " runs, times in ms; "
+		<< GetPixelKernelLevelName(GetPixelKernelLevel()) << " is used by default)" << std::endl;
+	std::cout << std::left << std::setw(22) << "Kernel" << std::right;
+	for (PixelKernelLevel level : levels)
+	{
+		std::cout << std::setw(10) << GetPixelKernelLevelName(level);
+	}
+	std::cout << std::setw(10) << "speedup" << std::endl;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (const PixelKernelCase& kernel : cases)
+	{
+		std::vector<unsigned char> input = MakeRandomImage(random, width, height, kernel.channels);
+		std::vector<unsigned char> output;
+		std::cout << std::left << std::setw(22) << kernel.name << std::right;
+		double scalarBest = 0.0;
+		double best = 0.0;
+		for (PixelKernelLevel level : levels)
+		{
+			best = std::numeric_limits<double>::max();
+			for (int i = 0; i < repetitions; i++)
+			{
+				if (kernel.inPlace)
+				{
+					output = input;
+				}
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				kernel.run(input, width, height, level, output);
+				best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			}
+			scalarBest = level == PixelKernelLevel::Scalar ? best : scalarBest;
+			std::cout << std::setw(10) << best * 1000.0;
+		}
+		std::cout << std::setw(9) << scalarBest / best << "x" << std::endl;
+	}
+
+	std::cout << std::defaultfloat;
+	return matching;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Exhibit.h"
+#include "MeshCache.h"
+
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Loads the model of every exhibit several times, once by parsing straight out of a memory
+/// mapping of the file and once by reading the file into a buffer first, and prints the best
+/// and first-run times of both ways side by side.
+/// </summary>
+/// <param name="exhibits">Exhibits whose models are loaded</param>
+/// <param name="threadPool">Optional worker threads used to parse large files in parallel</param>
+/// <param name="repetitions">Number of times each model is loaded each way</param>
+/// <returns>True if every model was loaded successfully</returns>
+bool RunObjReadingBenchmark(const std::vector<Exhibit>& exhibits, ThreadPool* threadPool, int repetitions);
+
+/// <summary>
+/// Loads the model of every exhibit with its levels of detail and prints, for a few typical viewpoints
+/// in the room, which level each model would be drawn with, how many triangles that saves, and how many
+/// triangles of those levels are left once the meshlets that face away from the viewpoint are culled.
+/// </summary>
+/// <param name="exhibits">Exhibits whose models are loaded (receive their levels of detail, meshlets and bounds)</param>
+/// <param name="settings">Settings for loading the models</param>
+/// <param name="maxPixelError">Largest error a level of detail may show on screen, in pixels</param>
+/// <param name="verticalFieldOfView">Vertical field of view of the projection, in radians</param>
+/// <param name="viewportHeight">Height of the viewport in pixels</param>
+/// <returns>True if every model was loaded successfully</returns>
+bool RunLodBenchmark(std::vector<Exhibit>& exhibits, const MeshLoadSettings& settings, float maxPixelError, float verticalFieldOfView, int viewportHeight);
+
+/// <summary>
+/// Checks every pixel kernel, with every instruction set this processor supports, against its scalar form on images of
+/// awkward sizes (1 pixel wide or high, odd, not a multiple of any vector width), then times each on a large image and
+/// prints the best times side by side.
+/// </summary>
+/// <param name="repetitions">Number of times each kernel runs on the large image with each instruction set</param>
+/// <returns>True if every instruction set gave the same bytes as the scalar form</returns>
+bool RunPixelKernelBenchmark(int repetitions);
@@ -0,0 +1,495 @@
+#include "BlockCompression.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	/// <summary>
+	/// Size of a 4x4 block of the given format in bytes
+	/// </summary>
+	std::size_t GetBlockSize(TextureCompression compression)
+	{
+		return compression == TextureCompression::Bc1 ? 8 : 16;
+	}
+
+	/// <summary>
+	/// Pixels of one block, 4 rows of 4, always as RGBA
+	/// </summary>
+	struct PixelBlock
+	{
+		unsigned char pixels[16][4];
+	};
+
+	PixelBlock ReadBlock(const unsigned char* pixels, int width, int height, int channels, int blockX, int blockY)
+	{
+		PixelBlock block;
+		for (int y = 0; y < 4; y++)
+		{
+			int sourceY = std::min(blockY * 4 + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				int sourceX = std::min(blockX * 4 + x, width - 1);
+				const unsigned char* source = pixels + (static_cast<std::size_t>(sourceY) * width + sourceX) * channels;
+				unsigned char* pixel = block.pixels[y * 4 + x];
+				pixel[0] = source[0];
+				pixel[1] = source[1];
+				pixel[2] = source[2];
+				pixel[3] = channels == 4 ? source[3] : 255;
+			}
+		}
+		return block;
+	}
+
+	std::uint16_t PackRgb565(const float color[3])
+	{
+		int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+		int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+		int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+		return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	/// <summary>
+	/// Widens a 5:6:5 color to 8 bits per channel, repeating the top bits in the bottom ones so 31 and 63 become 255
+	/// </summary>
+	void UnpackRgb565(std::uint16_t packed, int color[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	/// <summary>
+	/// The four colors a block's indices choose from: its two endpoints and the two colors a third of the way between them.
+	/// A BC1 block whose first endpoint is not greater than its second has three colors instead, the last index being transparent black.
+	/// </summary>
+	void GetColorPalette(std::uint16_t color0, std::uint16_t color1, bool fourColors, int palette[4][4])
+	{
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		palette[0][3] = 255;
+		palette[1][3] = 255;
+		for (int c = 0; c < 3; c++)
+		{
+			if (fourColors)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = fourColors ? 255 : 0;
+	}
+
+	int GetColorDistance(const unsigned char* pixel, const int color[4])
+	{
+		int r = pixel[0] - color[0];
+		int g = pixel[1] - color[1];
+		int b = pixel[2] - color[2];
+		return r * r + g * g + b * b;
+	}
+
+	void Write16(unsigned char* bytes, std::uint16_t value)
+	{
+		bytes[0] = static_cast<unsigned char>(value);
+		bytes[1] = static_cast<unsigned char>(value >> 8);
+	}
+
+	std::uint16_t Read16(const unsigned char* bytes)
+	{
+		return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+	}
+
+	std::uint32_t Read32(const unsigned char* bytes)
+	{
+		return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8)
+			| (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+	}
+
+	/// <summary>
+	/// Quantizes two endpoints to 5:6:5 and picks the closest of the four palette colors for every pixel.
+	/// The endpoints are ordered so the first is greater, which keeps the block in four-color mode for BC1 as well.
+	/// </summary>
+	/// <returns>Sum of the squared differences between the pixels and their colors</returns>
+	int EncodeColorBlock(const PixelBlock& block, const float endpoint0[3], const float endpoint1[3], unsigned char* output)
+	{
+		std::uint16_t color0 = PackRgb565(endpoint0);
+		std::uint16_t color1 = PackRgb565(endpoint1);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		int palette[4][4];
+		GetColorPalette(color0, color1, true, palette);
+
+		// With both endpoints equal a BC1 decoder falls back to three-color mode, where only the first two indices
+		// still mean the same thing, so every pixel uses index 0
+		int colorCount = color0 == color1 ? 1 : 4;
+		std::uint32_t indices = 0;
+		int error = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			int bestDistance = GetColorDistance(block.pixels[i], palette[0]);
+			for (int index = 1; index < colorCount; index++)
+			{
+				int distance = GetColorDistance(block.pixels[i], palette[index]);
+				if (distance < bestDistance)
+				{
+					bestIndex = index;
+					bestDistance = distance;
+				}
+			}
+			indices |= static_cast<std::uint32_t>(bestIndex) << (i * 2);
+			error += bestDistance;
+		}
+
+		Write16(output, color0);
+		Write16(output + 2, color1);
+		for (int i = 0; i < 4; i++)
+		{
+			output[4 + i] = static_cast<unsigned char>(indices >> (i * 8));
+		}
+		return error;
+	}
+
+	/// <summary>
+	/// Given the indices an encoded block chose, finds the two endpoints that best reproduce the pixels with those indices
+	/// (least squares, each pixel being the blend of the endpoints its index stands for).
+	/// </summary>
+	/// <returns>False if every pixel uses the same blend, which leaves the endpoints undetermined</returns>
+	bool RefineEndpoints(const PixelBlock& block, const unsigned char* encoded, float endpoint0[3], float endpoint1[3])
+	{
+		// Weight of the first endpoint for each index (the second one gets the rest)
+		const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+		std::uint32_t indices = Read32(encoded + 4);
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ap[3] = {}, bp[3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float a = weights[(indices >> (i * 2)) & 3];
+			float b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < 3; c++)
+			{
+				ap[c] += a * block.pixels[i][c];
+				bp[c] += b * block.pixels[i][c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			endpoint0[c] = std::clamp((bb * ap[c] - ab * bp[c]) / determinant, 0.0f, 255.0f);
+			endpoint1[c] = std::clamp((aa * bp[c] - ab * ap[c]) / determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Compresses the colors of a block into 8 bytes. The endpoints start at the ends of the range the pixels cover
+	/// along their principal axis, the direction in which their colors vary the most.
+	/// </summary>
+	void CompressColorBlock(const PixelBlock& block, unsigned char* output)
+	{
+		float mean[3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				mean[c] += block.pixels[i][c] / 16.0f;
+			}
+		}
+
+		float covariance[3][3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float offset[3] = { block.pixels[i][0] - mean[0], block.pixels[i][1] - mean[1], block.pixels[i][2] - mean[2] };
+			for (int row = 0; row < 3; row++)
+			{
+				for (int column = 0; column < 3; column++)
+				{
+					covariance[row][column] += offset[row] * offset[column];
+				}
+			}
+		}
+
+		// Power iteration, starting from the covariance of the channel that varies the most
+		// (which is never orthogonal to the principal axis unless the block is a single color)
+		int widest = 0;
+		for (int c = 1; c < 3; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest])
+			{
+				widest = c;
+			}
+		}
+		float axis[3] = { covariance[widest][0], covariance[widest][1], covariance[widest][2] };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[3];
+			for (int row = 0; row < 3; row++)
+			{
+				next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+			}
+			float largest = std::max({ std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2]) });
+			if (largest == 0.0f)
+			{
+				break;
+			}
+			for (int c = 0; c < 3; c++)
+			{
+				axis[c] = next[c] / largest;
+			}
+		}
+
+		float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+		if (length > 0.0f)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				axis[c] /= length;
+			}
+			for (int i = 0; i < 16; i++)
+			{
+				float projection = (block.pixels[i][0] - mean[0]) * axis[0] + (block.pixels[i][1] - mean[1]) * axis[1]
+					+ (block.pixels[i][2] - mean[2]) * axis[2];
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+		}
+
+		float endpoint0[3];
+		float endpoint1[3];
+		for (int c = 0; c < 3; c++)
+		{
+			endpoint0[c] = mean[c] + axis[c] * maxProjection;
+			endpoint1[c] = mean[c] + axis[c] * minProjection;
+		}
+
+		int bestError = EncodeColorBlock(block, endpoint0, endpoint1, output);
+		for (int iteration = 0; iteration < 2 && bestError > 0; iteration++)
+		{
+			unsigned char refined[8];
+			if (!RefineEndpoints(block, output, endpoint0, endpoint1))
+			{
+				break;
+			}
+			int error = EncodeColorBlock(block, endpoint0, endpoint1, refined);
+			if (error >= bestError)
+			{
+				break;
+			}
+			std::memcpy(output, refined, sizeof(refined));
+			bestError = error;
+		}
+	}
+
+	/// <summary>
+	/// The eight alpha values a BC3 block's indices choose from: its two endpoints, the first being greater,
+	/// and six evenly spaced between them
+	/// </summary>
+	void GetAlphaPalette(int alpha0, int alpha1, int palette[8])
+	{
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		if (alpha0 > alpha1)
+		{
+			for (int i = 1; i < 7; i++)
+			{
+				palette[i + 1] = ((7 - i) * alpha0 + i * alpha1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 1; i < 5; i++)
+			{
+				palette[i + 1] = ((5 - i) * alpha0 + i * alpha1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	/// <summary>
+	/// Compresses the alpha of a block into 8 bytes, with the block's own range of alpha as the endpoints
+	/// </summary>
+	void CompressAlphaBlock(const PixelBlock& block, unsigned char* output)
+	{
+		int minAlpha = 255;
+		int maxAlpha = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minAlpha = std::min(minAlpha, static_cast<int>(block.pixels[i][3]));
+			maxAlpha = std::max(maxAlpha, static_cast<int>(block.pixels[i][3]));
+		}
+
+		int palette[8];
+		GetAlphaPalette(maxAlpha, minAlpha, palette);
+
+		std::uint64_t indices = 0;
+		if (maxAlpha != minAlpha)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int bestIndex = 0;
+				int bestDistance = 256;
+				for (int index = 0; index < 8; index++)
+				{
+					int distance = std::abs(block.pixels[i][3] - palette[index]);
+					if (distance < bestDistance)
+					{
+						bestIndex = index;
+						bestDistance = distance;
+					}
+				}
+				indices |= static_cast<std::uint64_t>(bestIndex) << (i * 3);
+			}
+		}
+
+		output[0] = static_cast<unsigned char>(maxAlpha);
+		output[1] = static_cast<unsigned char>(minAlpha);
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+		}
+	}
+
+	void DecompressColorBlock(const unsigned char* input, bool alwaysFourColors, PixelBlock& block)
+	{
+		std::uint16_t color0 = Read16(input);
+		std::uint16_t color1 = Read16(input + 2);
+		int palette[4][4];
+		GetColorPalette(color0, color1, alwaysFourColors || color0 > color1, palette);
+
+		std::uint32_t indices = Read32(input + 4);
+		for (int i = 0; i < 16; i++)
+		{
+			const int* color = palette[(indices >> (i * 2)) & 3];
+			for (int c = 0; c < 4; c++)
+			{
+				block.pixels[i][c] = static_cast<unsigned char>(color[c]);
+			}
+		}
+	}
+
+	void DecompressAlphaBlock(const unsigned char* input, PixelBlock& block)
+	{
+		int palette[8];
+		GetAlphaPalette(input[0], input[1], palette);
+
+		std::uint64_t indices = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			indices |= static_cast<std::uint64_t>(input[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			block.pixels[i][3] = static_cast<unsigned char>(palette[(indices >> (i * 3)) & 7]);
+		}
+	}
+}
+
+std::size_t GetCompressedImageSize(int width, int height, TextureCompression compression)
+{
+	std::size_t blocksWide = static_cast<std::size_t>(width + 3) / 4;
+	std::size_t blocksHigh = static_cast<std::size_t>(height + 3) / 4;
+	return blocksWide * blocksHigh * GetBlockSize(compression);
+}
+
+void CompressImage(const unsigned char* pixels, int width, int height, int channels, TextureCompression compression,
+	unsigned char* blocks, ThreadPool* threadPool)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	std::size_t blockSize = GetBlockSize(compression);
+
+	// Every block is independent of the others, so each row of blocks can go to a different thread
+	auto compressRow = [=](std::size_t blockY)
+		{
+			unsigned char* output = blocks + blockY * blocksWide * blockSize;
+			for (int blockX = 0; blockX < blocksWide; blockX++, output += blockSize)
+			{
+				PixelBlock block = ReadBlock(pixels, width, height, channels, blockX, static_cast<int>(blockY));
+				if (compression == TextureCompression::Bc3)
+				{
+					CompressAlphaBlock(block, output);
+					CompressColorBlock(block, output + 8);
+				}
+				else
+				{
+					CompressColorBlock(block, output);
+				}
+			}
+		};
+
+	if (threadPool != nullptr)
+	{
+		threadPool->ParallelFor(static_cast<std::size_t>(blocksHigh), compressRow);
+	}
+	else
+	{
+		for (int blockY = 0; blockY < blocksHigh; blockY++)
+		{
+			compressRow(static_cast<std::size_t>(blockY));
+		}
+	}
+}
+
+void DecompressImage(const unsigned char* blocks, int width, int height, TextureCompression compression, unsigned char* pixels)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	std::size_t blockSize = GetBlockSize(compression);
+
+	const unsigned char* input = blocks;
+	for (int blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksWide; blockX++, input += blockSize)
+		{
+			// The color block of BC3 is always decoded with four colors
+			PixelBlock block;
+			if (compression == TextureCompression::Bc3)
+			{
+				DecompressColorBlock(input + 8, true, block);
+				DecompressAlphaBlock(input, block);
+			}
+			else
+			{
+				DecompressColorBlock(input, false, block);
+			}
+
+			// Blocks past the edge of the image only partly cover it
+			for (int y = 0; y < 4 && blockY * 4 + y < height; y++)
+			{
+				for (int x = 0; x < 4 && blockX * 4 + x < width; x++)
+				{
+					std::size_t pixel = static_cast<std::size_t>(blockY * 4 + y) * width + blockX * 4 + x;
+					std::memcpy(pixels + pixel * 4, block.pixels[y * 4 + x], 4);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+/// <summary>
+/// Block-compressed format of a texture's pixels (S3TC, known to Direct3D as BC1 and BC3).
+/// Both store the image as 4x4 blocks of pixels, each with two colors and a 2-bit index per pixel choosing
+/// between them and the two colors in between, which the GPU decodes as it samples.
+/// </summary>
+enum class TextureCompression : std::uint32_t
+{
+	None = 0,	// Uncompressed, 3 or 4 bytes per pixel
+	Bc1 = 1,	// RGB in 8 bytes per block (half a byte per pixel)
+	Bc3 = 2		// RGBA in 16 bytes per block: a BC1 color block plus 8 alpha values and a 3-bit index per pixel
+};
+
+/// <summary>
+/// Size of an image once compressed, including the blocks that only partly cover its last columns and rows.
+/// </summary>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="height">Height of the image in pixels</param>
+/// <param name="compression">Format of the blocks (not None)</param>
+/// <returns>Size in bytes</returns>
+std::size_t GetCompressedImageSize(int width, int height, TextureCompression compression);
+
+/// <summary>
+/// Compresses an image into 4x4 blocks, in the order of its rows. The two colors of each block are the ends
+/// of the line that best fits its pixels (their principal axis), refined by least squares. Pixels past the last
+/// column or row of the image repeat the ones on its edge.
+/// </summary>
+/// <param name="pixels">Tightly packed rows of the image</param>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="height">Height of the image in pixels</param>
+/// <param name="channels">Bytes per pixel: 3 (RGB) or 4 (RGBA)</param>
+/// <param name="compression">Format of the blocks (not None); BC1 drops the alpha channel</param>
+/// <param name="blocks">Receives the blocks (must have room for GetCompressedImageSize bytes)</param>
+/// <param name="threadPool">Worker threads that compress the rows of blocks in parallel (null to compress them on the calling thread)</param>
+void CompressImage(const unsigned char* pixels, int width, int height, int channels, TextureCompression compression,
+	unsigned char* blocks, ThreadPool* threadPool = nullptr);
+
+/// <summary>
+/// Decompresses an image written by CompressImage (or any BC1 or BC3 encoder) the way the GPU would,
+/// for drivers that cannot sample the compressed format.
+/// </summary>
+/// <param name="blocks">Blocks of the image</param>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="height">Height of the image in pixels</param>
+/// <param name="compression">Format of the blocks (not None)</param>
+/// <param name="pixels">Receives the tightly packed RGBA rows of the image (width * height * 4 bytes)</param>
+void DecompressImage(const unsigned char* blocks, int width, int height, TextureCompression compression, unsigned char* pixels);
@@ -0,0 +1,424 @@
+#include "CookedAssets.h"
+
+#include "PixelKernels.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+	const char CookedTextureMagic[8] = { 'T', 'E', 'X', 'T', 'U', 'R', 'E', 'S' };
+
+	/// <summary>
+	/// Version of the cooked texture layout, increased whenever the layout or the meaning of its data changes
+	/// </summary>
+	const std::uint32_t CookedTextureVersion = 2;
+
+	/// <summary>
+	/// Alignment of the levels inside the file
+	/// </summary>
+	const std::uint64_t CookedTextureAlignment = 64;
+
+	/// <summary>
+	/// Most levels a mip chain can have (enough for a 32768x32768 image)
+	/// </summary>
+	const std::uint32_t MaxTextureLevels = 16;
+
+	struct CookedTextureLevel
+	{
+		std::uint64_t offset;	// Offset of the pixels from the start of the file
+		std::uint64_t size;		// Size of the pixels in bytes
+		std::uint32_t width;
+		std::uint32_t height;
+	};
+
+	/// <summary>
+	/// Start of a cooked texture file, followed by the pixels of each level
+	/// </summary>
+	struct CookedTextureHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t channels;
+		std::uint32_t levelCount;
+		std::uint32_t compression;	// TextureCompression of every level
+		std::uint64_t sourceHash;	// HashBytes of the contents of the source image
+		CookedTextureLevel levels[MaxTextureLevels];
+	};
+
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + CookedTextureAlignment - 1) / CookedTextureAlignment * CookedTextureAlignment;
+	}
+
+	/// <summary>
+	/// Checks if every pixel of an RGBA image is fully opaque, in which case its alpha channel carries nothing
+	/// </summary>
+	bool IsOpaque(const unsigned char* pixels, int width, int height)
+	{
+		std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+		for (std::size_t i = 0; i < pixelCount; i++)
+		{
+			if (pixels[i * 4 + 3] != 255)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Checks that a mapped cooked texture is complete and was written by this version of the program.
+	/// </summary>
+	const CookedTextureHeader* ValidateTexture(const char* data, std::size_t size)
+	{
+		if (size < sizeof(CookedTextureHeader))
+		{
+			return nullptr;
+		}
+
+		const CookedTextureHeader* header = reinterpret_cast<const CookedTextureHeader*>(data);
+		if (std::memcmp(header->magic, CookedTextureMagic, sizeof(CookedTextureMagic)) != 0
+			|| header->version != CookedTextureVersion
+			|| (header->channels != 3 && header->channels != 4)
+			|| header->compression > static_cast<std::uint32_t>(TextureCompression::Bc3)
+			|| header->levelCount == 0 || header->levelCount > MaxTextureLevels
+			|| header->levels[0].width != header->width || header->levels[0].height != header->height)
+		{
+			return nullptr;
+		}
+
+		TextureCompression compression = static_cast<TextureCompression>(header->compression);
+		std::uint64_t fileSize = size;
+		for (std::uint32_t i = 0; i < header->levelCount; i++)
+		{
+			const CookedTextureLevel& level = header->levels[i];
+			if (level.offset % CookedTextureAlignment != 0 || level.offset > fileSize || level.size > fileSize - level.offset
+				|| level.width == 0 || level.height == 0 || level.width > header->width || level.height > header->height)
+			{
+				return nullptr;
+			}
+
+			std::uint64_t expectedSize = compression == TextureCompression::None
+				? static_cast<std::uint64_t>(level.width) * level.height * header->channels
+				: GetCompressedImageSize(static_cast<int>(level.width), static_cast<int>(level.height), compression);
+			if (level.size != expectedSize)
+			{
+				return nullptr;
+			}
+		}
+
+		return header;
+	}
+
+	void UseTexture(LoadedTexture& texture, const char* data, const CookedTextureHeader& header)
+	{
+		texture.width = static_cast<int>(header.width);
+		texture.height = static_cast<int>(header.height);
+		texture.channels = static_cast<int>(header.channels);
+		texture.compression = static_cast<TextureCompression>(header.compression);
+		for (std::uint32_t i = 0; i < header.levelCount; i++)
+		{
+			const CookedTextureLevel& level = header.levels[i];
+			texture.levels.push_back({ reinterpret_cast<const unsigned char*>(data + level.offset),
+				static_cast<std::size_t>(level.size), static_cast<int>(level.width), static_cast<int>(level.height) });
+		}
+	}
+
+	/// <summary>
+	/// Writes the texture to a temporary file first, so a cooked texture is never seen half-written.
+	/// </summary>
+	bool WriteTexture(const std::string& cookedFilePath, const CookedTextureHeader& header, const std::vector<TextureLevel>& levels)
+	{
+		std::string temporaryFilePath = cookedFilePath + ".tmp";
+		{
+			std::ofstream cookedFile(temporaryFilePath, std::ios::binary | std::ios::trunc);
+			if (cookedFile.fail())
+			{
+				return false;
+			}
+
+			const char padding[CookedTextureAlignment] = {};
+			std::uint64_t position = sizeof(header);
+			cookedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			for (std::uint32_t i = 0; i < header.levelCount; i++)
+			{
+				cookedFile.write(padding, header.levels[i].offset - position);
+				cookedFile.write(reinterpret_cast<const char*>(levels[i].pixels), header.levels[i].size);
+				position = header.levels[i].offset + header.levels[i].size;
+			}
+			if (cookedFile.fail())
+			{
+				cookedFile.close();
+				std::remove(temporaryFilePath.c_str());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryFilePath, cookedFilePath, error);
+		if (error)
+		{
+			std::remove(temporaryFilePath.c_str());
+			return false;
+		}
+		return true;
+	}
+}
+
+void ImageDataDeleter::operator()(unsigned char* imageData) const
+{
+	stbi_image_free(imageData);
+}
+
+std::string GetCookedAssetName(const std::string& sourceFilePath, const char* extension)
+{
+	return std::filesystem::path(sourceFilePath).filename().string() + extension;
+}
+
+std::string GetCookedAssetPath(const std::string& cookedDirectory, const std::string& sourceFilePath, const char* extension)
+{
+	return (std::filesystem::path(cookedDirectory) / GetCookedAssetName(sourceFilePath, extension)).string();
+}
+
+bool CookTexture(const std::string& imageFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash, bool blockCompress,
+	ThreadPool* threadPool)
+{
+	LoadedTexture texture;
+	if (!DecodeImage(imageFilePath, texture))
+	{
+		return false;
+	}
+
+	TextureCompression compression = blockCompress ? GetBlockCompression(texture) : TextureCompression::None;
+	BuildMipChain(texture, compression, threadPool);
+
+	CookedTextureHeader header = {};
+	std::memcpy(header.magic, CookedTextureMagic, sizeof(CookedTextureMagic));
+	header.version = CookedTextureVersion;
+	header.width = static_cast<std::uint32_t>(texture.width);
+	header.height = static_cast<std::uint32_t>(texture.height);
+	header.channels = static_cast<std::uint32_t>(texture.channels);
+	header.levelCount = static_cast<std::uint32_t>(texture.levels.size());
+	header.compression = static_cast<std::uint32_t>(compression);
+	header.sourceHash = sourceHash;
+
+	std::uint64_t offset = sizeof(header);
+	for (std::uint32_t i = 0; i < header.levelCount; i++)
+	{
+		CookedTextureLevel& level = header.levels[i];
+		level.offset = AlignOffset(offset);
+		level.size = texture.levels[i].size;
+		level.width = static_cast<std::uint32_t>(texture.levels[i].width);
+		level.height = static_cast<std::uint32_t>(texture.levels[i].height);
+		offset = level.offset + level.size;
+	}
+
+	return WriteTexture(cookedFilePath, header, texture.levels);
+}
+
+bool DecodeImage(const std::string& imageFilePath, LoadedTexture& texture)
+{
+	texture = LoadedTexture();
+
+	// Gray and gray-alpha images are widened, so every cooked texture can be uploaded as GL_RGB or GL_RGBA
+	int width, height, sourceChannels;
+	if (stbi_info(imageFilePath.c_str(), &width, &height, &sourceChannels) == 0)
+	{
+		return false;
+	}
+	int channels = (sourceChannels == 2 || sourceChannels == 4) ? 4 : 3;
+
+	texture.decodedPixels.reset(stbi_load(imageFilePath.c_str(), &width, &height, &sourceChannels, channels));
+	if (texture.decodedPixels == nullptr)
+	{
+		return false;
+	}
+	// stb_image decodes the top row first, but OpenGL expects the bottom row first
+	FlipRows(texture.decodedPixels.get(), width, height, channels);
+	texture.width = width;
+	texture.height = height;
+	texture.channels = channels;
+	texture.levels.push_back({ texture.decodedPixels.get(), static_cast<std::size_t>(width) * height * channels, width, height });
+	return true;
+}
+
+TextureCompression GetBlockCompression(const LoadedTexture& texture)
+{
+	// An RGBA image that is opaque everywhere loses nothing as BC1
+	const TextureLevel& level = texture.levels[0];
+	return texture.channels == 4 && !IsOpaque(level.pixels, level.width, level.height) ? TextureCompression::Bc3 : TextureCompression::Bc1;
+}
+
+void BuildMipChain(LoadedTexture& texture, TextureCompression compression, ThreadPool* threadPool)
+{
+	// Each level is made from the one before it, and compressed from its uncompressed pixels
+	// so the compression error does not build up down the chain
+	std::vector<std::vector<unsigned char>> halvedLevels;
+	std::vector<TextureLevel> levels = { texture.levels[0] };
+	while (levels.size() < MaxTextureLevels && (levels.back().width > 1 || levels.back().height > 1))
+	{
+		const TextureLevel& previous = levels.back();
+		TextureLevel level;
+		level.width = std::max(1, previous.width / 2);
+		level.height = std::max(1, previous.height / 2);
+		halvedLevels.emplace_back(static_cast<std::size_t>(level.width) * level.height * texture.channels);
+		HalveImageSrgb(previous.pixels, previous.width, previous.height, texture.channels, halvedLevels.back().data());
+		level.pixels = halvedLevels.back().data();
+		level.size = halvedLevels.back().size();
+		levels.push_back(level);
+	}
+
+	// Every level is copied into one block the texture owns, the full-size one included,
+	// so it no longer matters where that level came from
+	std::size_t totalSize = 0;
+	for (TextureLevel& level : levels)
+	{
+		if (compression != TextureCompression::None)
+		{
+			level.size = GetCompressedImageSize(level.width, level.height, compression);
+		}
+		totalSize += level.size;
+	}
+
+	std::vector<unsigned char> generatedPixels(totalSize);
+	unsigned char* pixels = generatedPixels.data();
+	for (TextureLevel& level : levels)
+	{
+		if (compression != TextureCompression::None)
+		{
+			CompressImage(level.pixels, level.width, level.height, texture.channels, compression, pixels, threadPool);
+		}
+		else
+		{
+			std::memcpy(pixels, level.pixels, level.size);
+		}
+		level.pixels = pixels;
+		pixels += level.size;
+	}
+
+	texture.generatedPixels = std::move(generatedPixels);
+	texture.levels = std::move(levels);
+	texture.compression = compression;
+}
+
+bool LoadCookedTexture(const std::string& cookedFilePath, LoadedTexture& texture)
+{
+	texture = LoadedTexture();
+
+	// A missing or outdated cooked texture is not an error (the source image is the fallback), so this stays silent
+	std::error_code error;
+	if (!std::filesystem::exists(cookedFilePath, error) || !texture.file.Open(cookedFilePath, MappedFileAccess::Sequential))
+	{
+		return false;
+	}
+
+	const CookedTextureHeader* header = ValidateTexture(texture.file.GetData(), texture.file.GetSize());
+	if (header == nullptr)
+	{
+		texture = LoadedTexture();
+		return false;
+	}
+
+	UseTexture(texture, texture.file.GetData(), *header);
+	return true;
+}
+
+bool LoadCookedTexture(AssetArchive& archive, const std::string& name, LoadedTexture& texture)
+{
+	texture = LoadedTexture();
+	if (!archive.Read(name, texture.asset))
+	{
+		return false;
+	}
+
+	const CookedTextureHeader* header = ValidateTexture(texture.asset.data, texture.asset.size);
+	if (header == nullptr)
+	{
+		texture = LoadedTexture();
+		return false;
+	}
+
+	UseTexture(texture, texture.asset.data, *header);
+	return true;
+}
+
+bool LoadTexture(const std::string& imageFilePath, AssetArchive* archive, LoadedTexture& texture, std::uint64_t* bytesRead)
+{
+	if (bytesRead != nullptr)
+	{
+		*bytesRead = GetImageReadSize(imageFilePath, archive);
+	}
+
+	if (archive != nullptr && LoadCookedTexture(*archive, GetCookedAssetName(imageFilePath, CookedTextureExtension), texture))
+	{
+		return true;
+	}
+
+	texture = LoadedTexture();
+	int numChannels;
+	texture.decodedPixels.reset(stbi_load(imageFilePath.c_str(), &texture.width, &texture.height, &numChannels, 3));
+	if (texture.decodedPixels == nullptr)
+	{
+		return false;
+	}
+
+	FlipRows(texture.decodedPixels.get(), texture.width, texture.height, 3);
+	texture.channels = 3;
+	texture.levels.push_back({ texture.decodedPixels.get(), static_cast<std::size_t>(texture.width) * texture.height * 3,
+		texture.width, texture.height });
+	return true;
+}
+
+void DecompressTexture(LoadedTexture& texture)
+{
+	if (texture.compression == TextureCompression::None)
+	{
+		return;
+	}
+
+	std::size_t totalSize = 0;
+	for (const TextureLevel& level : texture.levels)
+	{
+		totalSize += static_cast<std::size_t>(level.width) * level.height * 4;
+	}
+
+	std::vector<unsigned char> decompressedPixels(totalSize);
+	unsigned char* pixels = decompressedPixels.data();
+	for (TextureLevel& level : texture.levels)
+	{
+		std::size_t size = static_cast<std::size_t>(level.width) * level.height * 4;
+		DecompressImage(level.pixels, level.width, level.height, texture.compression, pixels);
+		level.pixels = pixels;
+		level.size = size;
+		pixels += size;
+	}
+
+	texture.generatedPixels = std::move(decompressedPixels);
+	texture.channels = 4;
+	texture.compression = TextureCompression::None;
+}
+
+std::uint64_t GetImageReadSize(const std::string& imageFilePath, AssetArchive* archive)
+{
+	if (archive != nullptr)
+	{
+		const ArchiveEntry* entry = archive->Find(GetCookedAssetName(imageFilePath, CookedTextureExtension));
+		if (entry != nullptr)
+		{
+			return entry->storedSize;
+		}
+	}
+
+	std::error_code error;
+	std::uintmax_t size = std::filesystem::file_size(imageFilePath, error);
+	return error ? 0 : static_cast<std::uint64_t>(size);
+}
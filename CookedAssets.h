@@ -0,0 +1,164 @@
+#pragma once
+
+#include "AssetArchive.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Directory the asset cooker writes the cooked assets and their archive to, unless told otherwise
+/// </summary>
+const char DefaultCookedDirectory[] = "cooked";
+
+/// <summary>
+/// Extension of cooked meshes (written by CookMesh, in the binary mesh cache format)
+/// </summary>
+const char CookedMeshExtension[] = ".mesh";
+
+/// <summary>
+/// Extension of cooked textures (written by CookTexture)
+/// </summary>
+const char CookedTextureExtension[] = ".texture";
+
+/// <summary>
+/// Frees image data decoded by stb_image (or returned by LoadImageFile)
+/// </summary>
+struct ImageDataDeleter
+{
+	void operator()(unsigned char* imageData) const;
+};
+
+/// <summary>
+/// One level of the mip chain of a texture
+/// </summary>
+struct TextureLevel
+{
+	const unsigned char* pixels = nullptr;	// Tightly packed rows (or rows of 4x4 blocks), the bottom row first (the way OpenGL expects them)
+	std::size_t size = 0;					// Size of the pixels in bytes
+	int width = 0;							// Width of the level in pixels
+	int height = 0;							// Height of the level in pixels
+};
+
+/// <summary>
+/// Texture image with its mip chain, from a cooked texture file or the asset archive, or decoded from its source image
+/// </summary>
+struct LoadedTexture
+{
+	MappedFile file;					// Mapping of the cooked texture file (closed otherwise)
+	ArchiveAsset asset;					// Cooked texture read from the asset archive (empty otherwise)
+	std::unique_ptr<unsigned char, ImageDataDeleter> decodedPixels;	// Pixels decoded from the source image (null otherwise)
+	std::vector<unsigned char> generatedPixels;	// Every level once BuildMipChain or DecompressTexture made them (empty otherwise)
+	int width = 0;						// Width of the full-size level in pixels
+	int height = 0;						// Height of the full-size level in pixels
+	int channels = 0;					// Bytes per pixel: 3 (RGB) or 4 (RGBA), before any block compression
+	TextureCompression compression = TextureCompression::None;	// Format of the levels' pixels
+	std::vector<TextureLevel> levels;	// Mip chain, full size first, down to 1x1
+};
+
+/// <summary>
+/// Name of the cooked form of a source asset, in the cooked directory and in the asset archive:
+/// the file name of the source plus an extension.
+/// </summary>
+/// <param name="sourceFilePath">Path to the source asset</param>
+/// <param name="extension">Extension of the cooked asset (CookedMeshExtension or CookedTextureExtension)</param>
+/// <returns>Name of the cooked asset</returns>
+std::string GetCookedAssetName(const std::string& sourceFilePath, const char* extension);
+
+/// <summary>
+/// Path of the cooked form of a source asset inside the cooked directory.
+/// </summary>
+/// <param name="cookedDirectory">Directory of the cooked assets</param>
+/// <param name="sourceFilePath">Path to the source asset</param>
+/// <param name="extension">Extension of the cooked asset (CookedMeshExtension or CookedTextureExtension)</param>
+/// <returns>Path to the cooked asset</returns>
+std::string GetCookedAssetPath(const std::string& cookedDirectory, const std::string& sourceFilePath, const char* extension);
+
+/// <summary>
+/// Decodes an image with stb_image, builds its mip chain with an sRGB-aware box filter (see HalveImageSrgb) and writes both
+/// to a cooked texture file. Images without an alpha channel are stored as RGB, the others as RGBA, the bottom row first.
+/// When block compressed, each level is compressed from its uncompressed pixels: as BC1 if the image is opaque, BC3 otherwise.
+/// </summary>
+/// <param name="imageFilePath">Path to the source image (PNG, JPEG, ...)</param>
+/// <param name="cookedFilePath">Path to the cooked texture to write</param>
+/// <param name="sourceHash">HashBytes of the source image, recorded in the cooked texture</param>
+/// <param name="blockCompress">Indicates if the levels are stored block compressed (4 to 8 times smaller) rather than as they are</param>
+/// <param name="threadPool">Worker threads that compress each level in parallel (null to compress on the calling thread)</param>
+/// <returns>True if the texture was cooked successfully</returns>
+bool CookTexture(const std::string& imageFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash, bool blockCompress,
+	ThreadPool* threadPool = nullptr);
+
+/// <summary>
+/// Decodes an image with stb_image as the full-size level of a texture: RGB, or RGBA if the image has an alpha channel,
+/// the bottom row first.
+/// </summary>
+/// <param name="imageFilePath">Path to the image (PNG, JPEG, ...)</param>
+/// <param name="texture">Receives the image, in its decodedPixels</param>
+/// <returns>True if the image was decoded successfully</returns>
+bool DecodeImage(const std::string& imageFilePath, LoadedTexture& texture);
+
+/// <summary>
+/// Block-compressed format a texture is cooked in: BC1 if it is opaque, BC3 if it has transparent pixels.
+/// </summary>
+/// <param name="texture">Texture with its uncompressed full-size level</param>
+/// <returns>BC1 or BC3</returns>
+TextureCompression GetBlockCompression(const LoadedTexture& texture);
+
+/// <summary>
+/// Builds the rest of the mip chain of a texture that only has its full-size level, with the sRGB-aware box filter CookTexture uses,
+/// and optionally block compresses every level.
+/// </summary>
+/// <param name="texture">Texture with its full-size level, whose levels then point into its generatedPixels</param>
+/// <param name="compression">Format to store the levels in (None to keep them as they are)</param>
+/// <param name="threadPool">Worker threads that compress each level in parallel (null to compress on the calling thread)</param>
+void BuildMipChain(LoadedTexture& texture, TextureCompression compression, ThreadPool* threadPool = nullptr);
+
+/// <summary>
+/// Memory-maps a texture written by CookTexture, checking that it is complete and of the current version.
+/// </summary>
+/// <param name="cookedFilePath">Path to the cooked texture</param>
+/// <param name="texture">Receives the texture, pointing into the mapping</param>
+/// <returns>True if the texture was loaded successfully</returns>
+bool LoadCookedTexture(const std::string& cookedFilePath, LoadedTexture& texture);
+
+/// <summary>
+/// Reads a texture written by CookTexture from an asset archive, checking that it is complete and of the current version.
+/// Textures the archive stores uncompressed are used straight out of its mapping.
+/// </summary>
+/// <param name="archive">Archive of cooked assets</param>
+/// <param name="name">Name of the cooked texture in the archive (see GetCookedAssetName)</param>
+/// <param name="texture">Receives the texture</param>
+/// <returns>True if the texture was loaded successfully</returns>
+bool LoadCookedTexture(AssetArchive& archive, const std::string& name, LoadedTexture& texture);
+
+/// <summary>
+/// Loads a texture from its cooked texture in the archive when there is one, with its whole mip chain; otherwise decodes
+/// the source image to RGB with stb_image, which only gives the full-size level.
+/// </summary>
+/// <param name="imageFilePath">Path to the source image</param>
+/// <param name="archive">Archive of cooked assets (null to always decode the source image)</param>
+/// <param name="texture">Receives the texture (without levels if it could not be loaded)</param>
+/// <param name="bytesRead">Optionally receives the size of what was read: the cooked texture as stored in the archive, or the image file</param>
+/// <returns>True if the texture was loaded successfully</returns>
+bool LoadTexture(const std::string& imageFilePath, AssetArchive* archive, LoadedTexture& texture, std::uint64_t* bytesRead = nullptr);
+
+/// <summary>
+/// Decompresses every level of a block-compressed texture to RGBA, for drivers that cannot sample the compressed formats.
+/// Does nothing to an uncompressed texture.
+/// </summary>
+/// <param name="texture">Texture to decompress, whose levels then point into its generatedPixels</param>
+void DecompressTexture(LoadedTexture& texture);
+
+/// <summary>
+/// Size of what loading an image reads: its cooked texture as stored in the archive when the archive has one, otherwise the image file.
+/// </summary>
+/// <param name="imageFilePath">Path to the source image</param>
+/// <param name="archive">Archive of cooked assets (null if the source image is decoded)</param>
+/// <returns>Size in bytes (0 if neither exists)</returns>
+std::uint64_t GetImageReadSize(const std::string& imageFilePath, AssetArchive* archive);
@@ -0,0 +1,67 @@
+#include "Exhibit.h"
+
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+bool LoadExhibitManifest(const std::string& filePath, std::vector<Exhibit>& exhibits)
+{
+	std::ifstream manifestFile(filePath);
+	if (manifestFile.fail())
+	{
+		std::cerr << "Unable to open exhibit manifest: " << filePath << std::endl;
+		return false;
+	}
+
+	exhibits.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(manifestFile, line))
+	{
+		lineNumber++;
+
+		std::istringstream lineStream(line);
+		std::string firstToken;
+		if (!(lineStream >> firstToken) || firstToken[0] == '#')
+		{
+			continue;
+		}
+
+		Exhibit exhibit;
+		exhibit.meshFilePath = firstToken;
+		if (!(lineStream >> exhibit.textureFilePath
+			>> exhibit.position.x >> exhibit.position.y >> exhibit.position.z
+			>> exhibit.scale.x >> exhibit.scale.y >> exhibit.scale.z))
+		{
+			std::cerr << "Invalid exhibit at line " << lineNumber << " of " << filePath << std::endl;
+			return false;
+		}
+
+		exhibits.push_back(std::move(exhibit));
+	}
+
+	return true;
+}
+
+float GetExhibitPixelsPerUnit(const Exhibit& exhibit, const glm::vec3& cameraPosition, float verticalFieldOfView, int viewportHeight)
+{
+	// The model spins around its origin, so the sphere is centered there and reaches the farthest corner of its box
+	glm::vec3 farthestCorner;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		farthestCorner[axis] = std::max(std::abs(exhibit.bounds.min[axis]), std::abs(exhibit.bounds.max[axis]));
+	}
+
+	float scale = std::max(std::abs(exhibit.scale.x), std::max(std::abs(exhibit.scale.y), std::abs(exhibit.scale.z)));
+	float radius = glm::length(farthestCorner) * scale;
+
+	// Inside the sphere, the distance is clamped to the near plane
+	float distance = std::max(0.1f, glm::length(cameraPosition - exhibit.position) - radius);
+	return GetPixelsPerUnit(distance, verticalFieldOfView, viewportHeight) * scale;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A 3D model displayed in the museum, as listed in the exhibit manifest
+/// </summary>
+struct Exhibit
+{
+	std::string meshFilePath;		// Path to the .obj file of the model
+	std::string textureFilePath;	// Path to the image used as the texture of the model
+	glm::vec3 position;				// Position of the model in the room
+	glm::vec3 scale;				// Scale applied to the model
+
+	GLuint vao = 0;					// OpenGL handle to the vertex array object of the model
+	GLuint vbo = 0;					// OpenGL handle to the vertex buffer of the model
+	GLuint colorVbo = 0;			// OpenGL handle to the separate color stream of compact vertices (0 if unused)
+	GLuint ebo = 0;					// OpenGL handle to the index buffer of the model
+	GLsizei vertexCount = 0;		// Number of vertices of the model inside the vertex buffer
+	std::vector<MeshLod> lods;		// Levels of detail of the model, as ranges of the index buffer
+	std::vector<Meshlet> meshlets;	// Meshlets of every level of detail, culled one by one when drawing (empty if none)
+	std::size_t lod = 0;			// Level of detail the model was drawn with last
+	MeshBounds bounds;				// Box around the model, used to dequantize compact vertex positions
+	GLuint texture = 0;				// OpenGL handle to the texture of the model
+	bool ready = false;				// Indicates if the model and its texture are fully uploaded and can be drawn
+};
+
+/// <summary>
+/// Reads the list of exhibits from a manifest file.
+/// Each non-empty line that does not start with '#' describes one exhibit:
+/// mesh file, texture file, position (x y z) and scale (x y z), separated by whitespace.
+/// </summary>
+/// <param name="filePath">Path to the manifest file</param>
+/// <param name="exhibits">Receives the exhibits listed in the manifest</param>
+/// <returns>True if the manifest was read successfully</returns>
+bool LoadExhibitManifest(const std::string& filePath, std::vector<Exhibit>& exhibits);
+
+/// <summary>
+/// Number of pixels one model unit of an exhibit covers on screen, measured at the point of the sphere
+/// around the model that is nearest to the camera, so the error of a level of detail is never underestimated.
+/// </summary>
+/// <param name="exhibit">Exhibit seen by the camera</param>
+/// <param name="cameraPosition">Position of the camera</param>
+/// <param name="verticalFieldOfView">Vertical field of view of the projection, in radians</param>
+/// <param name="viewportHeight">Height of the viewport in pixels</param>
+/// <returns>Pixels per model unit</returns>
+float GetExhibitPixelsPerUnit(const Exhibit& exhibit, const glm::vec3& cameraPosition, float verticalFieldOfView, int viewportHeight);
@@ -0,0 +1,425 @@
+#include "ExhibitStreamer.h"
+
+#include "Textures.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+	/// <summary>
+	/// Largest amount of data uploaded at once, so a single piece never takes a big bite out of a frame
+	/// </summary>
+	const std::size_t UploadPieceSize = 256 * 1024;
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void PrintMeshLoadStats(const std::string& meshFilePath, const MeshView& mesh, const MeshLoadStats& stats)
+	{
+		if (stats.fromCooked || stats.fromCache)
+		{
+			std::cout << "Loaded " << meshFilePath << (stats.fromCooked ? " from its cooked mesh: " : " from its mesh cache: ")
+				<< GetMeshLods(mesh)[0].indexCount / 3 << " triangles, " << mesh.vertexCount << " vertices in " << stats.seconds * 1000.0 << " ms" << std::endl;
+		}
+		else
+		{
+			std::cout << "Loaded " << meshFilePath << ": " << stats.obj.lines << " lines, "
+				<< stats.obj.triangles << " triangles in " << stats.obj.seconds * 1000.0 << " ms ("
+				<< stats.obj.MegabytesPerSecond() << " MB/s, " << stats.obj.chunks << " chunks)"
+				<< (stats.cacheWritten ? ", mesh cache written" : "") << std::endl;
+			std::cout << "  " << stats.obj.triangles * 3 << " corners share " << stats.obj.vertices << " vertices (dedup ratio "
+				<< stats.obj.DeduplicationRatio() << ":1)" << std::endl;
+			if (stats.optimized)
+			{
+				std::cout << "  Vertex cache: ACMR " << stats.optimization.before.acmr << " -> " << stats.optimization.after.acmr
+					<< ", ATVR " << stats.optimization.before.atvr << " -> " << stats.optimization.after.atvr
+					<< " (optimized in " << stats.optimization.seconds * 1000.0 << " ms)" << std::endl;
+			}
+		}
+
+		if (mesh.lodCount > 1)
+		{
+			std::cout << "  Levels of detail:";
+			for (std::size_t i = 0; i < mesh.lodCount; i++)
+			{
+				std::cout << (i == 0 ? " " : ", ") << mesh.lods[i].indexCount / 3 << " triangles (error " << mesh.lods[i].error << ")";
+			}
+			if (stats.lodsBuilt)
+			{
+				std::cout << " built in " << stats.lodSeconds * 1000.0 << " ms";
+			}
+			std::cout << std::endl;
+		}
+
+		if (mesh.meshletCount != 0)
+		{
+			std::size_t coneCount = 0;
+			for (std::size_t i = 0; i < mesh.meshletCount; i++)
+			{
+				coneCount += mesh.meshlets[i].coneCutoff < 1.0f ? 1 : 0;
+			}
+			std::cout << "  Meshlets: " << mesh.meshletCount << " over all levels, " << coneCount << " of them with a normal cone";
+			if (stats.meshletsBuilt)
+			{
+				std::cout << " (built in " << stats.meshletSeconds * 1000.0 << " ms)";
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	GLuint CreateBuffer(std::size_t size)
+	{
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+		return buffer;
+	}
+}
+
+bool LoadExhibitMesh(const std::string& meshFilePath, const MeshLoadSettings& settings, VertexFormat vertexFormat, ExhibitAssets& assets)
+{
+	assets.meshLoaded = LoadMesh(meshFilePath, assets.mesh, settings, &assets.meshStats);
+
+	if (assets.meshLoaded && vertexFormat == VertexFormat::Compact)
+	{
+		const MeshView& mesh = assets.mesh.view;
+		assets.compactVertices.resize(mesh.vertexCount);
+		CompactVertices(mesh.vertices, mesh.vertexCount, mesh.bounds, assets.compactVertices.data());
+
+		// Compact vertices carry no color, so the colors go in their own stream, and only if the model has any
+		if (mesh.hasColors)
+		{
+			assets.colors.resize(mesh.vertexCount * 4);
+			for (std::size_t i = 0; i < mesh.vertexCount; i++)
+			{
+				assets.colors[i * 4] = mesh.vertices[i].r;
+				assets.colors[i * 4 + 1] = mesh.vertices[i].g;
+				assets.colors[i * 4 + 2] = mesh.vertices[i].b;
+				assets.colors[i * 4 + 3] = 255;
+			}
+		}
+	}
+
+	return assets.meshLoaded;
+}
+
+ExhibitStreamer::ExhibitStreamer(std::vector<Exhibit>& exhibits, ThreadPool& threadPool, const MeshLoadSettings& settings,
+	VertexFormat vertexFormat, AssetArchive* archive, std::chrono::steady_clock::time_point startTime, StartupProfile* profile,
+	UploadRing* uploadRing)
+	: exhibits(exhibits), settings(settings), vertexFormat(vertexFormat), archive(archive), startTime(startTime), profile(profile),
+	uploadRing(uploadRing)
+{
+	for (std::size_t i = 0; i < exhibits.size(); i++)
+	{
+		jobs.push_back(threadPool.Submit([this, i]() { LoadAssets(i); }));
+	}
+}
+
+ExhibitStreamer::~ExhibitStreamer()
+{
+	for (std::future<void>& job : jobs)
+	{
+		job.wait();
+	}
+}
+
+void ExhibitStreamer::Update(double budgetSeconds)
+{
+	std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+
+	std::vector<std::unique_ptr<ExhibitAssets>> arrived;
+	arrivals.PopAll(arrived);
+	for (std::unique_ptr<ExhibitAssets>& assets : arrived)
+	{
+		PendingUpload upload;
+		upload.assets = std::move(assets);
+		pending.push_back(std::move(upload));
+	}
+
+	while (!pending.empty())
+	{
+		if (UploadPiece(pending.front()))
+		{
+			pending.pop_front();
+			finishedCount++;
+		}
+
+		if (SecondsSince(updateStart) >= budgetSeconds)
+		{
+			break;
+		}
+	}
+
+	// Leave the buffer and texture bindings the way the render loop expects to find them
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool ExhibitStreamer::IsFinished() const
+{
+	return finishedCount == exhibits.size();
+}
+
+std::size_t ExhibitStreamer::GetReadyCount() const
+{
+	return readyCount;
+}
+
+void ExhibitStreamer::LoadAssets(std::size_t exhibitIndex)
+{
+	std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+	const Exhibit& exhibit = exhibits[exhibitIndex];
+
+	std::unique_ptr<ExhibitAssets> assets = std::make_unique<ExhibitAssets>();
+	assets->exhibitIndex = exhibitIndex;
+
+	StartupProfileEntry& meshProfile = assets->meshProfile;
+	meshProfile.stage = "Exhibit model";
+	meshProfile.asset = exhibit.meshFilePath;
+	meshProfile.start = SecondsSince(startTime);
+	LoadExhibitMesh(exhibit.meshFilePath, settings, vertexFormat, *assets);
+
+	meshProfile.decodeSeconds = SecondsSince(loadStart);
+	meshProfile.bytesRead = assets->meshStats.bytes;
+	if (assets->meshStats.fromCooked)
+	{
+		// What was read is the cooked mesh as it is stored in the archive, possibly compressed
+		meshProfile.bytesRead = settings.archive->Find(GetCookedAssetName(exhibit.meshFilePath, CookedMeshExtension))->storedSize;
+	}
+
+	// A cooked texture comes out of the archive as it is, mip chain included and possibly block compressed; otherwise the source image
+	// is decoded to three channels (uploaded as GL_RGB) and its mip chain is generated once it is uploaded
+	StartupProfileEntry& textureProfile = assets->textureProfile;
+	textureProfile.stage = "Exhibit texture";
+	textureProfile.asset = exhibit.textureFilePath;
+	textureProfile.start = SecondsSince(startTime);
+
+	LoadTexture(exhibit.textureFilePath, archive, assets->texture, &textureProfile.bytesRead);
+
+	// Copying the levels into the upload ring here leaves the OpenGL thread only the calls that hand them to the GPU
+	// (an exhibit without its model is never uploaded, so it would never give its part of the ring back)
+	if (uploadRing != nullptr && assets->meshLoaded)
+	{
+		uploadRing->StageTexture(assets->texture, assets->stagedTexture);
+	}
+
+	textureProfile.decodeSeconds = SecondsSince(startTime) - textureProfile.start;
+
+	assets->seconds = SecondsSince(loadStart);
+	arrivals.Push(std::move(assets));
+}
+
+void ExhibitStreamer::CreateObjects(PendingUpload& upload)
+{
+	std::chrono::steady_clock::time_point createStart = std::chrono::steady_clock::now();
+	ExhibitAssets& assets = *upload.assets;
+	Exhibit& exhibit = exhibits[assets.exhibitIndex];
+	const MeshView& mesh = assets.mesh.view;
+
+	exhibit.vertexCount = static_cast<GLsizei>(mesh.vertexCount);
+	exhibit.lods = GetMeshLods(mesh);
+	exhibit.meshlets.assign(mesh.meshlets, mesh.meshlets + mesh.meshletCount);
+	exhibit.bounds = mesh.bounds;
+
+	// The buffers are created empty and filled piece by piece; compact vertices are uploaded from the
+	// converted copy, float vertices straight from where they were loaded (possibly a mapped mesh cache)
+	std::size_t vertexBytes = mesh.vertexCount * GetVertexSize(vertexFormat);
+	const void* vertexData = vertexFormat == VertexFormat::Compact ? static_cast<const void*>(assets.compactVertices.data()) : mesh.vertices;
+	exhibit.vbo = CreateBuffer(vertexBytes);
+	upload.buffers.push_back({ exhibit.vbo, static_cast<const GLubyte*>(vertexData), vertexBytes });
+
+	if (!assets.colors.empty())
+	{
+		exhibit.colorVbo = CreateBuffer(assets.colors.size());
+		upload.buffers.push_back({ exhibit.colorVbo, assets.colors.data(), assets.colors.size() });
+	}
+
+	std::size_t indexBytes = mesh.indexCount * sizeof(GLuint);
+	exhibit.ebo = CreateBuffer(indexBytes);
+	upload.buffers.push_back({ exhibit.ebo, reinterpret_cast<const GLubyte*>(mesh.indices), indexBytes });
+
+	glGenVertexArrays(1, &exhibit.vao);
+	glBindVertexArray(exhibit.vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, exhibit.vbo);
+	SetupVertexAttributes(vertexFormat);
+
+	if (exhibit.colorVbo != 0)
+	{
+		// Vertex attribute 1 - Color, from its own stream
+		glBindBuffer(GL_ARRAY_BUFFER, exhibit.colorVbo);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, 4 * sizeof(GLubyte), (void*)0);
+	}
+
+	// The element buffer binding is part of the vertex array object's state
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, exhibit.ebo);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	assets.meshProfile.gpuBytes = vertexBytes + assets.colors.size() + indexBytes;
+	assets.meshProfile.uploadSeconds += SecondsSince(createStart);
+	createStart = std::chrono::steady_clock::now();
+
+	// The texture's storage is allocated now, and its rows are uploaded piece by piece
+	// (its filtering and wrapping come from the sampler every texture is drawn with)
+	glGenTextures(1, &exhibit.texture);
+	glBindTexture(GL_TEXTURE_2D, exhibit.texture);
+
+	LoadedTexture& texture = assets.texture;
+	if (!texture.levels.empty())
+	{
+		PrepareTextureForUpload(texture);
+		GLenum internalFormat = GetTextureInternalFormat(texture);
+		GLenum format = GetTextureFormat(texture.channels);
+		for (std::size_t i = 0; i < texture.levels.size(); i++)
+		{
+			const TextureLevel& level = texture.levels[i];
+			if (texture.compression != TextureCompression::None)
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0,
+					static_cast<GLsizei>(level.size), nullptr);
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0,
+					format, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+		assets.textureProfile.gpuBytes = GetTextureMemorySize(texture);
+	}
+	else
+	{
+		std::cerr << "Failed to load image: " << exhibit.textureFilePath << std::endl;
+	}
+
+	assets.textureProfile.uploadSeconds += SecondsSince(createStart);
+	upload.objectsCreated = true;
+}
+
+bool ExhibitStreamer::UploadPiece(PendingUpload& upload)
+{
+	ExhibitAssets& assets = *upload.assets;
+	Exhibit& exhibit = exhibits[assets.exhibitIndex];
+
+	if (!upload.objectsCreated)
+	{
+		if (!assets.meshLoaded)
+		{
+			std::cerr << "Exhibit " << exhibit.meshFilePath << " will not be shown" << std::endl;
+			return true;
+		}
+
+		PrintMeshLoadStats(exhibit.meshFilePath, assets.mesh.view, assets.meshStats);
+		CreateObjects(upload);
+		return false;
+	}
+
+	std::chrono::steady_clock::time_point pieceStart = std::chrono::steady_clock::now();
+	if (upload.bufferIndex < upload.buffers.size())
+	{
+		const BufferUpload& buffer = upload.buffers[upload.bufferIndex];
+		std::size_t size = std::min(UploadPieceSize, buffer.size - upload.bufferOffset);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, upload.bufferOffset, size, buffer.data + upload.bufferOffset);
+
+		upload.bufferOffset += size;
+		if (upload.bufferOffset == buffer.size)
+		{
+			upload.bufferIndex++;
+			upload.bufferOffset = 0;
+		}
+		assets.meshProfile.uploadSeconds += SecondsSince(pieceStart);
+		return false;
+	}
+
+	const LoadedTexture& texture = assets.texture;
+	if (upload.textureLevel < texture.levels.size())
+	{
+		const TextureLevel& level = texture.levels[upload.textureLevel];
+		glBindTexture(GL_TEXTURE_2D, exhibit.texture);
+
+		// A staged level is copied by the driver straight out of the upload ring, so it goes in one piece
+		// and its pixels are passed as offsets into the ring
+		bool staged = assets.stagedTexture.size != 0;
+		std::size_t pieceSize = staged ? level.size : UploadPieceSize;
+		if (staged)
+		{
+			uploadRing->Bind();
+		}
+
+		int rowCount;
+		if (texture.compression != TextureCompression::None)
+		{
+			// A compressed level is uploaded in whole rows of 4x4 blocks
+			std::size_t blockRowSize = GetCompressedImageSize(level.width, 4, texture.compression);
+			int blockRowCount = static_cast<int>(std::max<std::size_t>(1, pieceSize / blockRowSize));
+			rowCount = std::min(level.height - upload.textureRow, blockRowCount * 4);
+			const unsigned char* pixels = level.pixels + upload.textureRow / 4 * blockRowSize;
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(upload.textureLevel), 0, upload.textureRow, level.width, rowCount,
+				GetTextureInternalFormat(texture), static_cast<GLsizei>(GetCompressedImageSize(level.width, rowCount, texture.compression)),
+				staged ? UploadRing::GetBufferOffset(assets.stagedTexture, pixels) : pixels);
+		}
+		else
+		{
+			// Rows are tightly packed, which does not match OpenGL's default 4-byte row alignment
+			// for three-byte pixels (or for the narrowest levels of a mip chain)
+			std::size_t rowSize = static_cast<std::size_t>(level.width) * texture.channels;
+			rowCount = std::min(level.height - upload.textureRow, static_cast<int>(std::max<std::size_t>(1, pieceSize / rowSize)));
+			const unsigned char* pixels = level.pixels + upload.textureRow * rowSize;
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(upload.textureLevel), 0, upload.textureRow, level.width, rowCount,
+				GetTextureFormat(texture.channels), GL_UNSIGNED_BYTE, staged ? UploadRing::GetBufferOffset(assets.stagedTexture, pixels) : pixels);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+
+		if (staged)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		upload.textureRow += rowCount;
+		if (upload.textureRow == level.height)
+		{
+			upload.textureLevel++;
+			upload.textureRow = 0;
+
+			// Once every loaded level is in, the rest of the chain is generated (the texture is not drawn before that),
+			// and the part of the upload ring it came from is reused once the GPU has read it
+			if (upload.textureLevel == texture.levels.size())
+			{
+				CompleteMipChain(texture);
+				if (assets.stagedTexture.size != 0)
+				{
+					uploadRing->Release(assets.stagedTexture);
+				}
+			}
+		}
+		assets.textureProfile.uploadSeconds += SecondsSince(pieceStart);
+		return false;
+	}
+
+	// Everything is on the GPU, so the loaded copy can go
+	std::cout << "  Ready after " << SecondsSince(startTime) * 1000.0 << " ms (loaded in " << assets.seconds * 1000.0
+		<< " ms on a worker thread)" << std::endl;
+	if (profile != nullptr)
+	{
+		double readyTime = SecondsSince(startTime);
+		assets.meshProfile.seconds = readyTime - assets.meshProfile.start;
+		assets.textureProfile.seconds = readyTime - assets.textureProfile.start;
+		profile->Add(assets.meshProfile);
+		profile->Add(assets.textureProfile);
+	}
+	upload.assets.reset();
+	exhibit.ready = true;
+	readyCount++;
+	return true;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "CookedAssets.h"
+#include "Exhibit.h"
+#include "MeshCache.h"
+#include "MpscQueue.h"
+#include "StartupProfile.h"
+#include "UploadRing.h"
+#include "VertexFormat.h"
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Geometry and texture image of an exhibit, prepared by a worker thread and waiting to be uploaded
+/// </summary>
+struct ExhibitAssets
+{
+	std::size_t exhibitIndex = 0;					// Position of the exhibit in the list of exhibits
+	bool meshLoaded = false;						// Indicates if the model was loaded successfully
+	LoadedMesh mesh;								// Triangles of the model
+	MeshLoadStats meshStats;						// Statistics about loading the model
+	std::vector<CompactVertex> compactVertices;		// Vertices in the compact format (empty for the float format)
+	std::vector<GLubyte> colors;					// Separate color stream of the compact vertices (empty if unused)
+	LoadedTexture texture;							// Texture image and its mip chain, if cooked (no levels if it failed to load)
+	UploadRingAllocation stagedTexture;				// Part of the upload ring the texture's levels were copied into (a size of 0 if they were not)
+	double seconds = 0.0;							// Time the worker thread spent loading and decoding
+	StartupProfileEntry meshProfile;				// Time, reads and GPU memory of the model, filled in as it loads and uploads
+	StartupProfileEntry textureProfile;				// Time, reads and GPU memory of the texture, filled in as it loads and uploads
+};
+
+/// <summary>
+/// Loads the model of an exhibit and converts its vertices to the format they are uploaded in.
+/// </summary>
+/// <param name="meshFilePath">Path to the .obj file of the model</param>
+/// <param name="settings">Settings for loading the model</param>
+/// <param name="vertexFormat">Format the vertices are uploaded in</param>
+/// <param name="assets">Receives the model (mesh, meshStats and meshLoaded) and its compact vertices and colors if needed</param>
+/// <returns>True if the model was loaded successfully</returns>
+bool LoadExhibitMesh(const std::string& meshFilePath, const MeshLoadSettings& settings, VertexFormat vertexFormat, ExhibitAssets& assets);
+
+/// <summary>
+/// Loads the models and textures of the exhibits on worker threads and uploads them on the OpenGL thread
+/// a little at a time, so the museum can be shown (and stays responsive) while the exhibits stream in.
+/// Worker threads hand finished assets to the OpenGL thread through a lock-free queue.
+/// </summary>
+class ExhibitStreamer
+{
+public:
+	/// <summary>
+	/// Starts loading every exhibit on the worker threads.
+	/// </summary>
+	/// <param name="exhibits">Exhibits to load (must outlive the streamer and keep its size)</param>
+	/// <param name="threadPool">Worker threads that load and decode the assets</param>
+	/// <param name="settings">Settings for loading the models</param>
+	/// <param name="vertexFormat">Format the vertices of the models are uploaded in</param>
+	/// <param name="archive">Archive of the textures cooked by AssetCooker (null to always decode the source images)</param>
+	/// <param name="startTime">Time the program started, used to report when each exhibit became ready</param>
+	/// <param name="profile">Receives an entry for the model and the texture of each exhibit once it is ready (null for none)</param>
+	/// <param name="uploadRing">Ring the worker threads stage the textures in, once it is created (null to upload them from their own pixels)</param>
+	ExhibitStreamer(std::vector<Exhibit>& exhibits, ThreadPool& threadPool, const MeshLoadSettings& settings,
+		VertexFormat vertexFormat, AssetArchive* archive, std::chrono::steady_clock::time_point startTime, StartupProfile* profile = nullptr,
+		UploadRing* uploadRing = nullptr);
+
+	/// <summary>
+	/// Waits for the worker threads to finish the exhibits they are still loading.
+	/// </summary>
+	~ExhibitStreamer();
+
+	ExhibitStreamer(const ExhibitStreamer&) = delete;
+	ExhibitStreamer& operator=(const ExhibitStreamer&) = delete;
+
+	/// <summary>
+	/// Uploads the assets that arrived from the worker threads, one piece at a time, until the time budget runs out.
+	/// At least one piece is uploaded per call if any is waiting. Must be called on the OpenGL thread.
+	/// </summary>
+	/// <param name="budgetSeconds">Time that may be spent uploading</param>
+	void Update(double budgetSeconds);
+
+	/// <summary>
+	/// Indicates if every exhibit was either uploaded or failed to load.
+	/// </summary>
+	bool IsFinished() const;
+
+	/// <summary>
+	/// Number of exhibits that are fully uploaded and can be drawn.
+	/// </summary>
+	std::size_t GetReadyCount() const;
+
+private:
+	/// <summary>
+	/// Part of a buffer that still has to be uploaded
+	/// </summary>
+	struct BufferUpload
+	{
+		GLuint buffer;			// OpenGL handle to the buffer
+		const GLubyte* data;	// Data of the buffer
+		std::size_t size;		// Size of the data in bytes
+	};
+
+	/// <summary>
+	/// Upload progress of the assets of one exhibit
+	/// </summary>
+	struct PendingUpload
+	{
+		std::unique_ptr<ExhibitAssets> assets;
+		bool objectsCreated = false;		// Indicates if the buffers, vertex array object and texture exist
+		std::vector<BufferUpload> buffers;	// Buffers to fill
+		std::size_t bufferIndex = 0;		// Buffer currently being filled
+		std::size_t bufferOffset = 0;		// Bytes of the current buffer that are already uploaded
+		std::size_t textureLevel = 0;		// Level of the mip chain currently being uploaded
+		int textureRow = 0;					// Rows of the current level that are already uploaded
+	};
+
+	void LoadAssets(std::size_t exhibitIndex);
+	void CreateObjects(PendingUpload& upload);
+	bool UploadPiece(PendingUpload& upload);
+
+	std::vector<Exhibit>& exhibits;
+	MeshLoadSettings settings;
+	VertexFormat vertexFormat;
+	AssetArchive* archive;
+	std::chrono::steady_clock::time_point startTime;
+	StartupProfile* profile;
+	UploadRing* uploadRing;
+
+	MpscQueue<std::unique_ptr<ExhibitAssets>> arrivals;	// Assets handed over by the worker threads
+	std::deque<PendingUpload> pending;					// Assets being uploaded, oldest first
+	std::vector<std::future<void>> jobs;
+	std::size_t finishedCount = 0;
+	std::size_t readyCount = 0;
+};
@@ -0,0 +1,258 @@
+#include "FileWatcher.h"
+
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	/// <summary>
+	/// Time a file has to stay unchanged before its change is reported
+	/// </summary>
+	const std::chrono::milliseconds SettleTime(100);
+
+#if defined(__linux__)
+	/// <summary>
+	/// Longest wait for inotify events before checking whether the watcher is stopping
+	/// </summary>
+	const int PollMilliseconds = 50;
+#else
+	/// <summary>
+	/// Time between two scans of the watched directories
+	/// </summary>
+	const std::chrono::milliseconds ScanInterval(250);
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+std::string FileWatcher::GetWatchedPath(const std::string& filePath)
+{
+	std::string path = std::filesystem::path(filePath).lexically_normal().generic_string();
+	if (path.compare(0, 2, "./") == 0)
+	{
+		path.erase(0, 2);
+	}
+	return path;
+}
+
+#if defined(__linux__)
+
+bool FileWatcher::Start(const std::vector<std::string>& directories)
+{
+	Stop();
+
+	inotifyFile = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFile < 0)
+	{
+		std::cerr << "Failed to initialize inotify" << std::endl;
+		return false;
+	}
+
+	// Editors either write the file in place (reported when it is closed) or write another file and rename it over this one
+	for (const std::string& directory : directories)
+	{
+		int watch = inotify_add_watch(inotifyFile, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watch < 0)
+		{
+			std::cerr << "Failed to watch directory: " << directory << std::endl;
+			Stop();
+			return false;
+		}
+		watchedDirectories[watch] = directory;
+	}
+
+	stopping = false;
+	thread = std::thread(&FileWatcher::Run, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	stopping = true;
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+
+	if (inotifyFile >= 0)
+	{
+		close(inotifyFile);
+		inotifyFile = -1;
+	}
+	watchedDirectories.clear();
+}
+
+void FileWatcher::WaitForChanges(std::vector<std::string>& filePaths)
+{
+	pollfd pollFile = { inotifyFile, POLLIN, 0 };
+	if (poll(&pollFile, 1, PollMilliseconds) <= 0)
+	{
+		return;
+	}
+
+	// Events are variable-sized (each is followed by its file name), so they are read into a buffer aligned for them
+	alignas(inotify_event) char buffer[16 * 1024];
+	for (;;)
+	{
+		ssize_t size = read(inotifyFile, buffer, sizeof(buffer));
+		if (size <= 0)
+		{
+			return;
+		}
+
+		for (char* position = buffer; position < buffer + size; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+			if ((event->mask & IN_Q_OVERFLOW) != 0)
+			{
+				std::cerr << "Too many file changes at once, some were missed" << std::endl;
+			}
+			else if (event->len != 0)
+			{
+				std::map<int, std::string>::const_iterator directory = watchedDirectories.find(event->wd);
+				if (directory != watchedDirectories.end())
+				{
+					filePaths.push_back(GetWatchedPath((std::filesystem::path(directory->second) / event->name).string()));
+				}
+			}
+			position += sizeof(inotify_event) + event->len;
+		}
+	}
+}
+
+#else
+
+bool FileWatcher::Start(const std::vector<std::string>& directories)
+{
+	Stop();
+
+	for (const std::string& directory : directories)
+	{
+		std::error_code error;
+		if (!std::filesystem::is_directory(directory, error))
+		{
+			std::cerr << "Failed to watch directory: " << directory << std::endl;
+			Stop();
+			return false;
+		}
+		watchedDirectories.push_back(directory);
+	}
+
+	// The first scan only records what is there
+	std::vector<std::string> unchanged;
+	ScanDirectories(unchanged, false);
+
+	stopping = false;
+	thread = std::thread(&FileWatcher::Run, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	stopping = true;
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+
+	watchedDirectories.clear();
+	fileStates.clear();
+}
+
+void FileWatcher::WaitForChanges(std::vector<std::string>& filePaths)
+{
+	std::this_thread::sleep_for(ScanInterval);
+	ScanDirectories(filePaths, true);
+}
+
+void FileWatcher::ScanDirectories(std::vector<std::string>& filePaths, bool reportChanges)
+{
+	for (const std::string& directory : watchedDirectories)
+	{
+		std::error_code error;
+		for (std::filesystem::directory_iterator file(directory, error), end; !error && file != end; file.increment(error))
+		{
+			std::error_code fileError;
+			if (!file->is_regular_file(fileError))
+			{
+				continue;
+			}
+
+			FileState state;
+			state.size = file->file_size(fileError);
+			state.modificationTime = static_cast<std::int64_t>(file->last_write_time(fileError).time_since_epoch().count());
+			if (fileError)
+			{
+				continue;
+			}
+
+			std::string path = GetWatchedPath(file->path().string());
+			std::map<std::string, FileState>::iterator known = fileStates.find(path);
+			if (known == fileStates.end())
+			{
+				fileStates[path] = state;
+				if (reportChanges)
+				{
+					filePaths.push_back(path);
+				}
+			}
+			else if (known->second.size != state.size || known->second.modificationTime != state.modificationTime)
+			{
+				known->second = state;
+				if (reportChanges)
+				{
+					filePaths.push_back(path);
+				}
+			}
+		}
+	}
+}
+
+#endif
+
+void FileWatcher::PopChanges(std::vector<std::string>& filePaths)
+{
+	changes.PopAll(filePaths);
+}
+
+void FileWatcher::Run()
+{
+	// Files that changed recently, with the time of their last change, waiting to settle
+	std::map<std::string, std::chrono::steady_clock::time_point> settling;
+	std::vector<std::string> changed;
+
+	while (!stopping)
+	{
+		changed.clear();
+		WaitForChanges(changed);
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		for (const std::string& filePath : changed)
+		{
+			settling[filePath] = now;
+		}
+
+		for (std::map<std::string, std::chrono::steady_clock::time_point>::iterator file = settling.begin(); file != settling.end(); )
+		{
+			if (now - file->second >= SettleTime)
+			{
+				changes.Push(file->first);
+				file = settling.erase(file);
+			}
+			else
+			{
+				++file;
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "MpscQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Watches directories for files that are written or replaced, on a background thread.
+/// On Linux the changes come from inotify; elsewhere the directories are scanned for new modification times a few times a second.
+/// A change is only reported once the file has stopped changing for a moment, so a file that is written in several steps
+/// (or saved to a temporary file and renamed) is reported once, after it is complete.
+/// </summary>
+class FileWatcher
+{
+public:
+	FileWatcher() = default;
+
+	/// <summary>
+	/// Stops watching.
+	/// </summary>
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	/// <summary>
+	/// Starts watching directories (not their subdirectories).
+	/// </summary>
+	/// <param name="directories">Directories to watch ("." for the working directory)</param>
+	/// <returns>True if every directory is being watched</returns>
+	bool Start(const std::vector<std::string>& directories);
+
+	/// <summary>
+	/// Stops watching and waits for the background thread to finish.
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// Takes the files that changed since the last call.
+	/// </summary>
+	/// <param name="filePaths">Receives the paths of the changed files, in the form GetWatchedPath gives</param>
+	void PopChanges(std::vector<std::string>& filePaths);
+
+	/// <summary>
+	/// Path of a file the way changes to it are reported: lexically normalized, with forward slashes
+	/// and without a leading "./".
+	/// </summary>
+	/// <param name="filePath">Path to the file</param>
+	/// <returns>Path to compare with the reported ones</returns>
+	static std::string GetWatchedPath(const std::string& filePath);
+
+private:
+	void Run();
+	void WaitForChanges(std::vector<std::string>& filePaths);
+
+#if defined(__linux__)
+	int inotifyFile = -1;
+	std::map<int, std::string> watchedDirectories;	// Directory of each inotify watch, by watch descriptor
+#else
+	/// <summary>
+	/// Size and modification time of a file, as seen by the last scan
+	/// </summary>
+	struct FileState
+	{
+		std::uintmax_t size;
+		std::int64_t modificationTime;
+	};
+
+	void ScanDirectories(std::vector<std::string>& filePaths, bool reportChanges);
+
+	std::vector<std::string> watchedDirectories;
+	std::map<std::string, FileState> fileStates;	// Files seen in the watched directories, by path
+#endif
+
+	std::atomic<bool> stopping{ false };
+	std::thread thread;
+	MpscQueue<std::string> changes;	// Paths of the files that finished changing
+};
@@ -0,0 +1,57 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace
+{
+	const std::uint64_t GoldenRatio = 0x9E3779B97F4A7C15ull;
+
+	/// <summary>
+	/// Final mix of MurmurHash3, spreads every input bit over the whole output
+	/// </summary>
+	std::uint64_t Mix(std::uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+		return value;
+	}
+}
+
+std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(size) * GoldenRatio);
+
+	// Four independent lanes, so consecutive words do not wait on each other's multiplications
+	std::uint64_t lanes[4] = { hash, hash + GoldenRatio, hash - GoldenRatio, ~hash };
+	std::size_t offset = 0;
+	for (; offset + 32 <= size; offset += 32)
+	{
+		for (int lane = 0; lane < 4; lane++)
+		{
+			std::uint64_t word;
+			std::memcpy(&word, bytes + offset + lane * 8, 8);
+			lanes[lane] = (lanes[lane] ^ word) * GoldenRatio;
+			lanes[lane] ^= lanes[lane] >> 29;
+		}
+	}
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		hash = Mix(hash ^ lanes[lane]);
+	}
+
+	// Remaining bytes, 8 at a time, the last word padded with zeros
+	for (; offset < size; offset += 8)
+	{
+		std::uint64_t word = 0;
+		std::size_t count = size - offset < 8 ? size - offset : 8;
+		std::memcpy(&word, bytes + offset, count);
+		hash = Mix(hash ^ word);
+	}
+
+	return hash;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// Computes a 64-bit hash of a block of memory, used to detect when the contents of a file change.
+/// This is not a cryptographic hash.
+/// </summary>
+/// <param name="data">Start of the memory block</param>
+/// <param name="size">Size of the memory block in bytes</param>
+/// <param name="seed">Starting value, to chain the hash over several blocks</param>
+/// <returns>Hash of the memory block</returns>
+std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t seed = 0);
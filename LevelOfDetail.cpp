@@ -0,0 +1,46 @@
+#include "LevelOfDetail.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// <summary>
+	/// Coarsest level whose error covers at most the given number of pixels (the full-detail level if none does).
+	/// </summary>
+	std::size_t CoarsestLodWithin(const MeshLod* lods, std::size_t lodCount, float pixelsPerUnit, float pixels)
+	{
+		std::size_t lod = 0;
+		for (std::size_t i = 1; i < lodCount; i++)
+		{
+			if (lods[i].error * pixelsPerUnit <= pixels)
+			{
+				lod = i;
+			}
+		}
+		return lod;
+	}
+}
+
+float GetPixelsPerUnit(float distance, float verticalFieldOfView, int viewportHeight)
+{
+	return static_cast<float>(viewportHeight) / (2.0f * std::tan(verticalFieldOfView * 0.5f) * distance);
+}
+
+std::size_t SelectLod(const MeshLod* lods, std::size_t lodCount, std::size_t currentLod, float pixelsPerUnit, const LodSelectionSettings& settings)
+{
+	if (lodCount == 0)
+	{
+		return 0;
+	}
+	currentLod = std::min(currentLod, lodCount - 1);
+
+	// The current level shows too much error: go finer, to a level that is within the limit
+	if (lods[currentLod].error * pixelsPerUnit > settings.maxPixelError * (1.0f + settings.hysteresis))
+	{
+		return std::min(currentLod, CoarsestLodWithin(lods, lodCount, pixelsPerUnit, settings.maxPixelError));
+	}
+
+	// Otherwise go coarser only if a coarser level is well within the limit
+	return std::max(currentLod, CoarsestLodWithin(lods, lodCount, pixelsPerUnit, settings.maxPixelError * (1.0f - settings.hysteresis)));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+
+/// <summary>
+/// Settings for picking the level of detail a model is drawn with
+/// </summary>
+struct LodSelectionSettings
+{
+	float maxPixelError = 1.0f;	// Largest error a level may show on screen, in pixels
+	float hysteresis = 0.25f;	// Fraction of maxPixelError a level's error must clear before switching, so levels do not flicker at the boundary
+};
+
+/// <summary>
+/// Number of pixels one unit covers on screen at a given distance from the camera.
+/// </summary>
+/// <param name="distance">Distance from the camera</param>
+/// <param name="verticalFieldOfView">Vertical field of view of the projection, in radians</param>
+/// <param name="viewportHeight">Height of the viewport in pixels</param>
+/// <returns>Pixels per unit at that distance</returns>
+float GetPixelsPerUnit(float distance, float verticalFieldOfView, int viewportHeight);
+
+/// <summary>
+/// Picks the coarsest level of detail whose error stays within the allowed number of pixels on screen.
+/// A coarser level is only taken once its error is comfortably below the limit, and the current level is only
+/// left for a finer one once its error is comfortably above the limit, so a model standing near a boundary
+/// does not switch back and forth every frame.
+/// </summary>
+/// <param name="lods">Levels of detail, from full detail to coarsest (with growing errors)</param>
+/// <param name="lodCount">Number of levels of detail</param>
+/// <param name="currentLod">Level the model was drawn with last</param>
+/// <param name="pixelsPerUnit">Pixels one model unit covers on screen, at the model's distance and scale</param>
+/// <param name="settings">Settings for picking the level of detail</param>
+/// <returns>Level to draw the model with</returns>
+std::size_t SelectLod(const MeshLod* lods, std::size_t lodCount, std::size_t currentLod, float pixelsPerUnit, const LodSelectionSettings& settings);
@@ -0,0 +1,246 @@
+#include "Lz4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	/// <summary>
+	/// Shortest match the format can express
+	/// </summary>
+	const std::size_t MinMatch = 4;
+
+	/// <summary>
+	/// The last bytes of a block are always literals
+	/// </summary>
+	const std::size_t LastLiterals = 5;
+
+	/// <summary>
+	/// The last match has to start at least this many bytes before the end of the block
+	/// </summary>
+	const std::size_t MatchStartLimit = 12;
+
+	/// <summary>
+	/// Farthest back a match can be (offsets are stored in 16 bits)
+	/// </summary>
+	const std::size_t MaxOffset = 65535;
+
+	/// <summary>
+	/// Size of the table of recently seen 4-byte sequences, as a power of two
+	/// </summary>
+	const int HashBits = 16;
+
+	std::uint32_t Read32(const unsigned char* bytes)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t HashSequence(std::uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HashBits);
+	}
+
+	/// <summary>
+	/// Writes the part of a length that did not fit in its 4 bits of the token.
+	/// </summary>
+	unsigned char* WriteExtraLength(unsigned char* output, std::size_t length)
+	{
+		while (length >= 255)
+		{
+			*output++ = 255;
+			length -= 255;
+		}
+		*output++ = static_cast<unsigned char>(length);
+		return output;
+	}
+
+	/// <summary>
+	/// Reads the part of a length that did not fit in its 4 bits of the token.
+	/// </summary>
+	bool ReadExtraLength(const unsigned char*& input, const unsigned char* inputEnd, std::size_t& length)
+	{
+		unsigned char byte;
+		do
+		{
+			if (input == inputEnd)
+			{
+				return false;
+			}
+			byte = *input++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	/// <summary>
+	/// Writes a sequence: literals copied as they are, followed by a match (unless matchLength is 0, for the last sequence).
+	/// </summary>
+	unsigned char* WriteSequence(unsigned char* output, const unsigned char* literals, std::size_t literalLength,
+		std::size_t offset, std::size_t matchLength)
+	{
+		unsigned char* token = output++;
+		*token = static_cast<unsigned char>((literalLength < 15 ? literalLength : 15) << 4);
+		if (literalLength >= 15)
+		{
+			output = WriteExtraLength(output, literalLength - 15);
+		}
+		std::memcpy(output, literals, literalLength);
+		output += literalLength;
+
+		if (matchLength != 0)
+		{
+			*output++ = static_cast<unsigned char>(offset & 0xFF);
+			*output++ = static_cast<unsigned char>(offset >> 8);
+
+			std::size_t extraMatchLength = matchLength - MinMatch;
+			*token |= static_cast<unsigned char>(extraMatchLength < 15 ? extraMatchLength : 15);
+			if (extraMatchLength >= 15)
+			{
+				output = WriteExtraLength(output, extraMatchLength - 15);
+			}
+		}
+		return output;
+	}
+}
+
+std::size_t GetLz4CompressBound(std::size_t sourceSize)
+{
+	return sourceSize + sourceSize / 255 + 16;
+}
+
+std::size_t CompressLz4(const char* source, std::size_t sourceSize, char* destination)
+{
+	if (sourceSize == 0)
+	{
+		// A block of nothing is a single token with no literals
+		*destination = 0;
+		return 1;
+	}
+
+	const unsigned char* input = reinterpret_cast<const unsigned char*>(source);
+	const unsigned char* inputEnd = input + sourceSize;
+	unsigned char* output = reinterpret_cast<unsigned char*>(destination);
+	const unsigned char* literals = input;
+
+	if (sourceSize > MatchStartLimit)
+	{
+		// Positions of the last place each hashed 4-byte sequence was seen
+		std::vector<std::uint32_t> table(std::size_t(1) << HashBits, 0);
+		const unsigned char* matchEndLimit = inputEnd - LastLiterals;
+		const unsigned char* matchStartLimit = inputEnd - MatchStartLimit;
+
+		// The search speeds up through data that keeps failing to match, so incompressible blobs stay cheap
+		std::size_t misses = 0;
+		const unsigned char* position = input;
+		while (position < matchStartLimit)
+		{
+			std::uint32_t sequence = Read32(position);
+			std::uint32_t& entry = table[HashSequence(sequence)];
+			const unsigned char* candidate = input + entry;
+			entry = static_cast<std::uint32_t>(position - input);
+
+			if (candidate >= position || static_cast<std::size_t>(position - candidate) > MaxOffset || Read32(candidate) != sequence)
+			{
+				position += 1 + (misses++ >> 6);
+				continue;
+			}
+
+			const unsigned char* matchEnd = position + MinMatch;
+			const unsigned char* candidateEnd = candidate + MinMatch;
+			while (matchEnd < matchEndLimit && *matchEnd == *candidateEnd)
+			{
+				matchEnd++;
+				candidateEnd++;
+			}
+
+			output = WriteSequence(output, literals, static_cast<std::size_t>(position - literals),
+				static_cast<std::size_t>(position - candidate), static_cast<std::size_t>(matchEnd - position));
+			position = matchEnd;
+			literals = position;
+			misses = 0;
+		}
+	}
+
+	output = WriteSequence(output, literals, static_cast<std::size_t>(inputEnd - literals), 0, 0);
+	return static_cast<std::size_t>(output - reinterpret_cast<unsigned char*>(destination));
+}
+
+bool DecompressLz4(const char* source, std::size_t sourceSize, char* destination, std::size_t destinationSize)
+{
+	if (sourceSize == 0 || destinationSize == 0)
+	{
+		return sourceSize == 1 && *source == 0 && destinationSize == 0;
+	}
+
+	const unsigned char* input = reinterpret_cast<const unsigned char*>(source);
+	const unsigned char* inputEnd = input + sourceSize;
+	unsigned char* outputStart = reinterpret_cast<unsigned char*>(destination);
+	unsigned char* output = outputStart;
+	unsigned char* outputEnd = outputStart + destinationSize;
+
+	while (input != inputEnd)
+	{
+		unsigned int token = *input++;
+
+		std::size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadExtraLength(input, inputEnd, literalLength))
+		{
+			return false;
+		}
+		if (literalLength > static_cast<std::size_t>(inputEnd - input) || literalLength > static_cast<std::size_t>(outputEnd - output))
+		{
+			return false;
+		}
+		std::memcpy(output, input, literalLength);
+		input += literalLength;
+		output += literalLength;
+
+		// The last sequence has no match
+		if (input == inputEnd)
+		{
+			break;
+		}
+
+		if (inputEnd - input < 2)
+		{
+			return false;
+		}
+		std::size_t offset = static_cast<std::size_t>(input[0]) | (static_cast<std::size_t>(input[1]) << 8);
+		input += 2;
+		if (offset == 0 || offset > static_cast<std::size_t>(output - outputStart))
+		{
+			return false;
+		}
+
+		std::size_t matchLength = token & 15;
+		if (matchLength == 15 && !ReadExtraLength(input, inputEnd, matchLength))
+		{
+			return false;
+		}
+		matchLength += MinMatch;
+		if (matchLength > static_cast<std::size_t>(outputEnd - output))
+		{
+			return false;
+		}
+
+		// A match closer than its length repeats the bytes it is copying, so it is copied one byte at a time
+		const unsigned char* match = output - offset;
+		if (offset >= matchLength)
+		{
+			std::memcpy(output, match, matchLength);
+			output += matchLength;
+		}
+		else
+		{
+			for (std::size_t i = 0; i < matchLength; i++)
+			{
+				*output++ = match[i];
+			}
+		}
+	}
+
+	return output == outputEnd;
+}
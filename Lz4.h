@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Largest size LZ4-compressing a block of the given size can produce (incompressible data grows slightly).
+/// </summary>
+/// <param name="sourceSize">Size of the data to compress in bytes</param>
+/// <returns>Size the destination of CompressLz4 needs</returns>
+std::size_t GetLz4CompressBound(std::size_t sourceSize);
+
+/// <summary>
+/// Compresses a block of memory in the LZ4 block format (a single block, without the LZ4 frame around it),
+/// using a greedy match search. Decompression is several times faster than reading the data from disk.
+/// </summary>
+/// <param name="source">Data to compress</param>
+/// <param name="sourceSize">Size of the data in bytes</param>
+/// <param name="destination">Receives the compressed data (must have room for GetLz4CompressBound(sourceSize) bytes)</param>
+/// <returns>Size of the compressed data in bytes</returns>
+std::size_t CompressLz4(const char* source, std::size_t sourceSize, char* destination);
+
+/// <summary>
+/// Decompresses a block written by CompressLz4 (or any LZ4 block compressor). Malformed input is detected
+/// and never makes this read or write outside the given buffers.
+/// </summary>
+/// <param name="source">Compressed data</param>
+/// <param name="sourceSize">Size of the compressed data in bytes</param>
+/// <param name="destination">Receives the decompressed data</param>
+/// <param name="destinationSize">Size of the decompressed data in bytes, which has to be known in advance</param>
+/// <returns>True if the block was valid and decompressed to exactly destinationSize bytes</returns>
+bool DecompressLz4(const char* source, std::size_t sourceSize, char* destination, std::size_t destinationSize);
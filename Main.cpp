@@ -3,18 +3,46 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "AssetArchive.h"
+#include "AssetReloader.h"
+#include "Benchmarks.h"
+#include "CookedAssets.h"
+#include "Exhibit.h"
+#include "ExhibitStreamer.h"
+#include "LevelOfDetail.h"
+#include "MemoryUsage.h"
+#include "Mesh.h"
+#include "Meshlets.h"
+#include "ObjLoader.h"
+#include "ProgramOptions.h"
+#include "ShaderUniforms.h"
+#include "StartupProfile.h"
+#include "StaticBatch.h"
+#include "TextureLoader.h"
+#include "Textures.h"
+#include "ThreadPool.h"
+#include "UniformRing.h"
+#include "UploadRing.h"
+#include "VertexFormat.h"
+#include "VirtualTextures.h"
+
 // ----------------
 // Function declarations
 // ----------------
@@ -24,16 +52,29 @@
 /// </summary>
 /// <param name="vertexShaderFilePath">Vertex shader file path</param>
 /// <param name="fragmentShaderFilePath">Fragment shader file path</param>
+/// <param name="archive">Archive to take the shader sources from, by file name (null to always read the files)</param>
+/// <param name="profile">Receives an entry for each shader and for linking the program</param>
 /// <returns>OpenGL handle to the created shader program</returns>
-GLuint CreateShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath);
+GLuint CreateShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath, AssetArchive* archive,
+	StartupProfile& profile);
+
+/// <summary>
+/// Links a vertex and a fragment shader into a shader program, then deletes the shaders.
+/// </summary>
+/// <param name="vertexShader">OpenGL handle to the vertex shader</param>
+/// <param name="fragmentShader">OpenGL handle to the fragment shader</param>
+/// <returns>OpenGL handle to the created shader program (check GL_LINK_STATUS to know if it linked)</returns>
+GLuint LinkShaderProgram(GLuint vertexShader, GLuint fragmentShader);
 
 /// <summary>
 /// Creates a shader based on the provided shader type and the path to the file containing the shader source.
 /// </summary>
 /// <param name="shaderType">Shader type</param>
 /// <param name="shaderFilePath">Path to the file containing the shader source</param>
+/// <param name="archive">Archive to take the shader source from, by file name (null to always read the file)</param>
+/// <param name="profile">Receives an entry for reading and compiling the shader</param>
 /// <returns>OpenGL handle to the created shader</returns>
-GLuint CreateShaderFromFile(const GLuint& shaderType, const std::string& shaderFilePath);
+GLuint CreateShaderFromFile(const GLuint& shaderType, const std::string& shaderFilePath, AssetArchive* archive, StartupProfile& profile);
 
 /// <summary>
 /// Creates a shader based on the provided shader type and the string containing the shader source.
@@ -70,15 +111,39 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 void MouseCallback(GLFWwindow* window, double xpos, double ypos);
 
 /// <summary>
-/// Struct containing data about a vertex
+/// Draws primitives from the bound vertex array object and counts the draw call.
 /// </summary>
-struct Vertex
-{
-	GLfloat x, y, z;	// Position
-	GLubyte r, g, b;	// Color
-	GLfloat u, v;		// UV Coordinates
-	GLfloat nx, ny, nz; // Normal Vector
-};
+/// <param name="mode">Primitive type</param>
+/// <param name="first">Index of the first vertex</param>
+/// <param name="count">Number of vertices</param>
+void DrawArrays(GLenum mode, GLint first, GLsizei count);
+
+/// <summary>
+/// Draws several ranges of primitives from the bound vertex array object with a single draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="first">Index of the first vertex of each range</param>
+/// <param name="count">Number of vertices of each range</param>
+/// <param name="drawCount">Number of ranges</param>
+void MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawCount);
+
+/// <summary>
+/// Draws indexed primitives from the bound vertex array object and counts the draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="count">Number of indices</param>
+/// <param name="firstIndex">Position of the first index inside the element buffer</param>
+/// <param name="baseVertex">Value added to every index before fetching the vertex</param>
+void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLsizei firstIndex, GLint baseVertex);
+
+/// <summary>
+/// Draws several ranges of indexed primitives from the bound vertex array object with a single draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="count">Number of indices of each range</param>
+/// <param name="offsets">Byte offset of each range inside the element buffer</param>
+/// <param name="drawCount">Number of ranges</param>
+void MultiDrawElements(GLenum mode, const GLsizei* count, const void* const* offsets, GLsizei drawCount);
 
 /// <summary>
 /// Camera variables
@@ -157,21 +222,179 @@ glm::vec3 spotlightSpecular = glm::vec3(0.5f, 0.5f, 0.5f);
 /// </summary>
 bool spotLightsOn = true;
 
+/// <summary>
+/// Number of draw calls issued since the start of the current frame
+/// </summary>
+unsigned int drawCallCount = 0;
+
+/// <summary>
+/// Number of exhibit triangles drawn since the start of the current frame
+/// </summary>
+unsigned int exhibitTriangleCount = 0;
+
+/// <summary>
+/// Number of exhibit meshlets skipped since the start of the current frame, for facing away from the camera or lying outside the view
+/// </summary>
+unsigned int exhibitMeshletsCulled = 0;
+
 /// <summary>
 /// Main function.
 /// </summary>
+/// <param name="argc">Number of command line arguments</param>
+/// <param name="argv">Command line arguments (see ProgramOptions)</param>
 /// <returns>An integer indicating whether the program ended successfully or not.
 /// A value of 0 indicates the program ended succesfully, while a non-zero value indicates
 /// something wrong happened during execution.</returns>
-int main()
+int main(int argc, char** argv)
 {
+	// Time-to-first-frame is measured from here
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	// Every stage of startup and every asset is timed, and reported once all the exhibits are in if asked for
+	StartupProfile startupProfile(startTime);
+
+	ProgramOptions options;
+	if (!ParseProgramOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	// Worker threads for loading the assets
+	StartupProfileEntry threadsProfile = startupProfile.Begin("Worker threads");
+	ThreadPool threadPool(options.workerThreads);
+	startupProfile.End(threadsProfile);
+	ThreadPool* objThreadPool = options.parallelObjParsing ? &threadPool : nullptr;
+
+	if (options.benchmarkObjReading)
+	{
+		std::vector<Exhibit> exhibits;
+		if (!LoadExhibitManifest("exhibits.txt", exhibits) || !RunObjReadingBenchmark(exhibits, objThreadPool, 10))
+		{
+			return 1;
+		}
+		return 0;
+	}
+
+	if (options.benchmarkPixelKernels)
+	{
+		return RunPixelKernelBenchmark(20) ? 0 : 1;
+	}
+
+	// Size of the window, and the vertical field of view of the camera
+	int windowWidth = 800;
+	int windowHeight = 600;
+	const float verticalFieldOfView = glm::radians(60.0f);
+
+	// --- 3D Models ---
+
+	// The exhibits are listed in a manifest, so new ones can be added without recompiling
+	std::vector<Exhibit> exhibits;
+	StartupProfileEntry manifestProfile = startupProfile.Begin("Manifest", "exhibits.txt");
+	if (!LoadExhibitManifest("exhibits.txt", exhibits))
+	{
+		return 1;
+	}
+	startupProfile.End(manifestProfile);
+
+	// The cooked meshes, textures and the shaders all come out of a single memory-mapped archive when the asset cooker made one
+	// (declared after the thread pool, so that it is closed while the worker threads are still there to finish preloading it)
+	AssetArchive assetArchive;
+	AssetArchive* archive = nullptr;
+	if (!options.assetArchive.empty())
+	{
+		StartupProfileEntry archiveProfile = startupProfile.Begin("Asset archive", options.assetArchive);
+		if (assetArchive.Open(options.assetArchive))
+		{
+			archive = &assetArchive;
+		}
+		else
+		{
+			std::cout << "No asset archive at " << options.assetArchive << ", loading the source files instead" << std::endl;
+		}
+		startupProfile.End(archiveProfile);
+	}
+
+	MeshLoadSettings meshLoadSettings;
+	meshLoadSettings.archive = archive;
+	meshLoadSettings.useCache = options.meshCache;
+	meshLoadSettings.optimize = options.meshOptimization;
+	meshLoadSettings.buildLods = options.meshLods;
+	meshLoadSettings.buildMeshlets = options.meshlets;
+	meshLoadSettings.threadPool = objThreadPool;
+	meshLoadSettings.reading = options.memoryMappedObj ? ObjFileReading::MemoryMapped : ObjFileReading::Buffered;
+
+	if (options.benchmarkLods)
+	{
+		return RunLodBenchmark(exhibits, meshLoadSettings, options.lodPixelError, verticalFieldOfView, windowHeight) ? 0 : 1;
+	}
+
+	// Levels of detail are picked by how many pixels their error covers on screen
+	LodSelectionSettings lodSettings;
+	lodSettings.maxPixelError = options.lodPixelError;
+
+	// The exhibits are quantized into the compact vertex format on the worker threads, unless told otherwise
+	VertexFormat exhibitVertexFormat = options.compactVertices ? VertexFormat::Compact : VertexFormat::Float;
+
+	// Images of the room, in the order of the layers of its texture array, and the paintings, whose layers come after them
+	std::vector<std::string> roomImageFilePaths = { "CubeMap-FrontWall.png", "CubeMap-BackWall.png", "CubeMap-LeftRightWall.png",
+		"CubeMap-Ceiling.png", "CubeMap-Floor.png", "PLATFORM-Wood.png", "PAINTING-Frame.png" };
+	const std::vector<std::string> paintingImageFilePaths = { "PAINTING-Mona-Lisa.png", "PAINTING-The-Starry-Night.png",
+		"PAINTING-The-Great-Wave-off-Kanagawa.png", "PAINTING-The-Birth-of-Venus.png", "PAINTING-Girl-with-a-Pearl-Earring.png",
+		"PAINTING-The-Scream.png" };
+
+	// The paintings are drawn as virtual textures when the asset archive has their tiled textures, so only the tiles that are seen
+	// are ever read, into a cache of fixed size. Otherwise they are loaded whole, as layers of the room's texture array
+	// (declared after the archive, so that it is destroyed while the tiles it reads are still mapped)
+	VirtualTextures virtualTextures(threadPool);
+	bool useVirtualTextures = false;
+	if (options.virtualTextures && archive != nullptr)
+	{
+		useVirtualTextures = virtualTextures.Open(*archive, paintingImageFilePaths);
+		if (!useVirtualTextures)
+		{
+			std::cout << "The asset archive has no tiled textures of the paintings, loading them whole instead" << std::endl;
+		}
+	}
+
+	// The room's images are all decoded at once on the worker threads (queued ahead of the exhibits, which the room is shown without)
+	// while the window is created, so the main thread only has to upload them
+	TextureLoader roomTextures(threadPool, archive, startupProfile, "Room texture");
+	for (const std::string& imageFilePath : roomImageFilePaths)
+	{
+		roomTextures.Load(imageFilePath);
+	}
+	if (!useVirtualTextures)
+	{
+		for (const std::string& imageFilePath : paintingImageFilePaths)
+		{
+			roomImageFilePaths.push_back(imageFilePath);
+			roomTextures.Load(imageFilePath);
+		}
+	}
+
+	// The models and textures of the exhibits load on the worker threads while the window and the room are set up,
+	// and are uploaded a little at a time by the render loop. The textures that finish loading once there is an OpenGL context
+	// are staged in the upload ring (declared first, so the streamer's worker threads are done with it by the time it goes)
+	UploadRing uploadRing;
+	ExhibitStreamer exhibitStreamer(exhibits, threadPool, meshLoadSettings, exhibitVertexFormat, archive, startTime, &startupProfile,
+		&uploadRing);
+
+	// The shaders are decompressed on the worker threads while the window is created as well
+	if (archive != nullptr)
+	{
+		archive->Preload(useVirtualTextures ? std::vector<std::string>{ "main.vsh", "main.fsh", "feedback.fsh" }
+			: std::vector<std::string>{ "main.vsh", "main.fsh" }, threadPool);
+	}
+
 	// Initialize GLFW
+	StartupProfileEntry glfwProfile = startupProfile.Begin("GLFW");
 	int glfwInitStatus = glfwInit();
 	if (glfwInitStatus == GLFW_FALSE)
 	{
 		std::cerr << "Failed to initialize GLFW!" << std::endl;
 		return 1;
 	}
+	startupProfile.End(glfwProfile);
 
 	// Tell GLFW that we prefer to use OpenGL 3.3
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -182,8 +405,7 @@ int main()
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 	// Tell GLFW to create a window
-	int windowWidth = 800;
-	int windowHeight = 600;
+	StartupProfileEntry windowProfile = startupProfile.Begin("Window");
 	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "[Mendoza & Serrano] GDEV 30 Final Project", nullptr, nullptr);
 	if (window == nullptr)
 	{
@@ -206,18 +428,27 @@ int main()
 
 	// Tell OpenGL to hide and capture the cursor
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	startupProfile.End(windowProfile);
 
 	// Tell GLAD to load the OpenGL function pointers
+	StartupProfileEntry gladProfile = startupProfile.Begin("GLAD");
 	if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
 	{
 		std::cerr << "Failed to initialize GLAD!" << std::endl;
 		return 1;
 	}
+	startupProfile.End(gladProfile);
+
+	// The exhibits' textures go to the GPU through a persistently mapped buffer when the driver supports one
+	if (options.uploadRingMegabytes != 0)
+	{
+		uploadRing.Create(static_cast<std::size_t>(options.uploadRingMegabytes) * 1024 * 1024, reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+	}
 
 	// --- Vertex specification ---
 
 	// Set up the data for each vertex of the triangle
-	Vertex vertices[84+56334+2904+13984+11988];
+	Vertex vertices[84];
 
 	// --- Room ---
 
@@ -668,300 +899,127 @@ int main()
 	vertices[83].u = 1.0f;			vertices[83].v = 0.0f;
 	vertices[83].nx = 0.0f;			vertices[83].ny = -1.0f;		vertices[83].nz = 0.0f;
 
-	// --- 3D Model: Nefertiti Bust ---
-
-	float vertXYZ[9391][3];
-	float texUV[10246][2];
-	float normXYZ[9391][3];
-
-	int i1 = 0;
-	int j1 = 0;
-	int k1 = 0;
-	int l1 = 84;
-
-	FILE* file1 = fopen("3D-MODEL-Nefertiti-Bust.obj", "r");
-	if (file1 == NULL) {
-		printf("Impossible to open the file !\n");
-		return false;
-	}
-
-	while (1) {
-		char lineHeader[128];
-		int res = fscanf(file1, "%s", lineHeader);
-
-		if (res == EOF)
-			break;
-
-		if (strcmp(lineHeader, "v") == 0) {
-			fscanf(file1, "%f %f %f\n", &vertXYZ[i1][0], &vertXYZ[i1][1], &vertXYZ[i1][2]);
-			i1 += 1;
-		}
-		else if (strcmp(lineHeader, "vt") == 0) {
-			fscanf(file1, "%f %f\n", &texUV[j1][0], &texUV[j1][1]);
-			j1 += 1;
-		}
-		else if (strcmp(lineHeader, "vn") == 0) {
-			fscanf(file1, "%f %f %f\n", &normXYZ[k1][0], &normXYZ[k1][1], &normXYZ[k1][2]);
-			k1 += 1;
-		}
-		else if (strcmp(lineHeader, "f") == 0) {
-			int v1, vt1, vn1, v2, vt2, vn2, v3, vt3, vn3;
-			int matches = fscanf(file1, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3);
-			if (matches != 9) {
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file1);
-				return false;
-			}
-			vertices[l1].x = vertXYZ[v1 - 1][0];			vertices[l1].y = vertXYZ[v1 - 1][1];			vertices[l1].z = vertXYZ[v1 - 1][2];
-			vertices[l1].r = 255;						vertices[l1].g = 255;						vertices[l1].b = 255;
-			vertices[l1].u = texUV[vt1 - 1][0];			vertices[l1].v = texUV[vt1 - 1][1];
-			vertices[l1].nx = normXYZ[vn1 - 1][0];		vertices[l1].ny = normXYZ[vn1 - 1][1];		vertices[l1].nz = normXYZ[vn1 - 1][2];
-
-			l1 += 1;
-			vertices[l1].x = vertXYZ[v2 - 1][0];			vertices[l1].y = vertXYZ[v2 - 1][1];			vertices[l1].z = vertXYZ[v2 - 1][2];
-			vertices[l1].r = 255;						vertices[l1].g = 255;						vertices[l1].b = 255;
-			vertices[l1].u = texUV[vt2 - 1][0];			vertices[l1].v = texUV[vt2 - 1][1];
-			vertices[l1].nx = normXYZ[vn2 - 1][0];		vertices[l1].ny = normXYZ[vn2 - 1][1];		vertices[l1].nz = normXYZ[vn2 - 1][2];
-
-			l1 += 1;
-			vertices[l1].x = vertXYZ[v3 - 1][0];			vertices[l1].y = vertXYZ[v3 - 1][1];			vertices[l1].z = vertXYZ[v3 - 1][2];
-			vertices[l1].r = 255;						vertices[l1].g = 255;						vertices[l1].b = 255;
-			vertices[l1].u = texUV[vt3 - 1][0];			vertices[l1].v = texUV[vt3 - 1][1];
-			vertices[l1].nx = normXYZ[vn3 - 1][0];		vertices[l1].ny = normXYZ[vn3 - 1][1];		vertices[l1].nz = normXYZ[vn3 - 1][2];
-
-			l1 += 1;
-		}
-		else {
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file1);
-		}
-	}
-
-	// --- 3D Model: Suzanne Monkey ---
-
-	float vertXYZ2[511][3];
-	float texUV2[590][2];
-	float normXYZ2[507][3];
-
-	int i2 = 0;
-	int j2 = 0;
-	int k2 = 0;
-	int l2 = 84 + 56334;
-
-	FILE* file2 = fopen("3D-MODEL-Suzanne-Monkey.obj", "r");
-	if (file2 == NULL) {
-		printf("Impossible to open the file !\n");
-		return false;
-	}
-
-	while (1) {
-		char lineHeader[128];
-		int res = fscanf(file2, "%s", lineHeader);
-
-		if (res == EOF)
-			break;
+	// Faces of the platform and of the painting frames, drawn as one triangle fan each
+	const GLint platformFirsts[] = { 24, 28, 32, 36, 40 };
+	const GLint squareFrameFirsts[] = { 48, 52, 56, 60 };
+	const GLint rectangularFrameFirsts[] = { 68, 72, 76, 80 };
+	const GLsizei quadCounts[] = { 4, 4, 4, 4, 4 };
+
+	// Layers of the room's texture array, which holds the images in the order of roomImageFilePaths.
+	// The paintings' layers come after them, and are also how they are told apart when drawn as virtual textures
+	const GLint frontWallLayer = 0;
+	const GLint backWallLayer = 1;
+	const GLint sideWallLayer = 2;
+	const GLint ceilingLayer = 3;
+	const GLint floorLayer = 4;
+	const GLint woodLayer = 5;
+	const GLint frameLayer = 6;
+	const GLint firstPaintingLayer = 7;
+
+	// The room, the platforms and the paintings never move, so they are baked into world space as one batch of triangles,
+	// each face naming the layer its image is in, and the whole batch is drawn with one call
+	StartupProfileEntry roomProfile = startupProfile.Begin("Room geometry");
+	StaticBatch roomBatch;
 
-		if (strcmp(lineHeader, "v") == 0) {
-			fscanf(file2, "%f %f %f\n", &vertXYZ2[i2][0], &vertXYZ2[i2][1], &vertXYZ2[i2][2]);
-			i2 += 1;
-		}
-		else if (strcmp(lineHeader, "vt") == 0) {
-			fscanf(file2, "%f %f\n", &texUV2[j2][0], &texUV[j2][1]);
-			j2 += 1;
-		}
-		else if (strcmp(lineHeader, "vn") == 0) {
-			fscanf(file2, "%f %f %f\n", &normXYZ2[k2][0], &normXYZ2[k2][1], &normXYZ2[k2][2]);
-			k2 += 1;
-		}
-		else if (strcmp(lineHeader, "f") == 0) {
-			int v1, vt1, vn1, v2, vt2, vn2, v3, vt3, vn3;
-			int matches = fscanf(file2, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3);
-			if (matches != 9) {
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file2);
-				return false;
-			}
-			vertices[l2].x = vertXYZ2[v1 - 1][0];			vertices[l2].y = vertXYZ2[v1 - 1][1];			vertices[l2].z = vertXYZ2[v1 - 1][2];
-			vertices[l2].r = 255;						vertices[l2].g = 255;						vertices[l2].b = 255;
-			vertices[l2].u = texUV2[vt1 - 1][0];			vertices[l2].v = texUV2[vt1 - 1][1];
-			vertices[l2].nx = normXYZ2[vn1 - 1][0];		vertices[l2].ny = normXYZ2[vn1 - 1][1];		vertices[l2].nz = normXYZ2[vn1 - 1][2];
-
-			l2 += 1;
-			vertices[l2].x = vertXYZ2[v2 - 1][0];			vertices[l2].y = vertXYZ2[v2 - 1][1];			vertices[l2].z = vertXYZ2[v2 - 1][2];
-			vertices[l2].r = 255;						vertices[l2].g = 255;						vertices[l2].b = 255;
-			vertices[l2].u = texUV2[vt2 - 1][0];			vertices[l2].v = texUV2[vt2 - 1][1];
-			vertices[l2].nx = normXYZ2[vn2 - 1][0];		vertices[l2].ny = normXYZ2[vn2 - 1][1];		vertices[l2].nz = normXYZ2[vn2 - 1][2];
-
-			l2 += 1;
-			vertices[l2].x = vertXYZ2[v3 - 1][0];			vertices[l2].y = vertXYZ2[v3 - 1][1];			vertices[l2].z = vertXYZ2[v3 - 1][2];
-			vertices[l2].r = 255;						vertices[l2].g = 255;						vertices[l2].b = 255;
-			vertices[l2].u = texUV2[vt3 - 1][0];			vertices[l2].v = texUV2[vt3 - 1][1];
-			vertices[l2].nx = normXYZ2[vn3 - 1][0];		vertices[l2].ny = normXYZ2[vn3 - 1][1];		vertices[l2].nz = normXYZ2[vn3 - 1][2];
-
-			l2 += 1;
-		}
-		else {
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file2);
-		}
-	}
-
-	// --- 3D Model: Asian Vase ---
-
-	float vertXYZ3[3494][3];
-	float texUV3[3798][2];
-	int texW;
-	float normXYZ3[13984][3];
-
-	int i3 = 0;
-	int j3 = 0;
-	int k3 = 0;
-	int l3 = 84 + 56334 + 2904;
-
-	FILE* file3 = fopen("3D-MODEL-Asian-Vase.obj", "r");
-	if (file3 == NULL) {
-		printf("Impossible to open the file !\n");
-		return false;
+	// --- Room ---
+	glm::mat4 roomModel = glm::scale(glm::mat4(1.0f), glm::vec3(50.0f, 50.0f, 50.0f));
+	const GLint roomFaceLayers[] = { frontWallLayer, backWallLayer, sideWallLayer, sideWallLayer, ceilingLayer, floorLayer };
+	for (GLint i = 0; i < 6; i++)
+	{
+		GLint first = i * 4;
+		AddTriangleFans(roomBatch, vertices, &first, quadCounts, 1, roomModel, roomFaceLayers[i]);
 	}
 
-	while (1) {
-		char lineHeader[128];
-		int res = fscanf(file3, "%s", lineHeader);
-
-		if (res == EOF)
-			break;
-
-		if (strcmp(lineHeader, "v") == 0) {
-			fscanf(file3, "%f %f %f\n", &vertXYZ3[i3][0], &vertXYZ3[i3][1], &vertXYZ3[i3][2]);
-			i3 += 1;
-		}
-		else if (strcmp(lineHeader, "vt") == 0) {
-			fscanf(file3, "%f %f %d\n", &texUV3[j3][0], &texUV3[j3][1], &texW);
-			j3 += 1;
-		}
-		else if (strcmp(lineHeader, "vn") == 0) {
-			fscanf(file3, "%f %f %f\n", &normXYZ3[k3][0], &normXYZ3[k3][1], &normXYZ3[k3][2]);
-			k3 += 1;
-		}
-		else if (strcmp(lineHeader, "f") == 0) {
-			int v1, vt1, vn1, v2, vt2, vn2, v3, vt3, vn3, v4, vt4, vn4;
-			int matches = fscanf(file3, "%d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", &v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3, &v4, &vt4, &vn4);
-			if (matches != 12) {
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file3);
-				return false;
-			}
-			vertices[l3].x = vertXYZ3[v1 - 1][0];			vertices[l3].y = vertXYZ3[v1 - 1][1];			vertices[l3].z = vertXYZ3[v1 - 1][2];
-			vertices[l3].r = 255;						vertices[l3].g = 255;						vertices[l3].b = 255;
-			vertices[l3].u = texUV3[vt1 - 1][0];			vertices[l3].v = texUV3[vt1 - 1][1];
-			vertices[l3].nx = normXYZ3[vn1 - 1][0];		vertices[l3].ny = normXYZ3[vn1 - 1][1];		vertices[l3].nz = normXYZ3[vn1 - 1][2];
-
-			l3 += 1;
-			vertices[l3].x = vertXYZ3[v2 - 1][0];			vertices[l3].y = vertXYZ3[v2 - 1][1];			vertices[l3].z = vertXYZ3[v2 - 1][2];
-			vertices[l3].r = 255;						vertices[l3].g = 255;						vertices[l3].b = 255;
-			vertices[l3].u = texUV3[vt2 - 1][0];			vertices[l3].v = texUV3[vt2 - 1][1];
-			vertices[l3].nx = normXYZ3[vn2 - 1][0];		vertices[l3].ny = normXYZ3[vn2 - 1][1];		vertices[l3].nz = normXYZ3[vn2 - 1][2];
-
-			l3 += 1;
-			vertices[l3].x = vertXYZ3[v3 - 1][0];			vertices[l3].y = vertXYZ3[v3 - 1][1];			vertices[l3].z = vertXYZ3[v3 - 1][2];
-			vertices[l3].r = 255;						vertices[l3].g = 255;						vertices[l3].b = 255;
-			vertices[l3].u = texUV3[vt3 - 1][0];			vertices[l3].v = texUV3[vt3 - 1][1];
-			vertices[l3].nx = normXYZ3[vn3 - 1][0];		vertices[l3].ny = normXYZ3[vn3 - 1][1];		vertices[l3].nz = normXYZ3[vn3 - 1][2];
-
-			l3 += 1;
-			vertices[l3].x = vertXYZ3[v4 - 1][0];			vertices[l3].y = vertXYZ3[v4 - 1][1];			vertices[l3].z = vertXYZ3[v4 - 1][2];
-			vertices[l3].r = 255;						vertices[l3].g = 255;						vertices[l3].b = 255;
-			vertices[l3].u = texUV3[vt4 - 1][0];			vertices[l3].v = texUV3[vt4 - 1][1];
-			vertices[l3].nx = normXYZ3[vn4 - 1][0];		vertices[l3].ny = normXYZ3[vn4 - 1][1];		vertices[l3].nz = normXYZ3[vn4 - 1][2];
-
-			l3 += 1;
-		}
-		else {
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file3);
-		}
+	// --- Platforms ---
+	const glm::vec3 platformPositions[] = { glm::vec3(-10.0f, -21.0f, 10.0f), glm::vec3(10.0f, -21.0f, 10.0f),
+		glm::vec3(-10.0f, -21.0f, -10.0f), glm::vec3(10.0f, -21.0f, -10.0f) };
+	for (const glm::vec3& platformPosition : platformPositions)
+	{
+		glm::mat4 platformModel = glm::translate(glm::mat4(1.0f), platformPosition);
+		platformModel = glm::scale(platformModel, glm::vec3(5.0f, 5.0f, 5.0f));
+		AddTriangleFans(roomBatch, vertices, platformFirsts, quadCounts, 5, platformModel, woodLayer);
 	}
 
-	// --- 3D Model: Jaguar Skull ---
+	// --- Paintings ---
 
-	float vertXYZ4[3080][3];
-	float texUV4[4532][2];
-	float normXYZ4[3080][3];
-
-	int i4 = 0;
-	int j4 = 0;
-	int k4 = 0;
-	int l4 = 84 + 56334 + 2904 + 13984;
-
-	FILE* file4 = fopen("3D-MODEL-Jaguar-Skull.obj", "r");
-	if (file4 == NULL) {
-		printf("Impossible to open the file !\n");
-		return false;
+	// Model Matrix of each painting, with the layer of its image and whether it uses the square canvas and frame
+	struct Painting
+	{
+		glm::mat4 model;
+		GLint layer;
+		bool square;
+	};
+	Painting paintings[6];
+
+	// Painting 1: Solo Vertical
+	paintings[0].model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 24.0f));
+	paintings[0].model = glm::rotate(paintings[0].model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	paintings[0].model = glm::scale(paintings[0].model, glm::vec3(17.5f, 17.5f, 2.0f));
+	paintings[0].layer = firstPaintingLayer + 0;
+	paintings[0].square = false;
+
+	// Painting 2: Solo Horizontal
+	paintings[1].model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -24.0f));
+	paintings[1].model = glm::rotate(paintings[1].model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	paintings[1].model = glm::scale(paintings[1].model, glm::vec3(17.5f, 17.5f, 2.0f));
+	paintings[1].layer = firstPaintingLayer + 1;
+	paintings[1].square = false;
+
+	// Painting 3: Horizontal
+	paintings[2].model = glm::translate(glm::mat4(1.0f), glm::vec3(-24.0f, 9.5f, 5.0f));
+	paintings[2].model = glm::rotate(paintings[2].model, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	paintings[2].model = glm::scale(paintings[2].model, glm::vec3(12.5f, 12.5f, 2.0f));
+	paintings[2].layer = firstPaintingLayer + 2;
+	paintings[2].square = false;
+
+	// Painting 4: Square
+	paintings[3].model = glm::translate(glm::mat4(1.0f), glm::vec3(-24.0f, -5.5f, -7.5f));
+	paintings[3].model = glm::rotate(paintings[3].model, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	paintings[3].model = glm::scale(paintings[3].model, glm::vec3(12.5f, 12.5f, 2.0f));
+	paintings[3].layer = firstPaintingLayer + 3;
+	paintings[3].square = true;
+
+	// Painting 5: Vertical
+	paintings[4].model = glm::translate(glm::mat4(1.0f), glm::vec3(25.0f, 5.0f, -7.5f));
+	paintings[4].model = glm::rotate(paintings[4].model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	paintings[4].model = glm::rotate(paintings[4].model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	paintings[4].model = glm::scale(paintings[4].model, glm::vec3(12.5f, 12.5f, 2.0f));
+	paintings[4].layer = firstPaintingLayer + 4;
+	paintings[4].square = false;
+
+	// Painting 6: Square
+	paintings[5].model = glm::translate(glm::mat4(1.0f), glm::vec3(25.0f, -3.5f, 7.5f));
+	paintings[5].model = glm::rotate(paintings[5].model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	paintings[5].model = glm::scale(paintings[5].model, glm::vec3(12.5f, 12.5f, 2.0f));
+	paintings[5].layer = firstPaintingLayer + 5;
+	paintings[5].square = true;
+
+	// The canvases come first and the frames after them, so that all of the frames share one run of the batch
+	const GLint squareCanvasFirst = 44;
+	const GLint rectangularCanvasFirst = 64;
+	for (const Painting& painting : paintings)
+	{
+		AddTriangleFans(roomBatch, vertices, painting.square ? &squareCanvasFirst : &rectangularCanvasFirst, quadCounts, 1,
+			painting.model, painting.layer);
 	}
-
-	while (1) {
-		char lineHeader[128];
-		int res = fscanf(file4, "%s", lineHeader);
-
-		if (res == EOF)
-			break;
-
-		if (strcmp(lineHeader, "v") == 0) {
-			fscanf(file4, "%f %f %f\n", &vertXYZ4[i4][0], &vertXYZ4[i4][1], &vertXYZ4[i4][2]);
-			i4 += 1;
-		}
-		else if (strcmp(lineHeader, "vt") == 0) {
-			fscanf(file4, "%f %f\n", &texUV4[j4][0], &texUV4[j4][1]);
-			j4 += 1;
-		}
-		else if (strcmp(lineHeader, "vn") == 0) {
-			fscanf(file4, "%f %f %f\n", &normXYZ4[k4][0], &normXYZ4[k4][1], &normXYZ4[k4][2]);
-			k4 += 1;
-		}
-		else if (strcmp(lineHeader, "f") == 0) {
-			int v1, vt1, vn1, v2, vt2, vn2, v3, vt3, vn3, v4, vt4, vn4;
-			int matches = fscanf(file4, "%d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", &v1, &vt1, &vn1, &v2, &vt2, &vn2, &v3, &vt3, &vn3, &v4, &vt4, &vn4);
-			if (matches > 12) {
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file4);
-				return false;
-			}
-			vertices[l4].x = vertXYZ4[v1 - 1][0];			vertices[l4].y = vertXYZ4[v1 - 1][1];			vertices[l4].z = vertXYZ4[v1 - 1][2];
-			vertices[l4].r = 255;						vertices[l4].g = 255;						vertices[l4].b = 255;
-			vertices[l4].u = texUV4[vt1 - 1][0];			vertices[l4].v = texUV4[vt1 - 1][1];
-			vertices[l4].nx = normXYZ4[vn1 - 1][0];		vertices[l4].ny = normXYZ4[vn1 - 1][1];		vertices[l4].nz = normXYZ4[vn1 - 1][2];
-
-			l4 += 1;
-			vertices[l4].x = vertXYZ4[v2 - 1][0];			vertices[l4].y = vertXYZ4[v2 - 1][1];			vertices[l4].z = vertXYZ4[v2 - 1][2];
-			vertices[l4].r = 255;						vertices[l4].g = 255;						vertices[l4].b = 255;
-			vertices[l4].u = texUV4[vt2 - 1][0];			vertices[l4].v = texUV4[vt2 - 1][1];
-			vertices[l4].nx = normXYZ4[vn2 - 1][0];		vertices[l4].ny = normXYZ4[vn2 - 1][1];		vertices[l4].nz = normXYZ4[vn2 - 1][2];
-
-			l4 += 1;
-			vertices[l4].x = vertXYZ4[v3 - 1][0];			vertices[l4].y = vertXYZ4[v3 - 1][1];			vertices[l4].z = vertXYZ4[v3 - 1][2];
-			vertices[l4].r = 255;						vertices[l4].g = 255;						vertices[l4].b = 255;
-			vertices[l4].u = texUV4[vt3 - 1][0];			vertices[l4].v = texUV4[vt3 - 1][1];
-			vertices[l4].nx = normXYZ4[vn3 - 1][0];		vertices[l4].ny = normXYZ4[vn3 - 1][1];		vertices[l4].nz = normXYZ4[vn3 - 1][2];
-
-			l4 += 1;
-			vertices[l4].x = vertXYZ4[v4 - 1][0];			vertices[l4].y = vertXYZ4[v4 - 1][1];			vertices[l4].z = vertXYZ4[v4 - 1][2];
-			vertices[l4].r = 255;						vertices[l4].g = 255;						vertices[l4].b = 255;
-			vertices[l4].u = texUV4[vt4 - 1][0];			vertices[l4].v = texUV4[vt4 - 1][1];
-			vertices[l4].nx = normXYZ4[vn4 - 1][0];		vertices[l4].ny = normXYZ4[vn4 - 1][1];		vertices[l4].nz = normXYZ4[vn4 - 1][2];
-
-			l4 += 1;
-		}
-		else {
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file4);
-		}
+	for (const Painting& painting : paintings)
+	{
+		AddTriangleFans(roomBatch, vertices, painting.square ? squareFrameFirsts : rectangularFrameFirsts, quadCounts, 4,
+			painting.model, frameLayer);
 	}
+	GLsizei roomBatchVertexCount = static_cast<GLsizei>(roomBatch.vertices.size());
 
-	// Create a vertex buffer object (VBO), and upload our vertices data to the VBO
+	// Create a vertex buffer object (VBO), and upload the batch's vertices to the VBO,
+	// with the layer of each vertex in a stream of its own
 	GLuint vbo;
 	glGenBuffers(1, &vbo);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, roomBatch.vertices.size() * sizeof(Vertex), roomBatch.vertices.data(), GL_STATIC_DRAW);
+
+	GLuint layerVbo;
+	glGenBuffers(1, &layerVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, layerVbo);
+	glBufferData(GL_ARRAY_BUFFER, roomBatch.layers.size() * sizeof(GLfloat), roomBatch.layers.data(), GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// Create a vertex array object that contains data on how to map vertex attributes
@@ -971,1146 +1029,535 @@ int main()
 	glBindVertexArray(vao);
 
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	SetupVertexAttributes(VertexFormat::Float);
 
-	// Vertex attribute 0 - Position
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
-
-	// Vertex attribute 1 - Color
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)(offsetof(Vertex, r)));
-
-	// Vertex attribute 2 - UV Coordinates
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, u)));
-
-	// Vertex attribute 3 - Normal Vector
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, nx)));
+	// Vertex attribute 4 - Layer of the texture array
+	glBindBuffer(GL_ARRAY_BUFFER, layerVbo);
+	glEnableVertexAttribArray(4);
+	glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (void*)0);
 
 	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	// Create a shader program
-	GLuint program = CreateShaderProgram("main.vsh", "main.fsh");
-
-	// Tell OpenGL the dimensions of the region where stuff will be drawn.
-	// For now, tell OpenGL to use the whole screen
-	glViewport(0, 0, windowWidth, windowHeight);
+	// Without a color stream, the color attribute keeps this constant value (white)
+	glVertexAttrib3f(1, 1.0f, 1.0f, 1.0f);
 
+	roomProfile.gpuBytes = roomBatch.vertices.size() * sizeof(Vertex) + roomBatch.layers.size() * sizeof(GLfloat);
+	roomProfile.uploadSeconds = startupProfile.GetSeconds() - roomProfile.start;
+	startupProfile.End(roomProfile);
 
-	// Textures
+	// Create a shader program
+	GLuint program = CreateShaderProgram("main.vsh", "main.fsh", archive, startupProfile);
 
-	// --- Room Textures ---
+	// The feedback pass of the virtual textures draws the same vertices with a shader that records the tiles they need
+	GLuint feedbackProgram = 0;
+	if (useVirtualTextures)
+	{
+		feedbackProgram = CreateShaderProgram("main.vsh", "feedback.fsh", archive, startupProfile);
+	}
 
-	// Create a variable that will contain the ID for our texture,
-	// and use glGenTextures() to generate the texture itself
-	GLuint tex0;
-	glGenTextures(1, &tex0);
+	// Locations of the programs' uniforms, found again whenever a program is rebuilt (see the render loop)
+	ShaderUniforms mainUniforms;
+	ShaderUniforms feedbackUniforms;
 
-	// --- Load our image using stb_image ---
+	// The camera, the lights and where each object is drawn go to the shaders as uniform blocks, written to the uniform ring
+	// in one go each frame: a frame block, then an object block for the room and for each exhibit
+	UniformRing uniformRing;
+	uniformRing.Create({ { sizeof(FrameUniformBlock), 1 }, { sizeof(ObjectUniformBlock), exhibits.size() + 1 } });
 
-	// Im image-space (pixels), (0, 0) is the upper-left corner of the image
-	// However, in u-v coordinates, (0, 0) is the lower-left corner of the image
-	// This means that the image will appear upside-down when we use the image data as is
-	// This function tells stbi to flip the image vertically so that it is not upside-down when we use it
-	stbi_set_flip_vertically_on_load(true);
+	// Tell OpenGL the dimensions of the region where stuff will be drawn.
+	// For now, tell OpenGL to use the whole screen (the framebuffer, which is larger than the window on high-DPI displays)
+	int initialFramebufferWidth = windowWidth;
+	int initialFramebufferHeight = windowHeight;
+	glfwGetFramebufferSize(window, &initialFramebufferWidth, &initialFramebufferHeight);
+	glViewport(0, 0, initialFramebufferWidth, initialFramebufferHeight);
 
-	// 'imageWidth' and imageHeight will contain the width and height of the loaded image respectively
-	int imageWidth, imageHeight, numChannels;
 
-	// Read the image data and store it in an unsigned char array
-	unsigned char* imageData = stbi_load("CubeMap-FrontWall.png", &imageWidth, &imageHeight, &numChannels, 0);
+	// Textures
 
-	// Make sure that we actually loaded the image before uploading the data to the GPU
-	if (imageData != nullptr)
+	// Every texture is drawn with the same sampler, which filters minified textures trilinearly from their mip chains
+	// (and anisotropically at grazing angles) instead of bilinearly from the full-size level. The exhibits' textures
+	// are drawn from texture unit 0, and the room's texture array from texture unit 1
+	TextureSamplingSettings samplingSettings;
+	samplingSettings.mipmaps = options.mipmaps;
+	samplingSettings.maxAnisotropy = options.textureAnisotropy;
+	GLuint textureSampler = CreateTextureSampler(samplingSettings);
+	glBindSampler(0, textureSampler);
+	glBindSampler(1, textureSampler);
+
+	// The tile cache and the page tables of the virtual textures, with the coarsest tile of each painting
+	// (if they cannot be created, the paintings are loaded whole after all)
+	if (useVirtualTextures)
 	{
-		// Our texture is 2D, so we bind our texture to the GL_TEXTURE_2D target
-		glBindTexture(GL_TEXTURE_2D, tex0);
-
-		// Set the filtering methods for magnification and minification
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		// Set the wrapping method for the s-axis (x-axis) and t-axis (y-axis)
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		// Upload the image data to GPU memory
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		// If we set minification to use mipmaps, we can tell OpenGL to generate the mipmaps for us
-		//glGenerateMipmap(GL_TEXTURE_2D);
+		StartupProfileEntry virtualTexturesProfile = startupProfile.Begin("Virtual textures");
+		useVirtualTextures = virtualTextures.Create(windowWidth, windowHeight);
+		virtualTexturesProfile.uploadSeconds = startupProfile.GetSeconds() - virtualTexturesProfile.start;
+		startupProfile.End(virtualTexturesProfile);
+		if (!useVirtualTextures)
+		{
+			virtualTextures.Destroy();
+			for (const std::string& imageFilePath : paintingImageFilePaths)
+			{
+				roomImageFilePaths.push_back(imageFilePath);
+				roomTextures.Load(imageFilePath);
+			}
+		}
+	}
 
-		// Once we have copied the data over to the GPU, we can delete
-		// the data on the CPU side, since we won't be using it anymore
-		stbi_image_free(imageData);
-		imageData = nullptr;
+	// The room's images are all the same size, so they are packed into the layers of one texture array
+	// (unless told otherwise, or they turn out not to fit, in which case each gets a texture of its own)
+	StartupProfileEntry roomTexturesProfile = startupProfile.Begin("Room textures");
+	if (options.textureArrays)
+	{
+		roomTextures.UploadArray();
 	}
 	else
 	{
-		std::cerr << "Failed to load image" << std::endl;
+		roomTextures.Upload();
 	}
+	startupProfile.End(roomTexturesProfile);
+	const TextureArray& roomTextureArray = roomTextures.GetTextureArray();
 
-	GLuint tex1;
-	glGenTextures(1, &tex1);
-
-	imageData = stbi_load("CubeMap-BackWall.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
+	// Texture of each run of the batch, for drawing it without the texture array (none for the virtual textures)
+	std::vector<GLuint> roomBatchTextures;
+	for (const StaticBatchRange& range : roomBatch.ranges)
 	{
-		glBindTexture(GL_TEXTURE_2D, tex1);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
+		roomBatchTextures.push_back(static_cast<std::size_t>(range.layer) < roomImageFilePaths.size()
+			? roomTextures.GetTexture(roomImageFilePaths[range.layer]) : 0);
 	}
-	else
+
+	// The shaders and the images and models of the room and of the exhibits are loaded again whenever their files change,
+	// so they can be edited while the program runs (the paintings' tiled textures are not, since they only change when cooked)
+	AssetReloader assetReloader(exhibits, threadPool, meshLoadSettings, exhibitVertexFormat);
+	ShaderProgramBuilder buildShaderProgram = [](const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
+		{
+			return LinkShaderProgram(CreateShaderFromSource(GL_VERTEX_SHADER, vertexShaderSource),
+				CreateShaderFromSource(GL_FRAGMENT_SHADER, fragmentShaderSource));
+		};
+	assetReloader.AddShaderProgram("main.vsh", "main.fsh", program, buildShaderProgram);
+	if (feedbackProgram != 0)
 	{
-		std::cerr << "Failed to load image" << std::endl;
+		assetReloader.AddShaderProgram("main.vsh", "feedback.fsh", feedbackProgram, buildShaderProgram);
 	}
-
-	GLuint tex2;
-	glGenTextures(1, &tex2);
-
-	imageData = stbi_load("CubeMap-LeftRightWall.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
+	for (const std::string& imageFilePath : roomImageFilePaths)
 	{
-		glBindTexture(GL_TEXTURE_2D, tex2);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
+		if (roomTextureArray.texture != 0)
+		{
+			assetReloader.AddTextureLayer(imageFilePath, roomTextureArray, roomTextures.GetLayer(imageFilePath));
+		}
+		else
+		{
+			assetReloader.AddTexture(imageFilePath, roomTextures.GetTexture(imageFilePath));
+		}
 	}
-	else
+	if (options.hotReload)
 	{
-		std::cerr << "Failed to load image" << std::endl;
+		assetReloader.Start();
 	}
 
-	GLuint tex3;
-	glGenTextures(1, &tex3);
+	// Without progressive loading, every exhibit is uploaded before the first frame
+	if (!options.progressiveLoading)
+	{
+		while (!exhibitStreamer.IsFinished())
+		{
+			exhibitStreamer.Update(std::numeric_limits<double>::infinity());
+			uploadRing.Update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
 
-	imageData = stbi_load("CubeMap-Ceiling.png", &imageWidth, &imageHeight, &numChannels, 0);
+	// Enable depth testing
+	glEnable(GL_DEPTH_TEST);
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex3);
+	// Draw calls are reported in the window title once per second
+	double lastReportTime = glfwGetTime();
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	// Time-to-first-frame and the end of streaming are reported once each
+	bool firstFrameReported = false;
+	bool streamingReported = false;
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// Ranges of the exhibits' index buffers left after culling their meshlets, kept across frames so they keep their memory
+	MeshletDrawList meshletDrawList;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+	// Model matrix of each exhibit this frame, and the offset of its object block in the uniform ring (-1 if it is not drawn)
+	std::vector<glm::mat4> exhibitModels(exhibits.size());
+	std::vector<GLintptr> exhibitBlockOffsets(exhibits.size());
+	bool reportedFullRing = false;
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
+	// Render loop
+	while (!glfwWindowShouldClose(window))
 	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
+		drawCallCount = 0;
+		exhibitTriangleCount = 0;
+		exhibitMeshletsCulled = 0;
+
+		// Upload whatever the worker threads finished, within this frame's share of time,
+		// and reuse the parts of the upload ring the GPU is done reading
+		exhibitStreamer.Update(options.uploadBudgetMilliseconds / 1000.0);
+		uploadRing.Update();
+
+		// Swap in the assets whose files changed and have been loaded again
+		assetReloader.Update();
+
+		// A reloaded shader program is a new program, whose uniforms may have moved. The samplers of the main program
+		// only need their texture units once per link: 0 to 3, since samplers of different types may not share a texture unit,
+		// even when one of them goes unused
+		if (mainUniforms.program != program)
+		{
+			ReflectShaderUniforms(program, mainUniforms);
+			glUseProgram(program);
+			mainUniforms.tex.Set(0);
+			mainUniforms.texArray.Set(1);
+			mainUniforms.pageTable.Set(PageTableTextureUnit);
+			mainUniforms.tileCache.Set(TileCacheTextureUnit);
+		}
+		if (feedbackUniforms.program != feedbackProgram)
+		{
+			ReflectShaderUniforms(feedbackProgram, feedbackUniforms);
+		}
 
-	GLuint tex4;
-	glGenTextures(1, &tex4);
+		// --- Projection and View Matrices ---
 
-	imageData = stbi_load("CubeMap-Floor.png", &imageWidth, &imageHeight, &numChannels, 0);
+		// The framebuffer can differ from the window's size (on high-DPI displays) and changes as the window is resized,
+		// so the projection, the level of detail selection and the feedback pass all go by its size this frame
+		// (a minimized window has an empty framebuffer, counted as 1 pixel so nothing divides by 0)
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		framebufferWidth = std::max(framebufferWidth, 1);
+		framebufferHeight = std::max(framebufferHeight, 1);
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex4);
+		// Projection Matrix
+		glm::mat4 proj = glm::perspective(verticalFieldOfView, (float)framebufferWidth / (float)framebufferHeight, 0.1f, 100.0f);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// View Matrix
+		glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// --- Uniform Blocks ---
+
+		uniformRing.BeginFrame();
+
+		// Camera and lights
+		FrameUniformBlock frameBlock = {};
+		frameBlock.proj = proj;
+		frameBlock.view = view;
+		frameBlock.cameraPosition = cameraPosition;
+
+		// Point light
+		frameBlock.lightPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+		frameBlock.lightAmbient = glm::vec3(0.2f, 0.2f, 0.2f);
+		frameBlock.lightDiffuse = lightDiffuse;
+		frameBlock.lightSpecular = lightSpecular;
+
+		// Spot lights
+		frameBlock.spotlightPosition[0] = glm::vec4(-10.0f, 20.0f, 10.0f, 0.0f);
+		frameBlock.spotlightPosition[1] = glm::vec4(10.0f, 20.0f, 10.0f, 0.0f);
+		frameBlock.spotlightPosition[2] = glm::vec4(-10.0f, 20.0f, -10.0f, 0.0f);
+		frameBlock.spotlightPosition[3] = glm::vec4(10.0f, 20.0f, -10.0f, 0.0f);
+		frameBlock.spotlightAmbient = spotlightAmbient;
+		frameBlock.spotlightDiffuse = spotlightDiffuse;
+		frameBlock.spotlightSpecular = spotlightSpecular;
+		frameBlock.spotlightTarget = glm::vec3(0.0f, -1.0f, 0.0f);
+		frameBlock.spotlightCutoff = glm::cos(glm::radians(7.5f));
+
+		// Material of every object
+		frameBlock.objectSpecular = glm::vec3(0.5f, 0.5f, 0.5f);
+		frameBlock.shininess = 8.0f;
+
+		// The ring has room for every block of a frame, so a block that does not fit is a bug in how it was created;
+		// it is reported once, and what the block is for is not drawn
+		auto allocateBlock = [&uniformRing, &reportedFullRing](const void* block, std::size_t size, GLintptr& offset)
+		{
+			if (uniformRing.Allocate(block, size, offset))
+			{
+				return true;
+			}
+			if (!reportedFullRing)
+			{
+				std::cerr << "The uniform ring has no room left for the blocks of the frame, so some objects are not drawn" << std::endl;
+				reportedFullRing = true;
+			}
+			offset = -1;
+			return false;
+		};
+
+		GLintptr frameBlockOffset = -1;
+		allocateBlock(&frameBlock, sizeof(frameBlock), frameBlockOffset);
+
+		// The room batch is already in world space, and its positions are stored as they are
+		ObjectUniformBlock roomBlock = {};
+		roomBlock.model = glm::mat4(1.0f);
+		roomBlock.normMatrix = glm::mat4(1.0f);
+		roomBlock.positionScale = glm::vec3(1.0f);
+
+		GLintptr roomBlockOffset = -1;
+		allocateBlock(&roomBlock, sizeof(roomBlock), roomBlockOffset);
+
+		// Each exhibit spins in place
+		for (std::size_t i = 0; i < exhibits.size(); i++)
+		{
+			const Exhibit& exhibit = exhibits[i];
+			exhibitBlockOffsets[i] = -1;
+			if (!exhibit.ready)
+			{
+				continue;
+			}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+			// Model Matrix
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), exhibit.position);
+			model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 1.0f, 0.0f));
+			model = glm::scale(model, exhibit.scale);
+			exhibitModels[i] = model;
+
+			// Normal Matrix
+			ObjectUniformBlock exhibitBlock = {};
+			exhibitBlock.model = model;
+			exhibitBlock.normMatrix = glm::transpose(glm::inverse(model));
+
+			// Compact positions are fractions of the model's bounds
+			exhibitBlock.positionScale = glm::vec3(1.0f);
+			if (exhibitVertexFormat == VertexFormat::Compact)
+			{
+				glm::vec3 boundsMin(exhibit.bounds.min[0], exhibit.bounds.min[1], exhibit.bounds.min[2]);
+				glm::vec3 boundsMax(exhibit.bounds.max[0], exhibit.bounds.max[1], exhibit.bounds.max[2]);
+				exhibitBlock.positionOffset = boundsMin;
+				exhibitBlock.positionScale = boundsMax - boundsMin;
+			}
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
+			allocateBlock(&exhibitBlock, sizeof(exhibitBlock), exhibitBlockOffsets[i]);
+		}
 
-	// --- Platform Texture ---
+		// One write for every block of the frame, then the frame block stays bound for the whole frame
+		// (nothing is drawn without it, and the room is not drawn without its own block)
+		uniformRing.Upload();
+		bool drawFrame = frameBlockOffset >= 0;
+		bool drawRoom = drawFrame && roomBlockOffset >= 0;
+		if (drawFrame)
+		{
+			uniformRing.Bind(FrameUniformsBinding, frameBlockOffset, sizeof(FrameUniformBlock));
+		}
+		if (drawRoom)
+		{
+			uniformRing.Bind(ObjectUniformsBinding, roomBlockOffset, sizeof(ObjectUniformBlock));
+		}
 
-	GLuint tex5;
-	glGenTextures(1, &tex5);
+		// The tiles the paintings needed a couple of frames ago are paged in, then the feedback pass records the ones this view needs
+		// by drawing the batch again, small, with the feedback shader (the batch is already in world space)
+		if (useVirtualTextures && drawRoom)
+		{
+			virtualTextures.Update();
+			virtualTextures.BeginFeedback(framebufferWidth, framebufferHeight);
 
-	imageData = stbi_load("PLATFORM-Wood.png", &imageWidth, &imageHeight, &numChannels, 0);
+			glUseProgram(feedbackProgram);
+			glBindVertexArray(vao);
+			virtualTextures.SetUniforms(feedbackUniforms, firstPaintingLayer, true);
+			DrawArrays(GL_TRIANGLES, 0, roomBatchVertexCount);
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex5);
+			virtualTextures.EndFeedback();
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// Clear the colors in our off-screen framebuffer
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// Use the shader program that we created
+		glUseProgram(program);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+		// Use the vertex array object that we created
+		glBindVertexArray(vao);
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
+		// --- Room, Platforms and Paintings ---
 
-	// --- Painting Textures ---
+		// The room's object block is already bound (see the uniform blocks above)
+		if (drawRoom)
+		{
+			// The paintings sample their virtual textures, whatever the rest of the batch is drawn with
+			if (useVirtualTextures)
+			{
+				virtualTextures.Bind();
+				virtualTextures.SetUniforms(mainUniforms, firstPaintingLayer, false);
+			}
+			else
+			{
+				mainUniforms.useVirtualTextures.Set(false);
+			}
 
-	GLuint tex6;
-	glGenTextures(1, &tex6);
+			if (roomTextureArray.texture != 0)
+			{
+				// Every face samples its own layer of the texture array, so the whole batch takes one bind and one draw
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, roomTextureArray.texture);
+				mainUniforms.useTextureArray.Set(true);
 
-	imageData = stbi_load("PAINTING-Mona-Lisa.png", &imageWidth, &imageHeight, &numChannels, 0);
+				// Draw the vertices using triangle primitives
+				DrawArrays(GL_TRIANGLES, 0, roomBatchVertexCount);
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex6);
+				mainUniforms.useTextureArray.Set(false);
+			}
+			else
+			{
+				// Otherwise each run of faces that shares an image binds its texture and is drawn on its own
+				glActiveTexture(GL_TEXTURE0);
+				mainUniforms.useTextureArray.Set(false);
+				for (std::size_t i = 0; i < roomBatch.ranges.size(); i++)
+				{
+					glBindTexture(GL_TEXTURE_2D, roomBatchTextures[i]);
+					DrawArrays(GL_TRIANGLES, roomBatch.ranges[i].first, roomBatch.ranges[i].count);
+				}
+			}
+			mainUniforms.useVirtualTextures.Set(false);
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// --- 3D Models ---
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		for (std::size_t i = 0; i < exhibits.size(); i++)
+		{
+			// Exhibits pop in once they are fully uploaded (and have an object block)
+			Exhibit& exhibit = exhibits[i];
+			if (!drawFrame || exhibitBlockOffsets[i] < 0)
+			{
+				continue;
+			}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+			glBindVertexArray(exhibit.vao);
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, exhibit.texture);
 
-	GLuint tex7;
-	glGenTextures(1, &tex7);
+			// Where the exhibit is drawn, from its object block
+			uniformRing.Bind(ObjectUniformsBinding, exhibitBlockOffsets[i], sizeof(ObjectUniformBlock));
+			const glm::mat4& model = exhibitModels[i];
 
-	imageData = stbi_load("PAINTING-The-Starry-Night.png", &imageWidth, &imageHeight, &numChannels, 0);
+			// Pick the coarsest level of detail whose error stays within the allowed pixels on screen
+			float pixelsPerUnit = GetExhibitPixelsPerUnit(exhibit, cameraPosition, verticalFieldOfView, framebufferHeight);
+			exhibit.lod = SelectLod(exhibit.lods.data(), exhibit.lods.size(), exhibit.lod, pixelsPerUnit, lodSettings);
+			const MeshLod& lod = exhibit.lods[exhibit.lod];
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex7);
+			if (lod.meshletCount == 0)
+			{
+				// Draw the vertices using triangle primitives
+				DrawElementsBaseVertex(GL_TRIANGLES, lod.indexCount, lod.firstIndex, 0);
+				exhibitTriangleCount += lod.indexCount / 3;
+				continue;
+			}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			// Only the meshlets of the level that may be seen are drawn. The camera and the frustum are taken into the
+			// model's space, so the spinning model's meshlets are tested with the bounds they were built with
+			glm::vec3 modelCameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+			CullMeshlets(exhibit.meshlets.data() + lod.firstMeshlet, lod.meshletCount, GetViewFrustum(proj * view * model),
+				modelCameraPosition, meshletDrawList);
+			if (!meshletDrawList.counts.empty())
+			{
+				MultiDrawElements(GL_TRIANGLES, meshletDrawList.counts.data(), meshletDrawList.offsets.data(),
+					static_cast<GLsizei>(meshletDrawList.counts.size()));
+			}
+			exhibitTriangleCount += static_cast<unsigned int>(meshletDrawList.triangleCount);
+			exhibitMeshletsCulled += static_cast<unsigned int>(meshletDrawList.backFacingCount + meshletDrawList.outsideCount);
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		// "Unuse" the vertex array object
+		glBindVertexArray(0);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+		// This frame's part of the uniform ring is reused once these draw calls are done with it
+		uniformRing.EndFrame();
+
+		// Show the number of draw calls of the last frame in the window title
+		if (glfwGetTime() - lastReportTime >= 1.0)
+		{
+			std::string title = "[Mendoza & Serrano] GDEV 30 Final Project | Draw calls per frame: " + std::to_string(drawCallCount)
+				+ " | Exhibit triangles: " + std::to_string(exhibitTriangleCount) + " | Meshlets culled: " + std::to_string(exhibitMeshletsCulled);
+			if (useVirtualTextures)
+			{
+				VirtualTextureStats virtualTextureStats = virtualTextures.GetStats();
+				title += " | Painting tiles: " + std::to_string(virtualTextureStats.residentTiles) + " of "
+					+ std::to_string(virtualTextureStats.cacheTiles) + " cached";
+			}
+			glfwSetWindowTitle(window, title.c_str());
+			lastReportTime = glfwGetTime();
+		}
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
+		// Tell GLFW to swap the screen buffer with the offscreen buffer
+		glfwSwapBuffers(window);
 
-	GLuint tex8;
-	glGenTextures(1, &tex8);
+		if (!firstFrameReported)
+		{
+			std::cout << "Time to first frame: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count()
+				<< " ms (" << exhibitStreamer.GetReadyCount() << " of " << exhibits.size() << " exhibits ready)" << std::endl;
+			startupProfile.AddMilestone("First frame");
+			firstFrameReported = true;
+		}
 
-	imageData = stbi_load("PAINTING-The-Great-Wave-off-Kanagawa.png", &imageWidth, &imageHeight, &numChannels, 0);
+		if (!streamingReported && exhibitStreamer.IsFinished())
+		{
+			std::size_t exhibitVertexBytes = 0;
+			for (const Exhibit& exhibit : exhibits)
+			{
+				exhibitVertexBytes += exhibit.vertexCount * GetVertexSize(exhibitVertexFormat);
+			}
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex8);
+			std::cout << "All exhibits streamed in after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count()
+				<< " ms" << std::endl;
+			std::cout << "Peak memory use while loading the exhibits: " << GetPeakMemoryUsage() / (1024.0 * 1024.0) << " MB" << std::endl;
+			std::cout << "Exhibit vertex buffers: " << exhibitVertexBytes / 1024 << " KiB of " << GetVertexSize(exhibitVertexFormat)
+				<< "-byte vertices" << std::endl;
+			streamingReported = true;
+
+			startupProfile.AddMilestone("All exhibits ready");
+			if (options.profileStartup)
+			{
+				startupProfile.Print(std::cout);
+			}
+			if (!options.startupProfilePath.empty() && startupProfile.WriteJson(options.startupProfilePath))
+			{
+				std::cout << "Startup profile written to " << options.startupProfilePath << std::endl;
+			}
+			if (options.quitWhenLoaded)
+			{
+				glfwSetWindowShouldClose(window, GLFW_TRUE);
+			}
+		}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// Tell GLFW to process window events (e.g., input events, window closed events, etc.)
+		glfwPollEvents();
+	}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// --- Cleanup ---
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
+	// Make sure to delete the shader programs
+	glDeleteProgram(program);
+	glDeleteProgram(feedbackProgram);
 
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
+	// Delete the tile cache, page tables and feedback buffers of the virtual textures
+	if (useVirtualTextures)
 	{
-		std::cerr << "Failed to load image" << std::endl;
+		virtualTextures.Destroy();
 	}
 
-	GLuint tex9;
-	glGenTextures(1, &tex9);
+	// Delete the sampler the textures are drawn with
+	glDeleteSamplers(1, &textureSampler);
 
-	imageData = stbi_load("PAINTING-The-Birth-of-Venus.png", &imageWidth, &imageHeight, &numChannels, 0);
+	// Unmap and delete the upload ring, once no worker thread is copying into it
+	uploadRing.Destroy();
 
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex9);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex10;
-	glGenTextures(1, &tex10);
-
-	imageData = stbi_load("PAINTING-Girl-with-a-Pearl-Earring.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex10);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex11;
-	glGenTextures(1, &tex11);
-
-	imageData = stbi_load("PAINTING-The-Scream.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex11);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex12;
-	glGenTextures(1, &tex12);
-
-	imageData = stbi_load("PAINTING-Frame.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	// --- 3D Model Textures ---
-
-	GLuint tex13;
-	glGenTextures(1, &tex13);
-
-	imageData = stbi_load("3D-MODEL-Nefertiti-Bust.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex13);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex14;
-	glGenTextures(1, &tex14);
-
-	imageData = stbi_load("3D-MODEL-Suzanne-Monkey.jpeg", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex14);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex15;
-	glGenTextures(1, &tex15);
-
-	imageData = stbi_load("3D-MODEL-Asian-Vase.png", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex15);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	GLuint tex16;
-	glGenTextures(1, &tex16);
-
-	imageData = stbi_load("3D-MODEL-Jaguar-Skull.jpeg", &imageWidth, &imageHeight, &numChannels, 0);
-
-	if (imageData != nullptr)
-	{
-		glBindTexture(GL_TEXTURE_2D, tex16);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-
-		stbi_image_free(imageData);
-		imageData = nullptr;
-	}
-	else
-	{
-		std::cerr << "Failed to load image" << std::endl;
-	}
-
-	// Enable depth testing
-	glEnable(GL_DEPTH_TEST);
-
-	// Render loop
-	while (!glfwWindowShouldClose(window))
-	{
-		// Clear the colors in our off-screen framebuffer
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// Use the shader program that we created
-		glUseProgram(program);
-
-		// Use the vertex array object that we created
-		glBindVertexArray(vao);
-
-		// Uniform variables for point light
-		GLint lightPositionUniformLocation = glGetUniformLocation(program, "lightPosition");
-		glUniform3f(lightPositionUniformLocation, 0.0f, 0.0f, 0.0f);
-
-		GLint lightAmbientUniformLocation = glGetUniformLocation(program, "lightAmbient");
-		glUniform3f(lightAmbientUniformLocation, 0.2f, 0.2f, 0.2f);
-
-		GLint lightDiffuseUniformLocation = glGetUniformLocation(program, "lightDiffuse");
-		glUniform3f(lightDiffuseUniformLocation, lightDiffuse.x, lightDiffuse.y, lightDiffuse.z);
-
-		GLint lightSpecularUniformLocation = glGetUniformLocation(program, "lightSpecular");
-		glUniform3f(lightSpecularUniformLocation, lightSpecular.x, lightSpecular.y, lightSpecular.z);
-
-		// Uniform variables for spot light
-		GLint spotlightPosition0UniformLocation = glGetUniformLocation(program, "spotlightPosition[0]");
-		glUniform3f(spotlightPosition0UniformLocation, -10.0f, 20.0f, 10.0f);
-
-		GLint spotlightPosition1UniformLocation = glGetUniformLocation(program, "spotlightPosition[1]");
-		glUniform3f(spotlightPosition1UniformLocation, 10.0f, 20.0f, 10.0f);
-
-		GLint spotlightPosition2UniformLocation = glGetUniformLocation(program, "spotlightPosition[2]");
-		glUniform3f(spotlightPosition2UniformLocation, -10.0f, 20.0f, -10.0f);
-
-		GLint spotlightPosition3UniformLocation = glGetUniformLocation(program, "spotlightPosition[3]");
-		glUniform3f(spotlightPosition3UniformLocation, 10.0f, 20.0f, -10.0f);
-
-		GLint spotlightAmbientUniformLocation = glGetUniformLocation(program, "spotlightAmbient");
-		glUniform3f(spotlightAmbientUniformLocation, spotlightAmbient.x, spotlightAmbient.y, spotlightAmbient.z);
-
-		GLint spotlightDiffuseUniformLocation = glGetUniformLocation(program, "spotlightDiffuse");
-		glUniform3f(spotlightDiffuseUniformLocation, spotlightDiffuse.x, spotlightDiffuse.y, spotlightDiffuse.z);
-
-		GLint spotlightSpecularUniformLocation = glGetUniformLocation(program, "spotlightSpecular");
-		glUniform3f(spotlightSpecularUniformLocation, spotlightSpecular.x, spotlightSpecular.y, spotlightSpecular.z);
-
-		GLint spotlightTargetUniformLocation = glGetUniformLocation(program, "spotlightTarget");
-		glUniform3f(spotlightTargetUniformLocation, 0.0f, -1.0f, 0.0f);
-
-		GLint spotlightCutoffUniformLocation = glGetUniformLocation(program, "spotlightCutoff");
-		glUniform1f(spotlightCutoffUniformLocation, glm::cos(glm::radians(7.5f)));
-
-		// Uniform variables for object
-		GLint objectSpecularUniformLocation = glGetUniformLocation(program, "objectSpecular");
-		glUniform3f(objectSpecularUniformLocation, 0.5f, 0.5f, 0.5f);
-
-		GLint shininessUniformLocation = glGetUniformLocation(program, "shininess");
-		glUniform1f(shininessUniformLocation, 8.0f);
-
-		// --- Projection and View Matrices ---
-
-		// Projection Matrix
-		glm::mat4 proj = glm::perspective(glm::radians(60.0f), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
-
-		// View Matrix
-		glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
-
-		// Uniform variables
-		GLint projUniformLocation = glGetUniformLocation(program, "proj");
-		glUniformMatrix4fv(projUniformLocation, 1, GL_FALSE, glm::value_ptr(proj));
-
-		GLint viewUniformLocation = glGetUniformLocation(program, "view");
-		glUniformMatrix4fv(viewUniformLocation, 1, GL_FALSE, glm::value_ptr(view));
-
-		GLint cameraPositionUniformLocation = glGetUniformLocation(program, "cameraPosition");
-		glUniform3fv(cameraPositionUniformLocation, 3, glm::value_ptr(cameraPosition));
-
-		// --- Room ---
-
-		// Bind our texture to texture unit 0
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex0);
-
-		// Make our sampler in the fragment shader use texture unit 0
-		GLint texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(50.0f, 50.0f, 50.0f));
-
-		// Normal Matrix
-		glm::mat4 normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		GLint modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		GLint normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-
-		// Bind our texture to texture unit 1
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex1);
-
-		// Make our sampler in the fragment shader use texture unit 1
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-		glDrawArrays(GL_TRIANGLE_FAN, 4, 4);
-
-		// Bind our texture to texture unit 2
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex2);
-
-		// Make our sampler in the fragment shader use texture unit 2
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-		glDrawArrays(GL_TRIANGLE_FAN, 8, 4);
-
-		// Bind our texture to texture unit 2
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex2);
-
-		// Make our sampler in the fragment shader use texture unit 2
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-		glDrawArrays(GL_TRIANGLE_FAN, 12, 4);
-
-		// Bind our texture to texture unit 3
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex3);
-
-		// Make our sampler in the fragment shader use texture unit 3
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-		glDrawArrays(GL_TRIANGLE_FAN, 16, 4);
-
-		// Bind our texture to texture unit 4
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex4);
-
-		// Make our sampler in the fragment shader use texture unit 4
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-		glDrawArrays(GL_TRIANGLE_FAN, 20, 4);
-
-		// --- Platform 1 ---
-
-		// Bind our texture to texture unit 5
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex5);
-
-		// Make our sampler in the fragment shader use texture unit 5
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-10.0f, -21.0f, 10.0f));
-		model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 24, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 28, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 32, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 40, 4);
-
-		// --- Platform 2 ---
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, -21.0f, 10.0f));
-		model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 24, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 28, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 32, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 40, 4);
-
-		// --- Platform 3 ---
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-10.0f, -21.0f, -10.0f));
-		model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 24, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 28, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 32, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 40, 4);
-
-		// --- Platform 4 ---
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, -21.0f, -10.0f));
-		model = glm::scale(model, glm::vec3(5.0f, 5.0f, 5.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 24, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 28, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 32, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 40, 4);
-
-		// --- Painting 1: Solo Vertical ---
-
-		// Bind our texture to texture unit 6
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex6);
-
-		// Make our sampler in the fragment shader use texture unit 6
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 24.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		model = glm::scale(model, glm::vec3(17.5f, 17.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 64, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 68, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 72, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 76, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 80, 4);
-
-		// --- Painting 2: Solo Horizontal ---
-
-		// Bind our texture to texture unit 7
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex7);
-
-		// Make our sampler in the fragment shader use texture unit 7
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -24.0f));
-		model = glm::rotate(model, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(17.5f, 17.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 64, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 68, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 72, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 76, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 80, 4);
-
-		// --- Paintings 3 and 4: Horizontal and Square ---
-
-		// --- Horizontal Painting ---
-
-		// Bind our texture to texture unit 8
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex8);
-
-		// Make our sampler in the fragment shader use texture unit 8
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-24.0f, 9.5f, 5.0f));
-		model = glm::rotate(model, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(12.5f, 12.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 64, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 68, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 72, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 76, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 80, 4);
-
-		// --- Square Painting ---
-
-		// Bind our texture to texture unit 9
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex9);
-
-		// Make our sampler in the fragment shader use texture unit 9
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-24.0f, -5.5f, -7.5f));
-		model = glm::rotate(model, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(12.5f, 12.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 44, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 48, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 52, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 56, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 60, 4);
-
-		// --- Paintings 5 and 6: Vertical and Square ---
-
-		// --- Vertical Painting ---
-
-		// Bind our texture to texture unit 10
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex10);
-
-		// Make our sampler in the fragment shader use texture unit 10
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(25.0f, 5.0f, -7.5f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		model = glm::scale(model, glm::vec3(12.5f, 12.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 64, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 68, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 72, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 76, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 80, 4);
-
-		// --- Square Painting ---
-
-		// Bind our texture to texture unit 11
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex11);
-
-		// Make our sampler in the fragment shader use texture unit 11
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(25.0f, -3.5f, 7.5f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(12.5f, 12.5f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		glDrawArrays(GL_TRIANGLE_FAN, 44, 4);
-
-		// Bind our texture to texture unit 12
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex12);
-
-		// Make our sampler in the fragment shader use texture unit 12
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		glDrawArrays(GL_TRIANGLE_FAN, 48, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 52, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 56, 4);
-		glDrawArrays(GL_TRIANGLE_FAN, 60, 4);
-
-		// --- 3D Models ---
-
-		// --- Nefertiti Bust ---
-
-		// Bind our texture to texture unit 13
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex13);
-
-		// Make our sampler in the fragment shader use texture unit 13
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-10.0f, -12.0f, 10.0f));
-		model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(0.1f / 6.0f, 0.1f / 6.0f, 0.1f / 6.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		int i = 84;
-		while (i != 84 + 56334) {
-			glDrawArrays(GL_TRIANGLES, i, 3);
-			i += 3;
-		}
-
-		// --- Suzanne Monkey ---
-
-		// Bind our texture to texture unit 14
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex14);
-
-		// Make our sampler in the fragment shader use texture unit 14
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, -13.5f, 10.0f));
-		model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		i = 84 + 56334;
-		while (i != 84 + 56334 + 2904) {
-			glDrawArrays(GL_TRIANGLES, i, 3);
-			i += 3;
-		}
-
-		// --- Asian Vase ---
-
-		// Bind our texture to texture unit 15
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex15);
-
-		// Make our sampler in the fragment shader use texture unit 15
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(-10.0f, -16.0f, -10.0f));
-		model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(0.7f / 40.0f, 0.7f / 40.0f, 0.7f / 40.0f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		i = 84 + 56334 + 2904;
-		while (i != 84 + 56334 + 2904 + 13984) {
-			glDrawArrays(GL_TRIANGLE_FAN, i, 4);
-			i += 4;
-		}
-
-		// --- Jaguar Skull ---
-
-		// Bind our texture to texture unit 16
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex16);
-
-		// Make our sampler in the fragment shader use texture unit 16
-		texUniformLocation = glGetUniformLocation(program, "tex");
-		glUniform1i(texUniformLocation, 0);
-
-		// Model Matrix
-		model = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, -15.5f, -10.0f));
-		model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.0f, 1.0f, 0.0f));
-		model = glm::scale(model, glm::vec3(5.0f, 5.0f, 4.8f));
-
-		// Normal Matrix
-		normal = glm::transpose(glm::inverse(model));
-
-		// Uniform variables
-		modelUniformLocation = glGetUniformLocation(program, "model");
-		glUniformMatrix4fv(modelUniformLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-		normMatrixUniformLocation = glGetUniformLocation(program, "normMatrix");
-		glUniformMatrix4fv(normMatrixUniformLocation, 1, GL_FALSE, glm::value_ptr(normal));
-
-		// Draw the vertices using triangle primitives
-		i = 84 + 56334 + 2904 + 13984;
-		while (i != 84 + 56334 + 2904 + 13984 + 11988) {
-			glDrawArrays(GL_TRIANGLE_FAN, i, 4);
-			i += 4;
-		}
-
-		// "Unuse" the vertex array object
-		glBindVertexArray(0);
-
-		// Tell GLFW to swap the screen buffer with the offscreen buffer
-		glfwSwapBuffers(window);
-
-		// Tell GLFW to process window events (e.g., input events, window closed events, etc.)
-		glfwPollEvents();
-	}
-
-	// --- Cleanup ---
-
-	// Make sure to delete the shader program
-	glDeleteProgram(program);
+	// Delete the uniform ring
+	uniformRing.Destroy();
 
 	// Delete the VBO that contains our vertices
 	glDeleteBuffers(1, &vbo);
+	glDeleteBuffers(1, &layerVbo);
 
 	// Delete the vertex array object
 	glDeleteVertexArrays(1, &vao);
 
+	// Delete the buffers, vertex array objects and textures of the exhibits (including any that were still streaming in)
+	for (const Exhibit& exhibit : exhibits)
+	{
+		glDeleteBuffers(1, &exhibit.vbo);
+		glDeleteBuffers(1, &exhibit.ebo);
+		glDeleteBuffers(1, &exhibit.colorVbo);
+		glDeleteVertexArrays(1, &exhibit.vao);
+		glDeleteTextures(1, &exhibit.texture);
+	}
+
 	// Remember to tell GLFW to clean itself up before exiting the application
 	glfwTerminate();
 
@@ -2122,12 +1569,32 @@ int main()
 /// </summary>
 /// <param name="vertexShaderFilePath">Vertex shader file path</param>
 /// <param name="fragmentShaderFilePath">Fragment shader file path</param>
+/// <param name="archive">Archive to take the shader sources from, by file name (null to always read the files)</param>
 /// <returns>OpenGL handle to the created shader program</returns>
-GLuint CreateShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath)
+GLuint CreateShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath, AssetArchive* archive,
+	StartupProfile& profile)
 {
-	GLuint vertexShader = CreateShaderFromFile(GL_VERTEX_SHADER, vertexShaderFilePath);
-	GLuint fragmentShader = CreateShaderFromFile(GL_FRAGMENT_SHADER, fragmentShaderFilePath);
+	GLuint vertexShader = CreateShaderFromFile(GL_VERTEX_SHADER, vertexShaderFilePath, archive, profile);
+	GLuint fragmentShader = CreateShaderFromFile(GL_FRAGMENT_SHADER, fragmentShaderFilePath, archive, profile);
+
+	StartupProfileEntry linkProfile = profile.Begin("Shader program", vertexShaderFilePath + " + " + fragmentShaderFilePath);
+	GLuint program = LinkShaderProgram(vertexShader, fragmentShader);
 
+	// Linking is all OpenGL work, so it counts as uploading
+	linkProfile.uploadSeconds = profile.GetSeconds() - linkProfile.start;
+	profile.End(linkProfile);
+
+	return program;
+}
+
+/// <summary>
+/// Links a vertex and a fragment shader into a shader program, then deletes the shaders.
+/// </summary>
+/// <param name="vertexShader">OpenGL handle to the vertex shader</param>
+/// <param name="fragmentShader">OpenGL handle to the fragment shader</param>
+/// <returns>OpenGL handle to the created shader program (check GL_LINK_STATUS to know if it linked)</returns>
+GLuint LinkShaderProgram(GLuint vertexShader, GLuint fragmentShader)
+{
 	GLuint program = glCreateProgram();
 	glAttachShader(program, vertexShader);
 	glAttachShader(program, fragmentShader);
@@ -2157,25 +1624,46 @@ GLuint CreateShaderProgram(const std::string& vertexShaderFilePath, const std::s
 /// </summary>
 /// <param name="shaderType">Shader type</param>
 /// <param name="shaderFilePath">Path to the file containing the shader source</param>
+/// <param name="archive">Archive to take the shader source from, by file name (null to always read the file)</param>
 /// <returns>OpenGL handle to the created shader</returns>
-GLuint CreateShaderFromFile(const GLuint& shaderType, const std::string& shaderFilePath)
+GLuint CreateShaderFromFile(const GLuint& shaderType, const std::string& shaderFilePath, AssetArchive* archive, StartupProfile& profile)
 {
-	std::ifstream shaderFile(shaderFilePath);
-	if (shaderFile.fail())
-	{
-		std::cerr << "Unable to open shader file: " << shaderFilePath << std::endl;
-		return 0;
-	}
+	StartupProfileEntry shaderProfile = profile.Begin("Shader", shaderFilePath);
 
 	std::string shaderSource;
-	std::string temp;
-	while (std::getline(shaderFile, temp))
+	ArchiveAsset asset;
+	std::string archiveName = std::filesystem::path(shaderFilePath).filename().string();
+	if (archive != nullptr && archive->Read(archiveName, asset))
+	{
+		shaderSource.assign(asset.data, asset.size);
+		shaderProfile.bytesRead = archive->Find(archiveName)->storedSize;
+	}
+	else
 	{
-		shaderSource += temp + "\n";
+		std::ifstream shaderFile(shaderFilePath);
+		if (shaderFile.fail())
+		{
+			std::cerr << "Unable to open shader file: " << shaderFilePath << std::endl;
+			return 0;
+		}
+
+		std::string temp;
+		while (std::getline(shaderFile, temp))
+		{
+			shaderSource += temp + "\n";
+		}
+		shaderFile.close();
+		shaderProfile.bytesRead = shaderSource.size();
 	}
-	shaderFile.close();
 
-	return CreateShaderFromSource(shaderType, shaderSource);
+	double compileStart = profile.GetSeconds();
+	shaderProfile.decodeSeconds = compileStart - shaderProfile.start;
+
+	GLuint shader = CreateShaderFromSource(shaderType, shaderSource);
+
+	shaderProfile.uploadSeconds = profile.GetSeconds() - compileStart;
+	profile.End(shaderProfile);
+	return shader;
 }
 
 /// <summary>
@@ -2207,6 +1695,57 @@ GLuint CreateShaderFromSource(const GLuint& shaderType, const std::string& shade
 	return shader;
 }
 
+/// <summary>
+/// Draws primitives from the bound vertex array object and counts the draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="first">Index of the first vertex</param>
+/// <param name="count">Number of vertices</param>
+void DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+	drawCallCount += 1;
+}
+
+/// <summary>
+/// Draws several ranges of primitives from the bound vertex array object with a single draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="first">Index of the first vertex of each range</param>
+/// <param name="count">Number of vertices of each range</param>
+/// <param name="drawCount">Number of ranges</param>
+void MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawCount)
+{
+	glMultiDrawArrays(mode, first, count, drawCount);
+	drawCallCount += 1;
+}
+
+/// <summary>
+/// Draws indexed primitives from the bound vertex array object and counts the draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="count">Number of indices</param>
+/// <param name="firstIndex">Position of the first index inside the element buffer</param>
+/// <param name="baseVertex">Value added to every index before fetching the vertex</param>
+void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLsizei firstIndex, GLint baseVertex)
+{
+	glDrawElementsBaseVertex(mode, count, GL_UNSIGNED_INT, (void*)(firstIndex * sizeof(GLuint)), baseVertex);
+	drawCallCount += 1;
+}
+
+/// <summary>
+/// Draws several ranges of indexed primitives from the bound vertex array object with a single draw call.
+/// </summary>
+/// <param name="mode">Primitive type</param>
+/// <param name="count">Number of indices of each range</param>
+/// <param name="offsets">Byte offset of each range inside the element buffer</param>
+/// <param name="drawCount">Number of ranges</param>
+void MultiDrawElements(GLenum mode, const GLsizei* count, const void* const* offsets, GLsizei drawCount)
+{
+	glMultiDrawElements(mode, count, GL_UNSIGNED_INT, offsets, drawCount);
+	drawCallCount += 1;
+}
+
 /// <summary>
 /// Function for handling the event when the size of the framebuffer changed.
 /// </summary>
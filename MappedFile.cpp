@@ -0,0 +1,201 @@
+#include "MappedFile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		Swap(other);
+	}
+	return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept
+{
+	std::swap(data, other.data);
+	std::swap(size, other.size);
+	std::swap(isOpen, other.isOpen);
+#ifdef _WIN32
+	std::swap(fileHandle, other.fileHandle);
+	std::swap(mappingHandle, other.mappingHandle);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filePath, MappedFileAccess access)
+{
+	Close();
+
+	DWORD flags = access == MappedFileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cerr << "Unable to open file: " << filePath << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		std::cerr << "Unable to get the size of file: " << filePath << std::endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are still valid files
+	if (fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		isOpen = true;
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		std::cerr << "Unable to map file: " << filePath << std::endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		std::cerr << "Unable to map file: " << filePath << std::endl;
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	data = static_cast<const char*>(view);
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+	isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mappingHandle != nullptr)
+	{
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != nullptr)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filePath, MappedFileAccess access)
+{
+	Close();
+
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		std::cerr << "Unable to open file: " << filePath << std::endl;
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0)
+	{
+		std::cerr << "Unable to get the size of file: " << filePath << std::endl;
+		close(file);
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are still valid files
+	if (fileStatus.st_size == 0)
+	{
+		close(file);
+		isOpen = true;
+		return true;
+	}
+
+	void* view = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping stays valid after the file descriptor is closed
+	close(file);
+
+	if (view == MAP_FAILED)
+	{
+		std::cerr << "Unable to map file: " << filePath << std::endl;
+		return false;
+	}
+
+	// Only a hint, so a failure here is not an error
+	madvise(view, static_cast<std::size_t>(fileStatus.st_size), access == MappedFileAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+	data = static_cast<const char*>(view);
+	size = static_cast<std::size_t>(fileStatus.st_size);
+	isOpen = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+	{
+		munmap(const_cast<char*>(data), size);
+	}
+
+	data = nullptr;
+	size = 0;
+	isOpen = false;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const
+{
+	return isOpen;
+}
+
+const char* MappedFile::GetData() const
+{
+	return data;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+	return size;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// How the contents of a mapped file are going to be read
+/// </summary>
+enum class MappedFileAccess
+{
+	Sequential,	// Read once from start to end (lets the OS read ahead aggressively)
+	Random		// Read in no particular order
+};
+
+/// <summary>
+/// Read-only memory mapping of a whole file, so its contents can be used without copying them
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile() = default;
+
+	/// <summary>
+	/// Unmaps the file.
+	/// </summary>
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/// <summary>
+	/// Maps a file into memory (unmapping the previous one, if any).
+	/// </summary>
+	/// <param name="filePath">Path to the file</param>
+	/// <param name="access">How the contents are going to be read</param>
+	/// <returns>True if the file was mapped successfully</returns>
+	bool Open(const std::string& filePath, MappedFileAccess access = MappedFileAccess::Sequential);
+
+	/// <summary>
+	/// Unmaps the file.
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// Indicates if a file is currently mapped.
+	/// </summary>
+	bool IsOpen() const;
+
+	/// <summary>
+	/// Start of the contents of the file (nullptr if the file is empty).
+	/// </summary>
+	const char* GetData() const;
+
+	/// <summary>
+	/// Size of the file in bytes.
+	/// </summary>
+	std::size_t GetSize() const;
+
+private:
+	void Swap(MappedFile& other) noexcept;
+
+	const char* data = nullptr;
+	std::size_t size = 0;
+	bool isOpen = false;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Largest amount of physical memory the process has used so far (peak resident set size / peak working set).
+/// </summary>
+/// <returns>Peak memory use in bytes (0 if the platform does not report it)</returns>
+std::size_t GetPeakMemoryUsage();
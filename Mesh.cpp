@@ -0,0 +1,55 @@
+#include "Mesh.h"
+
+#include <algorithm>
+
+MeshBounds ComputeBounds(const Vertex* vertices, std::size_t vertexCount)
+{
+	MeshBounds bounds;
+	if (vertexCount == 0)
+	{
+		return bounds;
+	}
+
+	bounds.min[0] = bounds.max[0] = vertices[0].x;
+	bounds.min[1] = bounds.max[1] = vertices[0].y;
+	bounds.min[2] = bounds.max[2] = vertices[0].z;
+
+	for (std::size_t i = 1; i < vertexCount; i++)
+	{
+		const Vertex& vertex = vertices[i];
+		bounds.min[0] = std::min(bounds.min[0], vertex.x);	bounds.max[0] = std::max(bounds.max[0], vertex.x);
+		bounds.min[1] = std::min(bounds.min[1], vertex.y);	bounds.max[1] = std::max(bounds.max[1], vertex.y);
+		bounds.min[2] = std::min(bounds.min[2], vertex.z);	bounds.max[2] = std::max(bounds.max[2], vertex.z);
+	}
+
+	return bounds;
+}
+
+MeshView GetMeshView(const MeshData& mesh)
+{
+	MeshView view;
+	view.vertices = mesh.vertices.data();
+	view.vertexCount = mesh.vertices.size();
+	view.indices = mesh.indices.data();
+	view.indexCount = mesh.indices.size();
+	view.lods = mesh.lods.data();
+	view.lodCount = mesh.lods.size();
+	view.meshlets = mesh.meshlets.data();
+	view.meshletCount = mesh.meshlets.size();
+	view.bounds = mesh.bounds;
+	view.hasColors = mesh.hasColors;
+	return view;
+}
+
+std::vector<MeshLod> GetMeshLods(const MeshView& mesh)
+{
+	if (mesh.lodCount != 0)
+	{
+		return std::vector<MeshLod>(mesh.lods, mesh.lods + mesh.lodCount);
+	}
+
+	MeshLod fullDetail;
+	fullDetail.indexCount = static_cast<GLuint>(mesh.indexCount);
+	fullDetail.meshletCount = static_cast<GLuint>(mesh.meshletCount);
+	return std::vector<MeshLod>(1, fullDetail);
+}
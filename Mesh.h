@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Struct containing data about a vertex
+/// </summary>
+struct Vertex
+{
+	GLfloat x, y, z;	// Position
+	GLubyte r, g, b;	// Color
+	GLfloat u, v;		// UV Coordinates
+	GLfloat nx, ny, nz; // Normal Vector
+};
+
+/// <summary>
+/// Axis-aligned box around the vertices of a model
+/// </summary>
+struct MeshBounds
+{
+	GLfloat min[3] = { 0.0f, 0.0f, 0.0f };
+	GLfloat max[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+/// <summary>
+/// One level of detail of a 3D model: a range of its index buffer, drawn with the model's vertices
+/// </summary>
+struct MeshLod
+{
+	GLuint firstIndex = 0;		// Position of the first index of the level inside the index buffer
+	GLuint indexCount = 0;		// Number of indices of the level
+	GLfloat error = 0.0f;		// How far the level's surface strays from the full-detail surface, in model units
+	GLuint firstMeshlet = 0;	// Position of the level's first meshlet inside the list of meshlets
+	GLuint meshletCount = 0;	// Number of meshlets the level is split into (0 if the model has no meshlets)
+};
+
+/// <summary>
+/// Small cluster of neighboring triangles of one level of detail, stored as a range of the index buffer,
+/// with the bounds the renderer uses to skip it when it lies outside the view or faces away from the camera
+/// </summary>
+struct Meshlet
+{
+	GLuint firstIndex = 0;							// Position of the first index of the meshlet inside the index buffer
+	GLuint indexCount = 0;							// Number of indices of the meshlet
+	GLfloat center[3] = { 0.0f, 0.0f, 0.0f };		// Center of the sphere around the meshlet's vertices
+	GLfloat radius = 0.0f;							// Radius of that sphere
+	GLfloat coneAxis[3] = { 0.0f, 0.0f, 0.0f };		// Average direction the meshlet's triangles face
+	GLfloat coneCutoff = 1.0f;						// Sine of the widest angle between a triangle and the axis (1 if never culled by it)
+};
+
+/// <summary>
+/// Geometry of a 3D model, stored as a list of vertices and a list of triangles (three indices per triangle)
+/// </summary>
+struct MeshData
+{
+	std::vector<Vertex> vertices;
+	std::vector<GLuint> indices;
+
+	/// <summary>
+	/// Levels of detail, from full detail to coarsest, each a range of the indices
+	/// (empty if the model only has its full detail, which is then the whole index buffer)
+	/// </summary>
+	std::vector<MeshLod> lods;
+
+	/// <summary>
+	/// Meshlets of every level of detail, level by level (empty if the model was not split into meshlets)
+	/// </summary>
+	std::vector<Meshlet> meshlets;
+
+	/// <summary>
+	/// Box around the vertices of the model
+	/// </summary>
+	MeshBounds bounds;
+
+	/// <summary>
+	/// Indicates if the model provided its own vertex colors (otherwise every vertex is white)
+	/// </summary>
+	bool hasColors = false;
+};
+
+/// <summary>
+/// Read-only view of the geometry of a 3D model, wherever that geometry is stored
+/// (for example in a MeshData, or in a memory-mapped mesh cache)
+/// </summary>
+struct MeshView
+{
+	const Vertex* vertices = nullptr;
+	std::size_t vertexCount = 0;
+	const GLuint* indices = nullptr;
+	std::size_t indexCount = 0;
+	const MeshLod* lods = nullptr;
+	std::size_t lodCount = 0;
+	const Meshlet* meshlets = nullptr;
+	std::size_t meshletCount = 0;
+	MeshBounds bounds;
+	bool hasColors = false;
+};
+
+/// <summary>
+/// Computes the box around a list of vertices.
+/// </summary>
+/// <param name="vertices">Start of the list of vertices</param>
+/// <param name="vertexCount">Number of vertices</param>
+/// <returns>Box around the vertices (an empty box at the origin if there are no vertices)</returns>
+MeshBounds ComputeBounds(const Vertex* vertices, std::size_t vertexCount);
+
+/// <summary>
+/// Creates a view of the geometry held by a MeshData.
+/// </summary>
+/// <param name="mesh">Geometry to view (must outlive the view)</param>
+/// <returns>View of the geometry</returns>
+MeshView GetMeshView(const MeshData& mesh);
+
+/// <summary>
+/// Lists the levels of detail of a model; a model without any gets its whole index buffer (and all its meshlets)
+/// as its only level.
+/// </summary>
+/// <param name="mesh">Geometry of the model</param>
+/// <returns>Levels of detail, from full detail to coarsest</returns>
+std::vector<MeshLod> GetMeshLods(const MeshView& mesh);
@@ -0,0 +1,486 @@
+#include "MeshCache.h"
+
+#include "CookedAssets.h"
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace
+{
+	const char MeshCacheMagic[8] = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' };
+
+	/// <summary>
+	/// Version of the cache layout, increased whenever the layout or the meaning of its data changes
+	/// </summary>
+	const std::uint32_t MeshCacheVersion = 5;
+
+	/// <summary>
+	/// Alignment of the blobs inside the cache file
+	/// </summary>
+	const std::uint64_t MeshCacheAlignment = 64;
+
+	/// <summary>
+	/// Flags of MeshCacheHeader::flags
+	/// </summary>
+	enum MeshCacheFlags : std::uint32_t
+	{
+		MeshCacheHasColors = 1,
+		MeshCacheOptimized = 2,	// The index and vertex order went through OptimizeMesh
+		MeshCacheHasLods = 4,		// The levels of detail were built with BuildMeshLods
+		MeshCacheHasMeshlets = 8	// The levels of detail were split into meshlets with BuildMeshlets
+	};
+
+	/// <summary>
+	/// Start of a binary mesh cache file, followed by the vertex blob, the index blob, the level of detail blob and the meshlet blob
+	/// </summary>
+	struct MeshCacheHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t vertexSize;			// sizeof(Vertex) when the cache was written
+		std::uint64_t sourceSize;			// Size of the .obj file
+		std::int64_t sourceModifiedTime;	// Modification time of the .obj file
+		std::uint64_t sourceHash;			// HashBytes of the contents of the .obj file
+		std::uint64_t vertexOffset;			// Offset of the vertex blob from the start of the file
+		std::uint64_t vertexCount;
+		std::uint64_t indexOffset;			// Offset of the index blob (32-bit indices) from the start of the file
+		std::uint64_t indexCount;
+		std::uint64_t lodOffset;			// Offset of the level of detail blob (MeshLod records) from the start of the file
+		std::uint64_t lodCount;
+		std::uint64_t meshletOffset;		// Offset of the meshlet blob (Meshlet records) from the start of the file
+		std::uint64_t meshletCount;
+		float boundsMin[3];
+		float boundsMax[3];
+		std::uint32_t flags;
+		std::uint32_t reserved;
+	};
+
+	/// <summary>
+	/// Flags every cooked mesh is written with
+	/// </summary>
+	const std::uint32_t CookedMeshFlags = MeshCacheOptimized | MeshCacheHasLods | MeshCacheHasMeshlets;
+
+	/// <summary>
+	/// Size and modification time of a file, the cheap way of telling if it changed
+	/// </summary>
+	struct SourceStamp
+	{
+		std::uint64_t size = 0;
+		std::int64_t modifiedTime = 0;
+	};
+
+	bool GetSourceStamp(const std::string& filePath, SourceStamp& stamp)
+	{
+		std::error_code error;
+		std::uintmax_t size = std::filesystem::file_size(filePath, error);
+		if (error)
+		{
+			return false;
+		}
+		std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(filePath, error);
+		if (error)
+		{
+			return false;
+		}
+
+		stamp.size = static_cast<std::uint64_t>(size);
+		stamp.modifiedTime = static_cast<std::int64_t>(modifiedTime.time_since_epoch().count());
+		return true;
+	}
+
+	bool HashFile(const std::string& filePath, std::uint64_t& hash)
+	{
+		MappedFile file;
+		if (!file.Open(filePath, MappedFileAccess::Sequential))
+		{
+			return false;
+		}
+		hash = HashBytes(file.GetData(), file.GetSize());
+		return true;
+	}
+
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + MeshCacheAlignment - 1) / MeshCacheAlignment * MeshCacheAlignment;
+	}
+
+	/// <summary>
+	/// Checks that a mapped cache file is complete, was written by this version of the program and only refers to data it holds.
+	/// </summary>
+	const MeshCacheHeader* ValidateCache(const char* data, std::size_t size)
+	{
+		if (size < sizeof(MeshCacheHeader))
+		{
+			return nullptr;
+		}
+
+		const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(data);
+		if (std::memcmp(header->magic, MeshCacheMagic, sizeof(MeshCacheMagic)) != 0
+			|| header->version != MeshCacheVersion
+			|| header->vertexSize != sizeof(Vertex))
+		{
+			return nullptr;
+		}
+
+		std::uint64_t fileSize = size;
+		if (header->vertexOffset % MeshCacheAlignment != 0 || header->indexOffset % MeshCacheAlignment != 0
+			|| header->vertexOffset > fileSize || header->vertexCount > (fileSize - header->vertexOffset) / sizeof(Vertex)
+			|| header->indexOffset > fileSize || header->indexCount > (fileSize - header->indexOffset) / sizeof(GLuint)
+			|| header->lodOffset % MeshCacheAlignment != 0
+			|| header->lodOffset > fileSize || header->lodCount > (fileSize - header->lodOffset) / sizeof(MeshLod)
+			|| header->meshletOffset % MeshCacheAlignment != 0
+			|| header->meshletOffset > fileSize || header->meshletCount > (fileSize - header->meshletOffset) / sizeof(Meshlet))
+		{
+			return nullptr;
+		}
+
+		// Every level of detail and meshlet draws from the one vertex blob, so an index past its end would have the GPU
+		// (and meshlet culling) read beyond the vertices
+		const GLuint* indices = reinterpret_cast<const GLuint*>(data + header->indexOffset);
+		GLuint maxIndex = 0;
+		for (std::uint64_t i = 0; i < header->indexCount; i++)
+		{
+			maxIndex = std::max(maxIndex, indices[i]);
+		}
+		if (header->indexCount > 0 && maxIndex >= header->vertexCount)
+		{
+			return nullptr;
+		}
+
+		const MeshLod* lods = reinterpret_cast<const MeshLod*>(data + header->lodOffset);
+		for (std::uint64_t i = 0; i < header->lodCount; i++)
+		{
+			if (lods[i].firstIndex > header->indexCount || lods[i].indexCount > header->indexCount - lods[i].firstIndex
+				|| lods[i].firstMeshlet > header->meshletCount || lods[i].meshletCount > header->meshletCount - lods[i].firstMeshlet)
+			{
+				return nullptr;
+			}
+		}
+
+		const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data + header->meshletOffset);
+		for (std::uint64_t i = 0; i < header->meshletCount; i++)
+		{
+			if (meshlets[i].firstIndex > header->indexCount || meshlets[i].indexCount > header->indexCount - meshlets[i].firstIndex)
+			{
+				return nullptr;
+			}
+		}
+
+		return header;
+	}
+
+	void UseCache(LoadedMesh& mesh, const char* data, const MeshCacheHeader& header)
+	{
+		mesh.view.vertices = reinterpret_cast<const Vertex*>(data + header.vertexOffset);
+		mesh.view.vertexCount = static_cast<std::size_t>(header.vertexCount);
+		mesh.view.indices = reinterpret_cast<const GLuint*>(data + header.indexOffset);
+		mesh.view.indexCount = static_cast<std::size_t>(header.indexCount);
+		mesh.view.lods = reinterpret_cast<const MeshLod*>(data + header.lodOffset);
+		mesh.view.lodCount = static_cast<std::size_t>(header.lodCount);
+		mesh.view.meshlets = reinterpret_cast<const Meshlet*>(data + header.meshletOffset);
+		mesh.view.meshletCount = static_cast<std::size_t>(header.meshletCount);
+		std::memcpy(mesh.view.bounds.min, header.boundsMin, sizeof(header.boundsMin));
+		std::memcpy(mesh.view.bounds.max, header.boundsMax, sizeof(header.boundsMax));
+		mesh.view.hasColors = (header.flags & MeshCacheHasColors) != 0;
+	}
+
+	/// <summary>
+	/// Records a new modification time in the header of a cache whose source was touched but not changed.
+	/// </summary>
+	bool UpdateCacheStamp(const std::string& cacheFilePath, const SourceStamp& stamp)
+	{
+		std::fstream cacheFile(cacheFilePath, std::ios::binary | std::ios::in | std::ios::out);
+		if (cacheFile.fail())
+		{
+			return false;
+		}
+
+		cacheFile.seekp(offsetof(MeshCacheHeader, sourceModifiedTime));
+		cacheFile.write(reinterpret_cast<const char*>(&stamp.modifiedTime), sizeof(stamp.modifiedTime));
+		return !cacheFile.fail();
+	}
+
+	/// <summary>
+	/// Writes the cache to a temporary file first, so a cache is never seen half-written.
+	/// </summary>
+	bool WriteCache(const std::string& cacheFilePath, const MeshData& mesh, std::uint32_t flags, const SourceStamp& stamp, std::uint64_t sourceHash)
+	{
+		MeshCacheHeader header = {};
+		std::memcpy(header.magic, MeshCacheMagic, sizeof(MeshCacheMagic));
+		header.version = MeshCacheVersion;
+		header.vertexSize = sizeof(Vertex);
+		header.sourceSize = stamp.size;
+		header.sourceModifiedTime = stamp.modifiedTime;
+		header.sourceHash = sourceHash;
+		header.vertexOffset = AlignOffset(sizeof(MeshCacheHeader));
+		header.vertexCount = mesh.vertices.size();
+		header.indexOffset = AlignOffset(header.vertexOffset + header.vertexCount * sizeof(Vertex));
+		header.indexCount = mesh.indices.size();
+		header.lodOffset = AlignOffset(header.indexOffset + header.indexCount * sizeof(GLuint));
+		header.lodCount = mesh.lods.size();
+		header.meshletOffset = AlignOffset(header.lodOffset + header.lodCount * sizeof(MeshLod));
+		header.meshletCount = mesh.meshlets.size();
+		std::memcpy(header.boundsMin, mesh.bounds.min, sizeof(header.boundsMin));
+		std::memcpy(header.boundsMax, mesh.bounds.max, sizeof(header.boundsMax));
+		header.flags = flags | (mesh.hasColors ? static_cast<std::uint32_t>(MeshCacheHasColors) : 0u);
+
+		std::string temporaryFilePath = cacheFilePath + ".tmp";
+		{
+			std::ofstream cacheFile(temporaryFilePath, std::ios::binary | std::ios::trunc);
+			if (cacheFile.fail())
+			{
+				return false;
+			}
+
+			const char padding[MeshCacheAlignment] = {};
+			cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			cacheFile.write(padding, header.vertexOffset - sizeof(header));
+			cacheFile.write(reinterpret_cast<const char*>(mesh.vertices.data()), header.vertexCount * sizeof(Vertex));
+			cacheFile.write(padding, header.indexOffset - (header.vertexOffset + header.vertexCount * sizeof(Vertex)));
+			cacheFile.write(reinterpret_cast<const char*>(mesh.indices.data()), header.indexCount * sizeof(GLuint));
+			cacheFile.write(padding, header.lodOffset - (header.indexOffset + header.indexCount * sizeof(GLuint)));
+			cacheFile.write(reinterpret_cast<const char*>(mesh.lods.data()), header.lodCount * sizeof(MeshLod));
+			cacheFile.write(padding, header.meshletOffset - (header.lodOffset + header.lodCount * sizeof(MeshLod)));
+			cacheFile.write(reinterpret_cast<const char*>(mesh.meshlets.data()), header.meshletCount * sizeof(Meshlet));
+			if (cacheFile.fail())
+			{
+				cacheFile.close();
+				std::remove(temporaryFilePath.c_str());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryFilePath, cacheFilePath, error);
+		if (error)
+		{
+			std::remove(temporaryFilePath.c_str());
+			return false;
+		}
+		return true;
+	}
+}
+
+std::string GetMeshCachePath(const std::string& objFilePath)
+{
+	return objFilePath + ".meshcache";
+}
+
+bool LoadMesh(const std::string& objFilePath, LoadedMesh& mesh, const MeshLoadSettings& settings, MeshLoadStats* stats)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	mesh = LoadedMesh();
+	MeshLoadStats loadStats;
+
+	SourceStamp stamp;
+	std::uint64_t sourceHash = 0;
+	bool sourceHashed = false;
+	std::string cacheFilePath = GetMeshCachePath(objFilePath);
+
+	if (settings.archive != nullptr && settings.optimize && settings.buildLods && settings.buildMeshlets
+		&& LoadCookedMesh(*settings.archive, GetCookedAssetName(objFilePath, CookedMeshExtension), mesh))
+	{
+		loadStats.fromCooked = true;
+		loadStats.bytes = mesh.cookedAsset.size;
+		loadStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		if (stats != nullptr)
+		{
+			*stats = loadStats;
+		}
+		return true;
+	}
+
+	if (settings.useCache && GetSourceStamp(objFilePath, stamp))
+	{
+		// A missing or outdated cache is not an error, so its failures stay silent
+		MappedFile cacheFile;
+		std::error_code error;
+		const MeshCacheHeader* header = nullptr;
+		if (std::filesystem::exists(cacheFilePath, error) && cacheFile.Open(cacheFilePath, MappedFileAccess::Sequential))
+		{
+			header = ValidateCache(cacheFile.GetData(), cacheFile.GetSize());
+		}
+
+		// A cache made with other optimization, level of detail or meshlet settings is rebuilt
+		if (header != nullptr && (((header->flags & MeshCacheOptimized) != 0) != settings.optimize
+			|| ((header->flags & MeshCacheHasLods) != 0) != settings.buildLods
+			|| ((header->flags & MeshCacheHasMeshlets) != 0) != settings.buildMeshlets))
+		{
+			header = nullptr;
+		}
+
+		if (header != nullptr && (header->sourceSize != stamp.size || header->sourceModifiedTime != stamp.modifiedTime))
+		{
+			// The .obj file was touched: the cache is only still good if its contents are the same
+			sourceHashed = HashFile(objFilePath, sourceHash);
+			if (sourceHashed && header->sourceSize == stamp.size && header->sourceHash == sourceHash)
+			{
+				cacheFile.Close();
+				UpdateCacheStamp(cacheFilePath, stamp);
+				header = cacheFile.Open(cacheFilePath, MappedFileAccess::Sequential) ? ValidateCache(cacheFile.GetData(), cacheFile.GetSize()) : nullptr;
+			}
+			else
+			{
+				header = nullptr;
+			}
+		}
+
+		if (header != nullptr)
+		{
+			mesh.cacheFile = std::move(cacheFile);
+			UseCache(mesh, mesh.cacheFile.GetData(), *header);
+
+			loadStats.fromCache = true;
+			loadStats.bytes = mesh.cacheFile.GetSize();
+		}
+	}
+
+	if (!loadStats.fromCache)
+	{
+		// Hash the source before parsing it, so a change made while parsing invalidates the new cache
+		if (settings.useCache && !sourceHashed)
+		{
+			sourceHashed = HashFile(objFilePath, sourceHash);
+		}
+
+		if (!LoadObjFile(objFilePath, mesh.data, &loadStats.obj, settings.threadPool, settings.reading))
+		{
+			return false;
+		}
+		if (settings.optimize)
+		{
+			OptimizeMesh(mesh.data, &loadStats.optimization);
+			loadStats.optimized = true;
+		}
+		if (settings.buildLods)
+		{
+			std::chrono::steady_clock::time_point lodStartTime = std::chrono::steady_clock::now();
+			BuildMeshLods(mesh.data, settings.optimize);
+			loadStats.lodsBuilt = true;
+			loadStats.lodSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lodStartTime).count();
+		}
+		if (settings.buildMeshlets)
+		{
+			std::chrono::steady_clock::time_point meshletStartTime = std::chrono::steady_clock::now();
+			BuildMeshlets(mesh.data, settings.optimize);
+			loadStats.meshletsBuilt = true;
+			loadStats.meshletSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - meshletStartTime).count();
+		}
+
+		mesh.view = GetMeshView(mesh.data);
+		loadStats.bytes = loadStats.obj.bytes;
+
+		SourceStamp stampAfterParsing;
+		if (settings.useCache && sourceHashed && GetSourceStamp(objFilePath, stampAfterParsing)
+			&& stampAfterParsing.size == stamp.size && stampAfterParsing.modifiedTime == stamp.modifiedTime)
+		{
+			std::uint32_t flags = (settings.optimize ? static_cast<std::uint32_t>(MeshCacheOptimized) : 0u)
+				| (settings.buildLods ? static_cast<std::uint32_t>(MeshCacheHasLods) : 0u)
+				| (settings.buildMeshlets ? static_cast<std::uint32_t>(MeshCacheHasMeshlets) : 0u);
+			loadStats.cacheWritten = WriteCache(cacheFilePath, mesh.data, flags, stamp, sourceHash);
+			if (!loadStats.cacheWritten)
+			{
+				std::cerr << "Unable to write mesh cache: " << cacheFilePath << std::endl;
+			}
+		}
+	}
+
+	loadStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	if (stats != nullptr)
+	{
+		*stats = loadStats;
+	}
+
+	return true;
+}
+
+bool CookMesh(const std::string& objFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash,
+	ThreadPool* threadPool, MeshLoadStats* stats)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	MeshLoadStats cookStats;
+	SourceStamp stamp;
+	MeshData mesh;
+	if (!GetSourceStamp(objFilePath, stamp) || !LoadObjFile(objFilePath, mesh, &cookStats.obj, threadPool, ObjFileReading::MemoryMapped))
+	{
+		return false;
+	}
+
+	OptimizeMesh(mesh, &cookStats.optimization);
+	cookStats.optimized = true;
+
+	std::chrono::steady_clock::time_point lodStartTime = std::chrono::steady_clock::now();
+	BuildMeshLods(mesh, true);
+	cookStats.lodsBuilt = true;
+	cookStats.lodSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lodStartTime).count();
+
+	std::chrono::steady_clock::time_point meshletStartTime = std::chrono::steady_clock::now();
+	BuildMeshlets(mesh, true);
+	cookStats.meshletsBuilt = true;
+	cookStats.meshletSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - meshletStartTime).count();
+
+	cookStats.bytes = cookStats.obj.bytes;
+	cookStats.cacheWritten = WriteCache(cookedFilePath, mesh, CookedMeshFlags, stamp, sourceHash);
+	cookStats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	if (stats != nullptr)
+	{
+		*stats = cookStats;
+	}
+
+	return cookStats.cacheWritten;
+}
+
+bool LoadCookedMesh(const std::string& cookedFilePath, LoadedMesh& mesh)
+{
+	mesh = LoadedMesh();
+
+	// A missing or outdated cooked mesh is not an error (the .obj file is the fallback), so this stays silent
+	std::error_code error;
+	if (!std::filesystem::exists(cookedFilePath, error) || !mesh.cacheFile.Open(cookedFilePath, MappedFileAccess::Sequential))
+	{
+		return false;
+	}
+
+	const MeshCacheHeader* header = ValidateCache(mesh.cacheFile.GetData(), mesh.cacheFile.GetSize());
+	if (header == nullptr || (header->flags & CookedMeshFlags) != CookedMeshFlags)
+	{
+		mesh = LoadedMesh();
+		return false;
+	}
+
+	UseCache(mesh, mesh.cacheFile.GetData(), *header);
+	return true;
+}
+
+bool LoadCookedMesh(AssetArchive& archive, const std::string& name, LoadedMesh& mesh)
+{
+	mesh = LoadedMesh();
+	if (!archive.Read(name, mesh.cookedAsset))
+	{
+		return false;
+	}
+
+	const MeshCacheHeader* header = ValidateCache(mesh.cookedAsset.data, mesh.cookedAsset.size);
+	if (header == nullptr || (header->flags & CookedMeshFlags) != CookedMeshFlags)
+	{
+		mesh = LoadedMesh();
+		return false;
+	}
+
+	UseCache(mesh, mesh.cookedAsset.data, *header);
+	return true;
+}
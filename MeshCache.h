@@ -0,0 +1,110 @@
+#pragma once
+
+#include "AssetArchive.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+
+#include <cstdint>
+#include <string>
+
+class ThreadPool;
+
+/// <summary>
+/// Geometry of a 3D model, either read from the asset archive, memory-mapped from its binary mesh cache
+/// or parsed from its .obj file.
+/// Moving a LoadedMesh keeps the view valid, since neither the vectors nor the mappings move their memory.
+/// </summary>
+struct LoadedMesh
+{
+	MeshData data;				// Geometry parsed from the .obj file (empty otherwise)
+	MappedFile cacheFile;		// Mapping of the binary mesh cache or cooked mesh file (closed otherwise)
+	ArchiveAsset cookedAsset;	// Cooked mesh read from the asset archive (empty otherwise)
+	MeshView view;				// Geometry of the model, pointing into one of the above
+};
+
+/// <summary>
+/// Settings for loading a 3D model
+/// </summary>
+struct MeshLoadSettings
+{
+	AssetArchive* archive = nullptr;						// Archive of the assets cooked by AssetCooker, tried first (null to ignore)
+	bool useCache = true;									// Indicates if the binary mesh cache is read and written
+	bool optimize = true;									// Indicates if parsed meshes are reordered with OptimizeMesh
+	bool buildLods = true;									// Indicates if parsed meshes get simplified levels of detail
+	bool buildMeshlets = true;								// Indicates if parsed meshes are split into meshlets with BuildMeshlets
+	ThreadPool* threadPool = nullptr;						// Optional worker threads used to parse large .obj files
+	ObjFileReading reading = ObjFileReading::MemoryMapped;	// How the .obj text is brought into memory
+};
+
+/// <summary>
+/// Statistics about loading a 3D model
+/// </summary>
+struct MeshLoadStats
+{
+	bool fromCooked = false;	// Indicates if the geometry came from a cooked mesh
+	bool fromCache = false;		// Indicates if the geometry came from a valid binary mesh cache
+	bool cacheWritten = false;	// Indicates if a new binary mesh cache was written
+	std::size_t bytes = 0;		// Size of the file the geometry came from
+	double seconds = 0.0;		// Total time spent loading
+	ObjLoadStats obj;			// Statistics about the .obj file (only filled if it was parsed)
+	bool optimized = false;		// Indicates if the parsed mesh was reordered with OptimizeMesh
+	MeshOptimizationStats optimization;	// Vertex cache statistics of the reordering (only filled if optimized)
+	bool lodsBuilt = false;		// Indicates if the levels of detail of the parsed mesh were built
+	double lodSeconds = 0.0;	// Time spent building the levels of detail
+	bool meshletsBuilt = false;	// Indicates if the parsed mesh was split into meshlets
+	double meshletSeconds = 0.0;	// Time spent building the meshlets
+};
+
+/// <summary>
+/// Path of the binary mesh cache that belongs to an .obj file.
+/// </summary>
+/// <param name="objFilePath">Path to the .obj file</param>
+/// <returns>Path to the binary mesh cache, next to the .obj file</returns>
+std::string GetMeshCachePath(const std::string& objFilePath);
+
+/// <summary>
+/// Loads a 3D model from its binary mesh cache when the cache is still valid, otherwise parses the
+/// .obj file and writes a new cache next to it. The cache records the size, modification time and
+/// hash of the .obj file; a cache whose size or time no longer match is only used if the hash
+/// of the .obj file still matches. A cooked mesh in settings.archive comes before either,
+/// as long as the settings ask for optimized meshes with levels of detail and meshlets (which is how meshes are cooked).
+/// </summary>
+/// <param name="objFilePath">Path to the .obj file</param>
+/// <param name="mesh">Receives the geometry of the model</param>
+/// <param name="settings">Settings for loading the model</param>
+/// <param name="stats">Optionally receives statistics about the loading</param>
+/// <returns>True if the model was loaded successfully</returns>
+bool LoadMesh(const std::string& objFilePath, LoadedMesh& mesh, const MeshLoadSettings& settings, MeshLoadStats* stats = nullptr);
+
+/// <summary>
+/// Parses an .obj file, reorders it with OptimizeMesh, builds its levels of detail and meshlets and writes the result in the
+/// binary mesh cache format, to be packed into the asset archive and read with LoadCookedMesh.
+/// </summary>
+/// <param name="objFilePath">Path to the .obj file</param>
+/// <param name="cookedFilePath">Path to the cooked mesh to write</param>
+/// <param name="sourceHash">HashBytes of the contents of the .obj file, recorded in the cooked mesh</param>
+/// <param name="threadPool">Optional worker threads used to parse large .obj files</param>
+/// <param name="stats">Optionally receives statistics about parsing and optimizing the model</param>
+/// <returns>True if the mesh was cooked successfully</returns>
+bool CookMesh(const std::string& objFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash,
+	ThreadPool* threadPool, MeshLoadStats* stats = nullptr);
+
+/// <summary>
+/// Memory-maps a mesh written by CookMesh. Unlike a mesh cache, a cooked mesh is used without looking at its .obj file.
+/// </summary>
+/// <param name="cookedFilePath">Path to the cooked mesh</param>
+/// <param name="mesh">Receives the geometry of the model</param>
+/// <returns>True if the mesh was loaded successfully</returns>
+bool LoadCookedMesh(const std::string& cookedFilePath, LoadedMesh& mesh);
+
+/// <summary>
+/// Reads a mesh written by CookMesh from an asset archive, without looking at its .obj file.
+/// Uncompressed meshes are used straight out of the archive's mapping.
+/// </summary>
+/// <param name="archive">Archive of cooked assets</param>
+/// <param name="name">Name of the cooked mesh in the archive (see GetCookedAssetName)</param>
+/// <param name="mesh">Receives the geometry of the model</param>
+/// <returns>True if the mesh was loaded successfully</returns>
+bool LoadCookedMesh(AssetArchive& archive, const std::string& name, LoadedMesh& mesh);
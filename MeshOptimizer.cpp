@@ -0,0 +1,402 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	const GLuint NoIndex = std::numeric_limits<GLuint>::max();
+
+	// Constants of Forsyth's vertex scoring
+	const int ForsythCacheSize = 32;
+	const int ForsythMaxValence = 32;
+	const float CacheDecayPower = 1.5f;
+	const float LastTriangleScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+
+	/// <summary>
+	/// Lookup tables for the two parts of Forsyth's vertex score
+	/// </summary>
+	struct ForsythScoreTables
+	{
+		float cache[ForsythCacheSize];
+		float valence[ForsythMaxValence + 1];
+
+		ForsythScoreTables()
+		{
+			for (int i = 0; i < ForsythCacheSize; i++)
+			{
+				// The three vertices of the last triangle get a fixed score, so the next triangle
+				// does not simply keep walking along the last one in a strip
+				cache[i] = i < 3 ? LastTriangleScore
+					: std::pow(1.0f - static_cast<float>(i - 3) / (ForsythCacheSize - 3), CacheDecayPower);
+			}
+
+			valence[0] = 0.0f;
+			for (int i = 1; i <= ForsythMaxValence; i++)
+			{
+				// Vertices with few triangles left are boosted, so they get finished off instead of left stranded
+				valence[i] = ValenceBoostScale * std::pow(static_cast<float>(i), -ValenceBoostPower);
+			}
+		}
+	};
+
+	float VertexScore(const ForsythScoreTables& tables, int cachePosition, unsigned int remainingValence)
+	{
+		if (remainingValence == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = tables.valence[std::min<unsigned int>(remainingValence, ForsythMaxValence)];
+		if (cachePosition >= 0)
+		{
+			score += tables.cache[cachePosition];
+		}
+		return score;
+	}
+
+	/// <summary>
+	/// Triangles that use each vertex, stored as one list per vertex inside a single array
+	/// </summary>
+	struct VertexTriangles
+	{
+		std::vector<GLuint> offsets;	// Start of the list of each vertex
+		std::vector<GLuint> counts;		// Length of the list of each vertex
+		std::vector<GLuint> triangles;
+
+		VertexTriangles(const GLuint* indices, std::size_t indexCount, std::size_t vertexCount)
+			: offsets(vertexCount + 1, 0), counts(vertexCount, 0), triangles(indexCount)
+		{
+			for (std::size_t i = 0; i < indexCount; i++)
+			{
+				counts[indices[i]]++;
+			}
+			for (std::size_t v = 0; v < vertexCount; v++)
+			{
+				offsets[v + 1] = offsets[v] + counts[v];
+			}
+
+			std::fill(counts.begin(), counts.end(), 0);
+			for (std::size_t i = 0; i < indexCount; i++)
+			{
+				GLuint vertex = indices[i];
+				triangles[offsets[vertex] + counts[vertex]++] = static_cast<GLuint>(i / 3);
+			}
+		}
+
+		void Remove(GLuint vertex, GLuint triangle)
+		{
+			GLuint* list = &triangles[offsets[vertex]];
+			for (GLuint i = 0; i < counts[vertex]; i++)
+			{
+				if (list[i] == triangle)
+				{
+					list[i] = list[--counts[vertex]];
+					return;
+				}
+			}
+		}
+	};
+}
+
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, std::size_t indexCount, std::size_t vertexCount, std::size_t cacheSize)
+{
+	VertexCacheStats stats;
+	if (indexCount == 0 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	// Each vertex remembers when it entered the FIFO; it is still cached while fewer than
+	// cacheSize other vertices entered after it
+	std::vector<std::size_t> entryTime(vertexCount, 0);
+	std::size_t time = 0;
+	std::size_t misses = 0;
+
+	for (std::size_t i = 0; i < indexCount; i++)
+	{
+		GLuint vertex = indices[i];
+		if (entryTime[vertex] == 0 || time - entryTime[vertex] >= cacheSize)
+		{
+			time++;
+			entryTime[vertex] = time;
+			misses++;
+		}
+	}
+
+	stats.acmr = static_cast<double>(misses) / static_cast<double>(indexCount / 3);
+	stats.atvr = static_cast<double>(misses) / static_cast<double>(vertexCount);
+	return stats;
+}
+
+void OptimizeVertexCache(GLuint* indices, std::size_t indexCount, std::size_t vertexCount)
+{
+	std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	static const ForsythScoreTables tables;
+
+	VertexTriangles vertexTriangles(indices, indexCount, vertexCount);
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScore[v] = VertexScore(tables, -1, vertexTriangles.counts[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	GLuint bestTriangle = 0;
+	for (std::size_t t = 0; t < triangleCount; t++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triangleScore[t] > triangleScore[bestTriangle])
+		{
+			bestTriangle = static_cast<GLuint>(t);
+		}
+	}
+
+	// The cache holds up to three extra entries while the vertices of a new triangle are pushed in
+	GLuint cache[ForsythCacheSize + 3];
+	GLuint newCache[ForsythCacheSize + 3];
+	int cacheCount = 0;
+
+	std::vector<GLuint> output(indexCount);
+	std::size_t deadEndCursor = 0;
+
+	for (std::size_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+	{
+		// When no cached vertex has triangles left, continue from the first triangle not drawn yet
+		if (bestTriangle == NoIndex)
+		{
+			while (emitted[deadEndCursor])
+			{
+				deadEndCursor++;
+			}
+			bestTriangle = static_cast<GLuint>(deadEndCursor);
+		}
+
+		const GLuint* triangle = &indices[bestTriangle * 3];
+		output[outputTriangle * 3] = triangle[0];
+		output[outputTriangle * 3 + 1] = triangle[1];
+		output[outputTriangle * 3 + 2] = triangle[2];
+		emitted[bestTriangle] = true;
+
+		// Push the vertices of the triangle to the front of the cache
+		int newCacheCount = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			vertexTriangles.Remove(triangle[k], bestTriangle);
+			newCache[newCacheCount++] = triangle[k];
+		}
+		for (int i = 0; i < cacheCount; i++)
+		{
+			GLuint vertex = cache[i];
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		// Rescore every vertex that is, or just was, in the cache, and the triangles they still have left
+		for (int i = 0; i < newCacheCount; i++)
+		{
+			GLuint vertex = newCache[i];
+			cachePosition[vertex] = i < ForsythCacheSize ? i : -1;
+
+			float newScore = VertexScore(tables, cachePosition[vertex], vertexTriangles.counts[vertex]);
+			float scoreChange = newScore - vertexScore[vertex];
+			vertexScore[vertex] = newScore;
+
+			const GLuint* remaining = &vertexTriangles.triangles[vertexTriangles.offsets[vertex]];
+			for (GLuint j = 0; j < vertexTriangles.counts[vertex]; j++)
+			{
+				triangleScore[remaining[j]] += scoreChange;
+			}
+		}
+
+		// The next triangle is the best one among those that use a cached vertex
+		bestTriangle = NoIndex;
+		float bestScore = -1.0f;
+		for (int i = 0; i < std::min(newCacheCount, ForsythCacheSize); i++)
+		{
+			GLuint vertex = newCache[i];
+			const GLuint* remaining = &vertexTriangles.triangles[vertexTriangles.offsets[vertex]];
+			for (GLuint j = 0; j < vertexTriangles.counts[vertex]; j++)
+			{
+				if (triangleScore[remaining[j]] > bestScore)
+				{
+					bestScore = triangleScore[remaining[j]];
+					bestTriangle = remaining[j];
+				}
+			}
+		}
+
+		cacheCount = std::min(newCacheCount, ForsythCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeOverdraw(GLuint* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount)
+{
+	std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// A cluster starts at every triangle whose three vertices all miss the cache
+	std::vector<std::size_t> clusterStarts;
+	{
+		const std::size_t CacheSize = 16;
+		std::vector<std::size_t> entryTime(vertexCount, 0);
+		std::size_t time = 0;
+
+		for (std::size_t t = 0; t < triangleCount; t++)
+		{
+			int misses = 0;
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint vertex = indices[t * 3 + k];
+				if (entryTime[vertex] == 0 || time - entryTime[vertex] >= CacheSize)
+				{
+					time++;
+					entryTime[vertex] = time;
+					misses++;
+				}
+			}
+
+			if (t == 0 || misses == 3)
+			{
+				clusterStarts.push_back(t);
+			}
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+
+	std::size_t clusterCount = clusterStarts.size() - 1;
+	if (clusterCount < 2)
+	{
+		return;
+	}
+
+	// Area-weighted centroid and normal of every cluster, and centroid of the whole mesh
+	std::vector<float> clusterData(clusterCount * 6, 0.0f);
+	double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+
+	for (std::size_t c = 0; c < clusterCount; c++)
+	{
+		double centroid[3] = { 0.0, 0.0, 0.0 };
+		double normal[3] = { 0.0, 0.0, 0.0 };
+		double clusterArea = 0.0;
+
+		for (std::size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			const Vertex& a = vertices[indices[t * 3]];
+			const Vertex& b = vertices[indices[t * 3 + 1]];
+			const Vertex& d = vertices[indices[t * 3 + 2]];
+
+			double ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+			double ad[3] = { d.x - a.x, d.y - a.y, d.z - a.z };
+			double cross[3] = { ab[1] * ad[2] - ab[2] * ad[1], ab[2] * ad[0] - ab[0] * ad[2], ab[0] * ad[1] - ab[1] * ad[0] };
+			double area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
+
+			centroid[0] += (a.x + b.x + d.x) / 3.0 * area;
+			centroid[1] += (a.y + b.y + d.y) / 3.0 * area;
+			centroid[2] += (a.z + b.z + d.z) / 3.0 * area;
+			normal[0] += cross[0];
+			normal[1] += cross[1];
+			normal[2] += cross[2];
+			clusterArea += area;
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			meshCentroid[k] += centroid[k];
+		}
+		meshArea += clusterArea;
+
+		double normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		for (int k = 0; k < 3; k++)
+		{
+			clusterData[c * 6 + k] = clusterArea > 0.0 ? static_cast<float>(centroid[k] / clusterArea) : 0.0f;
+			clusterData[c * 6 + 3 + k] = normalLength > 0.0 ? static_cast<float>(normal[k] / normalLength) : 0.0f;
+		}
+	}
+
+	if (meshArea > 0.0)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			meshCentroid[k] /= meshArea;
+		}
+	}
+
+	// Clusters that face away from the center of the mesh the most are drawn first
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<std::size_t> order(clusterCount);
+	for (std::size_t c = 0; c < clusterCount; c++)
+	{
+		const float* data = &clusterData[c * 6];
+		sortKeys[c] = static_cast<float>((data[0] - meshCentroid[0]) * data[3] + (data[1] - meshCentroid[1]) * data[4] + (data[2] - meshCentroid[2]) * data[5]);
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](std::size_t a, std::size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<GLuint> output;
+	output.reserve(indexCount);
+	for (std::size_t c : order)
+	{
+		output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+	}
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeVertexFetch(MeshData& mesh)
+{
+	std::vector<GLuint> remap(mesh.vertices.size(), NoIndex);
+	std::vector<Vertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (GLuint& index : mesh.indices)
+	{
+		if (remap[index] == NoIndex)
+		{
+			remap[index] = static_cast<GLuint>(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+void OptimizeMesh(MeshData& mesh, MeshOptimizationStats* stats)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	VertexCacheStats before = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+
+	OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+	OptimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(), mesh.vertices.size());
+	OptimizeVertexFetch(mesh);
+
+	if (stats != nullptr)
+	{
+		stats->before = before;
+		stats->after = AnalyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+		stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+}
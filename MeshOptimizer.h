@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+
+/// <summary>
+/// How well an index buffer uses the post-transform vertex cache
+/// </summary>
+struct VertexCacheStats
+{
+	double acmr = 0.0;	// Average cache miss ratio: vertex shader runs per triangle (0.5 is ideal, 3 is worst)
+	double atvr = 0.0;	// Average transformed vertex ratio: vertex shader runs per vertex (1 is ideal)
+};
+
+/// <summary>
+/// Vertex cache statistics of a mesh before and after MeshOptimizer reordered it
+/// </summary>
+struct MeshOptimizationStats
+{
+	VertexCacheStats before;
+	VertexCacheStats after;
+	double seconds = 0.0;	// Time spent optimizing
+};
+
+/// <summary>
+/// Simulates a FIFO post-transform vertex cache over an index buffer.
+/// </summary>
+/// <param name="indices">Index buffer (three indices per triangle)</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertexCount">Number of vertices the indices refer to</param>
+/// <param name="cacheSize">Number of entries of the simulated cache</param>
+/// <returns>Cache statistics of the index buffer</returns>
+VertexCacheStats AnalyzeVertexCache(const GLuint* indices, std::size_t indexCount, std::size_t vertexCount, std::size_t cacheSize = 16);
+
+/// <summary>
+/// Reorders the triangles of an index buffer so consecutive triangles reuse recently transformed vertices,
+/// using Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".
+/// </summary>
+/// <param name="indices">Index buffer to reorder in place (three indices per triangle)</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertexCount">Number of vertices the indices refer to</param>
+void OptimizeVertexCache(GLuint* indices, std::size_t indexCount, std::size_t vertexCount);
+
+/// <summary>
+/// Reorders clusters of triangles of a vertex cache optimized index buffer so the triangles that face away
+/// from the center of the mesh (and so tend to hide the others) are drawn first. The clusters start where
+/// the vertex cache starts cold anyway, so the vertex cache efficiency is kept.
+/// </summary>
+/// <param name="indices">Index buffer to reorder in place (three indices per triangle)</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertices">Vertices the indices refer to</param>
+/// <param name="vertexCount">Number of vertices</param>
+void OptimizeOverdraw(GLuint* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount);
+
+/// <summary>
+/// Reorders the vertices in the order the index buffer first uses them, so vertex fetches walk through
+/// memory mostly forward, and drops vertices that no triangle uses.
+/// </summary>
+/// <param name="mesh">Mesh whose vertices and indices are reordered</param>
+void OptimizeVertexFetch(MeshData& mesh);
+
+/// <summary>
+/// Runs the vertex cache, overdraw and vertex fetch optimizations on a mesh, in that order.
+/// </summary>
+/// <param name="mesh">Mesh to optimize</param>
+/// <param name="stats">Optionally receives the vertex cache statistics before and after</param>
+void OptimizeMesh(MeshData& mesh, MeshOptimizationStats* stats = nullptr);
@@ -0,0 +1,747 @@
+#include "MeshSimplifier.h"
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <unordered_set>
+
+namespace
+{
+	const GLuint NoVertex = std::numeric_limits<GLuint>::max();
+
+	/// <summary>
+	/// Weight of the planes that hold open borders in place, relative to the planes of the triangles
+	/// </summary>
+	const double BorderWeight = 10.0;
+
+	/// <summary>
+	/// Smallest cosine of the angle a triangle's normal may turn by in a collapse (larger turns are taken as flips)
+	/// </summary>
+	const double MinNormalCosine = 0.25;
+
+	/// <summary>
+	/// A pass only performs the collapses whose error is at most this many times the error of the
+	/// collapse that would reach the target, so the cheap collapses are not crowded out by expensive ones
+	/// </summary>
+	const double PassErrorSlack = 1.5;
+
+	/// <summary>
+	/// Each level of detail aims for this fraction of the triangles of the level before
+	/// </summary>
+	const double LodTriangleRatio = 0.5;
+
+	/// <summary>
+	/// A level of detail is only kept if it has at most this fraction of the triangles of the level before
+	/// </summary>
+	const double MaxKeptLodRatio = 0.9;
+
+	/// <summary>
+	/// Sum of the squared distances to a set of weighted planes, as a symmetric 4x4 matrix
+	/// </summary>
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void AddPlane(const double normal[3], double distance, double planeWeight)
+		{
+			a00 += normal[0] * normal[0] * planeWeight;
+			a01 += normal[0] * normal[1] * planeWeight;
+			a02 += normal[0] * normal[2] * planeWeight;
+			a11 += normal[1] * normal[1] * planeWeight;
+			a12 += normal[1] * normal[2] * planeWeight;
+			a22 += normal[2] * normal[2] * planeWeight;
+			b0 += normal[0] * distance * planeWeight;
+			b1 += normal[1] * distance * planeWeight;
+			b2 += normal[2] * distance * planeWeight;
+			c += distance * distance * planeWeight;
+			weight += planeWeight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		/// <summary>
+		/// Weighted mean of the squared distances from a point to the planes.
+		/// </summary>
+		double Evaluate(const double point[3]) const
+		{
+			const double x = point[0], y = point[1], z = point[2];
+			double sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0.0 ? std::max(0.0, sum) / weight : 0.0;
+		}
+	};
+
+	/// <summary>
+	/// How a position may move when it is collapsed
+	/// </summary>
+	enum class VertexKind : unsigned char
+	{
+		Manifold,	// Inside the surface with a single set of attributes: may collapse onto any neighbor
+		Border,		// On an open border: may only collapse along the border
+		Seam,		// On a UV or normal seam (two sets of attributes): may only collapse along the seam
+		Locked		// Where borders or seams meet, or anything more complicated: never collapses
+	};
+
+	/// <summary>
+	/// Candidate collapse of every corner at one position onto a neighboring position
+	/// </summary>
+	struct Collapse
+	{
+		GLuint from;
+		GLuint to;
+		double error;
+	};
+
+	void GetPosition(const Vertex& vertex, double position[3])
+	{
+		position[0] = vertex.x;
+		position[1] = vertex.y;
+		position[2] = vertex.z;
+	}
+
+	void Cross(const double a[3], const double b[3], double result[3])
+	{
+		result[0] = a[1] * b[2] - a[2] * b[1];
+		result[1] = a[2] * b[0] - a[0] * b[2];
+		result[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	double Dot(const double a[3], const double b[3])
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	void TriangleNormal(const double p0[3], const double p1[3], const double p2[3], double normal[3])
+	{
+		const double edge1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const double edge2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		Cross(edge1, edge2, normal);
+	}
+
+	bool SameAttributes(const Vertex& a, const Vertex& b)
+	{
+		return a.u == b.u && a.v == b.v && a.nx == b.nx && a.ny == b.ny && a.nz == b.nz
+			&& a.r == b.r && a.g == b.g && a.b == b.b;
+	}
+
+	std::uint64_t EdgeKey(GLuint from, GLuint to)
+	{
+		return (static_cast<std::uint64_t>(from) << 32) | to;
+	}
+
+	/// <summary>
+	/// Gives every vertex the index of the first vertex at exactly the same position, and of the first vertex
+	/// with the same position and attributes (the .obj file may repeat equal UV coordinates and normals under
+	/// different indices), and links the vertices of each position into a ring.
+	/// </summary>
+	void WeldPositions(const Vertex* vertices, std::size_t vertexCount, std::vector<GLuint>& positionOf,
+		std::vector<GLuint>& attributesOf, std::vector<GLuint>& nextAtPosition)
+	{
+		auto positionBits = [vertices](GLuint vertex)
+		{
+			std::uint32_t bits[3];
+			std::memcpy(&bits[0], &vertices[vertex].x, sizeof(bits[0]));
+			std::memcpy(&bits[1], &vertices[vertex].y, sizeof(bits[1]));
+			std::memcpy(&bits[2], &vertices[vertex].z, sizeof(bits[2]));
+			return std::make_tuple(bits[0], bits[1], bits[2]);
+		};
+
+		std::vector<GLuint> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&positionBits](GLuint a, GLuint b)
+		{
+			return positionBits(a) < positionBits(b) || (positionBits(a) == positionBits(b) && a < b);
+		});
+
+		positionOf.assign(vertexCount, NoVertex);
+		attributesOf.assign(vertexCount, NoVertex);
+		nextAtPosition.assign(vertexCount, NoVertex);
+
+		for (std::size_t begin = 0; begin < vertexCount;)
+		{
+			std::size_t end = begin + 1;
+			while (end < vertexCount && positionBits(order[end]) == positionBits(order[begin]))
+			{
+				end++;
+			}
+
+			for (std::size_t i = begin; i < end; i++)
+			{
+				positionOf[order[i]] = order[begin];
+				nextAtPosition[order[i]] = order[i + 1 < end ? i + 1 : begin];
+
+				attributesOf[order[i]] = order[i];
+				for (std::size_t j = begin; j < i; j++)
+				{
+					if (SameAttributes(vertices[order[j]], vertices[order[i]]))
+					{
+						attributesOf[order[i]] = attributesOf[order[j]];
+						break;
+					}
+				}
+			}
+			begin = end;
+		}
+	}
+
+	/// <summary>
+	/// Triangles around each position, stored as one list per position inside a single array
+	/// </summary>
+	struct PositionTriangles
+	{
+		std::vector<GLuint> offsets;
+		std::vector<GLuint> triangles;
+
+		PositionTriangles(const std::vector<GLuint>& indices, const std::vector<GLuint>& positionOf)
+			: offsets(positionOf.size() + 1, 0), triangles(indices.size())
+		{
+			for (GLuint index : indices)
+			{
+				offsets[positionOf[index] + 1]++;
+			}
+			for (std::size_t p = 0; p < positionOf.size(); p++)
+			{
+				offsets[p + 1] += offsets[p];
+			}
+
+			std::vector<GLuint> filled(offsets.begin(), offsets.end() - 1);
+			for (std::size_t i = 0; i < indices.size(); i++)
+			{
+				triangles[filled[positionOf[indices[i]]]++] = static_cast<GLuint>(i / 3);
+			}
+		}
+
+		const GLuint* begin(GLuint position) const { return triangles.data() + offsets[position]; }
+		const GLuint* end(GLuint position) const { return triangles.data() + offsets[position + 1]; }
+	};
+
+	void RemoveDegenerateTriangles(std::vector<GLuint>& indices, const std::vector<GLuint>& positionOf)
+	{
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < indices.size(); i += 3)
+		{
+			GLuint a = positionOf[indices[i]], b = positionOf[indices[i + 1]], c = positionOf[indices[i + 2]];
+			if (a != b && b != c && c != a)
+			{
+				indices[kept] = indices[i];
+				indices[kept + 1] = indices[i + 1];
+				indices[kept + 2] = indices[i + 2];
+				kept += 3;
+			}
+		}
+		indices.resize(kept);
+	}
+
+	/// <summary>
+	/// Mesh being simplified, with everything the collapses need to know about it
+	/// </summary>
+	struct Simplification
+	{
+		const Vertex* vertices;
+		std::vector<GLuint> indices;
+		std::vector<GLuint> positionOf;			// First vertex at the same position as each vertex
+		std::vector<GLuint> attributesOf;		// First vertex with the same position and attributes as each vertex
+		std::vector<GLuint> nextAtPosition;		// Next vertex in the ring of vertices at the same position
+		std::vector<VertexKind> kinds;			// Kind of each position
+		std::vector<Quadric> quadrics;			// Planes accumulated at each position
+		std::unordered_set<std::uint64_t> openEdges;	// Edges between positions used by a single triangle, in their triangle's winding
+
+		// State of the current pass
+		std::vector<GLuint> vertexTarget;		// Vertex each vertex moves to at the end of the pass
+		std::vector<unsigned char> locked;		// Positions that already took part in a collapse this pass
+
+		bool IsOpen(GLuint a, GLuint b) const
+		{
+			return openEdges.count(EdgeKey(a, b)) != 0 || openEdges.count(EdgeKey(b, a)) != 0;
+		}
+
+		bool CanCollapse(GLuint from, GLuint to) const
+		{
+			switch (kinds[from])
+			{
+			case VertexKind::Manifold:
+				return true;
+			case VertexKind::Border:
+				return (kinds[to] == VertexKind::Border || kinds[to] == VertexKind::Locked) && IsOpen(from, to);
+			case VertexKind::Seam:
+				return kinds[to] == VertexKind::Seam || kinds[to] == VertexKind::Locked;
+			default:
+				return false;
+			}
+		}
+
+		double CollapseError(GLuint from, GLuint to) const
+		{
+			Quadric quadric = quadrics[from];
+			quadric.Add(quadrics[to]);
+			double position[3];
+			GetPosition(vertices[to], position);
+			return quadric.Evaluate(position);
+		}
+
+		void CurrentPosition(GLuint vertex, double position[3]) const
+		{
+			GetPosition(vertices[vertexTarget[vertex]], position);
+		}
+	};
+
+	void Classify(Simplification& mesh, std::size_t vertexCount)
+	{
+		std::unordered_set<std::uint64_t> edges;
+		edges.reserve(mesh.indices.size());
+		for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				edges.insert(EdgeKey(mesh.positionOf[mesh.indices[i + k]], mesh.positionOf[mesh.indices[i + (k + 1) % 3]]));
+			}
+		}
+
+		std::vector<unsigned int> openEdgeCount(vertexCount, 0);
+		for (std::uint64_t edge : edges)
+		{
+			GLuint from = static_cast<GLuint>(edge >> 32);
+			GLuint to = static_cast<GLuint>(edge & 0xFFFFFFFFu);
+			if (edges.count(EdgeKey(to, from)) == 0)
+			{
+				mesh.openEdges.insert(edge);
+				openEdgeCount[from]++;
+				openEdgeCount[to]++;
+			}
+		}
+
+		// Only the attributes some triangle uses count as attribute sets of their position
+		std::vector<unsigned char> used(vertexCount, 0);
+		for (GLuint index : mesh.indices)
+		{
+			used[mesh.attributesOf[index]] = 1;
+		}
+
+		mesh.kinds.assign(vertexCount, VertexKind::Locked);
+		for (std::size_t v = 0; v < vertexCount; v++)
+		{
+			if (mesh.positionOf[v] != v)
+			{
+				continue;
+			}
+
+			unsigned int attributeSets = 0;
+			GLuint vertex = static_cast<GLuint>(v);
+			do
+			{
+				attributeSets += used[vertex];
+				vertex = mesh.nextAtPosition[vertex];
+			} while (vertex != v);
+
+			if (openEdgeCount[v] == 0 && attributeSets == 1)
+			{
+				mesh.kinds[v] = VertexKind::Manifold;
+			}
+			else if (openEdgeCount[v] == 0 && attributeSets == 2)
+			{
+				mesh.kinds[v] = VertexKind::Seam;
+			}
+			else if (openEdgeCount[v] == 2 && attributeSets == 1)
+			{
+				mesh.kinds[v] = VertexKind::Border;
+			}
+		}
+	}
+
+	void FillQuadrics(Simplification& mesh, std::size_t vertexCount)
+	{
+		mesh.quadrics.assign(vertexCount, Quadric());
+
+		for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			GLuint corners[3] = { mesh.positionOf[mesh.indices[i]], mesh.positionOf[mesh.indices[i + 1]], mesh.positionOf[mesh.indices[i + 2]] };
+			double points[3][3];
+			for (int k = 0; k < 3; k++)
+			{
+				GetPosition(mesh.vertices[corners[k]], points[k]);
+			}
+
+			double normal[3];
+			TriangleNormal(points[0], points[1], points[2], normal);
+			double length = std::sqrt(Dot(normal, normal));
+			if (length == 0.0)
+			{
+				continue;
+			}
+			normal[0] /= length;
+			normal[1] /= length;
+			normal[2] /= length;
+
+			// Each triangle's plane is weighted by its area
+			double distance = -Dot(normal, points[0]);
+			for (int k = 0; k < 3; k++)
+			{
+				mesh.quadrics[corners[k]].AddPlane(normal, distance, length * 0.5);
+			}
+
+			// Open edges also get a plane standing on them at a right angle to the triangle, which keeps the border from shrinking
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint from = corners[k];
+				GLuint to = corners[(k + 1) % 3];
+				if (mesh.openEdges.count(EdgeKey(from, to)) == 0)
+				{
+					continue;
+				}
+
+				const double* start = points[k];
+				const double* end = points[(k + 1) % 3];
+				const double edge[3] = { end[0] - start[0], end[1] - start[1], end[2] - start[2] };
+				double borderNormal[3];
+				Cross(edge, normal, borderNormal);
+				double borderLength = std::sqrt(Dot(borderNormal, borderNormal));
+				if (borderLength == 0.0)
+				{
+					continue;
+				}
+				borderNormal[0] /= borderLength;
+				borderNormal[1] /= borderLength;
+				borderNormal[2] /= borderLength;
+
+				double borderDistance = -Dot(borderNormal, start);
+				double borderWeight = Dot(edge, edge) * BorderWeight;
+				mesh.quadrics[from].AddPlane(borderNormal, borderDistance, borderWeight);
+				mesh.quadrics[to].AddPlane(borderNormal, borderDistance, borderWeight);
+			}
+		}
+	}
+
+	std::vector<Collapse> FindCollapses(const Simplification& mesh)
+	{
+		std::vector<Collapse> collapses;
+		collapses.reserve(mesh.indices.size());
+
+		for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint a = mesh.positionOf[mesh.indices[i + k]];
+				GLuint b = mesh.positionOf[mesh.indices[i + (k + 1) % 3]];
+
+				// Each edge is seen from both of its triangles, so it is only taken from the one where a < b,
+				// except for open edges, which only have one triangle
+				if (a > b && mesh.openEdges.count(EdgeKey(a, b)) == 0)
+				{
+					continue;
+				}
+
+				bool forward = mesh.CanCollapse(a, b);
+				bool backward = mesh.CanCollapse(b, a);
+				double forwardError = forward ? mesh.CollapseError(a, b) : 0.0;
+				double backwardError = backward ? mesh.CollapseError(b, a) : 0.0;
+
+				if (forward && (!backward || forwardError <= backwardError))
+				{
+					collapses.push_back({ a, b, forwardError });
+				}
+				else if (backward)
+				{
+					collapses.push_back({ b, a, backwardError });
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+		return collapses;
+	}
+
+	/// <summary>
+	/// Picks, for every set of attributes at the collapsing position, the vertex at the target position its
+	/// vertices move to: the one they share a triangle with. Fails if some set has no such partner, or partners
+	/// with different attributes, which is what keeps seams from moving away from themselves.
+	/// </summary>
+	bool MapVertices(Simplification& mesh, const PositionTriangles& adjacency, GLuint from, GLuint to)
+	{
+		GLuint attributes = from;
+		do
+		{
+			if (mesh.attributesOf[attributes] != attributes)
+			{
+				attributes = mesh.nextAtPosition[attributes];
+				continue;
+			}
+
+			GLuint target = NoVertex;
+			bool usedAttributes = false;
+			for (const GLuint* triangle = adjacency.begin(from); triangle != adjacency.end(from); triangle++)
+			{
+				const GLuint* corners = &mesh.indices[*triangle * 3];
+				if (mesh.attributesOf[corners[0]] != attributes && mesh.attributesOf[corners[1]] != attributes
+					&& mesh.attributesOf[corners[2]] != attributes)
+				{
+					continue;
+				}
+				usedAttributes = true;
+
+				for (int k = 0; k < 3; k++)
+				{
+					if (mesh.positionOf[corners[k]] != to)
+					{
+						continue;
+					}
+					if (target != NoVertex && mesh.attributesOf[target] != mesh.attributesOf[corners[k]])
+					{
+						return false;
+					}
+					target = corners[k];
+				}
+			}
+
+			if (usedAttributes && target == NoVertex)
+			{
+				return false;
+			}
+
+			if (target != NoVertex)
+			{
+				GLuint vertex = from;
+				do
+				{
+					if (mesh.attributesOf[vertex] == attributes)
+					{
+						mesh.vertexTarget[vertex] = target;
+					}
+					vertex = mesh.nextAtPosition[vertex];
+				} while (vertex != from);
+			}
+
+			attributes = mesh.nextAtPosition[attributes];
+		} while (attributes != from);
+
+		return true;
+	}
+
+	void UndoMapVertices(Simplification& mesh, GLuint from)
+	{
+		GLuint vertex = from;
+		do
+		{
+			mesh.vertexTarget[vertex] = vertex;
+			vertex = mesh.nextAtPosition[vertex];
+		} while (vertex != from);
+	}
+
+	/// <summary>
+	/// Checks if moving a position onto another would turn one of the triangles around it over.
+	/// </summary>
+	bool FlipsTriangle(const Simplification& mesh, const PositionTriangles& adjacency, GLuint from, GLuint to)
+	{
+		double targetPosition[3];
+		GetPosition(mesh.vertices[to], targetPosition);
+
+		for (const GLuint* triangle = adjacency.begin(from); triangle != adjacency.end(from); triangle++)
+		{
+			const GLuint* corners = &mesh.indices[*triangle * 3];
+			double before[3][3];
+			double after[3][3];
+			bool collapses = false;
+			for (int k = 0; k < 3; k++)
+			{
+				if (mesh.positionOf[corners[k]] == from)
+				{
+					GetPosition(mesh.vertices[from], before[k]);
+					std::memcpy(after[k], targetPosition, sizeof(after[k]));
+				}
+				else
+				{
+					// Neighbors may already have moved in this pass
+					collapses = collapses || mesh.positionOf[mesh.vertexTarget[corners[k]]] == to;
+					mesh.CurrentPosition(corners[k], before[k]);
+					std::memcpy(after[k], before[k], sizeof(after[k]));
+				}
+			}
+
+			// The triangles along the collapsing edge disappear, so they cannot flip
+			if (collapses)
+			{
+				continue;
+			}
+
+			double normalBefore[3], normalAfter[3];
+			TriangleNormal(before[0], before[1], before[2], normalBefore);
+			TriangleNormal(after[0], after[1], after[2], normalAfter);
+			double lengths = std::sqrt(Dot(normalBefore, normalBefore) * Dot(normalAfter, normalAfter));
+			if (lengths == 0.0)
+			{
+				continue;
+			}
+			if (Dot(normalBefore, normalAfter) < MinNormalCosine * lengths)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Moves the open edges of a border position that collapsed onto its target, so the new border edges stay open.
+	/// </summary>
+	void MoveOpenEdges(Simplification& mesh, const PositionTriangles& adjacency, GLuint from, GLuint to)
+	{
+		for (const GLuint* triangle = adjacency.begin(from); triangle != adjacency.end(from); triangle++)
+		{
+			const GLuint* corners = &mesh.indices[*triangle * 3];
+			for (int k = 0; k < 3; k++)
+			{
+				GLuint a = mesh.positionOf[corners[k]];
+				GLuint b = mesh.positionOf[corners[(k + 1) % 3]];
+				if ((a == from || b == from) && mesh.openEdges.count(EdgeKey(a, b)) != 0)
+				{
+					mesh.openEdges.insert(EdgeKey(a == from ? to : a, b == from ? to : b));
+				}
+			}
+		}
+	}
+}
+
+std::vector<GLuint> SimplifyMesh(const GLuint* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount,
+	std::size_t targetIndexCount, float* error)
+{
+	Simplification mesh;
+	mesh.vertices = vertices;
+	mesh.indices.assign(indices, indices + indexCount);
+
+	WeldPositions(vertices, vertexCount, mesh.positionOf, mesh.attributesOf, mesh.nextAtPosition);
+	RemoveDegenerateTriangles(mesh.indices, mesh.positionOf);
+	Classify(mesh, vertexCount);
+	FillQuadrics(mesh, vertexCount);
+
+	mesh.vertexTarget.resize(vertexCount);
+	mesh.locked.resize(vertexCount);
+	double largestError = 0.0;
+
+	// Each pass collapses the cheapest edges that do not touch each other, then rebuilds the triangles
+	while (mesh.indices.size() > targetIndexCount)
+	{
+		std::vector<Collapse> collapses = FindCollapses(mesh);
+		if (collapses.empty())
+		{
+			break;
+		}
+
+		PositionTriangles adjacency(mesh.indices, mesh.positionOf);
+		std::iota(mesh.vertexTarget.begin(), mesh.vertexTarget.end(), 0);
+		std::fill(mesh.locked.begin(), mesh.locked.end(), 0);
+
+		// Most collapses remove two triangles
+		std::size_t trianglesToRemove = (mesh.indices.size() - targetIndexCount + 2) / 3;
+		double errorLimit = collapses[std::min(collapses.size() - 1, trianglesToRemove / 2)].error * PassErrorSlack;
+
+		std::size_t trianglesRemoved = 0;
+		std::size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (trianglesRemoved >= trianglesToRemove || collapse.error > errorLimit)
+			{
+				break;
+			}
+			if (mesh.locked[collapse.from] || mesh.locked[collapse.to])
+			{
+				continue;
+			}
+
+			if (!MapVertices(mesh, adjacency, collapse.from, collapse.to) || FlipsTriangle(mesh, adjacency, collapse.from, collapse.to))
+			{
+				UndoMapVertices(mesh, collapse.from);
+				continue;
+			}
+
+			for (const GLuint* triangle = adjacency.begin(collapse.from); triangle != adjacency.end(collapse.from); triangle++)
+			{
+				const GLuint* corners = &mesh.indices[*triangle * 3];
+				if (mesh.positionOf[corners[0]] == collapse.to || mesh.positionOf[corners[1]] == collapse.to || mesh.positionOf[corners[2]] == collapse.to)
+				{
+					trianglesRemoved++;
+				}
+			}
+
+			if (mesh.kinds[collapse.from] == VertexKind::Border)
+			{
+				MoveOpenEdges(mesh, adjacency, collapse.from, collapse.to);
+			}
+
+			mesh.quadrics[collapse.to].Add(mesh.quadrics[collapse.from]);
+			mesh.locked[collapse.from] = 1;
+			mesh.locked[collapse.to] = 1;
+			largestError = std::max(largestError, collapse.error);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		for (GLuint& index : mesh.indices)
+		{
+			index = mesh.vertexTarget[index];
+		}
+		RemoveDegenerateTriangles(mesh.indices, mesh.positionOf);
+	}
+
+	if (error != nullptr)
+	{
+		*error = static_cast<float>(std::sqrt(largestError));
+	}
+	return mesh.indices;
+}
+
+void BuildMeshLods(MeshData& mesh, bool optimizeVertexCache)
+{
+	std::size_t fullIndexCount = mesh.indices.size();
+
+	mesh.lods.clear();
+	MeshLod fullDetail;
+	fullDetail.indexCount = static_cast<GLuint>(fullIndexCount);
+	mesh.lods.push_back(fullDetail);
+
+	// Every level is simplified from the full detail, so its error is measured against the real surface
+	std::size_t previousIndexCount = fullIndexCount;
+	while (mesh.lods.size() < MaxMeshLods)
+	{
+		std::size_t targetIndexCount = static_cast<std::size_t>(previousIndexCount / 3 * LodTriangleRatio) * 3;
+		float error = 0.0f;
+		std::vector<GLuint> lodIndices = SimplifyMesh(mesh.indices.data(), fullIndexCount, mesh.vertices.data(), mesh.vertices.size(),
+			targetIndexCount, &error);
+
+		if (lodIndices.empty() || lodIndices.size() > previousIndexCount * MaxKeptLodRatio)
+		{
+			break;
+		}
+
+		if (optimizeVertexCache)
+		{
+			OptimizeVertexCache(lodIndices.data(), lodIndices.size(), mesh.vertices.size());
+		}
+
+		MeshLod lod;
+		lod.firstIndex = static_cast<GLuint>(mesh.indices.size());
+		lod.indexCount = static_cast<GLuint>(lodIndices.size());
+		lod.error = std::max(error, mesh.lods.back().error);
+		mesh.indices.insert(mesh.indices.end(), lodIndices.begin(), lodIndices.end());
+		mesh.lods.push_back(lod);
+
+		previousIndexCount = lodIndices.size();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Largest number of levels of detail built for a model, the full-detail level included
+/// </summary>
+const std::size_t MaxMeshLods = 4;
+
+/// <summary>
+/// Removes triangles from a mesh by collapsing edges in the order of their quadric error
+/// (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics"), keeping the vertices
+/// as they are, so the result is a new index buffer for the same vertex buffer.
+/// Corners that share a position but not their UV coordinates or normal vector (UV and normal seams)
+/// only move along their seam, and open borders only move along their border, so neither tears open.
+/// </summary>
+/// <param name="indices">Index buffer to simplify (three indices per triangle)</param>
+/// <param name="indexCount">Number of indices</param>
+/// <param name="vertices">Vertices the indices refer to</param>
+/// <param name="vertexCount">Number of vertices</param>
+/// <param name="targetIndexCount">Number of indices to get down to (the result may have more if no collapse is left)</param>
+/// <param name="error">Optionally receives how far the simplified surface strays from the original one, in model units</param>
+/// <returns>Index buffer of the simplified mesh</returns>
+std::vector<GLuint> SimplifyMesh(const GLuint* indices, std::size_t indexCount, const Vertex* vertices, std::size_t vertexCount,
+	std::size_t targetIndexCount, float* error = nullptr);
+
+/// <summary>
+/// Builds up to MaxMeshLods levels of detail for a mesh, each with about half the triangles of the level before,
+/// and appends their indices after the full-detail ones. Levels that would barely remove anything are left out.
+/// </summary>
+/// <param name="mesh">Mesh whose levels of detail are built (receives the extra indices and the list of levels)</param>
+/// <param name="optimizeVertexCache">Indicates if the triangles of each level are reordered with OptimizeVertexCache</param>
+void BuildMeshLods(MeshData& mesh, bool optimizeVertexCache);
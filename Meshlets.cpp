@@ -0,0 +1,448 @@
+#include "Meshlets.h"
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+	const GLuint NoMeshlet = std::numeric_limits<GLuint>::max();
+
+	/// <summary>
+	/// Gives every vertex the index of the first vertex at exactly the same position, so triangles on both sides
+	/// of a UV or normal seam count as neighbors.
+	/// </summary>
+	std::vector<GLuint> WeldPositions(const std::vector<Vertex>& vertices)
+	{
+		auto positionBits = [&vertices](GLuint vertex)
+		{
+			std::uint32_t bits[3];
+			std::memcpy(&bits[0], &vertices[vertex].x, sizeof(bits[0]));
+			std::memcpy(&bits[1], &vertices[vertex].y, sizeof(bits[1]));
+			std::memcpy(&bits[2], &vertices[vertex].z, sizeof(bits[2]));
+			return std::make_tuple(bits[0], bits[1], bits[2]);
+		};
+
+		std::vector<GLuint> order(vertices.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&positionBits](GLuint a, GLuint b)
+		{
+			return positionBits(a) < positionBits(b) || (positionBits(a) == positionBits(b) && a < b);
+		});
+
+		std::vector<GLuint> positionOf(vertices.size());
+		for (std::size_t begin = 0; begin < order.size();)
+		{
+			std::size_t end = begin + 1;
+			while (end < order.size() && positionBits(order[end]) == positionBits(order[begin]))
+			{
+				end++;
+			}
+			for (std::size_t i = begin; i < end; i++)
+			{
+				positionOf[order[i]] = order[begin];
+			}
+			begin = end;
+		}
+		return positionOf;
+	}
+
+	glm::vec3 GetPosition(const Vertex& vertex)
+	{
+		return glm::vec3(vertex.x, vertex.y, vertex.z);
+	}
+
+	/// <summary>
+	/// Tells which way the triangles of a mesh face: 1 if their counter-clockwise side faces out, -1 if it faces in,
+	/// and 0 if the mesh has open borders (or edges shared by more than two triangles), so it has no inside to speak of.
+	/// </summary>
+	float GetOutwardOrientation(const MeshData& mesh, const std::vector<GLuint>& positionOf, std::size_t firstIndex, std::size_t indexCount)
+	{
+		std::vector<std::uint64_t> edges;
+		edges.reserve(indexCount);
+		double volume = 0.0;
+		for (std::size_t i = firstIndex; i + 3 <= firstIndex + indexCount; i += 3)
+		{
+			GLuint corners[3] = { positionOf[mesh.indices[i]], positionOf[mesh.indices[i + 1]], positionOf[mesh.indices[i + 2]] };
+			for (int corner = 0; corner < 3; corner++)
+			{
+				std::uint64_t a = corners[corner];
+				std::uint64_t b = corners[(corner + 1) % 3];
+				edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+			}
+
+			// Signed volume of the tetrahedron between the triangle and the origin
+			glm::dvec3 p0(GetPosition(mesh.vertices[corners[0]]));
+			glm::dvec3 p1(GetPosition(mesh.vertices[corners[1]]));
+			glm::dvec3 p2(GetPosition(mesh.vertices[corners[2]]));
+			volume += glm::dot(p0, glm::cross(p1, p2));
+		}
+
+		// In a closed mesh, every edge is shared by exactly two triangles
+		std::sort(edges.begin(), edges.end());
+		for (std::size_t begin = 0; begin < edges.size();)
+		{
+			std::size_t end = begin + 1;
+			while (end < edges.size() && edges[end] == edges[begin])
+			{
+				end++;
+			}
+			if (end - begin != 2)
+			{
+				return 0.0f;
+			}
+			begin = end;
+		}
+
+		return volume < 0.0 ? -1.0f : 1.0f;
+	}
+
+	/// <summary>
+	/// Computes the sphere and normal cone of a meshlet from the indices of its triangles.
+	/// </summary>
+	void ComputeMeshletBounds(Meshlet& meshlet, const std::vector<Vertex>& vertices, const GLuint* indices,
+		const std::vector<glm::vec3>& normals, const std::vector<GLuint>& triangles, bool hasCone)
+	{
+		glm::vec3 boxMin(std::numeric_limits<float>::max());
+		glm::vec3 boxMax(-std::numeric_limits<float>::max());
+		for (std::size_t i = 0; i < meshlet.indexCount; i++)
+		{
+			glm::vec3 position = GetPosition(vertices[indices[i]]);
+			boxMin = glm::min(boxMin, position);
+			boxMax = glm::max(boxMax, position);
+		}
+
+		glm::vec3 center = (boxMin + boxMax) * 0.5f;
+		float radius = 0.0f;
+		for (std::size_t i = 0; i < meshlet.indexCount; i++)
+		{
+			radius = std::max(radius, glm::length(GetPosition(vertices[indices[i]]) - center));
+		}
+
+		glm::vec3 normalSum(0.0f);
+		for (GLuint triangle : triangles)
+		{
+			normalSum += normals[triangle];
+		}
+		float normalLength = glm::length(normalSum);
+		glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+
+		// The triangles all face away from the camera when the view direction is closer to the axis than 90 degrees
+		// minus the widest angle between a triangle and the axis, so the cutoff is the sine of that angle
+		float coneCutoff = 1.0f;
+		if (hasCone && normalLength > 0.0f)
+		{
+			float minCosine = 1.0f;
+			for (GLuint triangle : triangles)
+			{
+				if (normals[triangle] != glm::vec3(0.0f))
+				{
+					minCosine = std::min(minCosine, glm::dot(normals[triangle], axis));
+				}
+			}
+			if (minCosine > 0.0f)
+			{
+				coneCutoff = std::sqrt(1.0f - minCosine * minCosine);
+			}
+		}
+
+		for (int axisIndex = 0; axisIndex < 3; axisIndex++)
+		{
+			meshlet.center[axisIndex] = center[axisIndex];
+			meshlet.coneAxis[axisIndex] = axis[axisIndex];
+		}
+		meshlet.radius = radius;
+		meshlet.coneCutoff = coneCutoff;
+	}
+
+	/// <summary>
+	/// Reorders the triangles of a meshlet for the vertex cache, on a copy of its indices renumbered from 0,
+	/// so the work depends on the size of the meshlet and not on the size of the mesh.
+	/// </summary>
+	void OptimizeMeshletVertexCache(GLuint* indices, std::size_t indexCount)
+	{
+		std::vector<GLuint> meshletVertices;
+		std::vector<GLuint> localIndices(indexCount);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			std::vector<GLuint>::iterator found = std::find(meshletVertices.begin(), meshletVertices.end(), indices[i]);
+			localIndices[i] = static_cast<GLuint>(found - meshletVertices.begin());
+			if (found == meshletVertices.end())
+			{
+				meshletVertices.push_back(indices[i]);
+			}
+		}
+
+		OptimizeVertexCache(localIndices.data(), localIndices.size(), meshletVertices.size());
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			indices[i] = meshletVertices[localIndices[i]];
+		}
+	}
+
+	/// <summary>
+	/// Splits one level of detail into meshlets, rewriting its range of the index buffer meshlet by meshlet.
+	/// </summary>
+	void BuildLevelMeshlets(MeshData& mesh, GLuint firstIndex, GLuint indexCount, const std::vector<GLuint>& positionOf,
+		float orientation, bool optimizeVertexCache)
+	{
+		const GLuint* levelIndices = mesh.indices.data() + firstIndex;
+		std::size_t triangleCount = indexCount / 3;
+
+		// Facing of each triangle, pointing out of the mesh (for an open mesh, the counter-clockwise side)
+		std::vector<glm::vec3> normals(triangleCount);
+		for (std::size_t t = 0; t < triangleCount; t++)
+		{
+			glm::vec3 p0 = GetPosition(mesh.vertices[levelIndices[t * 3]]);
+			glm::vec3 p1 = GetPosition(mesh.vertices[levelIndices[t * 3 + 1]]);
+			glm::vec3 p2 = GetPosition(mesh.vertices[levelIndices[t * 3 + 2]]);
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+			normals[t] = length > 0.0f ? normal * ((orientation < 0.0f ? -1.0f : 1.0f) / length) : glm::vec3(0.0f);
+		}
+
+		// Triangles around each position, stored as one list per position inside a single array
+		std::vector<GLuint> offsets(mesh.vertices.size() + 1, 0);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			offsets[positionOf[levelIndices[i]] + 1]++;
+		}
+		for (std::size_t p = 0; p < mesh.vertices.size(); p++)
+		{
+			offsets[p + 1] += offsets[p];
+		}
+		std::vector<GLuint> positionTriangles(indexCount);
+		std::vector<GLuint> filled(offsets.begin(), offsets.end() - 1);
+		for (std::size_t i = 0; i < indexCount; i++)
+		{
+			positionTriangles[filled[positionOf[levelIndices[i]]]++] = static_cast<GLuint>(i / 3);
+		}
+
+		std::vector<GLuint> reordered;
+		reordered.reserve(indexCount);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<GLuint> meshletOfVertex(mesh.vertices.size(), NoMeshlet);
+		std::vector<GLuint> meshletVertices;
+		std::vector<GLuint> meshletTriangles;
+
+		// Seeds are taken in the existing triangle order, which keeps neighboring meshlets close in the index buffer
+		std::size_t seed = 0;
+		GLuint meshletNumber = 0;
+		while (true)
+		{
+			while (seed < triangleCount && emitted[seed])
+			{
+				seed++;
+			}
+			if (seed == triangleCount)
+			{
+				break;
+			}
+
+			meshletVertices.clear();
+			meshletTriangles.clear();
+			glm::vec3 normalSum(0.0f);
+			GLuint triangle = static_cast<GLuint>(seed);
+			while (true)
+			{
+				emitted[triangle] = true;
+				meshletTriangles.push_back(triangle);
+				normalSum += normals[triangle];
+				for (int corner = 0; corner < 3; corner++)
+				{
+					GLuint vertex = levelIndices[triangle * 3 + corner];
+					if (meshletOfVertex[vertex] != meshletNumber)
+					{
+						meshletOfVertex[vertex] = meshletNumber;
+						meshletVertices.push_back(vertex);
+					}
+				}
+
+				if (meshletTriangles.size() == MaxMeshletTriangles)
+				{
+					break;
+				}
+
+				// The next triangle touches the meshlet, adds the fewest vertices and bends its cone the least
+				float normalLength = glm::length(normalSum);
+				glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+				GLuint best = NoMeshlet;
+				float bestScore = std::numeric_limits<float>::max();
+				for (GLuint vertex : meshletVertices)
+				{
+					GLuint position = positionOf[vertex];
+					for (GLuint i = offsets[position]; i < offsets[position + 1]; i++)
+					{
+						GLuint candidate = positionTriangles[i];
+						if (emitted[candidate])
+						{
+							continue;
+						}
+
+						std::size_t newVertices = 0;
+						for (int corner = 0; corner < 3; corner++)
+						{
+							newVertices += meshletOfVertex[levelIndices[candidate * 3 + corner]] != meshletNumber ? 1 : 0;
+						}
+						if (meshletVertices.size() + newVertices > MaxMeshletVertices)
+						{
+							continue;
+						}
+
+						float score = static_cast<float>(newVertices) + (1.0f - glm::dot(normals[candidate], axis));
+						if (score < bestScore)
+						{
+							bestScore = score;
+							best = candidate;
+						}
+					}
+				}
+
+				if (best == NoMeshlet)
+				{
+					break;
+				}
+				triangle = best;
+			}
+
+			Meshlet meshlet;
+			meshlet.firstIndex = static_cast<GLuint>(firstIndex + reordered.size());
+			meshlet.indexCount = static_cast<GLuint>(meshletTriangles.size() * 3);
+			for (GLuint meshletTriangle : meshletTriangles)
+			{
+				reordered.insert(reordered.end(), levelIndices + meshletTriangle * 3, levelIndices + meshletTriangle * 3 + 3);
+			}
+			if (optimizeVertexCache)
+			{
+				OptimizeMeshletVertexCache(reordered.data() + (meshlet.firstIndex - firstIndex), meshlet.indexCount);
+			}
+			ComputeMeshletBounds(meshlet, mesh.vertices, reordered.data() + (meshlet.firstIndex - firstIndex), normals,
+				meshletTriangles, orientation != 0.0f);
+			mesh.meshlets.push_back(meshlet);
+			meshletNumber++;
+		}
+
+		std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + firstIndex);
+	}
+}
+
+void BuildMeshlets(MeshData& mesh, bool optimizeVertexCache)
+{
+	mesh.meshlets.clear();
+	if (mesh.indices.empty())
+	{
+		return;
+	}
+
+	std::vector<GLuint> positionOf = WeldPositions(mesh.vertices);
+
+	// Whether the mesh is closed is decided on the full detail, which every level is simplified from
+	GLuint fullIndexCount = mesh.lods.empty() ? static_cast<GLuint>(mesh.indices.size()) : mesh.lods[0].indexCount;
+	GLuint fullFirstIndex = mesh.lods.empty() ? 0 : mesh.lods[0].firstIndex;
+	float orientation = GetOutwardOrientation(mesh, positionOf, fullFirstIndex, fullIndexCount);
+
+	if (mesh.lods.empty())
+	{
+		BuildLevelMeshlets(mesh, 0, static_cast<GLuint>(mesh.indices.size()), positionOf, orientation, optimizeVertexCache);
+		return;
+	}
+
+	for (MeshLod& lod : mesh.lods)
+	{
+		lod.firstMeshlet = static_cast<GLuint>(mesh.meshlets.size());
+		BuildLevelMeshlets(mesh, lod.firstIndex, lod.indexCount, positionOf, orientation, optimizeVertexCache);
+		lod.meshletCount = static_cast<GLuint>(mesh.meshlets.size()) - lod.firstMeshlet;
+	}
+}
+
+ViewFrustum GetViewFrustum(const glm::mat4& clipFromSpace)
+{
+	// A point is inside when -w <= x, y, z <= w in clip space, which gives one plane per row and sign
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(clipFromSpace[0][row], clipFromSpace[1][row], clipFromSpace[2][row], clipFromSpace[3][row]);
+	}
+
+	ViewFrustum frustum;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		frustum.planes[axis * 2] = rows[3] + rows[axis];
+		frustum.planes[axis * 2 + 1] = rows[3] - rows[axis];
+	}
+	for (glm::vec4& plane : frustum.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+bool IsSphereInFrustum(const ViewFrustum& frustum, const glm::vec3& center, float radius)
+{
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsMeshletBackFacing(const Meshlet& meshlet, const glm::vec3& cameraPosition)
+{
+	if (meshlet.coneCutoff >= 1.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+	glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+	glm::vec3 toCenter = center - cameraPosition;
+	return glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+}
+
+void CullMeshlets(const Meshlet* meshlets, std::size_t meshletCount, const ViewFrustum& frustum, const glm::vec3& cameraPosition,
+	MeshletDrawList& drawList)
+{
+	drawList.counts.clear();
+	drawList.offsets.clear();
+	drawList.triangleCount = 0;
+	drawList.backFacingCount = 0;
+	drawList.outsideCount = 0;
+
+	GLuint rangeEnd = 0;
+	for (std::size_t i = 0; i < meshletCount; i++)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		if (IsMeshletBackFacing(meshlet, cameraPosition))
+		{
+			drawList.backFacingCount++;
+			continue;
+		}
+		if (!IsSphereInFrustum(frustum, glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2]), meshlet.radius))
+		{
+			drawList.outsideCount++;
+			continue;
+		}
+
+		// A meshlet that starts where the last range ends extends it instead of starting a new one
+		if (!drawList.counts.empty() && meshlet.firstIndex == rangeEnd)
+		{
+			drawList.counts.back() += static_cast<GLsizei>(meshlet.indexCount);
+		}
+		else
+		{
+			drawList.counts.push_back(static_cast<GLsizei>(meshlet.indexCount));
+			drawList.offsets.push_back(reinterpret_cast<const void*>(static_cast<std::size_t>(meshlet.firstIndex) * sizeof(GLuint)));
+		}
+		rangeEnd = meshlet.firstIndex + meshlet.indexCount;
+		drawList.triangleCount += meshlet.indexCount / 3;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Largest number of vertices a meshlet may use
+/// </summary>
+const std::size_t MaxMeshletVertices = 64;
+
+/// <summary>
+/// Largest number of triangles a meshlet may hold
+/// </summary>
+const std::size_t MaxMeshletTriangles = 124;
+
+/// <summary>
+/// Splits every level of detail of a mesh into meshlets, reordering the triangles of each level so every meshlet is
+/// a range of the index buffer. A meshlet grows from a seed triangle by taking the neighboring triangle that adds the
+/// fewest new vertices and turns its normal cone the least, so its triangles stay together and face the same way.
+/// Only closed meshes get normal cones, since the inside of an open mesh can be seen through its holes.
+/// </summary>
+/// <param name="mesh">Mesh to split (receives the meshlets and the meshlet range of each level)</param>
+/// <param name="optimizeVertexCache">Indicates if the triangles of each meshlet are reordered with OptimizeVertexCache</param>
+void BuildMeshlets(MeshData& mesh, bool optimizeVertexCache);
+
+/// <summary>
+/// The six planes of a view frustum, each as a normal pointing inside and a distance (x, y, z, w)
+/// </summary>
+struct ViewFrustum
+{
+	glm::vec4 planes[6];
+};
+
+/// <summary>
+/// Extracts the planes of the view frustum from a projection matrix (Gribb and Hartmann), in the space
+/// the matrix transforms from, so passing projection * view * model gives the frustum in model space.
+/// </summary>
+/// <param name="clipFromSpace">Matrix from the space of the planes to clip space</param>
+/// <returns>Planes of the frustum, normalized so distances to them are in units of that space</returns>
+ViewFrustum GetViewFrustum(const glm::mat4& clipFromSpace);
+
+/// <summary>
+/// Indicates if a sphere is at least partly inside a view frustum.
+/// </summary>
+/// <param name="frustum">View frustum</param>
+/// <param name="center">Center of the sphere, in the space of the frustum</param>
+/// <param name="radius">Radius of the sphere</param>
+/// <returns>True unless the sphere is entirely outside one of the planes</returns>
+bool IsSphereInFrustum(const ViewFrustum& frustum, const glm::vec3& center, float radius);
+
+/// <summary>
+/// Indicates if every triangle of a meshlet faces away from the camera, wherever the triangles are inside its sphere.
+/// </summary>
+/// <param name="meshlet">Meshlet to test</param>
+/// <param name="cameraPosition">Position of the camera, in the model's space</param>
+/// <returns>True if the meshlet can be skipped</returns>
+bool IsMeshletBackFacing(const Meshlet& meshlet, const glm::vec3& cameraPosition);
+
+/// <summary>
+/// Ranges of an index buffer left to draw after culling, ready for glMultiDrawElements
+/// </summary>
+struct MeshletDrawList
+{
+	std::vector<GLsizei> counts;		// Number of indices of each range
+	std::vector<const void*> offsets;	// Byte offset of each range inside the index buffer
+	std::size_t triangleCount = 0;		// Number of triangles left to draw
+	std::size_t backFacingCount = 0;	// Number of meshlets skipped for facing away from the camera
+	std::size_t outsideCount = 0;		// Number of meshlets skipped for lying outside the view frustum
+};
+
+/// <summary>
+/// Lists the meshlets of a level of detail that may be seen, merging the ones that follow each other
+/// in the index buffer into a single range.
+/// </summary>
+/// <param name="meshlets">Meshlets of the level of detail</param>
+/// <param name="meshletCount">Number of meshlets</param>
+/// <param name="frustum">View frustum, in the model's space</param>
+/// <param name="cameraPosition">Position of the camera, in the model's space</param>
+/// <param name="drawList">Receives the ranges to draw (its previous contents are replaced)</param>
+void CullMeshlets(const Meshlet* meshlets, std::size_t meshletCount, const ViewFrustum& frustum, const glm::vec3& cameraPosition,
+	MeshletDrawList& drawList);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/// <summary>
+/// Lock-free queue that any number of threads push values into and a single thread takes them out of.
+/// Pushing links a node onto an atomic list head, and taking swaps the whole list out at once,
+/// so neither side ever blocks the other.
+/// </summary>
+template <typename T>
+class MpscQueue
+{
+public:
+	MpscQueue() = default;
+
+	/// <summary>
+	/// Destroys the values that were never taken out.
+	/// </summary>
+	~MpscQueue()
+	{
+		Node* node = head.exchange(nullptr, std::memory_order_acquire);
+		while (node != nullptr)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	/// <summary>
+	/// Adds a value to the queue. May be called from any thread.
+	/// </summary>
+	/// <param name="value">Value to add</param>
+	void Push(T value)
+	{
+		Node* node = new Node{ std::move(value), head.load(std::memory_order_relaxed) };
+		while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	/// <summary>
+	/// Takes every value pushed so far out of the queue. Must only be called from one thread at a time.
+	/// </summary>
+	/// <param name="values">Container that receives the values (through push_back), in the order they were pushed</param>
+	/// <returns>Number of values taken out</returns>
+	template <typename Container>
+	std::size_t PopAll(Container& values)
+	{
+		// The list holds the newest value first, so it is reversed before handing the values out
+		Node* newestFirst = head.exchange(nullptr, std::memory_order_acquire);
+		Node* oldestFirst = nullptr;
+		while (newestFirst != nullptr)
+		{
+			Node* next = newestFirst->next;
+			newestFirst->next = oldestFirst;
+			oldestFirst = newestFirst;
+			newestFirst = next;
+		}
+
+		std::size_t count = 0;
+		while (oldestFirst != nullptr)
+		{
+			Node* next = oldestFirst->next;
+			values.push_back(std::move(oldestFirst->value));
+			delete oldestFirst;
+			oldestFirst = next;
+			count++;
+		}
+		return count;
+	}
+
+private:
+	struct Node
+	{
+		T value;
+		Node* next;
+	};
+
+	std::atomic<Node*> head{ nullptr };
+};
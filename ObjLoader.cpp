@@ -0,0 +1,839 @@
+#include "ObjLoader.h"
+
+#include "Arena.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <system_error>
+
+namespace
+{
+	/// <summary>
+	/// Index used by a face corner that leaves out its UV coordinates or normal vector
+	/// </summary>
+	const int MissingIndex = std::numeric_limits<int>::min();
+
+	/// <summary>
+	/// Texts smaller than this are not worth splitting over several threads
+	/// </summary>
+	const std::size_t MinChunkBytes = 256 * 1024;
+
+	/// <summary>
+	/// Flags of ObjCorner::relativeMask
+	/// </summary>
+	enum ObjRelativeIndex : std::uint8_t
+	{
+		RelativePosition = 1,
+		RelativeUv = 2,
+		RelativeNormal = 4
+	};
+
+	/// <summary>
+	/// 0-based indices of the position, UV coordinates and normal vector used by one corner of a face.
+	/// Indices written relative to the end (negative in the file) are stored relative to the start
+	/// of the chunk they were read in, and are flagged in relativeMask until they are fixed up.
+	/// </summary>
+	struct ObjCorner
+	{
+		int position, uv, normal;
+		std::uint8_t relativeMask;
+	};
+
+	/// <summary>
+	/// Attributes read from the "v", "vt" and "vn" records of an .obj file, kept in scratch memory
+	/// </summary>
+	struct ObjAttributes
+	{
+		ArenaVector<float> positions;	// 3 floats per position
+		ArenaVector<float> uvs;			// 2 floats per UV coordinate
+		ArenaVector<float> normals;		// 3 floats per normal vector
+		ArenaVector<GLubyte> colors;	// 3 bytes per position (only filled if the file has vertex colors)
+
+		explicit ObjAttributes(Arena& arena)
+			: positions(ArenaAllocator<float>(arena)), uvs(ArenaAllocator<float>(arena)),
+			normals(ArenaAllocator<float>(arena)), colors(ArenaAllocator<GLubyte>(arena))
+		{
+		}
+	};
+
+	/// <summary>
+	/// Part of the .obj text that ends at a line break, parsed independently of the other parts.
+	/// Everything the chunk reads goes in its own arena, since each chunk is parsed on its own thread.
+	/// </summary>
+	struct ObjChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		Arena arena;
+		ObjAttributes attributes;
+		ArenaVector<ObjCorner> triangleCorners;	// Three corners per triangle
+		std::size_t lines = 0;
+		std::size_t faces = 0;
+
+		// First error found in the chunk (errorLine is 0 if the error is not tied to a line)
+		const char* error = nullptr;
+		std::size_t errorLine = 0;
+
+		// Where the records of this chunk start among the records of the whole file
+		std::size_t firstLine = 0;
+		std::size_t firstPosition = 0;
+		std::size_t firstUv = 0;
+		std::size_t firstNormal = 0;
+		std::size_t firstTriangle = 0;
+
+		ObjChunk() : attributes(arena), triangleCorners(ArenaAllocator<ObjCorner>(arena))
+		{
+		}
+	};
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	const char* SkipSpaces(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+		{
+			p++;
+		}
+		return p;
+	}
+
+	/// <summary>
+	/// Checks if the line starting at p begins with the given keyword followed by a space.
+	/// </summary>
+	bool StartsWithKeyword(const char* p, const char* lineEnd, const char* keyword, std::size_t keywordLength)
+	{
+		return static_cast<std::size_t>(lineEnd - p) > keywordLength
+			&& std::memcmp(p, keyword, keywordLength) == 0
+			&& IsSpace(p[keywordLength]);
+	}
+
+	bool ReadFloat(const char*& p, const char* end, float& value)
+	{
+		p = SkipSpaces(p, end);
+
+		// std::from_chars does not accept an explicit plus sign
+		if (p < end && *p == '+')
+		{
+			p++;
+		}
+
+		std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec != std::errc())
+		{
+			return false;
+		}
+		p = result.ptr;
+		return true;
+	}
+
+	/// <summary>
+	/// Reads a 1-based (or negative, relative to the end) .obj index and turns it into a 0-based index.
+	/// </summary>
+	bool ReadIndex(const char*& p, const char* end, std::size_t localCount, int& index, bool& relative)
+	{
+		int value;
+		std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec != std::errc() || value == 0)
+		{
+			return false;
+		}
+		p = result.ptr;
+
+		relative = value < 0;
+		index = relative ? static_cast<int>(localCount) + value : value - 1;
+		return true;
+	}
+
+	/// <summary>
+	/// Reads one face corner (v, v/vt, v//vn or v/vt/vn).
+	/// </summary>
+	bool ReadCorner(const char*& p, const char* end, const ObjAttributes& attributes, ObjCorner& corner)
+	{
+		bool relative;
+		corner.uv = MissingIndex;
+		corner.normal = MissingIndex;
+		corner.relativeMask = 0;
+
+		if (!ReadIndex(p, end, attributes.positions.size() / 3, corner.position, relative))
+		{
+			return false;
+		}
+		corner.relativeMask |= relative ? RelativePosition : 0;
+
+		if (p < end && *p == '/')
+		{
+			p++;
+			if (p < end && *p != '/')
+			{
+				if (!ReadIndex(p, end, attributes.uvs.size() / 2, corner.uv, relative))
+				{
+					return false;
+				}
+				corner.relativeMask |= relative ? RelativeUv : 0;
+			}
+		}
+
+		if (p < end && *p == '/')
+		{
+			p++;
+			if (!ReadIndex(p, end, attributes.normals.size() / 3, corner.normal, relative))
+			{
+				return false;
+			}
+			corner.relativeMask |= relative ? RelativeNormal : 0;
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Reserves the scratch arrays of a chunk from a quick count of its records and of the corners of each face,
+	/// since arrays that grow inside an arena leave their old copies behind until the arena is released.
+	/// </summary>
+	/// <param name="chunk">Chunk to reserve the arrays of</param>
+	/// <returns>Most corners of any face of the chunk</returns>
+	std::size_t ReserveChunk(ObjChunk& chunk)
+	{
+		std::size_t positions = 0, uvs = 0, normals = 0, triangles = 0, maxFaceCorners = 0;
+
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		while (p < end)
+		{
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if (lineEnd == nullptr)
+			{
+				lineEnd = end;
+			}
+
+			p = SkipSpaces(p, lineEnd);
+			if (StartsWithKeyword(p, lineEnd, "v", 1))
+			{
+				positions++;
+			}
+			else if (StartsWithKeyword(p, lineEnd, "vt", 2))
+			{
+				uvs++;
+			}
+			else if (StartsWithKeyword(p, lineEnd, "vn", 2))
+			{
+				normals++;
+			}
+			else if (StartsWithKeyword(p, lineEnd, "f", 1))
+			{
+				// Faces are split into triangle fans, so a face with n corners gives n - 2 triangles
+				std::size_t faceCorners = 0;
+				for (const char* c = SkipSpaces(p + 1, lineEnd); c < lineEnd; c = SkipSpaces(c, lineEnd))
+				{
+					faceCorners++;
+					while (c < lineEnd && !IsSpace(*c))
+					{
+						c++;
+					}
+				}
+				triangles += faceCorners > 2 ? faceCorners - 2 : 0;
+				maxFaceCorners = std::max(maxFaceCorners, faceCorners);
+			}
+
+			p = lineEnd + 1;
+		}
+
+		// All of it goes in one block of just the right size (with room to align each array), instead of blocks of the arena's usual size
+		chunk.arena.Reserve((positions * 3 + uvs * 2 + normals * 3) * sizeof(float) + (triangles * 3 + maxFaceCorners) * sizeof(ObjCorner)
+			+ 5 * alignof(std::max_align_t));
+
+		chunk.attributes.positions.reserve(positions * 3);
+		chunk.attributes.uvs.reserve(uvs * 2);
+		chunk.attributes.normals.reserve(normals * 3);
+		chunk.triangleCorners.reserve(triangles * 3);
+		return maxFaceCorners;
+	}
+
+	/// <summary>
+	/// Tokenizes the v, vt, vn and f records of one chunk.
+	/// </summary>
+	void ParseChunk(ObjChunk& chunk)
+	{
+		std::size_t maxFaceCorners = ReserveChunk(chunk);
+
+		ObjAttributes& attributes = chunk.attributes;
+		ArenaVector<ObjCorner> corners{ ArenaAllocator<ObjCorner>(chunk.arena) };
+		corners.reserve(maxFaceCorners);
+
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		while (p < end)
+		{
+			chunk.lines++;
+
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if (lineEnd == nullptr)
+			{
+				lineEnd = end;
+			}
+
+			p = SkipSpaces(p, lineEnd);
+
+			if (StartsWithKeyword(p, lineEnd, "v", 1))
+			{
+				p += 1;
+				float x, y, z;
+				if (!ReadFloat(p, lineEnd, x) || !ReadFloat(p, lineEnd, y) || !ReadFloat(p, lineEnd, z))
+				{
+					chunk.error = "Invalid vertex position";
+					chunk.errorLine = chunk.lines;
+					return;
+				}
+				attributes.positions.push_back(x);
+				attributes.positions.push_back(y);
+				attributes.positions.push_back(z);
+
+				// Some exporters append a vertex color (v x y z r g b) to the position
+				float r, g, b;
+				const char* colorStart = p;
+				if (ReadFloat(p, lineEnd, r) && ReadFloat(p, lineEnd, g) && ReadFloat(p, lineEnd, b))
+				{
+					if (attributes.colors.empty())
+					{
+						attributes.colors.reserve(attributes.positions.capacity());
+						attributes.colors.assign(attributes.positions.size() - 3, 255);
+					}
+					attributes.colors.push_back(static_cast<GLubyte>(std::fmin(std::fmax(r, 0.0f), 1.0f) * 255.0f + 0.5f));
+					attributes.colors.push_back(static_cast<GLubyte>(std::fmin(std::fmax(g, 0.0f), 1.0f) * 255.0f + 0.5f));
+					attributes.colors.push_back(static_cast<GLubyte>(std::fmin(std::fmax(b, 0.0f), 1.0f) * 255.0f + 0.5f));
+				}
+				else
+				{
+					p = colorStart;
+					if (!attributes.colors.empty())
+					{
+						attributes.colors.insert(attributes.colors.end(), 3, 255);
+					}
+				}
+			}
+			else if (StartsWithKeyword(p, lineEnd, "vt", 2))
+			{
+				p += 2;
+				float u, v;
+				if (!ReadFloat(p, lineEnd, u) || !ReadFloat(p, lineEnd, v))
+				{
+					chunk.error = "Invalid UV coordinates";
+					chunk.errorLine = chunk.lines;
+					return;
+				}
+				attributes.uvs.push_back(u);
+				attributes.uvs.push_back(v);
+			}
+			else if (StartsWithKeyword(p, lineEnd, "vn", 2))
+			{
+				p += 2;
+				float x, y, z;
+				if (!ReadFloat(p, lineEnd, x) || !ReadFloat(p, lineEnd, y) || !ReadFloat(p, lineEnd, z))
+				{
+					chunk.error = "Invalid normal vector";
+					chunk.errorLine = chunk.lines;
+					return;
+				}
+				attributes.normals.push_back(x);
+				attributes.normals.push_back(y);
+				attributes.normals.push_back(z);
+			}
+			else if (StartsWithKeyword(p, lineEnd, "f", 1))
+			{
+				p += 1;
+				corners.clear();
+
+				p = SkipSpaces(p, lineEnd);
+				while (p < lineEnd)
+				{
+					ObjCorner corner;
+					if (!ReadCorner(p, lineEnd, attributes, corner))
+					{
+						chunk.error = "Invalid face corner";
+						chunk.errorLine = chunk.lines;
+						return;
+					}
+					corners.push_back(corner);
+					p = SkipSpaces(p, lineEnd);
+				}
+
+				if (corners.size() < 3)
+				{
+					chunk.error = "Face with less than 3 corners";
+					chunk.errorLine = chunk.lines;
+					return;
+				}
+
+				// Split the polygon into a triangle fan around its first corner
+				for (std::size_t i = 1; i + 1 < corners.size(); i++)
+				{
+					chunk.triangleCorners.push_back(corners[0]);
+					chunk.triangleCorners.push_back(corners[i]);
+					chunk.triangleCorners.push_back(corners[i + 1]);
+				}
+				chunk.faces++;
+			}
+
+			// Anything else (comments, o, g, s, usemtl, mtllib, ...) is skipped
+			p = lineEnd + 1;
+		}
+	}
+
+	/// <summary>
+	/// Finds the attributes of the whole file by index, where they were left in the chunks that read them
+	/// (instead of copying them all into merged arrays)
+	/// </summary>
+	struct ObjAttributeTable
+	{
+		const std::vector<ObjChunk>& chunks;
+		std::size_t positionCount = 0;
+		std::size_t uvCount = 0;
+		std::size_t normalCount = 0;
+		bool hasColors = false;
+
+		explicit ObjAttributeTable(const std::vector<ObjChunk>& chunks) : chunks(chunks)
+		{
+		}
+
+		/// <summary>
+		/// Last chunk whose first record of a kind comes at or before the index (skipping chunks without that kind of record).
+		/// </summary>
+		const ObjChunk& FindChunk(int index, std::size_t ObjChunk::* first) const
+		{
+			std::size_t low = 0, high = chunks.size();
+			while (high - low > 1)
+			{
+				std::size_t middle = (low + high) / 2;
+				if (chunks[middle].*first <= static_cast<std::size_t>(index))
+				{
+					low = middle;
+				}
+				else
+				{
+					high = middle;
+				}
+			}
+			return chunks[low];
+		}
+
+		const float* Position(int index) const
+		{
+			const ObjChunk& chunk = FindChunk(index, &ObjChunk::firstPosition);
+			return &chunk.attributes.positions[(index - chunk.firstPosition) * 3];
+		}
+
+		const float* Uv(int index) const
+		{
+			const ObjChunk& chunk = FindChunk(index, &ObjChunk::firstUv);
+			return &chunk.attributes.uvs[(index - chunk.firstUv) * 2];
+		}
+
+		const float* Normal(int index) const
+		{
+			const ObjChunk& chunk = FindChunk(index, &ObjChunk::firstNormal);
+			return &chunk.attributes.normals[(index - chunk.firstNormal) * 3];
+		}
+
+		/// <summary>
+		/// Color of a position, or nullptr if the chunk that read the position had no vertex colors (white).
+		/// </summary>
+		const GLubyte* Color(int index) const
+		{
+			const ObjChunk& chunk = FindChunk(index, &ObjChunk::firstPosition);
+			return chunk.attributes.colors.empty() ? nullptr : &chunk.attributes.colors[(index - chunk.firstPosition) * 3];
+		}
+	};
+
+	/// <summary>
+	/// Turns an index read in a chunk into an index among the records of the whole file.
+	/// </summary>
+	bool FixUpIndex(int& index, bool relative, std::size_t chunkFirst, std::size_t mergedCount)
+	{
+		long long fixedIndex = relative ? static_cast<long long>(chunkFirst) + index : index;
+		if (fixedIndex < 0 || fixedIndex >= static_cast<long long>(mergedCount))
+		{
+			return false;
+		}
+		index = static_cast<int>(fixedIndex);
+		return true;
+	}
+
+	/// <summary>
+	/// Turns the corners of a chunk into corners that index the records of the whole file.
+	/// </summary>
+	void FixUpChunkCorners(ObjChunk& chunk, const ObjAttributeTable& attributes)
+	{
+		std::size_t positionCount = attributes.positionCount;
+		std::size_t uvCount = attributes.uvCount;
+		std::size_t normalCount = attributes.normalCount;
+
+		for (ObjCorner& corner : chunk.triangleCorners)
+		{
+			bool valid = FixUpIndex(corner.position, (corner.relativeMask & RelativePosition) != 0, chunk.firstPosition, positionCount);
+			if (corner.uv != MissingIndex)
+			{
+				valid = valid && FixUpIndex(corner.uv, (corner.relativeMask & RelativeUv) != 0, chunk.firstUv, uvCount);
+			}
+			if (corner.normal != MissingIndex)
+			{
+				valid = valid && FixUpIndex(corner.normal, (corner.relativeMask & RelativeNormal) != 0, chunk.firstNormal, normalCount);
+			}
+			corner.relativeMask = 0;
+
+			if (!valid)
+			{
+				chunk.error = "Face refers to a vertex attribute that does not exist";
+				return;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Computes the unit normal of the triangle formed by three positions.
+	/// </summary>
+	void ComputeFaceNormal(const ObjAttributeTable& attributes, const ObjCorner* corners, float* faceNormal)
+	{
+		const float* a = attributes.Position(corners[0].position);
+		const float* b = attributes.Position(corners[1].position);
+		const float* c = attributes.Position(corners[2].position);
+
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+		faceNormal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+		faceNormal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+		faceNormal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+
+		float length = std::sqrt(faceNormal[0] * faceNormal[0] + faceNormal[1] * faceNormal[1] + faceNormal[2] * faceNormal[2]);
+		if (length > 0.0f)
+		{
+			faceNormal[0] /= length;
+			faceNormal[1] /= length;
+			faceNormal[2] /= length;
+		}
+	}
+
+	/// <summary>
+	/// Builds one vertex from the attributes of the file.
+	/// </summary>
+	Vertex MakeVertex(const ObjAttributeTable& attributes, const ObjCorner& corner, const float* faceNormal)
+	{
+		const float* position = attributes.Position(corner.position);
+		const float* normal = corner.normal != MissingIndex ? attributes.Normal(corner.normal) : faceNormal;
+
+		Vertex vertex;
+		vertex.x = position[0];		vertex.y = position[1];		vertex.z = position[2];
+		vertex.r = 255;				vertex.g = 255;				vertex.b = 255;
+		vertex.u = 0.0f;			vertex.v = 0.0f;
+		vertex.nx = normal[0];		vertex.ny = normal[1];		vertex.nz = normal[2];
+
+		if (corner.uv != MissingIndex)
+		{
+			const float* uv = attributes.Uv(corner.uv);
+			vertex.u = uv[0];
+			vertex.v = uv[1];
+		}
+
+		const GLubyte* color = attributes.hasColors ? attributes.Color(corner.position) : nullptr;
+		if (color != nullptr)
+		{
+			vertex.r = color[0];
+			vertex.g = color[1];
+			vertex.b = color[2];
+		}
+
+		return vertex;
+	}
+
+	/// <summary>
+	/// Gives every distinct (position, UV coordinates, normal vector) triple one vertex, in the order
+	/// the triples first appear, and fills the index buffer with three indices per triangle.
+	/// The triples are bucketed by their position index, so finding a triple only compares it
+	/// against the few other triples that share its position.
+	/// Corners without a normal vector get the normal of their triangle, and are never shared.
+	/// The arrays here grow to a size that is only known at the end, so they stay on the heap, where a grown array
+	/// frees its old copy (in an arena every copy would be kept until the arena is released).
+	/// </summary>
+	void BuildIndexedVertices(const std::vector<ObjChunk>& chunks, const ObjAttributeTable& attributes, std::size_t triangleCount, MeshData& mesh)
+	{
+		const GLuint NoVertex = std::numeric_limits<GLuint>::max();
+
+		std::vector<GLuint> firstVertexOfPosition(attributes.positionCount, NoVertex);
+		std::vector<GLuint> nextVertexOfPosition;
+		std::vector<ObjCorner> vertexCorners;
+
+		// There are usually about as many vertices as positions
+		nextVertexOfPosition.reserve(firstVertexOfPosition.size());
+		vertexCorners.reserve(firstVertexOfPosition.size());
+		mesh.vertices.reserve(firstVertexOfPosition.size());
+
+		mesh.indices.resize(triangleCount * 3);
+		GLuint* output = mesh.indices.data();
+
+		for (const ObjChunk& chunk : chunks)
+		{
+			for (std::size_t t = 0; t < chunk.triangleCorners.size(); t += 3)
+			{
+				const ObjCorner* corners = &chunk.triangleCorners[t];
+
+				for (int k = 0; k < 3; k++)
+				{
+					const ObjCorner& corner = corners[k];
+
+					GLuint vertexIndex = NoVertex;
+					if (corner.normal != MissingIndex)
+					{
+						for (GLuint candidate = firstVertexOfPosition[corner.position]; candidate != NoVertex; candidate = nextVertexOfPosition[candidate])
+						{
+							if (vertexCorners[candidate].uv == corner.uv && vertexCorners[candidate].normal == corner.normal)
+							{
+								vertexIndex = candidate;
+								break;
+							}
+						}
+					}
+
+					if (vertexIndex == NoVertex)
+					{
+						float faceNormal[3] = { 0.0f, 0.0f, 0.0f };
+						if (corner.normal == MissingIndex)
+						{
+							ComputeFaceNormal(attributes, corners, faceNormal);
+						}
+
+						vertexIndex = static_cast<GLuint>(mesh.vertices.size());
+						mesh.vertices.push_back(MakeVertex(attributes, corner, faceNormal));
+						vertexCorners.push_back(corner);
+						nextVertexOfPosition.push_back(firstVertexOfPosition[corner.position]);
+						firstVertexOfPosition[corner.position] = vertexIndex;
+					}
+
+					*output++ = vertexIndex;
+				}
+			}
+		}
+
+		// The vertices are kept, so they give back what they reserved beyond their final size
+		mesh.vertices.shrink_to_fit();
+	}
+
+	/// <summary>
+	/// Splits the text into about chunkCount parts that each end at a line break.
+	/// </summary>
+	std::vector<ObjChunk> SplitIntoChunks(const char* begin, const char* end, std::size_t chunkCount)
+	{
+		std::vector<ObjChunk> chunks(chunkCount);
+		std::size_t totalBytes = static_cast<std::size_t>(end - begin);
+
+		const char* chunkBegin = begin;
+		for (std::size_t i = 0; i < chunkCount; i++)
+		{
+			const char* chunkEnd = end;
+			if (i + 1 < chunkCount)
+			{
+				chunkEnd = std::max(chunkBegin, begin + totalBytes * (i + 1) / chunkCount);
+				const char* lineBreak = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+				chunkEnd = lineBreak != nullptr ? lineBreak + 1 : end;
+			}
+
+			chunks[i].begin = chunkBegin;
+			chunks[i].end = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+
+		return chunks;
+	}
+}
+
+double ObjLoadStats::MegabytesPerSecond() const
+{
+	if (seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+}
+
+double ObjLoadStats::DeduplicationRatio() const
+{
+	if (vertices == 0)
+	{
+		return 0.0;
+	}
+	return static_cast<double>(triangles * 3) / static_cast<double>(vertices);
+}
+
+bool LoadObjFile(const std::string& filePath, MeshData& mesh, ObjLoadStats* stats, ThreadPool* threadPool, ObjFileReading reading)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	// Either parse straight out of a mapping of the file, or read the whole file with a single read first
+	MappedFile mappedFile;
+	std::vector<char> buffer;
+	const char* text = nullptr;
+	std::size_t textSize = 0;
+
+	if (reading == ObjFileReading::MemoryMapped)
+	{
+		if (!mappedFile.Open(filePath, MappedFileAccess::Sequential))
+		{
+			std::cerr << "Unable to open model file: " << filePath << std::endl;
+			return false;
+		}
+		text = mappedFile.GetData();
+		textSize = mappedFile.GetSize();
+	}
+	else
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (file.fail())
+		{
+			std::cerr << "Unable to open model file: " << filePath << std::endl;
+			return false;
+		}
+
+		std::streamsize fileSize = file.tellg();
+		file.seekg(0, std::ios::beg);
+
+		buffer.resize(static_cast<std::size_t>(fileSize));
+		if (!file.read(buffer.data(), fileSize))
+		{
+			std::cerr << "Unable to read model file: " << filePath << std::endl;
+			return false;
+		}
+		text = buffer.data();
+		textSize = buffer.size();
+	}
+
+	if (!ParseObj(text, text + textSize, mesh, stats, threadPool))
+	{
+		std::cerr << "Unable to parse model file: " << filePath << std::endl;
+		return false;
+	}
+
+	if (stats != nullptr)
+	{
+		stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	return true;
+}
+
+bool ParseObj(const char* begin, const char* end, MeshData& mesh, ObjLoadStats* stats, ThreadPool* threadPool)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.hasColors = false;
+
+	// Large texts are split at line breaks into a few chunks per worker thread
+	std::size_t chunkCount = 1;
+	if (threadPool != nullptr)
+	{
+		std::size_t maxChunks = static_cast<std::size_t>(threadPool->GetThreadCount()) * 4;
+		chunkCount = std::clamp<std::size_t>(static_cast<std::size_t>(end - begin) / MinChunkBytes, 1, maxChunks);
+	}
+
+	std::vector<ObjChunk> chunks = SplitIntoChunks(begin, end, chunkCount);
+
+	auto forEachChunk = [threadPool, &chunks](const std::function<void(std::size_t)>& body)
+	{
+		if (threadPool != nullptr && chunks.size() > 1)
+		{
+			threadPool->ParallelFor(chunks.size(), body);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < chunks.size(); i++)
+			{
+				body(i);
+			}
+		}
+	};
+
+	// --- Tokenize every chunk on its own ---
+
+	forEachChunk([&chunks](std::size_t i) { ParseChunk(chunks[i]); });
+
+	// --- Work out where the records of each chunk land among the records of the whole file ---
+
+	std::size_t lineCount = 0, positionCount = 0, uvCount = 0, normalCount = 0, faceCount = 0, triangleCount = 0;
+	bool hasColors = false;
+
+	for (ObjChunk& chunk : chunks)
+	{
+		chunk.firstLine = lineCount;
+		chunk.firstPosition = positionCount;
+		chunk.firstUv = uvCount;
+		chunk.firstNormal = normalCount;
+		chunk.firstTriangle = triangleCount;
+
+		if (chunk.error != nullptr)
+		{
+			std::cerr << chunk.error << " at line " << chunk.firstLine + chunk.errorLine << std::endl;
+			return false;
+		}
+
+		lineCount += chunk.lines;
+		positionCount += chunk.attributes.positions.size() / 3;
+		uvCount += chunk.attributes.uvs.size() / 2;
+		normalCount += chunk.attributes.normals.size() / 3;
+		faceCount += chunk.faces;
+		triangleCount += chunk.triangleCorners.size() / 3;
+		hasColors = hasColors || !chunk.attributes.colors.empty();
+	}
+
+	// --- Fix up the indices of the triangles ---
+
+	ObjAttributeTable attributes(chunks);
+	attributes.positionCount = positionCount;
+	attributes.uvCount = uvCount;
+	attributes.normalCount = normalCount;
+	attributes.hasColors = hasColors;
+
+	forEachChunk([&chunks, &attributes](std::size_t i) { FixUpChunkCorners(chunks[i], attributes); });
+
+	for (const ObjChunk& chunk : chunks)
+	{
+		if (chunk.error != nullptr)
+		{
+			std::cerr << chunk.error << " (in the lines starting at line " << chunk.firstLine + 1 << ")" << std::endl;
+			return false;
+		}
+	}
+
+	// --- Share the vertices of corners that use the same attributes ---
+
+	BuildIndexedVertices(chunks, attributes, triangleCount, mesh);
+
+	mesh.hasColors = hasColors;
+	mesh.bounds = ComputeBounds(mesh.vertices.data(), mesh.vertices.size());
+
+	if (stats != nullptr)
+	{
+		stats->bytes = static_cast<std::size_t>(end - begin);
+		stats->lines = lineCount;
+		stats->positions = positionCount;
+		stats->uvs = uvCount;
+		stats->normals = normalCount;
+		stats->faces = faceCount;
+		stats->triangles = triangleCount;
+		stats->vertices = mesh.vertices.size();
+		stats->chunks = chunks.size();
+	}
+
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <string>
+
+class ThreadPool;
+
+/// <summary>
+/// How the text of an .obj file is brought into memory
+/// </summary>
+enum class ObjFileReading
+{
+	MemoryMapped,	// Parse straight out of a read-only mapping of the file
+	Buffered		// Read the whole file into a buffer first
+};
+
+/// <summary>
+/// Statistics about a parsed .obj file
+/// </summary>
+struct ObjLoadStats
+{
+	std::size_t bytes = 0;		// Size of the .obj text
+	std::size_t lines = 0;		// Number of lines in the .obj text
+	std::size_t positions = 0;	// Number of "v" records
+	std::size_t uvs = 0;		// Number of "vt" records
+	std::size_t normals = 0;	// Number of "vn" records
+	std::size_t faces = 0;		// Number of "f" records
+	std::size_t triangles = 0;	// Number of triangles after splitting the faces
+	std::size_t vertices = 0;	// Number of distinct vertices after sharing the corners that use the same attributes
+	std::size_t chunks = 0;		// Number of parts the text was split into for parsing
+	double seconds = 0.0;		// Time spent reading and parsing
+
+	/// <summary>
+	/// Parse throughput in megabytes per second.
+	/// </summary>
+	double MegabytesPerSecond() const;
+
+	/// <summary>
+	/// Number of triangle corners per distinct vertex (how many times fewer vertices indexing needs).
+	/// </summary>
+	double DeduplicationRatio() const;
+};
+
+/// <summary>
+/// Loads a Wavefront .obj file into an indexed list of triangles.
+/// Faces may have any number of corners (they are split into a triangle fan), and each corner
+/// may leave out its UV coordinates and/or normal vector (v, v/vt, v//vn or v/vt/vn).
+/// </summary>
+/// <param name="filePath">Path to the .obj file</param>
+/// <param name="mesh">Receives the triangles of the model</param>
+/// <param name="stats">Optionally receives statistics about the file</param>
+/// <param name="threadPool">Optional worker threads used to parse large files in parallel</param>
+/// <param name="reading">How the text of the file is brought into memory</param>
+/// <returns>True if the file was read and parsed successfully</returns>
+bool LoadObjFile(const std::string& filePath, MeshData& mesh, ObjLoadStats* stats = nullptr, ThreadPool* threadPool = nullptr,
+	ObjFileReading reading = ObjFileReading::MemoryMapped);
+
+/// <summary>
+/// Parses the text of a Wavefront .obj file into an indexed list of triangles.
+/// Corners that use the same position, UV coordinates and normal vector share one vertex.
+/// When a thread pool is given, large texts are split at line breaks into chunks that are
+/// tokenized in parallel; the attributes of the chunks are then merged and the face indices
+/// of each chunk are fixed up to point into the merged attributes.
+/// </summary>
+/// <param name="begin">Start of the .obj text</param>
+/// <param name="end">End of the .obj text (the text does not need to be null-terminated)</param>
+/// <param name="mesh">Receives the triangles of the model</param>
+/// <param name="stats">Optionally receives statistics about the text</param>
+/// <param name="threadPool">Optional worker threads used to parse large texts in parallel</param>
+/// <returns>True if the text was parsed successfully</returns>
+bool ParseObj(const char* begin, const char* end, MeshData& mesh, ObjLoadStats* stats = nullptr, ThreadPool* threadPool = nullptr);
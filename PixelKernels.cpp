@@ -0,0 +1,615 @@
+#include "PixelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_IX86)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PIXEL_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles AVX2 intrinsics anywhere; GCC and Clang only in functions built for AVX2,
+// which are only called once the processor is known to have it
+#if defined(PIXEL_KERNELS_X86) && !defined(_MSC_VER)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define AVX2_FUNCTION
+#endif
+
+namespace
+{
+	/// <summary>
+	/// Tables the sRGB-aware kernels convert with, the same for every instruction set so they all give the same bytes
+	/// </summary>
+	struct SrgbTables
+	{
+		std::uint32_t toLinear[256];				// Linear light of each sRGB value, from 0 to 65535
+		std::vector<std::uint8_t> fromLinear;		// Nearest sRGB value of each linear light from 0 to 65535 (padded so 4-byte gathers stay inside)
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables tables = []()
+			{
+				SrgbTables built;
+				for (int i = 0; i < 256; i++)
+				{
+					double value = i / 255.0;
+					double linear = value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+					built.toLinear[i] = static_cast<std::uint32_t>(std::lround(linear * 65535.0));
+				}
+				built.fromLinear.resize(65536 + 3);
+				for (int i = 0; i < 65536; i++)
+				{
+					double linear = i / 65535.0;
+					double value = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+					built.fromLinear[i] = static_cast<std::uint8_t>(std::lround(std::min(1.0, std::max(0.0, value)) * 255.0));
+				}
+				return built;
+			}();
+		return tables;
+	}
+
+	/// <summary>
+	/// color * alpha / 255, rounded to the nearest value without a division
+	/// </summary>
+	inline unsigned char MultiplyAlpha(unsigned int color, unsigned int alpha)
+	{
+		unsigned int product = color * alpha + 128;
+		return static_cast<unsigned char>((product + (product >> 8)) >> 8);
+	}
+
+	// --- Scalar kernels, the reference every other form has to match ---
+
+	void FlipRowsScalar(unsigned char* pixels, std::size_t rowSize, int height)
+	{
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = pixels + static_cast<std::size_t>(y) * rowSize;
+			unsigned char* bottom = pixels + static_cast<std::size_t>(height - 1 - y) * rowSize;
+			for (std::size_t i = 0; i < rowSize; i++)
+			{
+				std::swap(top[i], bottom[i]);
+			}
+		}
+	}
+
+	void ExpandRgbToRgbaScalar(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba)
+	{
+		for (std::size_t i = 0; i < pixelCount; i++)
+		{
+			rgba[i * 4] = rgb[i * 3];
+			rgba[i * 4 + 1] = rgb[i * 3 + 1];
+			rgba[i * 4 + 2] = rgb[i * 3 + 2];
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+	void SwapRedBlueScalar(unsigned char* rgba, std::size_t pixelCount)
+	{
+		for (std::size_t i = 0; i < pixelCount; i++)
+		{
+			std::swap(rgba[i * 4], rgba[i * 4 + 2]);
+		}
+	}
+
+	void PremultiplyAlphaScalar(unsigned char* rgba, std::size_t pixelCount)
+	{
+		for (std::size_t i = 0; i < pixelCount; i++)
+		{
+			unsigned int alpha = rgba[i * 4 + 3];
+			rgba[i * 4] = MultiplyAlpha(rgba[i * 4], alpha);
+			rgba[i * 4 + 1] = MultiplyAlpha(rgba[i * 4 + 1], alpha);
+			rgba[i * 4 + 2] = MultiplyAlpha(rgba[i * 4 + 2], alpha);
+		}
+	}
+
+	/// <summary>
+	/// Halves the bytes of one row of the halved image from the two rows of the image it averages, from byte first on.
+	/// Byte j of the halved row averages bytes 2j - c and 2j - c + channels of both rows, c being its channel.
+	/// </summary>
+	void HalveRowSrgbScalar(const unsigned char* row0, const unsigned char* row1, std::size_t first, std::size_t halfRowSize,
+		int channels, bool repeatColumn, unsigned char* halfRow)
+	{
+		const SrgbTables& tables = GetSrgbTables();
+		for (std::size_t j = first; j < halfRowSize; j++)
+		{
+			std::size_t c = j % channels;
+			std::size_t x0 = 2 * j - c;
+			std::size_t x1 = repeatColumn ? x0 : x0 + channels;
+			if (c == 3)
+			{
+				halfRow[j] = static_cast<unsigned char>((row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) / 4);
+			}
+			else
+			{
+				std::uint32_t sum = tables.toLinear[row0[x0]] + tables.toLinear[row0[x1]] + tables.toLinear[row1[x0]] + tables.toLinear[row1[x1]];
+				halfRow[j] = tables.fromLinear[(sum + 2) / 4];
+			}
+		}
+	}
+
+#if defined(PIXEL_KERNELS_X86)
+	// --- SSE2 kernels ---
+
+	void FlipRowsSse2(unsigned char* pixels, std::size_t rowSize, int height)
+	{
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = pixels + static_cast<std::size_t>(y) * rowSize;
+			unsigned char* bottom = pixels + static_cast<std::size_t>(height - 1 - y) * rowSize;
+			std::size_t i = 0;
+			for (; i + 16 <= rowSize; i += 16)
+			{
+				__m128i topBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+				__m128i bottomBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(top + i), bottomBytes);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bottom + i), topBytes);
+			}
+			for (; i < rowSize; i++)
+			{
+				std::swap(top[i], bottom[i]);
+			}
+		}
+	}
+
+	void ExpandRgbToRgbaSse2(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba)
+	{
+		// Without a byte shuffle, each of 4 pixels is shifted down to the start of the register and their low 32 bits interleaved.
+		// The load reads 16 bytes for 12, so the last pixels are left to the scalar loop
+		const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+		const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+		std::size_t i = 0;
+		for (; i + 6 <= pixelCount; i += 4)
+		{
+			__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+			__m128i pixels01 = _mm_unpacklo_epi32(bytes, _mm_srli_si128(bytes, 3));
+			__m128i pixels23 = _mm_unpacklo_epi32(_mm_srli_si128(bytes, 6), _mm_srli_si128(bytes, 9));
+			__m128i pixels = _mm_unpacklo_epi64(pixels01, pixels23);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_or_si128(_mm_and_si128(pixels, colorMask), opaque));
+		}
+		ExpandRgbToRgbaScalar(rgb + i * 3, pixelCount - i, rgba + i * 4);
+	}
+
+	void SwapRedBlueSse2(unsigned char* rgba, std::size_t pixelCount)
+	{
+		const __m128i greenAlphaMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+		const __m128i lowByteMask = _mm_set1_epi32(0xFF);
+		std::size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+			__m128i red = _mm_slli_epi32(_mm_and_si128(pixels, lowByteMask), 16);
+			__m128i blue = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByteMask);
+			pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), _mm_or_si128(red, blue));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), pixels);
+		}
+		SwapRedBlueScalar(rgba + i * 4, pixelCount - i);
+	}
+
+	/// <summary>
+	/// Premultiplies 2 pixels widened to 16 bits per channel
+	/// </summary>
+	inline __m128i PremultiplyWidePixelsSse2(__m128i pixels)
+	{
+		// Each channel is multiplied by its pixel's alpha, except alpha itself, which is multiplied by 255 to stay as it is
+		const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+		const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, _mm_or_si128(_mm_and_si128(alpha, colorLanes), alphaLanes)), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+	}
+
+	void PremultiplyAlphaSse2(unsigned char* rgba, std::size_t pixelCount)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		std::size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+			__m128i low = PremultiplyWidePixelsSse2(_mm_unpacklo_epi8(pixels, zero));
+			__m128i high = PremultiplyWidePixelsSse2(_mm_unpackhi_epi8(pixels, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_packus_epi16(low, high));
+		}
+		PremultiplyAlphaScalar(rgba + i * 4, pixelCount - i);
+	}
+
+	// --- AVX2 kernels ---
+
+	AVX2_FUNCTION void FlipRowsAvx2(unsigned char* pixels, std::size_t rowSize, int height)
+	{
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = pixels + static_cast<std::size_t>(y) * rowSize;
+			unsigned char* bottom = pixels + static_cast<std::size_t>(height - 1 - y) * rowSize;
+			std::size_t i = 0;
+			for (; i + 32 <= rowSize; i += 32)
+			{
+				__m256i topBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(top + i));
+				__m256i bottomBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(top + i), bottomBytes);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(bottom + i), topBytes);
+			}
+			for (; i < rowSize; i++)
+			{
+				std::swap(top[i], bottom[i]);
+			}
+		}
+	}
+
+	AVX2_FUNCTION void ExpandRgbToRgbaAvx2(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba)
+	{
+		// Each 128-bit lane gets 4 pixels (12 of its 16 bytes), spread out to 4 bytes each by one shuffle.
+		// The second load reads 16 bytes from byte 12, so the last pixels are left to the scalar loop
+		const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+		std::size_t i = 0;
+		for (; i + 10 <= pixelCount; i += 8)
+		{
+			__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+			__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3 + 12));
+			__m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(bytes, spread), opaque));
+		}
+		ExpandRgbToRgbaScalar(rgb + i * 3, pixelCount - i, rgba + i * 4);
+	}
+
+	AVX2_FUNCTION void SwapRedBlueAvx2(unsigned char* rgba, std::size_t pixelCount)
+	{
+		const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		std::size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + i * 4));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_shuffle_epi8(pixels, swap));
+		}
+		SwapRedBlueScalar(rgba + i * 4, pixelCount - i);
+	}
+
+	AVX2_FUNCTION void PremultiplyAlphaAvx2(unsigned char* rgba, std::size_t pixelCount)
+	{
+		// Widened to 16 bits within each 128-bit lane, so packing them back keeps the pixels in order
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i broadcastAlpha = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1,
+			6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+		const __m256i alphaLanes = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+		const __m256i rounding = _mm256_set1_epi16(128);
+		std::size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + i * 4));
+			__m256i halves[2] = { _mm256_unpacklo_epi8(pixels, zero), _mm256_unpackhi_epi8(pixels, zero) };
+			for (__m256i& wide : halves)
+			{
+				__m256i alpha = _mm256_or_si256(_mm256_shuffle_epi8(wide, broadcastAlpha), alphaLanes);
+				__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(wide, alpha), rounding);
+				wide = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_packus_epi16(halves[0], halves[1]));
+		}
+		PremultiplyAlphaScalar(rgba + i * 4, pixelCount - i);
+	}
+
+	AVX2_FUNCTION void HalveRowSrgbAvx2(const unsigned char* row0, const unsigned char* row1, std::size_t rowSize, std::size_t halfRowSize,
+		int channels, unsigned char* halfRow)
+	{
+		// 8 bytes of the halved row at a time: the 4 source bytes of each are gathered (4 bytes read, the low one kept),
+		// then turned into linear light and back through the same tables as the scalar form. Which byte of a pixel the first
+		// of the 8 is repeats every channels bytes, so there is one pattern of source offsets per phase
+		const SrgbTables& tables = GetSrgbTables();
+		const int* toLinear = reinterpret_cast<const int*>(tables.toLinear);
+		const int* fromLinear = reinterpret_cast<const int*>(tables.fromLinear.data());
+		const __m256i lowByte = _mm256_set1_epi32(0xFF);
+		const __m256i rounding = _mm256_set1_epi32(2);
+		const __m256i packBytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m256i packLanes = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+		__m256i offsets[4];
+		__m256i alphaMasks[4];
+		for (int phase = 0; phase < channels; phase++)
+		{
+			int laneOffsets[8];
+			int laneAlpha[8];
+			for (int k = 0; k < 8; k++)
+			{
+				laneOffsets[k] = 2 * k - (phase + k) % channels;
+				laneAlpha[k] = (phase + k) % channels == 3 ? -1 : 0;
+			}
+			offsets[phase] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(laneOffsets));
+			alphaMasks[phase] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(laneAlpha));
+		}
+
+		// The gathers read up to 3 bytes past the last source byte they keep, which must stay inside the row
+		std::size_t j = 0;
+		for (; j + 8 <= halfRowSize && 2 * j + 14 + channels + 4 <= rowSize; j += 8)
+		{
+			int phase = static_cast<int>(j % channels);
+			__m256i offset0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(2 * j)), offsets[phase]);
+			__m256i offset1 = _mm256_add_epi32(offset0, _mm256_set1_epi32(channels));
+			const int* source0 = reinterpret_cast<const int*>(row0);
+			const int* source1 = reinterpret_cast<const int*>(row1);
+			__m256i bytes00 = _mm256_and_si256(_mm256_i32gather_epi32(source0, offset0, 1), lowByte);
+			__m256i bytes01 = _mm256_and_si256(_mm256_i32gather_epi32(source0, offset1, 1), lowByte);
+			__m256i bytes10 = _mm256_and_si256(_mm256_i32gather_epi32(source1, offset0, 1), lowByte);
+			__m256i bytes11 = _mm256_and_si256(_mm256_i32gather_epi32(source1, offset1, 1), lowByte);
+
+			__m256i linearSum = _mm256_add_epi32(
+				_mm256_add_epi32(_mm256_i32gather_epi32(toLinear, bytes00, 4), _mm256_i32gather_epi32(toLinear, bytes01, 4)),
+				_mm256_add_epi32(_mm256_i32gather_epi32(toLinear, bytes10, 4), _mm256_i32gather_epi32(toLinear, bytes11, 4)));
+			__m256i color = _mm256_and_si256(
+				_mm256_i32gather_epi32(fromLinear, _mm256_srli_epi32(_mm256_add_epi32(linearSum, rounding), 2), 1), lowByte);
+
+			__m256i alphaSum = _mm256_add_epi32(_mm256_add_epi32(bytes00, bytes01), _mm256_add_epi32(bytes10, bytes11));
+			__m256i alpha = _mm256_srli_epi32(_mm256_add_epi32(alphaSum, rounding), 2);
+
+			__m256i averaged = _mm256_blendv_epi8(color, alpha, alphaMasks[phase]);
+			__m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(averaged, packBytes), packLanes);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(halfRow + j), _mm256_castsi256_si128(packed));
+		}
+		HalveRowSrgbScalar(row0, row1, j, halfRowSize, channels, false, halfRow);
+	}
+
+	bool HasAvx2()
+	{
+#if defined(_MSC_VER)
+		// AVX2 is usable if the processor has it (leaf 7) and the operating system saves the AVX registers (XGETBV)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+		__cpuid(info, 1);
+		bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return osSavesAvx && (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+#endif
+
+#if defined(PIXEL_KERNELS_NEON)
+	// --- NEON kernels ---
+
+	void FlipRowsNeon(unsigned char* pixels, std::size_t rowSize, int height)
+	{
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = pixels + static_cast<std::size_t>(y) * rowSize;
+			unsigned char* bottom = pixels + static_cast<std::size_t>(height - 1 - y) * rowSize;
+			std::size_t i = 0;
+			for (; i + 16 <= rowSize; i += 16)
+			{
+				uint8x16_t topBytes = vld1q_u8(top + i);
+				uint8x16_t bottomBytes = vld1q_u8(bottom + i);
+				vst1q_u8(top + i, bottomBytes);
+				vst1q_u8(bottom + i, topBytes);
+			}
+			for (; i < rowSize; i++)
+			{
+				std::swap(top[i], bottom[i]);
+			}
+		}
+	}
+
+	void ExpandRgbToRgbaNeon(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba)
+	{
+		std::size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			uint8x16x3_t color = vld3q_u8(rgb + i * 3);
+			uint8x16x4_t pixels = { { color.val[0], color.val[1], color.val[2], vdupq_n_u8(255) } };
+			vst4q_u8(rgba + i * 4, pixels);
+		}
+		ExpandRgbToRgbaScalar(rgb + i * 3, pixelCount - i, rgba + i * 4);
+	}
+
+	void SwapRedBlueNeon(unsigned char* rgba, std::size_t pixelCount)
+	{
+		std::size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			uint8x16x4_t pixels = vld4q_u8(rgba + i * 4);
+			uint8x16_t red = pixels.val[0];
+			pixels.val[0] = pixels.val[2];
+			pixels.val[2] = red;
+			vst4q_u8(rgba + i * 4, pixels);
+		}
+		SwapRedBlueScalar(rgba + i * 4, pixelCount - i);
+	}
+
+	inline uint8x8_t MultiplyAlphaNeon(uint8x8_t color, uint8x8_t alpha)
+	{
+		uint16x8_t product = vaddq_u16(vmull_u8(color, alpha), vdupq_n_u16(128));
+		return vshrn_n_u16(vaddq_u16(product, vshrq_n_u16(product, 8)), 8);
+	}
+
+	void PremultiplyAlphaNeon(unsigned char* rgba, std::size_t pixelCount)
+	{
+		std::size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			uint8x16x4_t pixels = vld4q_u8(rgba + i * 4);
+			for (int c = 0; c < 3; c++)
+			{
+				pixels.val[c] = vcombine_u8(MultiplyAlphaNeon(vget_low_u8(pixels.val[c]), vget_low_u8(pixels.val[3])),
+					MultiplyAlphaNeon(vget_high_u8(pixels.val[c]), vget_high_u8(pixels.val[3])));
+			}
+			vst4q_u8(rgba + i * 4, pixels);
+		}
+		PremultiplyAlphaScalar(rgba + i * 4, pixelCount - i);
+	}
+#endif
+}
+
+PixelKernelLevel GetPixelKernelLevel()
+{
+	static const PixelKernelLevel level = []()
+		{
+#if defined(PIXEL_KERNELS_X86)
+			return HasAvx2() ? PixelKernelLevel::Avx2 : PixelKernelLevel::Sse2;
+#elif defined(PIXEL_KERNELS_NEON)
+			return PixelKernelLevel::Neon;
+#else
+			return PixelKernelLevel::Scalar;
+#endif
+		}();
+	return level;
+}
+
+bool IsPixelKernelLevelSupported(PixelKernelLevel level)
+{
+	switch (level)
+	{
+	case PixelKernelLevel::Scalar:
+		return true;
+#if defined(PIXEL_KERNELS_X86)
+	case PixelKernelLevel::Sse2:
+		return true;
+	case PixelKernelLevel::Avx2:
+		return GetPixelKernelLevel() == PixelKernelLevel::Avx2;
+#elif defined(PIXEL_KERNELS_NEON)
+	case PixelKernelLevel::Neon:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+const char* GetPixelKernelLevelName(PixelKernelLevel level)
+{
+	switch (level)
+	{
+	case PixelKernelLevel::Sse2:
+		return "SSE2";
+	case PixelKernelLevel::Avx2:
+		return "AVX2";
+	case PixelKernelLevel::Neon:
+		return "NEON";
+	default:
+		return "Scalar";
+	}
+}
+
+void FlipRows(unsigned char* pixels, int width, int height, int channels, PixelKernelLevel level)
+{
+	std::size_t rowSize = static_cast<std::size_t>(width) * channels;
+	switch (level)
+	{
+#if defined(PIXEL_KERNELS_X86)
+	case PixelKernelLevel::Sse2:
+		FlipRowsSse2(pixels, rowSize, height);
+		return;
+	case PixelKernelLevel::Avx2:
+		FlipRowsAvx2(pixels, rowSize, height);
+		return;
+#elif defined(PIXEL_KERNELS_NEON)
+	case PixelKernelLevel::Neon:
+		FlipRowsNeon(pixels, rowSize, height);
+		return;
+#endif
+	default:
+		FlipRowsScalar(pixels, rowSize, height);
+		return;
+	}
+}
+
+void ExpandRgbToRgba(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba, PixelKernelLevel level)
+{
+	switch (level)
+	{
+#if defined(PIXEL_KERNELS_X86)
+	case PixelKernelLevel::Sse2:
+		ExpandRgbToRgbaSse2(rgb, pixelCount, rgba);
+		return;
+	case PixelKernelLevel::Avx2:
+		ExpandRgbToRgbaAvx2(rgb, pixelCount, rgba);
+		return;
+#elif defined(PIXEL_KERNELS_NEON)
+	case PixelKernelLevel::Neon:
+		ExpandRgbToRgbaNeon(rgb, pixelCount, rgba);
+		return;
+#endif
+	default:
+		ExpandRgbToRgbaScalar(rgb, pixelCount, rgba);
+		return;
+	}
+}
+
+void SwapRedBlue(unsigned char* rgba, std::size_t pixelCount, PixelKernelLevel level)
+{
+	switch (level)
+	{
+#if defined(PIXEL_KERNELS_X86)
+	case PixelKernelLevel::Sse2:
+		SwapRedBlueSse2(rgba, pixelCount);
+		return;
+	case PixelKernelLevel::Avx2:
+		SwapRedBlueAvx2(rgba, pixelCount);
+		return;
+#elif defined(PIXEL_KERNELS_NEON)
+	case PixelKernelLevel::Neon:
+		SwapRedBlueNeon(rgba, pixelCount);
+		return;
+#endif
+	default:
+		SwapRedBlueScalar(rgba, pixelCount);
+		return;
+	}
+}
+
+void PremultiplyAlpha(unsigned char* rgba, std::size_t pixelCount, PixelKernelLevel level)
+{
+	switch (level)
+	{
+#if defined(PIXEL_KERNELS_X86)
+	case PixelKernelLevel::Sse2:
+		PremultiplyAlphaSse2(rgba, pixelCount);
+		return;
+	case PixelKernelLevel::Avx2:
+		PremultiplyAlphaAvx2(rgba, pixelCount);
+		return;
+#elif defined(PIXEL_KERNELS_NEON)
+	case PixelKernelLevel::Neon:
+		PremultiplyAlphaNeon(rgba, pixelCount);
+		return;
+#endif
+	default:
+		PremultiplyAlphaScalar(rgba, pixelCount);
+		return;
+	}
+}
+
+void HalveImageSrgb(const unsigned char* pixels, int width, int height, int channels, unsigned char* half, PixelKernelLevel level)
+{
+	int halfWidth = std::max(1, width / 2);
+	int halfHeight = std::max(1, height / 2);
+	std::size_t rowSize = static_cast<std::size_t>(width) * channels;
+	std::size_t halfRowSize = static_cast<std::size_t>(halfWidth) * channels;
+	for (int y = 0; y < halfHeight; y++)
+	{
+		const unsigned char* row0 = pixels + static_cast<std::size_t>(std::min(y * 2, height - 1)) * rowSize;
+		const unsigned char* row1 = pixels + static_cast<std::size_t>(std::min(y * 2 + 1, height - 1)) * rowSize;
+		unsigned char* halfRow = half + static_cast<std::size_t>(y) * halfRowSize;
+
+		// Only AVX2 can look up the tables several values at a time; the other instruction sets run the scalar form
+#if defined(PIXEL_KERNELS_X86)
+		if (level == PixelKernelLevel::Avx2 && width > 1)
+		{
+			HalveRowSrgbAvx2(row0, row1, rowSize, halfRowSize, channels, halfRow);
+			continue;
+		}
+#endif
+		HalveRowSrgbScalar(row0, row1, 0, halfRowSize, channels, width == 1, halfRow);
+	}
+}
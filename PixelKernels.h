@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+
+/// <summary>
+/// Instruction set a pixel kernel runs with. Every kernel has a scalar form, which the others must match byte for byte;
+/// a kernel with no form for an instruction set runs its scalar one there.
+/// </summary>
+enum class PixelKernelLevel
+{
+	Scalar,		// Plain C++
+	Sse2,		// 128-bit SSE2, which every x86-64 processor has
+	Avx2,		// 256-bit AVX2, on x86-64 processors that have it
+	Neon		// 128-bit NEON, which every 64-bit ARM processor has
+};
+
+/// <summary>
+/// Fastest instruction set this processor supports, found once.
+/// </summary>
+/// <returns>Level every kernel runs with by default</returns>
+PixelKernelLevel GetPixelKernelLevel();
+
+/// <summary>
+/// Checks if this processor (and the build) can run kernels with an instruction set.
+/// </summary>
+/// <param name="level">Instruction set</param>
+/// <returns>True if the kernels can run with it</returns>
+bool IsPixelKernelLevelSupported(PixelKernelLevel level);
+
+/// <summary>
+/// Name of an instruction set, for reports.
+/// </summary>
+/// <param name="level">Instruction set</param>
+/// <returns>Name such as "AVX2"</returns>
+const char* GetPixelKernelLevelName(PixelKernelLevel level);
+
+/// <summary>
+/// Reverses the order of the rows of an image in place, so that an image decoded top row first is stored bottom row first
+/// (the way OpenGL expects it), or the other way around.
+/// </summary>
+/// <param name="pixels">Tightly packed rows of the image</param>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="height">Height of the image in pixels</param>
+/// <param name="channels">Bytes per pixel</param>
+/// <param name="level">Instruction set to run with</param>
+void FlipRows(unsigned char* pixels, int width, int height, int channels, PixelKernelLevel level = GetPixelKernelLevel());
+
+/// <summary>
+/// Widens RGB pixels to RGBA, with an opaque alpha.
+/// </summary>
+/// <param name="rgb">Pixels to widen, 3 bytes each</param>
+/// <param name="pixelCount">Number of pixels</param>
+/// <param name="rgba">Receives the pixels, 4 bytes each (must not overlap rgb)</param>
+/// <param name="level">Instruction set to run with</param>
+void ExpandRgbToRgba(const unsigned char* rgb, std::size_t pixelCount, unsigned char* rgba, PixelKernelLevel level = GetPixelKernelLevel());
+
+/// <summary>
+/// Swaps the red and blue channels of RGBA pixels in place, turning them into BGRA or back.
+/// </summary>
+/// <param name="rgba">Pixels, 4 bytes each</param>
+/// <param name="pixelCount">Number of pixels</param>
+/// <param name="level">Instruction set to run with</param>
+void SwapRedBlue(unsigned char* rgba, std::size_t pixelCount, PixelKernelLevel level = GetPixelKernelLevel());
+
+/// <summary>
+/// Multiplies the color of RGBA pixels by their alpha in place, rounding to the nearest value.
+/// </summary>
+/// <param name="rgba">Pixels, 4 bytes each</param>
+/// <param name="pixelCount">Number of pixels</param>
+/// <param name="level">Instruction set to run with</param>
+void PremultiplyAlpha(unsigned char* rgba, std::size_t pixelCount, PixelKernelLevel level = GetPixelKernelLevel());
+
+/// <summary>
+/// Averages each 2x2 block of pixels into one, for the next level of a mip chain. The color channels are sRGB, so they are
+/// averaged in linear light (averaging the stored values would darken the level, most of all where light and dark meet);
+/// alpha is averaged as it is. An odd last row or column is left out, and the only row or column
+/// of an image 1 pixel high or wide is used twice.
+/// </summary>
+/// <param name="pixels">Tightly packed rows of the image</param>
+/// <param name="width">Width of the image in pixels</param>
+/// <param name="height">Height of the image in pixels</param>
+/// <param name="channels">Bytes per pixel: 3 (RGB) or 4 (RGBA)</param>
+/// <param name="half">Receives the max(1, width / 2) x max(1, height / 2) halved image</param>
+/// <param name="level">Instruction set to run with</param>
+void HalveImageSrgb(const unsigned char* pixels, int width, int height, int channels, unsigned char* half,
+	PixelKernelLevel level = GetPixelKernelLevel());
@@ -0,0 +1,195 @@
+#include "ProgramOptions.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	void PrintUsage(const char* programName)
+	{
+		std::cerr << "Usage: " << programName << " [options]" << std::endl
+			<< "  --archive <file>        Archive of the cooked assets and shaders (default: cooked/assets.pak)" << std::endl
+			<< "  --source-assets         Load the source .obj, image and shader files, ignoring the asset archive" << std::endl
+			<< "  --serial-obj            Parse each .obj file on a single thread" << std::endl
+			<< "  --buffered-obj          Read each .obj file into a buffer instead of memory mapping it" << std::endl
+			<< "  --no-mesh-cache         Always parse the .obj files, without reading or writing the binary mesh caches" << std::endl
+			<< "  --no-mesh-optimization  Keep the triangle and vertex order of the .obj files" << std::endl
+			<< "  --no-lods               Always draw the models at full detail, without building levels of detail" << std::endl
+			<< "  --no-meshlets           Draw every triangle of a model's level of detail, without splitting it into culled meshlets" << std::endl
+			<< "  --lod-error <px>        Largest error a level of detail may show on screen, in pixels (default: 1)" << std::endl
+			<< "  --float-vertices        Upload the exhibits as 36-byte float vertices instead of 16-byte quantized ones" << std::endl
+			<< "  --no-mipmaps            Sample the textures bilinearly from their full-size level only" << std::endl
+			<< "  --anisotropy <n>        Most samples anisotropic texture filtering takes, 1 to turn it off (default: 8)" << std::endl
+			<< "  --no-texture-arrays     Give each of the room's images its own texture, and draw the room one texture at a time" << std::endl
+			<< "  --no-virtual-textures   Load the paintings whole instead of paging in the tiles that are seen" << std::endl
+			<< "  --benchmark-obj         Compare memory mapped and buffered .obj reading on every exhibit, then exit" << std::endl
+			<< "  --benchmark-lod         Report the triangles the levels of detail save from typical viewpoints, then exit" << std::endl
+			<< "  --benchmark-pixels      Check the SIMD pixel kernels against their scalar forms and time them, then exit" << std::endl
+			<< "  --threads <n>           Number of worker threads (default: one per hardware thread)" << std::endl
+			<< "  --blocking-load         Load every exhibit before showing the first frame" << std::endl
+			<< "  --upload-budget <ms>    Time per frame spent uploading streamed-in exhibits (default: 2)" << std::endl
+			<< "  --upload-ring <MiB>     Size of the mapped buffer exhibit textures are staged in, 0 for none (default: 32)" << std::endl
+			<< "  --no-hot-reload         Do not watch the shaders, textures and models for changes while running" << std::endl
+			<< "  --profile-startup       Print the time, reads and GPU memory of each stage of startup and each asset, slowest first" << std::endl
+			<< "  --profile-json <file>   Write the startup profile to a JSON file" << std::endl
+			<< "  --quit-when-loaded      Close the program once every exhibit is loaded" << std::endl;
+	}
+}
+
+bool ParseProgramOptions(int argc, char** argv, ProgramOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--archive" && i + 1 < argc)
+		{
+			options.assetArchive = argv[++i];
+		}
+		else if (argument == "--source-assets")
+		{
+			options.assetArchive.clear();
+		}
+		else if (argument == "--serial-obj")
+		{
+			options.parallelObjParsing = false;
+		}
+		else if (argument == "--buffered-obj")
+		{
+			options.memoryMappedObj = false;
+		}
+		else if (argument == "--no-mesh-cache")
+		{
+			options.meshCache = false;
+		}
+		else if (argument == "--no-mesh-optimization")
+		{
+			options.meshOptimization = false;
+		}
+		else if (argument == "--no-lods")
+		{
+			options.meshLods = false;
+		}
+		else if (argument == "--no-meshlets")
+		{
+			options.meshlets = false;
+		}
+		else if (argument == "--lod-error" && i + 1 < argc)
+		{
+			char* numberEnd = nullptr;
+			double pixels = std::strtod(argv[++i], &numberEnd);
+			if (numberEnd == argv[i] || *numberEnd != '\0' || !(pixels > 0.0))
+			{
+				std::cerr << "Invalid level of detail error: " << argv[i] << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+			options.lodPixelError = static_cast<float>(pixels);
+		}
+		else if (argument == "--float-vertices")
+		{
+			options.compactVertices = false;
+		}
+		else if (argument == "--no-mipmaps")
+		{
+			options.mipmaps = false;
+		}
+		else if (argument == "--no-texture-arrays")
+		{
+			options.textureArrays = false;
+		}
+		else if (argument == "--no-virtual-textures")
+		{
+			options.virtualTextures = false;
+		}
+		else if (argument == "--anisotropy" && i + 1 < argc)
+		{
+			char* numberEnd = nullptr;
+			double anisotropy = std::strtod(argv[++i], &numberEnd);
+			if (numberEnd == argv[i] || *numberEnd != '\0' || !(anisotropy >= 1.0))
+			{
+				std::cerr << "Invalid anisotropy: " << argv[i] << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+			options.textureAnisotropy = static_cast<float>(anisotropy);
+		}
+		else if (argument == "--benchmark-obj")
+		{
+			options.benchmarkObjReading = true;
+		}
+		else if (argument == "--threads" && i + 1 < argc)
+		{
+			char* numberEnd = nullptr;
+			unsigned long threadCount = std::strtoul(argv[++i], &numberEnd, 10);
+			if (numberEnd == argv[i] || *numberEnd != '\0')
+			{
+				std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+			options.workerThreads = static_cast<unsigned int>(threadCount);
+		}
+		else if (argument == "--benchmark-lod")
+		{
+			options.benchmarkLods = true;
+		}
+		else if (argument == "--benchmark-pixels")
+		{
+			options.benchmarkPixelKernels = true;
+		}
+		else if (argument == "--blocking-load")
+		{
+			options.progressiveLoading = false;
+		}
+		else if (argument == "--upload-budget" && i + 1 < argc)
+		{
+			char* numberEnd = nullptr;
+			double budget = std::strtod(argv[++i], &numberEnd);
+			if (numberEnd == argv[i] || *numberEnd != '\0' || !(budget > 0.0))
+			{
+				std::cerr << "Invalid upload budget: " << argv[i] << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+			options.uploadBudgetMilliseconds = budget;
+		}
+		else if (argument == "--upload-ring" && i + 1 < argc)
+		{
+			char* numberEnd = nullptr;
+			unsigned long megabytes = std::strtoul(argv[++i], &numberEnd, 10);
+			if (numberEnd == argv[i] || *numberEnd != '\0' || megabytes > 1024)
+			{
+				std::cerr << "Invalid upload ring size: " << argv[i] << std::endl;
+				PrintUsage(argv[0]);
+				return false;
+			}
+			options.uploadRingMegabytes = static_cast<unsigned int>(megabytes);
+		}
+		else if (argument == "--no-hot-reload")
+		{
+			options.hotReload = false;
+		}
+		else if (argument == "--profile-startup")
+		{
+			options.profileStartup = true;
+		}
+		else if (argument == "--profile-json" && i + 1 < argc)
+		{
+			options.startupProfilePath = argv[++i];
+		}
+		else if (argument == "--quit-when-loaded")
+		{
+			options.quitWhenLoaded = true;
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << argument << std::endl;
+			PrintUsage(argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "CookedAssets.h"
+
+#include <string>
+
+/// <summary>
+/// Settings that can be changed from the command line
+/// </summary>
+struct ProgramOptions
+{
+	/// <summary>
+	/// Archive of the assets cooked by AssetCooker, loaded instead of the source files when present (empty to ignore)
+	/// </summary>
+	std::string assetArchive = std::string(DefaultCookedDirectory) + "/" + AssetArchiveFileName;
+
+	/// <summary>
+	/// Indicates if large .obj files are split into chunks that are parsed on the worker threads
+	/// </summary>
+	bool parallelObjParsing = true;
+
+	/// <summary>
+	/// Indicates if .obj files are parsed straight out of a memory mapping instead of being read into a buffer first
+	/// </summary>
+	bool memoryMappedObj = true;
+
+	/// <summary>
+	/// Indicates if the models are loaded from (and saved to) a binary mesh cache next to each .obj file
+	/// </summary>
+	bool meshCache = true;
+
+	/// <summary>
+	/// Indicates if the triangles and vertices of parsed models are reordered for the GPU's vertex cache and overdraw
+	/// </summary>
+	bool meshOptimization = true;
+
+	/// <summary>
+	/// Indicates if parsed models get simplified levels of detail, picked at runtime by their error on screen
+	/// </summary>
+	bool meshLods = true;
+
+	/// <summary>
+	/// Indicates if parsed models are split into meshlets, so the ones outside the view or facing away from the camera are skipped
+	/// </summary>
+	bool meshlets = true;
+
+	/// <summary>
+	/// Largest error a level of detail may show on screen, in pixels
+	/// </summary>
+	float lodPixelError = 1.0f;
+
+	/// <summary>
+	/// Indicates if the exhibits are uploaded in the 16-byte quantized vertex format instead of the 36-byte float one
+	/// </summary>
+	bool compactVertices = true;
+
+	/// <summary>
+	/// Indicates if minified textures are sampled from their mip chains with trilinear filtering
+	/// </summary>
+	bool mipmaps = true;
+
+	/// <summary>
+	/// Most samples anisotropic filtering takes from a texture seen at a grazing angle (1 turns it off)
+	/// </summary>
+	float textureAnisotropy = 8.0f;
+
+	/// <summary>
+	/// Indicates if the room's images are packed into one texture array, so that the room, the platforms and the paintings draw with one call
+	/// </summary>
+	bool textureArrays = true;
+
+	/// <summary>
+	/// Indicates if the paintings are drawn as virtual textures, paging in only the tiles that are seen, when the asset archive has their tiled textures
+	/// </summary>
+	bool virtualTextures = true;
+
+	/// <summary>
+	/// Indicates if the program only benchmarks the ways of reading the .obj files, then exits
+	/// </summary>
+	bool benchmarkObjReading = false;
+
+	/// <summary>
+	/// Indicates if the program only reports the triangles the levels of detail save from typical viewpoints, then exits
+	/// </summary>
+	bool benchmarkLods = false;
+
+	/// <summary>
+	/// Indicates if the program only checks the pixel kernels against their scalar forms and times them, then exits
+	/// </summary>
+	bool benchmarkPixelKernels = false;
+
+	/// <summary>
+	/// Indicates if the render loop starts as soon as the room is ready, with the exhibits streaming in afterwards
+	/// </summary>
+	bool progressiveLoading = true;
+
+	/// <summary>
+	/// Time per frame the render loop may spend uploading streamed-in exhibits, in milliseconds
+	/// </summary>
+	double uploadBudgetMilliseconds = 2.0;
+
+	/// <summary>
+	/// Size of the persistently mapped ring the exhibits' textures are staged in, in megabytes (0 to upload them from their own pixels)
+	/// </summary>
+	unsigned int uploadRingMegabytes = 32;
+
+	/// <summary>
+	/// Indicates if the shaders, textures and models are loaded again whenever their files change
+	/// </summary>
+	bool hotReload = true;
+
+	/// <summary>
+	/// Number of worker threads (0 uses one per hardware thread)
+	/// </summary>
+	unsigned int workerThreads = 0;
+
+	/// <summary>
+	/// Indicates if the time, reads and GPU memory of every stage of startup and every asset are printed once all the exhibits are in
+	/// </summary>
+	bool profileStartup = false;
+
+	/// <summary>
+	/// JSON file the startup profile is written to once all the exhibits are in (empty for none)
+	/// </summary>
+	std::string startupProfilePath;
+
+	/// <summary>
+	/// Indicates if the program closes once all the exhibits are in, so startup can be timed without anyone at the keyboard
+	/// </summary>
+	bool quitWhenLoaded = false;
+};
+
+/// <summary>
+/// Reads the program options from the command line arguments.
+/// </summary>
+/// <param name="argc">Number of command line arguments</param>
+/// <param name="argv">Command line arguments</param>
+/// <param name="options">Receives the program options</param>
+/// <returns>True if every argument was understood</returns>
+bool ParseProgramOptions(int argc, char** argv, ProgramOptions& options);
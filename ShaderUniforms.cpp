@@ -0,0 +1,128 @@
+#include "ShaderUniforms.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <>
+void Uniform<bool>::Set(const bool& value) const
+{
+	glUniform1i(location, value ? GL_TRUE : GL_FALSE);
+}
+
+template <>
+void Uniform<GLint>::Set(const GLint& value) const
+{
+	glUniform1i(location, value);
+}
+
+template <>
+void Uniform<GLfloat>::Set(const GLfloat& value) const
+{
+	glUniform1f(location, value);
+}
+
+template <>
+void UniformArray<glm::vec3>::Set(const glm::vec3* values, GLsizei count) const
+{
+	glUniform3fv(location, count, glm::value_ptr(values[0]));
+}
+
+void ReflectShaderUniforms(GLuint program, ShaderUniforms& uniforms)
+{
+	uniforms = ShaderUniforms();
+	uniforms.program = program;
+
+	// Name of each uniform the fields stand for, with the field that receives its location
+	struct Field
+	{
+		const char* name;
+		GLint* location;
+	};
+	const Field fields[] =
+	{
+		{ "tex", &uniforms.tex.location },
+		{ "texArray", &uniforms.texArray.location },
+		{ "useTextureArray", &uniforms.useTextureArray.location },
+		{ "useVirtualTextures", &uniforms.useVirtualTextures.location },
+		{ "firstVirtualLayer", &uniforms.firstVirtualLayer.location },
+		{ "pageTable", &uniforms.pageTable.location },
+		{ "tileCache", &uniforms.tileCache.location },
+		{ "virtualTextureSize", &uniforms.virtualTextureSize.location },
+		{ "virtualLevelBias", &uniforms.virtualLevelBias.location }
+	};
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<GLchar> nameBuffer(static_cast<std::size_t>(maxNameLength) + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &nameLength, &size, &type, nameBuffer.data());
+
+		// An array is listed once, as its first element, whose location is the array's
+		std::string name(nameBuffer.data(), nameLength);
+		GLint location = glGetUniformLocation(program, name.c_str());
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+		{
+			name.resize(name.size() - 3);
+		}
+
+		// Uniforms in blocks have no location of their own
+		if (location < 0)
+		{
+			continue;
+		}
+
+		bool found = false;
+		for (const Field& field : fields)
+		{
+			if (name == field.name)
+			{
+				*field.location = location;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			std::cerr << "Uniform " << name << " of program " << program << " has no field in ShaderUniforms, so it is never set" << std::endl;
+		}
+	}
+
+	// Each block is read from the same binding point in every program, where the render loop binds its part of the uniform ring
+	struct Block
+	{
+		const char* name;
+		GLuint binding;
+		std::size_t size;
+	};
+	const Block blocks[] =
+	{
+		{ "FrameUniforms", FrameUniformsBinding, sizeof(FrameUniformBlock) },
+		{ "ObjectUniforms", ObjectUniformsBinding, sizeof(ObjectUniformBlock) }
+	};
+	for (const Block& block : blocks)
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(program, block.name);
+		if (blockIndex == GL_INVALID_INDEX)
+		{
+			continue;
+		}
+
+		GLint dataSize = 0;
+		glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+		if (static_cast<std::size_t>(dataSize) != block.size)
+		{
+			std::cerr << "Uniform block " << block.name << " of program " << program << " takes " << dataSize << " bytes, but its struct has "
+				<< block.size << std::endl;
+		}
+		glUniformBlockBinding(program, blockIndex, block.binding);
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Location of a uniform of a linked program, with the setter for its type. A uniform the program does not use
+/// keeps the location -1, which OpenGL ignores, so it can be set all the same.
+/// </summary>
+template <typename T>
+struct Uniform
+{
+	GLint location = -1;
+
+	/// <summary>
+	/// Sets the uniform of the program in use.
+	/// </summary>
+	/// <param name="value">Value of the uniform</param>
+	void Set(const T& value) const;
+};
+
+template <> void Uniform<bool>::Set(const bool& value) const;
+template <> void Uniform<GLint>::Set(const GLint& value) const;
+template <> void Uniform<GLfloat>::Set(const GLfloat& value) const;
+
+/// <summary>
+/// Location of the first element of a uniform array, whose elements are set together
+/// </summary>
+template <typename T>
+struct UniformArray
+{
+	GLint location = -1;
+
+	/// <summary>
+	/// Sets the first elements of the uniform array of the program in use.
+	/// </summary>
+	/// <param name="values">Values of the elements</param>
+	/// <param name="count">Number of elements to set (at most the size of the array)</param>
+	void Set(const T* values, GLsizei count) const;
+};
+
+template <> void UniformArray<glm::vec3>::Set(const glm::vec3* values, GLsizei count) const;
+
+/// <summary>
+/// Uniform buffer binding point of FrameUniforms
+/// </summary>
+const GLuint FrameUniformsBinding = 0;
+
+/// <summary>
+/// Uniform buffer binding point of ObjectUniforms
+/// </summary>
+const GLuint ObjectUniformsBinding = 1;
+
+/// <summary>
+/// Contents of the FrameUniforms block of main.vsh and main.fsh, laid out as std140: the camera and the lights,
+/// the same for everything drawn in a frame. Each vec3 takes 16 bytes, the last 4 of which a float may fill.
+/// </summary>
+struct FrameUniformBlock
+{
+	glm::mat4 proj;
+	glm::mat4 view;
+	glm::vec3 cameraPosition;
+	float padding0;
+
+	// Point light
+	glm::vec3 lightPosition;
+	float padding1;
+	glm::vec3 lightAmbient;
+	float padding2;
+	glm::vec3 lightDiffuse;
+	float padding3;
+	glm::vec3 lightSpecular;
+	float padding4;
+
+	// Spot lights (the elements of a vec3 array are 16 bytes apart, so only xyz is used)
+	glm::vec4 spotlightPosition[4];
+	glm::vec3 spotlightAmbient;
+	float padding5;
+	glm::vec3 spotlightDiffuse;
+	float padding6;
+	glm::vec3 spotlightSpecular;
+	float padding7;
+	glm::vec3 spotlightTarget;
+	float spotlightCutoff;
+
+	// Material of every object
+	glm::vec3 objectSpecular;
+	float shininess;
+};
+
+static_assert(sizeof(FrameUniformBlock) == 352, "FrameUniformBlock must match the std140 layout of FrameUniforms");
+
+/// <summary>
+/// Contents of the ObjectUniforms block of main.vsh, laid out as std140: where one object is drawn
+/// </summary>
+struct ObjectUniformBlock
+{
+	glm::mat4 model;
+	glm::mat4 normMatrix;
+
+	// Dequantization of the position (see main.vsh)
+	glm::vec3 positionOffset;
+	float padding0;
+	glm::vec3 positionScale;
+	float padding1;
+};
+
+static_assert(sizeof(ObjectUniformBlock) == 160, "ObjectUniformBlock must match the std140 layout of ObjectUniforms");
+
+/// <summary>
+/// Every uniform main.fsh and feedback.fsh declare outside the uniform blocks, found once each time the program links instead of
+/// by name every time one is set (each glGetUniformLocation is a string lookup in the driver). Both programs use the same
+/// fields; the uniforms a program does not use stay at -1.
+/// </summary>
+struct ShaderUniforms
+{
+	GLuint program = 0;								// Program the locations were found in (0 before ReflectShaderUniforms)
+
+	// Textures
+	Uniform<GLint> tex;
+	Uniform<GLint> texArray;
+	Uniform<bool> useTextureArray;
+
+	// Virtual textures (see VirtualTextures::SetUniforms)
+	Uniform<bool> useVirtualTextures;
+	Uniform<GLfloat> firstVirtualLayer;
+	Uniform<GLint> pageTable;
+	Uniform<GLint> tileCache;
+	UniformArray<glm::vec3> virtualTextureSize;
+	Uniform<GLfloat> virtualLevelBias;
+};
+
+/// <summary>
+/// Finds the location of every active uniform of a linked program (glGetProgramiv and glGetActiveUniform)
+/// and stores it in its field, then binds the program's uniform blocks to FrameUniformsBinding and ObjectUniformsBinding.
+/// An active uniform with no field, or a block whose size differs from its struct, is reported.
+/// </summary>
+/// <param name="program">Linked program</param>
+/// <param name="uniforms">Receives the locations, and the program they were found in</param>
+void ReflectShaderUniforms(GLuint program, ShaderUniforms& uniforms);
@@ -0,0 +1,200 @@
+#include "StartupProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+
+namespace
+{
+	/// <summary>
+	/// Writes a string as a JSON string literal, escaping the characters JSON does not allow as they are.
+	/// </summary>
+	void WriteJsonString(std::ostream& stream, const std::string& text)
+	{
+		stream << '"';
+		for (char character : text)
+		{
+			switch (character)
+			{
+			case '"':
+				stream << "\\\"";
+				break;
+			case '\\':
+				stream << "\\\\";
+				break;
+			case '\n':
+				stream << "\\n";
+				break;
+			case '\t':
+				stream << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+				{
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(character)));
+					stream << escaped;
+				}
+				else
+				{
+					stream << character;
+				}
+				break;
+			}
+		}
+		stream << '"';
+	}
+}
+
+StartupProfile::StartupProfile(std::chrono::steady_clock::time_point startTime)
+	: startTime(startTime)
+{
+}
+
+double StartupProfile::GetSeconds() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+StartupProfileEntry StartupProfile::Begin(const std::string& stage, const std::string& asset) const
+{
+	StartupProfileEntry entry;
+	entry.stage = stage;
+	entry.asset = asset;
+	entry.start = GetSeconds();
+	return entry;
+}
+
+void StartupProfile::End(StartupProfileEntry& entry)
+{
+	entry.seconds = GetSeconds() - entry.start;
+	Add(entry);
+}
+
+void StartupProfile::Add(const StartupProfileEntry& entry)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.push_back(entry);
+}
+
+void StartupProfile::AddMilestone(const std::string& name)
+{
+	double seconds = GetSeconds();
+	std::lock_guard<std::mutex> lock(mutex);
+	milestones.push_back({ name, seconds });
+}
+
+void StartupProfile::Print(std::ostream& stream) const
+{
+	std::vector<StartupProfileEntry> sorted;
+	std::vector<Milestone> reached;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		sorted = entries;
+		reached = milestones;
+	}
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[](const StartupProfileEntry& a, const StartupProfileEntry& b) { return a.seconds > b.seconds; });
+
+	stream << "Startup profile, slowest first (decode and upload are the time spent in each step; "
+		<< "the total also counts time spent waiting for a worker thread or a frame)" << std::endl;
+	stream << std::left << std::setw(16) << "Stage" << std::setw(42) << "Asset" << std::right
+		<< std::setw(10) << "Start ms"
+		<< std::setw(10) << "Total ms"
+		<< std::setw(11) << "Decode ms"
+		<< std::setw(11) << "Upload ms"
+		<< std::setw(11) << "Read KiB"
+		<< std::setw(11) << "GPU KiB" << std::endl;
+
+	std::ios::fmtflags flags = stream.flags();
+	std::streamsize precision = stream.precision();
+	stream << std::fixed << std::setprecision(2);
+
+	double decodeSeconds = 0.0;
+	double uploadSeconds = 0.0;
+	std::uint64_t bytesRead = 0;
+	std::uint64_t gpuBytes = 0;
+	for (const StartupProfileEntry& entry : sorted)
+	{
+		stream << std::left << std::setw(16) << entry.stage << std::setw(42) << entry.asset << std::right
+			<< std::setw(10) << entry.start * 1000.0
+			<< std::setw(10) << entry.seconds * 1000.0
+			<< std::setw(11) << entry.decodeSeconds * 1000.0
+			<< std::setw(11) << entry.uploadSeconds * 1000.0
+			<< std::setw(11) << entry.bytesRead / 1024.0
+			<< std::setw(11) << entry.gpuBytes / 1024.0 << std::endl;
+
+		decodeSeconds += entry.decodeSeconds;
+		uploadSeconds += entry.uploadSeconds;
+		bytesRead += entry.bytesRead;
+		gpuBytes += entry.gpuBytes;
+	}
+
+	stream << std::left << std::setw(78) << "Total" << std::right
+		<< std::setw(11) << decodeSeconds * 1000.0
+		<< std::setw(11) << uploadSeconds * 1000.0
+		<< std::setw(11) << bytesRead / 1024.0
+		<< std::setw(11) << gpuBytes / 1024.0 << std::endl;
+
+	for (const Milestone& milestone : reached)
+	{
+		stream << "  " << milestone.name << " after " << milestone.seconds * 1000.0 << " ms" << std::endl;
+	}
+
+	stream.flags(flags);
+	stream.precision(precision);
+}
+
+bool StartupProfile::WriteJson(const std::string& filePath) const
+{
+	std::vector<StartupProfileEntry> written;
+	std::vector<Milestone> reached;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		written = entries;
+		reached = milestones;
+	}
+
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cerr << "Failed to create startup profile: " << filePath << std::endl;
+		return false;
+	}
+
+	// Times are in milliseconds and sizes in bytes; the entries keep the order they finished in
+	file << std::setprecision(6);
+	file << "{" << std::endl << "\t\"milestones\": [";
+	for (std::size_t i = 0; i < reached.size(); i++)
+	{
+		file << (i == 0 ? "" : ",") << std::endl << "\t\t{ \"name\": ";
+		WriteJsonString(file, reached[i].name);
+		file << ", \"ms\": " << reached[i].seconds * 1000.0 << " }";
+	}
+	file << std::endl << "\t]," << std::endl << "\t\"entries\": [";
+	for (std::size_t i = 0; i < written.size(); i++)
+	{
+		const StartupProfileEntry& entry = written[i];
+		file << (i == 0 ? "" : ",") << std::endl << "\t\t{ \"stage\": ";
+		WriteJsonString(file, entry.stage);
+		file << ", \"asset\": ";
+		WriteJsonString(file, entry.asset);
+		file << ", \"startMs\": " << entry.start * 1000.0
+			<< ", \"totalMs\": " << entry.seconds * 1000.0
+			<< ", \"decodeMs\": " << entry.decodeSeconds * 1000.0
+			<< ", \"uploadMs\": " << entry.uploadSeconds * 1000.0
+			<< ", \"bytesRead\": " << entry.bytesRead
+			<< ", \"gpuBytes\": " << entry.gpuBytes << " }";
+	}
+	file << std::endl << "\t]" << std::endl << "}" << std::endl;
+
+	if (!file)
+	{
+		std::cerr << "Failed to write startup profile: " << filePath << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Time and memory spent on one stage of startup, or on one asset
+/// </summary>
+struct StartupProfileEntry
+{
+	std::string stage;				// Stage of startup the work belongs to ("Window", "Room texture", "Exhibit mesh", ...)
+	std::string asset;				// Asset the work was about (empty for stages that are not about a single asset)
+	double start = 0.0;				// Time the work started, in seconds since the program started
+	double seconds = 0.0;			// Time from the start of the work until it was done (including time spent waiting)
+	double decodeSeconds = 0.0;		// Time spent reading, decompressing, parsing or decoding
+	double uploadSeconds = 0.0;		// Time the OpenGL calls that create and fill the GPU objects took on the CPU
+	std::uint64_t bytesRead = 0;	// Bytes read from the file (or from the asset archive) the asset came from
+	std::uint64_t gpuBytes = 0;		// Bytes of buffer and texture storage allocated for the asset
+};
+
+/// <summary>
+/// Collects how long each stage of startup and each asset took, and how much it read and allocated,
+/// then reports it as a summary sorted by time or as JSON. Entries may be added from any thread.
+/// </summary>
+class StartupProfile
+{
+public:
+	/// <summary>
+	/// Creates an empty profile.
+	/// </summary>
+	/// <param name="startTime">Time the program started, which the times of the entries are measured from</param>
+	explicit StartupProfile(std::chrono::steady_clock::time_point startTime);
+
+	/// <summary>
+	/// Time since the program started, in seconds.
+	/// </summary>
+	double GetSeconds() const;
+
+	/// <summary>
+	/// Starts timing a stage of startup or an asset.
+	/// </summary>
+	/// <param name="stage">Stage of startup the work belongs to</param>
+	/// <param name="asset">Asset the work is about (empty if none)</param>
+	/// <returns>Entry with its start time set, to be handed to End once the work is done</returns>
+	StartupProfileEntry Begin(const std::string& stage, const std::string& asset = std::string()) const;
+
+	/// <summary>
+	/// Stops timing a stage of startup or an asset, and adds its entry.
+	/// </summary>
+	/// <param name="entry">Entry from Begin, with the rest of its fields filled in</param>
+	void End(StartupProfileEntry& entry);
+
+	/// <summary>
+	/// Adds an entry.
+	/// </summary>
+	/// <param name="entry">Entry to add</param>
+	void Add(const StartupProfileEntry& entry);
+
+	/// <summary>
+	/// Records the time a point of startup was reached (such as the first frame).
+	/// </summary>
+	/// <param name="name">Name of the point</param>
+	void AddMilestone(const std::string& name);
+
+	/// <summary>
+	/// Prints every entry, the slowest first, followed by the totals and the milestones.
+	/// </summary>
+	/// <param name="stream">Stream to print to</param>
+	void Print(std::ostream& stream) const;
+
+	/// <summary>
+	/// Writes the entries and milestones to a JSON file, so the startup times can be tracked from run to run.
+	/// </summary>
+	/// <param name="filePath">Path to the file to write</param>
+	/// <returns>True if the file was written successfully</returns>
+	bool WriteJson(const std::string& filePath) const;
+
+private:
+	/// <summary>
+	/// Point of startup, and the time it was reached in seconds since the program started
+	/// </summary>
+	struct Milestone
+	{
+		std::string name;
+		double seconds;
+	};
+
+	std::chrono::steady_clock::time_point startTime;
+
+	mutable std::mutex mutex;
+	std::vector<StartupProfileEntry> entries;
+	std::vector<Milestone> milestones;
+};
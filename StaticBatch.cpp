@@ -0,0 +1,59 @@
+#include "StaticBatch.h"
+
+namespace
+{
+	/// <summary>
+	/// Moves a vertex into world space.
+	/// </summary>
+	Vertex TransformVertex(const Vertex& vertex, const glm::mat4& model, const glm::mat3& normalMatrix)
+	{
+		Vertex transformed = vertex;
+
+		glm::vec3 position = glm::vec3(model * glm::vec4(vertex.x, vertex.y, vertex.z, 1.0f));
+		transformed.x = position.x;
+		transformed.y = position.y;
+		transformed.z = position.z;
+
+		glm::vec3 normal = glm::normalize(normalMatrix * glm::vec3(vertex.nx, vertex.ny, vertex.nz));
+		transformed.nx = normal.x;
+		transformed.ny = normal.y;
+		transformed.nz = normal.z;
+		return transformed;
+	}
+}
+
+void AddTriangleFans(StaticBatch& batch, const Vertex* vertices, const GLint* firsts, const GLsizei* counts, GLsizei fanCount,
+	const glm::mat4& model, GLint layer)
+{
+	// Normals are moved by the inverse transpose, so that they stay perpendicular to faces that are scaled unevenly
+	glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+	GLint first = static_cast<GLint>(batch.vertices.size());
+
+	// Fan (0, 1, 2, 3, ...) becomes the triangles (0, 1, 2), (0, 2, 3), ..., which keep its winding
+	for (GLsizei i = 0; i < fanCount; i++)
+	{
+		const Vertex* fan = vertices + firsts[i];
+		for (GLsizei j = 2; j < counts[i]; j++)
+		{
+			batch.vertices.push_back(TransformVertex(fan[0], model, normalMatrix));
+			batch.vertices.push_back(TransformVertex(fan[j - 1], model, normalMatrix));
+			batch.vertices.push_back(TransformVertex(fan[j], model, normalMatrix));
+		}
+	}
+
+	GLsizei count = static_cast<GLsizei>(batch.vertices.size()) - first;
+	batch.layers.resize(batch.vertices.size(), static_cast<GLfloat>(layer));
+
+	if (!batch.ranges.empty() && batch.ranges.back().layer == layer)
+	{
+		batch.ranges.back().count += count;
+	}
+	else
+	{
+		StaticBatchRange range;
+		range.first = first;
+		range.count = count;
+		range.layer = layer;
+		batch.ranges.push_back(range);
+	}
+}
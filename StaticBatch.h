@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/// <summary>
+/// Run of a static batch's vertices that samples the same texture
+/// </summary>
+struct StaticBatchRange
+{
+	GLint first = 0;	// First vertex of the run
+	GLsizei count = 0;	// Number of vertices in the run
+	GLint layer = 0;	// Layer of the texture array the run samples
+};
+
+/// <summary>
+/// Geometry that never moves, baked into world space as one list of triangles so that all of it
+/// can be drawn with one call, each vertex naming the layer of the texture array it samples.
+/// </summary>
+struct StaticBatch
+{
+	std::vector<Vertex> vertices;		// Vertices of the triangles, in world space
+	std::vector<GLfloat> layers;		// Layer of the texture array each vertex samples
+	std::vector<StaticBatchRange> ranges;	// Runs of vertices that sample the same layer, in order
+};
+
+/// <summary>
+/// Adds faces drawn as triangle fans to a batch, as triangles moved into world space by a model matrix.
+/// A run that samples the same layer as the last one extends it.
+/// </summary>
+/// <param name="batch">Batch to add the faces to</param>
+/// <param name="vertices">Vertices the fans are taken from</param>
+/// <param name="firsts">First vertex of each fan</param>
+/// <param name="counts">Number of vertices in each fan</param>
+/// <param name="fanCount">Number of fans</param>
+/// <param name="model">Model matrix that places the faces in the world</param>
+/// <param name="layer">Layer of the texture array the faces sample</param>
+void AddTriangleFans(StaticBatch& batch, const Vertex* vertices, const GLint* firsts, const GLsizei* counts, GLsizei fanCount,
+	const glm::mat4& model, GLint layer);
@@ -0,0 +1,212 @@
+#include "TextureLoader.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+TextureLoader::TextureLoader(ThreadPool& threadPool, AssetArchive* archive, StartupProfile& profile, const std::string& profileStage)
+	: threadPool(threadPool), archive(archive), profile(profile), profileStage(profileStage)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	for (std::future<void>& job : jobs)
+	{
+		job.wait();
+	}
+}
+
+void TextureLoader::Load(const std::string& imageFilePath)
+{
+	std::size_t imageIndex = imageFilePaths.size();
+	imageFilePaths.push_back(imageFilePath);
+
+	// The job gets its own copy of the path, since more images may be added while it runs
+	jobs.push_back(threadPool.Submit([this, imageIndex, imageFilePath]()
+		{
+			std::unique_ptr<DecodedImage> image = std::make_unique<DecodedImage>();
+			image->imageIndex = imageIndex;
+			image->profile = profile.Begin(profileStage, imageFilePath);
+
+			// Read the image data, with its mip chain when it comes from the image's cooked texture in the asset archive
+			// (so the PNG does not have to be decoded)
+			LoadTexture(imageFilePath, archive, image->texture, &image->profile.bytesRead);
+
+			image->profile.decodeSeconds = profile.GetSeconds() - image->profile.start;
+			decoded.Push(std::move(image));
+		}));
+}
+
+void TextureLoader::Upload()
+{
+	// Create a variable that will contain the ID for each texture,
+	// and use glGenTextures() to generate the textures themselves
+	std::size_t firstNew = textures.size();
+	textures.resize(imageFilePaths.size());
+	if (firstNew < textures.size())
+	{
+		glGenTextures(static_cast<GLsizei>(textures.size() - firstNew), &textures[firstNew]);
+	}
+
+	std::vector<std::unique_ptr<DecodedImage>> arrived;
+	for (std::size_t remaining = textures.size() - firstNew; remaining != 0; )
+	{
+		arrived.clear();
+		if (decoded.PopAll(arrived) == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		for (std::unique_ptr<DecodedImage>& image : arrived)
+		{
+			UploadImage(*image);
+			remaining--;
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TextureLoader::UploadArray()
+{
+	std::size_t firstNew = textures.size();
+	std::vector<std::unique_ptr<DecodedImage>> images = WaitForImages(imageFilePaths.size() - firstNew);
+	textures.resize(imageFilePaths.size());
+	if (images.empty())
+	{
+		return false;
+	}
+
+	// Every image has to fit the layout of the first one, after any decompression the driver needs
+	std::sort(images.begin(), images.end(),
+		[](const std::unique_ptr<DecodedImage>& a, const std::unique_ptr<DecodedImage>& b) { return a->imageIndex < b->imageIndex; });
+	for (std::unique_ptr<DecodedImage>& image : images)
+	{
+		PrepareTextureForUpload(image->texture);
+	}
+	TextureArray layout = GetTextureArrayLayout(images[0]->texture, static_cast<GLsizei>(images.size()));
+	bool fits = true;
+	for (const std::unique_ptr<DecodedImage>& image : images)
+	{
+		fits = fits && FitsTextureArray(layout, image->texture);
+	}
+
+	if (!fits)
+	{
+		std::cout << "The images do not all have the same size and format, so each gets a texture of its own instead of a layer" << std::endl;
+		glGenTextures(static_cast<GLsizei>(images.size()), &textures[firstNew]);
+		for (std::unique_ptr<DecodedImage>& image : images)
+		{
+			UploadImage(*image);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return false;
+	}
+
+	textureArray = layout;
+	firstLayerImage = firstNew;
+	CreateTextureArray(textureArray);
+
+	bool completeChains = true;
+	for (std::unique_ptr<DecodedImage>& image : images)
+	{
+		double uploadStart = profile.GetSeconds();
+		GLint layer = static_cast<GLint>(image->imageIndex - firstLayerImage);
+		completeChains = UploadTextureLayer(textureArray, image->texture, layer) && completeChains;
+		image->profile.gpuBytes = GetTextureMemorySize(image->texture);
+		image->texture = LoadedTexture();
+
+		image->profile.uploadSeconds = profile.GetSeconds() - uploadStart;
+		profile.End(image->profile);
+	}
+
+	// Decoded images only brought their full-size level, so the GPU makes the smaller ones, for every layer at once
+	if (!completeChains)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	return true;
+}
+
+GLuint TextureLoader::GetTexture(const std::string& imageFilePath) const
+{
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		if (imageFilePaths[i] == imageFilePath)
+		{
+			return textures[i];
+		}
+	}
+	return 0;
+}
+
+const TextureArray& TextureLoader::GetTextureArray() const
+{
+	return textureArray;
+}
+
+GLint TextureLoader::GetLayer(const std::string& imageFilePath) const
+{
+	if (textureArray.texture == 0)
+	{
+		return -1;
+	}
+
+	for (std::size_t i = firstLayerImage; i < firstLayerImage + static_cast<std::size_t>(textureArray.layerCount); i++)
+	{
+		if (imageFilePaths[i] == imageFilePath)
+		{
+			return static_cast<GLint>(i - firstLayerImage);
+		}
+	}
+	return -1;
+}
+
+std::vector<std::unique_ptr<TextureLoader::DecodedImage>> TextureLoader::WaitForImages(std::size_t count)
+{
+	std::vector<std::unique_ptr<DecodedImage>> images;
+	while (images.size() < count)
+	{
+		if (decoded.PopAll(images) == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	return images;
+}
+
+void TextureLoader::UploadImage(DecodedImage& image)
+{
+	double uploadStart = profile.GetSeconds();
+
+	// Make sure that we actually loaded the image before uploading the data to the GPU
+	if (!image.texture.levels.empty())
+	{
+		// Our texture is 2D, so we bind our texture to the GL_TEXTURE_2D target
+		// (its filtering and wrapping come from the sampler every texture is drawn with)
+		glBindTexture(GL_TEXTURE_2D, textures[image.imageIndex]);
+
+		// Upload the image data and its mip chain to GPU memory
+		UploadTexture(image.texture);
+		image.profile.gpuBytes = GetTextureMemorySize(image.texture);
+
+		// Once we have copied the data over to the GPU, we can delete
+		// the data on the CPU side, since we won't be using it anymore
+		image.texture = LoadedTexture();
+	}
+	else
+	{
+		std::cerr << "Failed to load image: " << imageFilePaths[image.imageIndex] << std::endl;
+	}
+
+	image.profile.uploadSeconds = profile.GetSeconds() - uploadStart;
+	profile.End(image.profile);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "AssetArchive.h"
+#include "CookedAssets.h"
+#include "MpscQueue.h"
+#include "StartupProfile.h"
+#include "Textures.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Decodes a set of images on worker threads, all of them at once, and creates their textures (with full mip chains)
+/// on the OpenGL thread as each one finishes decoding. Decoding can start before there is an OpenGL context, so it overlaps creating the window,
+/// and the time spent waiting for the images comes down to about that of the slowest one.
+/// </summary>
+class TextureLoader
+{
+public:
+	/// <summary>
+	/// Creates a loader with no images.
+	/// </summary>
+	/// <param name="threadPool">Worker threads that decode the images</param>
+	/// <param name="archive">Archive of cooked assets (null to always decode the source images)</param>
+	/// <param name="profile">Receives an entry for each texture once it is uploaded</param>
+	/// <param name="profileStage">Stage the entries are reported under</param>
+	TextureLoader(ThreadPool& threadPool, AssetArchive* archive, StartupProfile& profile, const std::string& profileStage);
+
+	/// <summary>
+	/// Waits for the worker threads to finish the images they are still decoding.
+	/// </summary>
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	/// <summary>
+	/// Starts decoding an image on a worker thread. Does not need an OpenGL context.
+	/// </summary>
+	/// <param name="imageFilePath">Path to the image (its cooked texture is used when the archive has one)</param>
+	void Load(const std::string& imageFilePath);
+
+	/// <summary>
+	/// Creates a texture for every image passed to Load, and uploads each image as soon as it is decoded,
+	/// in the order they finish. Returns once all of them are uploaded. Must be called on the OpenGL thread.
+	/// </summary>
+	void Upload();
+
+	/// <summary>
+	/// Like Upload, but packs the images into the layers of one texture array, in the order they were passed to Load,
+	/// if they all turn out to have the same size and format; otherwise each still gets a texture of its own.
+	/// Waits for every image to be decoded, since that is only known once they all are. Must be called on the OpenGL thread.
+	/// </summary>
+	/// <returns>True if the images were packed into a texture array (see GetTextureArray)</returns>
+	bool UploadArray();
+
+	/// <summary>
+	/// Texture created from an image by Upload, or by UploadArray when the images could not be packed into an array.
+	/// </summary>
+	/// <param name="imageFilePath">Path to the image, as passed to Load</param>
+	/// <returns>OpenGL handle to the texture (0 if the image was never loaded or is a layer of the texture array)</returns>
+	GLuint GetTexture(const std::string& imageFilePath) const;
+
+	/// <summary>
+	/// Texture array created by UploadArray.
+	/// </summary>
+	/// <returns>Texture array (with a texture of 0 if there is none)</returns>
+	const TextureArray& GetTextureArray() const;
+
+	/// <summary>
+	/// Layer of the texture array that holds an image.
+	/// </summary>
+	/// <param name="imageFilePath">Path to the image, as passed to Load</param>
+	/// <returns>Layer of the image (-1 if it is not in the texture array)</returns>
+	GLint GetLayer(const std::string& imageFilePath) const;
+
+private:
+	/// <summary>
+	/// Image decoded by a worker thread, waiting to be uploaded
+	/// </summary>
+	struct DecodedImage
+	{
+		std::size_t imageIndex = 0;			// Position of the image in the order it was passed to Load
+		LoadedTexture texture;				// Image and its mip chain, if cooked (no levels if it failed to load)
+		StartupProfileEntry profile;		// Time and reads of the image, filled in as it is decoded and uploaded
+	};
+
+	std::vector<std::unique_ptr<DecodedImage>> WaitForImages(std::size_t count);
+	void UploadImage(DecodedImage& image);
+
+	ThreadPool& threadPool;
+	AssetArchive* archive;
+	StartupProfile& profile;
+	std::string profileStage;
+
+	std::vector<std::string> imageFilePaths;	// Images passed to Load, in order
+	std::vector<GLuint> textures;				// Texture of each image, once Upload created them
+	TextureArray textureArray;					// Texture array created by UploadArray
+	std::size_t firstLayerImage = 0;			// Image in the first layer of the texture array
+	MpscQueue<std::unique_ptr<DecodedImage>> decoded;	// Images handed over by the worker threads
+	std::vector<std::future<void>> jobs;
+};
@@ -0,0 +1,277 @@
+#include "Textures.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Anisotropic filtering comes from GL_EXT_texture_filter_anisotropic (only core since OpenGL 4.6),
+// which an OpenGL 3.3 loader does not necessarily define
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+// The same goes for the S3TC formats of GL_EXT_texture_compression_s3tc
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace
+{
+	/// <summary>
+	/// Number of levels in the full mip chain of an image, down to 1x1
+	/// </summary>
+	int GetMipLevelCount(int width, int height)
+	{
+		int levelCount = 1;
+		for (int size = std::max(width, height); size > 1; size /= 2)
+		{
+			levelCount++;
+		}
+		return levelCount;
+	}
+}
+
+bool HasExtension(const char* name)
+{
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (GLint i = 0; i < extensionCount; i++)
+	{
+		const GLubyte* extension = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+		if (extension != nullptr && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+GLenum GetTextureFormat(int channels)
+{
+	return channels == 4 ? GL_RGBA : GL_RGB;
+}
+
+GLenum GetTextureInternalFormat(const LoadedTexture& texture)
+{
+	switch (texture.compression)
+	{
+	case TextureCompression::Bc1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TextureCompression::Bc3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	default:
+		return texture.channels == 4 ? GL_RGBA8 : GL_RGB8;
+	}
+}
+
+bool IsTextureCompressionSupported()
+{
+	static const bool supported = []()
+		{
+			bool extension = HasExtension("GL_EXT_texture_compression_s3tc");
+			if (!extension)
+			{
+				std::cout << "S3TC texture compression is not supported, compressed textures are decompressed to RGBA" << std::endl;
+			}
+			return extension;
+		}();
+	return supported;
+}
+
+void PrepareTextureForUpload(LoadedTexture& texture)
+{
+	if (texture.compression != TextureCompression::None && !IsTextureCompressionSupported())
+	{
+		DecompressTexture(texture);
+	}
+}
+
+std::uint64_t GetTextureMemorySize(const LoadedTexture& texture)
+{
+	// Compressed textures always come with their whole chain
+	std::uint64_t size = 0;
+	if (texture.levels.size() > 1 || texture.compression != TextureCompression::None)
+	{
+		for (const TextureLevel& level : texture.levels)
+		{
+			size += level.size;
+		}
+		return size;
+	}
+
+	int levelWidth = texture.width;
+	int levelHeight = texture.height;
+	for (int i = GetMipLevelCount(texture.width, texture.height); i > 0; i--)
+	{
+		size += static_cast<std::uint64_t>(levelWidth) * levelHeight * texture.channels;
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+	return size;
+}
+
+void CompleteMipChain(const LoadedTexture& texture)
+{
+	// A decoded image only has its full-size level, so the GPU makes the smaller ones from it
+	// (a 1x1 texture, which may be compressed, has nothing to generate)
+	int fullLevelCount = GetMipLevelCount(texture.width, texture.height);
+	if (texture.levels.size() == 1 && fullLevelCount > 1)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, fullLevelCount - 1);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels.size()) - 1);
+	}
+}
+
+void UploadTexture(LoadedTexture& texture)
+{
+	PrepareTextureForUpload(texture);
+	GLenum internalFormat = GetTextureInternalFormat(texture);
+	GLenum format = GetTextureFormat(texture.channels);
+
+	// Rows of three-byte pixels are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (std::size_t i = 0; i < texture.levels.size(); i++)
+	{
+		// Compressed blocks go to the GPU as they are, to be decoded as they are sampled
+		const TextureLevel& level = texture.levels[i];
+		if (texture.compression != TextureCompression::None)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0,
+				static_cast<GLsizei>(level.size), level.pixels);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0, format, GL_UNSIGNED_BYTE,
+				level.pixels);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	CompleteMipChain(texture);
+}
+
+float GetMaxTextureAnisotropy()
+{
+	if (!HasExtension("GL_EXT_texture_filter_anisotropic") && !HasExtension("GL_ARB_texture_filter_anisotropic"))
+	{
+		return 1.0f;
+	}
+
+	GLfloat maxAnisotropy = 1.0f;
+	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+	return std::max(1.0f, maxAnisotropy);
+}
+
+GLuint CreateTextureSampler(const TextureSamplingSettings& settings)
+{
+	GLuint sampler;
+	glGenSamplers(1, &sampler);
+
+	// Trilinear filtering: the two mip levels closest to the texture's size on screen are each sampled bilinearly and blended
+	glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, settings.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// Surfaces seen at a grazing angle, like the floor and the walls, are stretched along one direction on screen;
+	// anisotropic filtering takes more samples along it instead of blurring the texture in both directions
+	if (settings.maxAnisotropy > 1.0f)
+	{
+		float maxAnisotropy = GetMaxTextureAnisotropy();
+		if (maxAnisotropy > 1.0f)
+		{
+			glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(settings.maxAnisotropy, maxAnisotropy));
+		}
+		else
+		{
+			std::cout << "Anisotropic filtering is not supported, textures are filtered without it" << std::endl;
+		}
+	}
+
+	return sampler;
+}
+
+TextureArray GetTextureArrayLayout(const LoadedTexture& texture, GLsizei layerCount)
+{
+	TextureArray textureArray;
+	textureArray.width = texture.width;
+	textureArray.height = texture.height;
+	textureArray.internalFormat = GetTextureInternalFormat(texture);
+	textureArray.compression = texture.compression;
+	textureArray.layerCount = layerCount;
+	textureArray.levelCount = GetMipLevelCount(texture.width, texture.height);
+	return textureArray;
+}
+
+bool FitsTextureArray(const TextureArray& textureArray, const LoadedTexture& texture)
+{
+	return !texture.levels.empty() && texture.width == textureArray.width && texture.height == textureArray.height
+		&& GetTextureInternalFormat(texture) == textureArray.internalFormat
+		&& (texture.compression == TextureCompression::None || static_cast<GLsizei>(texture.levels.size()) == textureArray.levelCount);
+}
+
+void CreateTextureArray(TextureArray& textureArray)
+{
+	glGenTextures(1, &textureArray.texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture);
+
+	// Storage for every level is allocated up front; the layers fill it in afterwards
+	GLenum format = textureArray.internalFormat == GL_RGBA8 ? GL_RGBA : GL_RGB;
+	int levelWidth = textureArray.width;
+	int levelHeight = textureArray.height;
+	for (GLsizei i = 0; i < textureArray.levelCount; i++)
+	{
+		if (textureArray.compression != TextureCompression::None)
+		{
+			GLsizei layerSize = static_cast<GLsizei>(GetCompressedImageSize(levelWidth, levelHeight, textureArray.compression));
+			glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, textureArray.internalFormat, levelWidth, levelHeight, textureArray.layerCount, 0,
+				layerSize * textureArray.layerCount, nullptr);
+		}
+		else
+		{
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, i, textureArray.internalFormat, levelWidth, levelHeight, textureArray.layerCount, 0,
+				format, GL_UNSIGNED_BYTE, nullptr);
+		}
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.levelCount - 1);
+}
+
+bool UploadTextureLayer(const TextureArray& textureArray, const LoadedTexture& texture, GLint layer)
+{
+	GLsizei levelCount = std::min(static_cast<GLsizei>(texture.levels.size()), textureArray.levelCount);
+	GLenum format = GetTextureFormat(texture.channels);
+
+	// Rows of three-byte pixels are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (GLsizei i = 0; i < levelCount; i++)
+	{
+		const TextureLevel& level = texture.levels[i];
+		if (texture.compression != TextureCompression::None)
+		{
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1, textureArray.internalFormat,
+				static_cast<GLsizei>(level.size), level.pixels);
+		}
+		else
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1, format, GL_UNSIGNED_BYTE, level.pixels);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return levelCount == textureArray.levelCount;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CookedAssets.h"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+/// <summary>
+/// How the textures are filtered when they are drawn
+/// </summary>
+struct TextureSamplingSettings
+{
+	bool mipmaps = true;			// Indicates if minified textures blend the two closest levels of their mip chain (trilinear filtering)
+	float maxAnisotropy = 8.0f;		// Most samples taken along the direction a texture is stretched in on screen (1 for none)
+};
+
+/// <summary>
+/// Texture array whose layers are textures of the same size and format, so objects drawn with different textures
+/// can share one binding (and one draw call), picking their layer in the shader
+/// </summary>
+struct TextureArray
+{
+	GLuint texture = 0;				// OpenGL handle to the GL_TEXTURE_2D_ARRAY (0 until CreateTextureArray)
+	int width = 0;					// Width of every layer in pixels
+	int height = 0;					// Height of every layer in pixels
+	GLenum internalFormat = 0;		// Format every layer is stored in (see GetTextureInternalFormat)
+	TextureCompression compression = TextureCompression::None;	// Block compression of every layer
+	GLsizei layerCount = 0;			// Number of layers
+	GLsizei levelCount = 0;			// Levels of the mip chain, down to 1x1
+};
+
+/// <summary>
+/// Checks if the driver has an OpenGL extension. Must be called on the OpenGL thread.
+/// </summary>
+/// <param name="name">Name of the extension, such as GL_EXT_texture_filter_anisotropic</param>
+/// <returns>True if the extension is in the driver's list of extensions</returns>
+bool HasExtension(const char* name);
+
+/// <summary>
+/// OpenGL format of the pixels of a texture.
+/// </summary>
+/// <param name="channels">Bytes per pixel: 3 (RGB) or 4 (RGBA)</param>
+/// <returns>GL_RGB or GL_RGBA</returns>
+GLenum GetTextureFormat(int channels);
+
+/// <summary>
+/// Format OpenGL stores a texture in: a sized uncompressed format, or the S3TC format its blocks are in.
+/// </summary>
+/// <param name="texture">Texture with at least its full-size level</param>
+/// <returns>GL_RGB8, GL_RGBA8, GL_COMPRESSED_RGB_S3TC_DXT1_EXT (BC1) or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3)</returns>
+GLenum GetTextureInternalFormat(const LoadedTexture& texture);
+
+/// <summary>
+/// Checks once whether the driver can sample BC1 and BC3 textures (GL_EXT_texture_compression_s3tc, which every desktop driver
+/// has in practice but which is not core OpenGL). Must be called on the OpenGL thread.
+/// </summary>
+/// <returns>True if block-compressed textures can be uploaded as they are</returns>
+bool IsTextureCompressionSupported();
+
+/// <summary>
+/// Makes a texture uploadable on this driver: a block-compressed texture the driver cannot sample is decompressed to RGBA.
+/// Must be called on the OpenGL thread.
+/// </summary>
+/// <param name="texture">Texture to upload</param>
+void PrepareTextureForUpload(LoadedTexture& texture);
+
+/// <summary>
+/// GPU memory taken by a texture once its mip chain is complete, whether the chain was loaded or is generated.
+/// </summary>
+/// <param name="texture">Texture with at least its full-size level</param>
+/// <returns>Size in bytes</returns>
+std::uint64_t GetTextureMemorySize(const LoadedTexture& texture);
+
+/// <summary>
+/// Completes the mip chain of the texture bound to GL_TEXTURE_2D with glGenerateMipmap when only its full-size level
+/// was loaded (a cooked texture already comes with every level, which are used as they are, compressed or not).
+/// </summary>
+/// <param name="texture">Texture whose levels have been uploaded</param>
+void CompleteMipChain(const LoadedTexture& texture);
+
+/// <summary>
+/// Uploads every level of a texture to the texture bound to GL_TEXTURE_2D, then completes its mip chain (see CompleteMipChain)
+/// so every texture can be sampled with mipmaps. Block-compressed levels are uploaded with glCompressedTexImage2D,
+/// or decompressed to RGBA first if the driver cannot sample them (see PrepareTextureForUpload).
+/// </summary>
+/// <param name="texture">Texture with at least its full-size level</param>
+void UploadTexture(LoadedTexture& texture);
+
+/// <summary>
+/// Largest anisotropy the driver supports for texture filtering.
+/// </summary>
+/// <returns>Largest anisotropy, or 1 if anisotropic filtering is not supported</returns>
+float GetMaxTextureAnisotropy();
+
+/// <summary>
+/// Creates the sampler object every texture is drawn with, shared by all of them so their filtering is set in one place
+/// (a sampler bound to a texture unit overrides the filtering and wrapping of the textures bound to that unit).
+/// Textures repeat in both directions.
+/// </summary>
+/// <param name="settings">Filtering of the textures (the anisotropy is limited to what the driver supports)</param>
+/// <returns>OpenGL handle to the sampler</returns>
+GLuint CreateTextureSampler(const TextureSamplingSettings& settings);
+
+/// <summary>
+/// Describes a texture array with layers of the size and format of a texture, without creating it.
+/// </summary>
+/// <param name="texture">Texture that would be the first layer (made uploadable with PrepareTextureForUpload)</param>
+/// <param name="layerCount">Number of layers</param>
+/// <returns>Texture array without an OpenGL texture</returns>
+TextureArray GetTextureArrayLayout(const LoadedTexture& texture, GLsizei layerCount);
+
+/// <summary>
+/// Checks if a texture can be a layer of a texture array: it has to have the same size and format, and a compressed texture
+/// also has to bring its whole mip chain (the levels of an uncompressed array can be generated once every layer is in).
+/// </summary>
+/// <param name="textureArray">Texture array</param>
+/// <param name="texture">Texture made uploadable with PrepareTextureForUpload</param>
+/// <returns>True if the texture can be uploaded to a layer</returns>
+bool FitsTextureArray(const TextureArray& textureArray, const LoadedTexture& texture);
+
+/// <summary>
+/// Creates the OpenGL texture of a texture array and allocates every level of every layer, leaving it bound to GL_TEXTURE_2D_ARRAY.
+/// </summary>
+/// <param name="textureArray">Texture array from GetTextureArrayLayout, which receives the OpenGL handle</param>
+void CreateTextureArray(TextureArray& textureArray);
+
+/// <summary>
+/// Uploads the levels of a texture to one layer of the texture array bound to GL_TEXTURE_2D_ARRAY.
+/// </summary>
+/// <param name="textureArray">Texture array the texture fits (see FitsTextureArray)</param>
+/// <param name="texture">Texture to upload</param>
+/// <param name="layer">Layer to upload to</param>
+/// <returns>True if the texture brought every level; otherwise the array's mip chain still has to be generated with glGenerateMipmap</returns>
+bool UploadTextureLayer(const TextureArray& textureArray, const LoadedTexture& texture, GLint layer);
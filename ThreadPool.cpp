@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		stopping = true;
+	}
+	jobsChanged.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		jobs.push_back(std::move(job));
+	}
+	jobsChanged.notify_one();
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// Iterations are handed out through a shared counter, so whoever is free takes the next one.
+	// Helper jobs that only start after every iteration was taken return without touching body.
+	struct SharedState
+	{
+		std::atomic<std::size_t> nextIndex{ 0 };
+		std::atomic<std::size_t> doneCount{ 0 };
+		std::mutex doneMutex;
+		std::condition_variable allDone;
+	};
+	std::shared_ptr<SharedState> state = std::make_shared<SharedState>();
+	const std::function<void(std::size_t)>* bodyPointer = &body;
+
+	auto runIterations = [state, count, bodyPointer]()
+	{
+		std::size_t index;
+		while ((index = state->nextIndex.fetch_add(1)) < count)
+		{
+			(*bodyPointer)(index);
+			if (state->doneCount.fetch_add(1) + 1 == count)
+			{
+				std::lock_guard<std::mutex> lock(state->doneMutex);
+				state->allDone.notify_all();
+			}
+		}
+	};
+
+	std::size_t helperCount = std::min<std::size_t>(count - 1, workers.size());
+	for (std::size_t i = 0; i < helperCount; i++)
+	{
+		Enqueue(runIterations);
+	}
+
+	runIterations();
+
+	std::unique_lock<std::mutex> lock(state->doneMutex);
+	state->allDone.wait(lock, [&state, count]() { return state->doneCount.load() == count; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			jobsChanged.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+			if (jobs.empty())
+			{
+				return;
+			}
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Fixed set of worker threads that run queued jobs
+/// </summary>
+class ThreadPool
+{
+public:
+	/// <summary>
+	/// Starts the worker threads.
+	/// </summary>
+	/// <param name="threadCount">Number of worker threads (0 uses one per hardware thread)</param>
+	explicit ThreadPool(unsigned int threadCount = 0);
+
+	/// <summary>
+	/// Finishes the queued jobs and stops the worker threads.
+	/// </summary>
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// <summary>
+	/// Number of worker threads in the pool.
+	/// </summary>
+	unsigned int GetThreadCount() const;
+
+	/// <summary>
+	/// Queues a job to be run by one of the worker threads.
+	/// </summary>
+	/// <param name="job">Job to run</param>
+	void Enqueue(std::function<void()> job);
+
+	/// <summary>
+	/// Queues a job and returns a future that receives its result.
+	/// </summary>
+	/// <param name="function">Job to run</param>
+	/// <returns>Future that becomes ready when the job is done</returns>
+	template <typename Function>
+	auto Submit(Function function) -> std::future<decltype(function())>
+	{
+		using Result = decltype(function());
+		std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+		std::future<Result> result = task->get_future();
+		Enqueue([task]() { (*task)(); });
+		return result;
+	}
+
+	/// <summary>
+	/// Runs body(0) to body(count - 1) spread over the worker threads and the calling thread,
+	/// and returns once all of them are done. The calling thread takes part in the work,
+	/// so this may safely be called from inside a job of the same pool.
+	/// </summary>
+	/// <param name="count">Number of iterations</param>
+	/// <param name="body">Function called once per iteration with the iteration index</param>
+	void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex jobsMutex;
+	std::condition_variable jobsChanged;
+	bool stopping = false;
+};
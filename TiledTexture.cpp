@@ -0,0 +1,336 @@
+#include "TiledTexture.h"
+
+#include "CookedAssets.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+	const char TiledTextureMagic[8] = { 'T', 'I', 'L', 'E', 'D', 'T', 'E', 'X' };
+
+	/// <summary>
+	/// Version of the tiled texture layout, increased whenever the layout or the meaning of its data changes
+	/// </summary>
+	const std::uint32_t TiledTextureVersion = 1;
+
+	/// <summary>
+	/// Alignment of the first tile inside the file
+	/// </summary>
+	const std::uint64_t TiledTextureAlignment = 64;
+
+	/// <summary>
+	/// Most levels a tiled texture can have (enough for an image of 120 x 32768 pixels along its longer side)
+	/// </summary>
+	const std::uint32_t MaxTiledTextureLevels = 16;
+
+	struct TiledTextureFileLevel
+	{
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t tilesX;
+		std::uint32_t tilesY;
+		std::uint64_t firstTile;	// Index of the level's first tile
+	};
+
+	/// <summary>
+	/// Start of a tiled texture file, followed by every tile, level by level and row by row
+	/// </summary>
+	struct TiledTextureHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t channels;
+		std::uint32_t compression;	// TextureCompression of every tile
+		std::uint32_t levelCount;
+		std::uint32_t tileSize;		// TileSize the texture was cut with
+		std::uint32_t tileBorder;	// TileBorder the texture was cut with
+		std::uint64_t tileBytes;	// Size of each tile in bytes
+		std::uint64_t tilesOffset;	// Offset of the first tile from the start of the file
+		std::uint64_t sourceHash;	// HashBytes of the contents of the source image
+		TiledTextureFileLevel levels[MaxTiledTextureLevels];
+	};
+
+	int GetTileCount(int levelSize)
+	{
+		return (levelSize + TilePayloadSize - 1) / TilePayloadSize;
+	}
+
+	std::uint64_t GetTileBytes(std::uint32_t channels, TextureCompression compression)
+	{
+		return compression == TextureCompression::None ? static_cast<std::uint64_t>(TileSize) * TileSize * channels
+			: GetCompressedImageSize(TileSize, TileSize, compression);
+	}
+
+	/// <summary>
+	/// Copies one tile, with its border, out of a level. Pixels past the edges of the level repeat the ones on the edge.
+	/// </summary>
+	void CopyTile(const TextureLevel& level, int channels, int tileX, int tileY, unsigned char* tile)
+	{
+		for (int y = 0; y < TileSize; y++)
+		{
+			int sourceY = std::clamp(tileY * TilePayloadSize + y - TileBorder, 0, level.height - 1);
+			const unsigned char* sourceRow = level.pixels + static_cast<std::size_t>(sourceY) * level.width * channels;
+			unsigned char* tileRow = tile + static_cast<std::size_t>(y) * TileSize * channels;
+
+			for (int x = 0; x < TileSize; x++)
+			{
+				int sourceX = std::clamp(tileX * TilePayloadSize + x - TileBorder, 0, level.width - 1);
+				std::memcpy(tileRow + static_cast<std::size_t>(x) * channels, sourceRow + static_cast<std::size_t>(sourceX) * channels, channels);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Checks that a mapped tiled texture is complete and was written by this version of the program.
+	/// </summary>
+	const TiledTextureHeader* ValidateTiledTexture(const char* data, std::size_t size)
+	{
+		if (size < sizeof(TiledTextureHeader))
+		{
+			return nullptr;
+		}
+
+		const TiledTextureHeader* header = reinterpret_cast<const TiledTextureHeader*>(data);
+		if (std::memcmp(header->magic, TiledTextureMagic, sizeof(TiledTextureMagic)) != 0
+			|| header->version != TiledTextureVersion
+			|| header->tileSize != static_cast<std::uint32_t>(TileSize) || header->tileBorder != static_cast<std::uint32_t>(TileBorder)
+			|| (header->channels != 3 && header->channels != 4)
+			|| header->compression > static_cast<std::uint32_t>(TextureCompression::Bc3)
+			|| header->tileBytes != GetTileBytes(header->channels, static_cast<TextureCompression>(header->compression))
+			|| header->levelCount == 0 || header->levelCount > MaxTiledTextureLevels
+			|| header->levels[0].width != header->width || header->levels[0].height != header->height)
+		{
+			return nullptr;
+		}
+
+		// Each level halves the one before it, and the last one fits in a single tile
+		std::uint64_t tileCount = 0;
+		for (std::uint32_t i = 0; i < header->levelCount; i++)
+		{
+			const TiledTextureFileLevel& level = header->levels[i];
+			if (level.width == 0 || level.height == 0 || level.width > header->width || level.height > header->height
+				|| (i > 0 && (level.width != std::max<std::uint32_t>(1, header->levels[i - 1].width / 2)
+					|| level.height != std::max<std::uint32_t>(1, header->levels[i - 1].height / 2)))
+				|| level.tilesX != static_cast<std::uint32_t>(GetTileCount(static_cast<int>(level.width)))
+				|| level.tilesY != static_cast<std::uint32_t>(GetTileCount(static_cast<int>(level.height)))
+				|| level.firstTile != tileCount)
+			{
+				return nullptr;
+			}
+			tileCount += static_cast<std::uint64_t>(level.tilesX) * level.tilesY;
+		}
+
+		const TiledTextureFileLevel& lastLevel = header->levels[header->levelCount - 1];
+		if (lastLevel.tilesX != 1 || lastLevel.tilesY != 1
+			|| header->tilesOffset % TiledTextureAlignment != 0 || header->tilesOffset > size
+			|| tileCount > (size - header->tilesOffset) / header->tileBytes)
+		{
+			return nullptr;
+		}
+
+		return header;
+	}
+
+	void UseTiledTexture(TiledTexture& texture, const char* data, const TiledTextureHeader& header)
+	{
+		texture.width = static_cast<int>(header.width);
+		texture.height = static_cast<int>(header.height);
+		texture.channels = static_cast<int>(header.channels);
+		texture.compression = static_cast<TextureCompression>(header.compression);
+		texture.tileBytes = static_cast<std::size_t>(header.tileBytes);
+		texture.tiles = reinterpret_cast<const unsigned char*>(data + header.tilesOffset);
+		for (std::uint32_t i = 0; i < header.levelCount; i++)
+		{
+			const TiledTextureFileLevel& level = header.levels[i];
+			texture.levels.push_back({ static_cast<int>(level.width), static_cast<int>(level.height), static_cast<int>(level.tilesX),
+				static_cast<int>(level.tilesY), static_cast<std::size_t>(level.firstTile) });
+		}
+	}
+
+	/// <summary>
+	/// Writes the texture to a temporary file first, so a tiled texture is never seen half-written.
+	/// </summary>
+	bool WriteTiledTexture(const std::string& cookedFilePath, const TiledTextureHeader& header, const std::vector<unsigned char>& tiles)
+	{
+		std::string temporaryFilePath = cookedFilePath + ".tmp";
+		{
+			std::ofstream cookedFile(temporaryFilePath, std::ios::binary | std::ios::trunc);
+			if (cookedFile.fail())
+			{
+				return false;
+			}
+
+			const char padding[TiledTextureAlignment] = {};
+			cookedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			cookedFile.write(padding, header.tilesOffset - sizeof(header));
+			cookedFile.write(reinterpret_cast<const char*>(tiles.data()), tiles.size());
+			if (cookedFile.fail())
+			{
+				cookedFile.close();
+				std::remove(temporaryFilePath.c_str());
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryFilePath, cookedFilePath, error);
+		if (error)
+		{
+			std::remove(temporaryFilePath.c_str());
+			return false;
+		}
+		return true;
+	}
+}
+
+bool IsTiledImage(const std::string& imageFilePath)
+{
+	return std::filesystem::path(imageFilePath).filename().string().rfind(TiledImagePrefix, 0) == 0;
+}
+
+bool CookTiledTexture(const std::string& imageFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash, bool blockCompress,
+	ThreadPool* threadPool)
+{
+	LoadedTexture texture;
+	if (!DecodeImage(imageFilePath, texture))
+	{
+		return false;
+	}
+
+	// The tiles are cut from uncompressed levels and compressed one by one, so each tile is whole blocks
+	TextureCompression compression = blockCompress ? GetBlockCompression(texture) : TextureCompression::None;
+	BuildMipChain(texture, TextureCompression::None);
+
+	TiledTextureHeader header = {};
+	std::memcpy(header.magic, TiledTextureMagic, sizeof(TiledTextureMagic));
+	header.version = TiledTextureVersion;
+	header.width = static_cast<std::uint32_t>(texture.width);
+	header.height = static_cast<std::uint32_t>(texture.height);
+	header.channels = static_cast<std::uint32_t>(texture.channels);
+	header.compression = static_cast<std::uint32_t>(compression);
+	header.tileSize = static_cast<std::uint32_t>(TileSize);
+	header.tileBorder = static_cast<std::uint32_t>(TileBorder);
+	header.tileBytes = GetTileBytes(header.channels, compression);
+	header.tilesOffset = (sizeof(header) + TiledTextureAlignment - 1) / TiledTextureAlignment * TiledTextureAlignment;
+	header.sourceHash = sourceHash;
+
+	// Levels smaller than a tile would only repeat the last one
+	std::size_t tileCount = 0;
+	for (const TextureLevel& level : texture.levels)
+	{
+		TiledTextureFileLevel& tiledLevel = header.levels[header.levelCount++];
+		tiledLevel.width = static_cast<std::uint32_t>(level.width);
+		tiledLevel.height = static_cast<std::uint32_t>(level.height);
+		tiledLevel.tilesX = static_cast<std::uint32_t>(GetTileCount(level.width));
+		tiledLevel.tilesY = static_cast<std::uint32_t>(GetTileCount(level.height));
+		tiledLevel.firstTile = tileCount;
+		tileCount += static_cast<std::size_t>(tiledLevel.tilesX) * tiledLevel.tilesY;
+
+		if ((tiledLevel.tilesX == 1 && tiledLevel.tilesY == 1) || header.levelCount == MaxTiledTextureLevels)
+		{
+			break;
+		}
+	}
+	if (header.levels[header.levelCount - 1].tilesX != 1 || header.levels[header.levelCount - 1].tilesY != 1)
+	{
+		return false;
+	}
+
+	// Every tile is cut (and compressed) into its own place, so they are all done in parallel
+	std::vector<unsigned char> tiles(tileCount * header.tileBytes);
+	std::function<void(std::size_t)> cutTile = [&texture, &header, &tiles, compression](std::size_t tileIndex)
+		{
+			std::uint32_t levelIndex = 0;
+			while (levelIndex + 1 < header.levelCount && header.levels[levelIndex + 1].firstTile <= tileIndex)
+			{
+				levelIndex++;
+			}
+			const TiledTextureFileLevel& level = header.levels[levelIndex];
+			std::size_t levelTile = tileIndex - static_cast<std::size_t>(level.firstTile);
+			int tileX = static_cast<int>(levelTile % level.tilesX);
+			int tileY = static_cast<int>(levelTile / level.tilesX);
+
+			unsigned char* tile = tiles.data() + tileIndex * header.tileBytes;
+			if (compression == TextureCompression::None)
+			{
+				CopyTile(texture.levels[levelIndex], texture.channels, tileX, tileY, tile);
+				return;
+			}
+
+			std::vector<unsigned char> pixels(static_cast<std::size_t>(TileSize) * TileSize * texture.channels);
+			CopyTile(texture.levels[levelIndex], texture.channels, tileX, tileY, pixels.data());
+			CompressImage(pixels.data(), TileSize, TileSize, texture.channels, compression, tile);
+		};
+
+	if (threadPool != nullptr)
+	{
+		threadPool->ParallelFor(tileCount, cutTile);
+	}
+	else
+	{
+		for (std::size_t i = 0; i < tileCount; i++)
+		{
+			cutTile(i);
+		}
+	}
+
+	return WriteTiledTexture(cookedFilePath, header, tiles);
+}
+
+bool LoadCookedTiledTexture(const std::string& cookedFilePath, TiledTexture& texture)
+{
+	texture = TiledTexture();
+
+	std::error_code error;
+	if (!std::filesystem::exists(cookedFilePath, error) || !texture.file.Open(cookedFilePath, MappedFileAccess::Random))
+	{
+		return false;
+	}
+
+	const TiledTextureHeader* header = ValidateTiledTexture(texture.file.GetData(), texture.file.GetSize());
+	if (header == nullptr)
+	{
+		texture = TiledTexture();
+		return false;
+	}
+
+	UseTiledTexture(texture, texture.file.GetData(), *header);
+	return true;
+}
+
+bool LoadTiledTexture(AssetArchive& archive, const std::string& name, TiledTexture& texture)
+{
+	texture = TiledTexture();
+
+	// A compressed entry would have to be decompressed whole, which is exactly what tiling avoids
+	const ArchiveEntry* entry = archive.Find(name);
+	if (entry == nullptr || entry->compression != static_cast<std::uint32_t>(ArchiveCompression::None) || !archive.Read(name, texture.asset))
+	{
+		return false;
+	}
+
+	const TiledTextureHeader* header = ValidateTiledTexture(texture.asset.data, texture.asset.size);
+	if (header == nullptr)
+	{
+		texture = TiledTexture();
+		return false;
+	}
+
+	UseTiledTexture(texture, texture.asset.data, *header);
+	return true;
+}
+
+const unsigned char* GetTile(const TiledTexture& texture, int level, int x, int y)
+{
+	const TiledTextureLevel& tiledLevel = texture.levels[level];
+	std::size_t tileIndex = tiledLevel.firstTile + static_cast<std::size_t>(y) * tiledLevel.tilesX + x;
+	return texture.tiles + tileIndex * texture.tileBytes;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "AssetArchive.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Extension of tiled textures (written by CookTiledTexture)
+/// </summary>
+const char TiledTextureExtension[] = ".tiles";
+
+/// <summary>
+/// Images whose file name starts with this are also cooked as tiled textures, so that they can be drawn as virtual textures
+/// </summary>
+const char TiledImagePrefix[] = "PAINTING-";
+
+/// <summary>
+/// Size of a tile in pixels, its border included
+/// </summary>
+const int TileSize = 128;
+
+/// <summary>
+/// Pixels around each tile copied from the tiles next to it (or repeating the edge of the image),
+/// so that filtering near the edge of a tile reads the same colors it would in the whole image
+/// </summary>
+const int TileBorder = 4;
+
+/// <summary>
+/// Pixels of its level each tile covers, along each side
+/// </summary>
+const int TilePayloadSize = TileSize - 2 * TileBorder;
+
+/// <summary>
+/// One level of the mip chain of a tiled texture
+/// </summary>
+struct TiledTextureLevel
+{
+	int width = 0;					// Width of the level in pixels
+	int height = 0;					// Height of the level in pixels
+	int tilesX = 0;					// Number of tiles across the level
+	int tilesY = 0;					// Number of tiles up the level
+	std::size_t firstTile = 0;		// Index of the level's first tile among every tile of the texture
+};
+
+/// <summary>
+/// Tiled texture: every level of an image's mip chain cut into tiles of TileSize pixels, the bottom row of tiles first,
+/// each stored on its own so that it can be read without the rest of the image
+/// </summary>
+struct TiledTexture
+{
+	MappedFile file;					// Mapping of the tiled texture file (closed otherwise)
+	ArchiveAsset asset;					// Tiled texture read from the asset archive (empty otherwise)
+	int width = 0;						// Width of the full-size level in pixels
+	int height = 0;						// Height of the full-size level in pixels
+	int channels = 0;					// Bytes per pixel: 3 (RGB) or 4 (RGBA), before any block compression
+	TextureCompression compression = TextureCompression::None;	// Format of the tiles' pixels
+	std::size_t tileBytes = 0;			// Size of each tile in bytes
+	std::vector<TiledTextureLevel> levels;	// Mip chain, full size first, down to the first level that fits in a single tile
+	const unsigned char* tiles = nullptr;	// Every tile, level by level
+};
+
+/// <summary>
+/// Checks if an image is cooked as a tiled texture as well, from its file name (see TiledImagePrefix).
+/// </summary>
+/// <param name="imageFilePath">Path to the image</param>
+/// <returns>True if the image has a tiled texture</returns>
+bool IsTiledImage(const std::string& imageFilePath);
+
+/// <summary>
+/// Decodes an image with stb_image, builds its mip chain with the sRGB-aware box filter CookTexture uses, and writes it cut into tiles
+/// to a tiled texture file. The tiles are stored the way CookTexture stores levels: block compressed (BC1 if the image
+/// is opaque, BC3 otherwise) or as RGB or RGBA, the bottom row first.
+/// </summary>
+/// <param name="imageFilePath">Path to the source image (PNG, JPEG, ...)</param>
+/// <param name="cookedFilePath">Path to the tiled texture to write</param>
+/// <param name="sourceHash">HashBytes of the source image, recorded in the tiled texture</param>
+/// <param name="blockCompress">Indicates if the tiles are stored block compressed rather than as they are</param>
+/// <param name="threadPool">Worker threads that cut and compress the tiles in parallel (null to do it on the calling thread)</param>
+/// <returns>True if the texture was cooked successfully</returns>
+bool CookTiledTexture(const std::string& imageFilePath, const std::string& cookedFilePath, std::uint64_t sourceHash, bool blockCompress,
+	ThreadPool* threadPool = nullptr);
+
+/// <summary>
+/// Memory-maps a tiled texture written by CookTiledTexture, checking that it is complete and of the current version.
+/// </summary>
+/// <param name="cookedFilePath">Path to the tiled texture</param>
+/// <param name="texture">Receives the texture, pointing into the mapping</param>
+/// <returns>True if the texture was loaded successfully</returns>
+bool LoadCookedTiledTexture(const std::string& cookedFilePath, TiledTexture& texture);
+
+/// <summary>
+/// Finds a tiled texture written by CookTiledTexture in an asset archive, checking that it is complete and of the current version.
+/// The archive stores tiled textures uncompressed, so nothing is read until a tile is: each tile comes straight out of the mapping.
+/// </summary>
+/// <param name="archive">Archive of cooked assets</param>
+/// <param name="name">Name of the tiled texture in the archive (see GetCookedAssetName)</param>
+/// <param name="texture">Receives the texture, pointing into the archive's mapping</param>
+/// <returns>True if the texture was loaded successfully</returns>
+bool LoadTiledTexture(AssetArchive& archive, const std::string& name, TiledTexture& texture);
+
+/// <summary>
+/// Pixels of one tile of a tiled texture.
+/// </summary>
+/// <param name="texture">Tiled texture</param>
+/// <param name="level">Level of the mip chain</param>
+/// <param name="x">Column of the tile, from the left</param>
+/// <param name="y">Row of the tile, from the bottom</param>
+/// <returns>The tileBytes bytes of the tile</returns>
+const unsigned char* GetTile(const TiledTexture& texture, int level, int x, int y);
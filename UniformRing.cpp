@@ -0,0 +1,109 @@
+#include "UniformRing.h"
+
+#include <cstring>
+#include <iostream>
+
+void UniformRing::Create(std::initializer_list<BlockCount> blockCounts)
+{
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = alignment > 0 ? alignment : 1;
+	partSize = 0;
+	for (const BlockCount& blocks : blockCounts)
+	{
+		partSize += GetAlignedSize(blocks.size) * blocks.count;
+	}
+
+	// The buffer is only ever written by the CPU and read by the GPU
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(partSize * PartCount), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	frameBlocks.reserve(partSize);
+}
+
+void UniformRing::Destroy()
+{
+	for (GLsync& fence : fences)
+	{
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+std::size_t UniformRing::GetAlignedSize(std::size_t size) const
+{
+	std::size_t blockAlignment = static_cast<std::size_t>(alignment);
+	return (size + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+void UniformRing::BeginFrame()
+{
+	part = (part + 1) % PartCount;
+	frameBlocks.clear();
+
+	// Usually long signaled, since the part was last used a few frames ago
+	GLsync& fence = fences[part];
+	if (fence != nullptr)
+	{
+		GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED)
+		{
+			std::cerr << "Timed out waiting for the GPU to read the uniform blocks of an earlier frame" << std::endl;
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
+
+bool UniformRing::Allocate(const void* data, std::size_t size, GLintptr& offset)
+{
+	std::size_t blockOffset = frameBlocks.size();
+	if (blockOffset + size > partSize)
+	{
+		return false;
+	}
+
+	frameBlocks.resize(blockOffset + GetAlignedSize(size));
+	std::memcpy(frameBlocks.data() + blockOffset, data, size);
+	offset = static_cast<GLintptr>(part * partSize + blockOffset);
+	return true;
+}
+
+void UniformRing::Upload()
+{
+	if (frameBlocks.empty())
+	{
+		return;
+	}
+
+	// The fence waited on in BeginFrame makes sure the GPU is done with the part, so the driver need not check
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	GLintptr offset = static_cast<GLintptr>(part * partSize);
+	GLsizeiptr size = static_cast<GLsizeiptr>(frameBlocks.size());
+	void* mapping = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (mapping != nullptr)
+	{
+		std::memcpy(mapping, frameBlocks.data(), frameBlocks.size());
+		if (glUnmapBuffer(GL_UNIFORM_BUFFER) == GL_TRUE)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			return;
+		}
+	}
+
+	// The mapping failed or its contents were lost (rare, such as when the display mode changes), so the blocks are copied instead
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, frameBlocks.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformRing::Bind(GLuint binding, GLintptr offset, std::size_t size) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, static_cast<GLsizeiptr>(size));
+}
+
+void UniformRing::EndFrame()
+{
+	fences[part] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
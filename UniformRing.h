@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+/// <summary>
+/// Uniform buffer that the uniform blocks of each frame are sub-allocated from and bound with glBindBufferRange.
+/// The buffer is split into a few parts used in turn, one per frame: a frame's blocks are gathered in memory and written
+/// to its part in one go, and a fence after the frame's draw calls tells when that part can be written again,
+/// so the CPU never writes what the GPU may still be reading.
+/// </summary>
+class UniformRing
+{
+public:
+	UniformRing() = default;
+
+	UniformRing(const UniformRing&) = delete;
+	UniformRing& operator=(const UniformRing&) = delete;
+
+	/// <summary>
+	/// How many blocks of a size one frame may allocate
+	/// </summary>
+	struct BlockCount
+	{
+		std::size_t size;							// Size of each block in bytes, before padding
+		std::size_t count;							// Number of blocks of that size per frame
+	};
+
+	/// <summary>
+	/// Creates the buffer, with room in each part for the blocks of one frame once each is padded to the offset alignment
+	/// the driver requires (which is only known here). Must be called on the OpenGL thread.
+	/// </summary>
+	/// <param name="blockCounts">Blocks one frame may allocate</param>
+	void Create(std::initializer_list<BlockCount> blockCounts);
+
+	/// <summary>
+	/// Deletes the buffer and the fences. Must be called on the OpenGL thread while the context is still there.
+	/// </summary>
+	void Destroy();
+
+	/// <summary>
+	/// Size a block takes in the ring, padded to the offset alignment the driver requires of glBindBufferRange.
+	/// Only valid once the ring is created.
+	/// </summary>
+	/// <param name="size">Size of the block in bytes</param>
+	/// <returns>Padded size in bytes</returns>
+	std::size_t GetAlignedSize(std::size_t size) const;
+
+	/// <summary>
+	/// Starts the blocks of a new frame in the next part of the ring, waiting for the GPU to finish reading that part
+	/// if it has not yet (it was last used as many frames ago as there are parts).
+	/// </summary>
+	void BeginFrame();
+
+	/// <summary>
+	/// Copies a block into this frame's part of the ring.
+	/// </summary>
+	/// <param name="data">Contents of the block, laid out as std140</param>
+	/// <param name="size">Size of the block in bytes</param>
+	/// <param name="offset">Receives the offset of the block in the buffer, for Bind</param>
+	/// <returns>True if the block fit in what is left of the frame's part (more blocks than Create made room for do not)</returns>
+	bool Allocate(const void* data, std::size_t size, GLintptr& offset);
+
+	/// <summary>
+	/// Writes this frame's blocks to the buffer. Must be called after the last Allocate and before the draw calls that read the blocks.
+	/// </summary>
+	void Upload();
+
+	/// <summary>
+	/// Binds a block to the binding point its uniform block reads from.
+	/// </summary>
+	/// <param name="binding">Uniform buffer binding point</param>
+	/// <param name="offset">Offset of the block, from Allocate</param>
+	/// <param name="size">Size of the block in bytes</param>
+	void Bind(GLuint binding, GLintptr offset, std::size_t size) const;
+
+	/// <summary>
+	/// Places the fence that tells when this frame's part has been read. Must be called after the frame's last draw call.
+	/// </summary>
+	void EndFrame();
+
+private:
+	/// <summary>
+	/// Number of parts of the ring, which is how many frames the CPU may run ahead of the GPU
+	/// </summary>
+	static const std::size_t PartCount = 3;
+
+	GLuint buffer = 0;
+	std::size_t partSize = 0;					// Size of each part, a multiple of the alignment
+	GLint alignment = 1;						// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	GLsync fences[PartCount] = {};				// Fence after the last frame that used each part (null if none)
+	std::size_t part = 0;						// Part of the current frame
+	std::vector<unsigned char> frameBlocks;		// Blocks of the current frame, until they are uploaded
+};
@@ -0,0 +1,221 @@
+#include "UploadRing.h"
+
+#include "Textures.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Persistent mapping comes from GL_ARB_buffer_storage (only core since OpenGL 4.4),
+// which an OpenGL 3.3 loader does not necessarily define
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace
+{
+	typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+	/// <summary>
+	/// Alignment of every part of the ring, so the copies into it are aligned whatever the size of the textures before
+	/// </summary>
+	const std::size_t BlockAlignment = 64;
+}
+
+bool UploadRing::Create(std::size_t size, GLADloadproc loadProc)
+{
+	if (!HasExtension("GL_ARB_buffer_storage"))
+	{
+		std::cout << "Persistent buffer mapping is not supported, exhibit textures are uploaded from their own pixels" << std::endl;
+		return false;
+	}
+	BufferStorageProc bufferStorage = reinterpret_cast<BufferStorageProc>(loadProc("glBufferStorage"));
+	if (bufferStorage == nullptr)
+	{
+		std::cerr << "Failed to load glBufferStorage" << std::endl;
+		return false;
+	}
+
+	// Immutable storage that stays mapped while the GPU reads from it; coherent, so what the worker threads copy
+	// is seen by uploads issued after it without flushing
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	bufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags);
+	void* bufferMapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size), flags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (bufferMapping == nullptr)
+	{
+		std::cerr << "Failed to map the upload ring" << std::endl;
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		return false;
+	}
+
+	// Compressed textures a driver cannot sample are decompressed on the OpenGL thread, from memory it can read back
+	bool compressed = IsTextureCompressionSupported();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	mapping = static_cast<unsigned char*>(bufferMapping);
+	capacity = size;
+	compressedTextures = compressed;
+	return true;
+}
+
+void UploadRing::Destroy()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	writesFinished.wait(lock, [this]() { return writesInFlight == 0; });
+	if (mapping == nullptr)
+	{
+		return;
+	}
+
+	for (const Block& block : blocks)
+	{
+		glDeleteSync(block.fence);
+	}
+	blocks.clear();
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	mapping = nullptr;
+	capacity = 0;
+}
+
+bool UploadRing::StageTexture(LoadedTexture& texture, UploadRingAllocation& allocation)
+{
+	allocation = UploadRingAllocation();
+	std::size_t size = 0;
+	for (const TextureLevel& level : texture.levels)
+	{
+		size += level.size;
+	}
+	if (texture.levels.empty() || !Allocate(size, texture.compression != TextureCompression::None, allocation))
+	{
+		return false;
+	}
+
+	// The writes are where the pages of the mapping get touched, so they happen here rather than on the OpenGL thread
+	std::size_t offset = 0;
+	for (TextureLevel& level : texture.levels)
+	{
+		std::memcpy(allocation.data + offset, level.pixels, level.size);
+		level.pixels = allocation.data + offset;
+		offset += level.size;
+	}
+	texture.file.Close();
+	texture.asset = ArchiveAsset();
+	texture.decodedPixels.reset();
+	texture.generatedPixels = std::vector<unsigned char>();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	writesInFlight--;
+	writesFinished.notify_all();
+	return true;
+}
+
+void UploadRing::Bind() const
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+}
+
+const void* UploadRing::GetBufferOffset(const UploadRingAllocation& allocation, const unsigned char* pixels)
+{
+	return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(allocation.offset + (pixels - allocation.data)));
+}
+
+void UploadRing::Release(const UploadRingAllocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (Block& block : blocks)
+	{
+		if (block.offset == allocation.offset && !block.released)
+		{
+			block.released = true;
+			block.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			return;
+		}
+	}
+}
+
+void UploadRing::Update()
+{
+	// Parts are reused in the order they were handed out, so the oldest one still in use holds back the rest
+	std::lock_guard<std::mutex> lock(mutex);
+	while (!blocks.empty() && blocks.front().released)
+	{
+		GLenum status = glClientWaitSync(blocks.front().fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+		glDeleteSync(blocks.front().fence);
+		blocks.pop_front();
+	}
+}
+
+bool UploadRing::Allocate(std::size_t size, bool blockCompressed, UploadRingAllocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (mapping == nullptr || size == 0 || (blockCompressed && !compressedTextures))
+	{
+		return false;
+	}
+
+	// The free space is either after the newest part and before the oldest (once the ring has wrapped around),
+	// or after the newest part up to the end plus before the oldest part from the start
+	std::size_t alignedSize = (size + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+	std::size_t offset;
+	if (blocks.empty())
+	{
+		if (alignedSize > capacity)
+		{
+			return false;
+		}
+		offset = 0;
+	}
+	else if (blocks.back().offset >= blocks.front().offset)
+	{
+		if (head + alignedSize <= capacity)
+		{
+			offset = head;
+		}
+		else if (alignedSize <= blocks.front().offset)
+		{
+			offset = 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	else if (head + alignedSize <= blocks.front().offset)
+	{
+		offset = head;
+	}
+	else
+	{
+		return false;
+	}
+
+	Block block;
+	block.offset = offset;
+	block.size = alignedSize;
+	blocks.push_back(block);
+	head = offset + alignedSize;
+	writesInFlight++;
+
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.data = mapping + offset;
+	return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CookedAssets.h"
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/// <summary>
+/// Part of the upload ring that holds the pixels of one texture
+/// </summary>
+struct UploadRingAllocation
+{
+	std::size_t offset = 0;				// Offset of the pixels in the ring's buffer
+	std::size_t size = 0;				// Size of the pixels in bytes (0 if the texture is not in the ring)
+	unsigned char* data = nullptr;		// Pixels, in the persistent mapping of the buffer
+};
+
+/// <summary>
+/// Pixel buffer that stays mapped for the whole run (GL_ARB_buffer_storage), which textures are staged in on their way
+/// to the GPU. Worker threads copy the pixels they loaded straight into the mapping, so the OpenGL thread only issues
+/// the glTexSubImage2D calls that read them from the buffer, which the driver carries out without touching the pixels itself.
+/// Each part of the ring is reused once a fence shows that the GPU has read it. Without the extension, nothing is staged
+/// and textures are uploaded from their own pixels as before.
+/// </summary>
+class UploadRing
+{
+public:
+	UploadRing() = default;
+
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	/// <summary>
+	/// Creates the buffer and maps it. Must be called on the OpenGL thread; textures loaded before this are not staged.
+	/// </summary>
+	/// <param name="size">Size of the ring in bytes</param>
+	/// <param name="loadProc">Function that finds OpenGL functions (glBufferStorage is not part of OpenGL 3.3)</param>
+	/// <returns>True if the driver supports persistent mapping and the buffer was created</returns>
+	bool Create(std::size_t size, GLADloadproc loadProc);
+
+	/// <summary>
+	/// Waits for the worker threads to finish copying into the ring, then unmaps and deletes the buffer.
+	/// Must be called on the OpenGL thread while the context is still there.
+	/// </summary>
+	void Destroy();
+
+	/// <summary>
+	/// Copies the levels of a texture into the ring and frees the texture's own copy of them, leaving its levels pointing
+	/// into the mapping. Can be called on any thread. A texture that does not fit in the space left, or that would have to be
+	/// decompressed before it is uploaded (see PrepareTextureForUpload), is left as it is.
+	/// </summary>
+	/// <param name="texture">Texture with at least its full-size level</param>
+	/// <param name="allocation">Receives the part of the ring the texture is in (with a size of 0 if it was left as it is)</param>
+	/// <returns>True if the texture was staged</returns>
+	bool StageTexture(LoadedTexture& texture, UploadRingAllocation& allocation);
+
+	/// <summary>
+	/// Binds the ring to GL_PIXEL_UNPACK_BUFFER, so that the pixel pointers of texture uploads are offsets into it
+	/// (see GetBufferOffset). Must be unbound again before uploading pixels from anywhere else.
+	/// </summary>
+	void Bind() const;
+
+	/// <summary>
+	/// Offset in the ring's buffer to pass to glTexSubImage2D in place of a pointer to staged pixels.
+	/// </summary>
+	/// <param name="allocation">Part of the ring the pixels are in</param>
+	/// <param name="pixels">Pixels in the mapping</param>
+	/// <returns>Offset, as the pointer OpenGL expects</returns>
+	static const void* GetBufferOffset(const UploadRingAllocation& allocation, const unsigned char* pixels);
+
+	/// <summary>
+	/// Gives a part of the ring back once the uploads that read it have been issued: a fence is placed after them,
+	/// and the part is reused once the GPU passes it. Must be called on the OpenGL thread.
+	/// </summary>
+	/// <param name="allocation">Part of the ring returned by StageTexture</param>
+	void Release(const UploadRingAllocation& allocation);
+
+	/// <summary>
+	/// Frees the parts of the ring the GPU is done reading, without waiting for the others. Must be called on the OpenGL thread once per frame.
+	/// </summary>
+	void Update();
+
+private:
+	/// <summary>
+	/// Part of the ring handed out by StageTexture, in the order they were handed out
+	/// </summary>
+	struct Block
+	{
+		std::size_t offset = 0;		// Offset in the buffer
+		std::size_t size = 0;		// Size in bytes
+		bool released = false;		// Indicates if the uploads that read it have been issued
+		GLsync fence = nullptr;		// Fence after those uploads
+	};
+
+	bool Allocate(std::size_t size, bool blockCompressed, UploadRingAllocation& allocation);
+
+	GLuint buffer = 0;
+	unsigned char* mapping = nullptr;
+	std::size_t capacity = 0;
+	bool compressedTextures = false;			// Indicates if block-compressed textures can be staged as they are
+
+	std::mutex mutex;							// Guards everything below, and the fields above once the ring is created
+	std::condition_variable writesFinished;
+	std::deque<Block> blocks;					// Parts of the ring in use, oldest first
+	std::size_t head = 0;						// Offset where the newest part ends
+	std::size_t writesInFlight = 0;				// Worker threads copying into the ring
+};
@@ -0,0 +1,143 @@
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+std::size_t GetVertexSize(VertexFormat format)
+{
+	return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+GLhalf FloatToHalf(float value)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	std::uint32_t sign = (bits >> 16) & 0x8000u;
+	std::uint32_t exponent = (bits >> 23) & 0xFFu;
+	std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+	// NaN and infinity
+	if (exponent == 0xFFu)
+	{
+		return static_cast<GLhalf>(sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u));
+	}
+
+	int halfExponent = static_cast<int>(exponent) - 127 + 15;
+
+	// Too large for a half float
+	if (halfExponent >= 31)
+	{
+		return static_cast<GLhalf>(sign | 0x7C00u);
+	}
+
+	// Normal half float, with the dropped mantissa bits rounded to nearest even
+	if (halfExponent > 0)
+	{
+		std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+		std::uint32_t rest = mantissa & 0x1FFFu;
+		if (rest > 0x1000u || (rest == 0x1000u && (half & 1u) != 0))
+		{
+			half++;	// May carry into the exponent, which correctly rounds up to the next power of two
+		}
+		return static_cast<GLhalf>(sign | half);
+	}
+
+	// Too small even for a subnormal half float
+	if (halfExponent < -10)
+	{
+		return static_cast<GLhalf>(sign);
+	}
+
+	// Subnormal half float
+	mantissa |= 0x800000u;
+	int shift = 14 - halfExponent;
+	std::uint32_t half = mantissa >> shift;
+	std::uint32_t rest = mantissa & ((1u << shift) - 1u);
+	std::uint32_t halfway = 1u << (shift - 1);
+	if (rest > halfway || (rest == halfway && (half & 1u) != 0))
+	{
+		half++;
+	}
+	return static_cast<GLhalf>(sign | half);
+}
+
+GLuint PackNormal(float x, float y, float z)
+{
+	auto packComponent = [](float value) -> GLuint
+	{
+		float clamped = std::min(std::max(value, -1.0f), 1.0f);
+		int quantized = static_cast<int>(std::lround(clamped * 511.0f));
+		return static_cast<GLuint>(quantized) & 0x3FFu;
+	};
+
+	return packComponent(x) | (packComponent(y) << 10) | (packComponent(z) << 20);
+}
+
+void CompactVertices(const Vertex* vertices, std::size_t vertexCount, const MeshBounds& bounds, CompactVertex* output)
+{
+	float scale[3];
+	for (int k = 0; k < 3; k++)
+	{
+		float extent = bounds.max[k] - bounds.min[k];
+		scale[k] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+	}
+
+	auto quantize = [](float value, float min, float scale) -> GLushort
+	{
+		float quantized = (value - min) * scale + 0.5f;
+		return static_cast<GLushort>(std::min(std::max(quantized, 0.0f), 65535.0f));
+	};
+
+	for (std::size_t i = 0; i < vertexCount; i++)
+	{
+		const Vertex& vertex = vertices[i];
+		CompactVertex& compact = output[i];
+
+		compact.x = quantize(vertex.x, bounds.min[0], scale[0]);
+		compact.y = quantize(vertex.y, bounds.min[1], scale[1]);
+		compact.z = quantize(vertex.z, bounds.min[2], scale[2]);
+		compact.padding = 0;
+		compact.u = FloatToHalf(vertex.u);
+		compact.v = FloatToHalf(vertex.v);
+		compact.normal = PackNormal(vertex.nx, vertex.ny, vertex.nz);
+	}
+}
+
+void SetupVertexAttributes(VertexFormat format)
+{
+	if (format == VertexFormat::Compact)
+	{
+		// Vertex attribute 0 - Position, as fractions of the mesh bounds (scaled back in the vertex shader)
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, x));
+
+		// Vertex attribute 2 - UV Coordinates
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, u));
+
+		// Vertex attribute 3 - Normal Vector
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, normal));
+		return;
+	}
+
+	// Vertex attribute 0 - Position
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+
+	// Vertex attribute 1 - Color
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+
+	// Vertex attribute 2 - UV Coordinates
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+
+	// Vertex attribute 3 - Normal Vector
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, nx));
+}
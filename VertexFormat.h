@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <cstddef>
+
+/// <summary>
+/// Layout of the vertices of the exhibits inside their vertex buffer
+/// </summary>
+enum class VertexFormat
+{
+	Float,		// struct Vertex: float position, UV and normal, byte color (36 bytes)
+	Compact		// struct CompactVertex: quantized position, half-float UV, packed normal (16 bytes)
+};
+
+/// <summary>
+/// Quantized vertex. The position is stored as 16-bit fractions of the mesh bounds
+/// (dequantized in the vertex shader), the UV coordinates as half floats and the normal
+/// vector as GL_INT_2_10_10_10_REV. Vertex colors, if any, go in a separate stream.
+/// </summary>
+struct CompactVertex
+{
+	GLushort x, y, z;	// Position relative to the mesh bounds (0 = min, 65535 = max)
+	GLushort padding;	// Keeps the UV coordinates 4-byte aligned
+	GLhalf u, v;		// UV Coordinates
+	GLuint normal;		// Normal Vector (10 bits per component, signed normalized)
+};
+
+/// <summary>
+/// Size in bytes of one vertex in the given format.
+/// </summary>
+std::size_t GetVertexSize(VertexFormat format);
+
+/// <summary>
+/// Converts a float to a half float (rounding to nearest even, overflowing to infinity).
+/// </summary>
+GLhalf FloatToHalf(float value);
+
+/// <summary>
+/// Packs a normal vector into the GL_INT_2_10_10_10_REV format (w is left at 0).
+/// </summary>
+GLuint PackNormal(float x, float y, float z);
+
+/// <summary>
+/// Quantizes vertices into the compact format.
+/// </summary>
+/// <param name="vertices">Vertices to quantize</param>
+/// <param name="vertexCount">Number of vertices</param>
+/// <param name="bounds">Box around the vertices, the range the positions are quantized to</param>
+/// <param name="output">Receives vertexCount compact vertices</param>
+void CompactVertices(const Vertex* vertices, std::size_t vertexCount, const MeshBounds& bounds, CompactVertex* output);
+
+/// <summary>
+/// Sets up the position (0), UV (2) and normal (3) vertex attributes of the bound vertex array object
+/// to read the given format from the buffer bound to GL_ARRAY_BUFFER. Float vertices also set up the
+/// color attribute (1); compact vertices leave it to a separate color stream.
+/// </summary>
+void SetupVertexAttributes(VertexFormat format);
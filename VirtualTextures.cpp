@@ -0,0 +1,568 @@
+#include "VirtualTextures.h"
+
+#include "CookedAssets.h"
+#include "PixelKernels.h"
+#include "Textures.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+namespace
+{
+	/// <summary>
+	/// Packs the image, level and position of a tile into one number, ordered by image, then level, then row
+	/// </summary>
+	std::uint64_t MakeTileKey(std::size_t textureIndex, int level, int x, int y)
+	{
+		return (static_cast<std::uint64_t>(textureIndex) << 56) | (static_cast<std::uint64_t>(level) << 48)
+			| (static_cast<std::uint64_t>(y) << 24) | static_cast<std::uint64_t>(x);
+	}
+
+	std::size_t GetKeyTexture(std::uint64_t key)
+	{
+		return static_cast<std::size_t>(key >> 56);
+	}
+
+	int GetKeyLevel(std::uint64_t key)
+	{
+		return static_cast<int>((key >> 48) & 0xFF);
+	}
+
+	int GetKeyY(std::uint64_t key)
+	{
+		return static_cast<int>((key >> 24) & 0xFFFFFF);
+	}
+
+	int GetKeyX(std::uint64_t key)
+	{
+		return static_cast<int>(key & 0xFFFFFF);
+	}
+
+	/// <summary>
+	/// Coarser levels first, since each of their tiles stands in for several finer ones
+	/// </summary>
+	bool IsCoarserTile(std::uint64_t a, std::uint64_t b)
+	{
+		int levelA = GetKeyLevel(a);
+		int levelB = GetKeyLevel(b);
+		return levelA != levelB ? levelA > levelB : a < b;
+	}
+
+	GLenum GetCompressedInternalFormat(TextureCompression compression)
+	{
+		LoadedTexture texture;
+		texture.compression = compression;
+		return GetTextureInternalFormat(texture);
+	}
+}
+
+VirtualTextures::VirtualTextures(ThreadPool& threadPool, const VirtualTextureSettings& settings)
+	: threadPool(threadPool), settings(settings)
+{
+}
+
+VirtualTextures::~VirtualTextures()
+{
+	// The jobs hand their tiles to this object, so it has to outlive them
+	while (loadsInFlight.load() != 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool VirtualTextures::Open(AssetArchive& archive, const std::vector<std::string>& imageFilePaths)
+{
+	textures.clear();
+	if (imageFilePaths.empty() || imageFilePaths.size() > static_cast<std::size_t>(MaxVirtualTextures))
+	{
+		return false;
+	}
+
+	textures.resize(imageFilePaths.size());
+	for (std::size_t i = 0; i < imageFilePaths.size(); i++)
+	{
+		if (!LoadTiledTexture(archive, GetCookedAssetName(imageFilePaths[i], TiledTextureExtension), textures[i]))
+		{
+			textures.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VirtualTextures::Create(int windowWidth, int windowHeight)
+{
+	if (textures.empty())
+	{
+		return false;
+	}
+
+	// A block-compressed cache takes a quarter (BC3) or an eighth (BC1) of the memory, but only if every image shares its format
+	cacheCompression = textures[0].compression;
+	for (const TiledTexture& texture : textures)
+	{
+		if (texture.compression != cacheCompression)
+		{
+			cacheCompression = TextureCompression::None;
+		}
+	}
+	if (cacheCompression != TextureCompression::None && !IsTextureCompressionSupported())
+	{
+		cacheCompression = TextureCompression::None;
+	}
+
+	// The cache is a single level: the shader picks the level of detail by picking the tile.
+	// Filtering never leaves a tile, since the shader keeps its samples within the tile's border
+	GLsizei cacheSize = settings.cacheTilesPerSide * TileSize;
+	glActiveTexture(GL_TEXTURE0 + TileCacheTextureUnit);
+	glGenTextures(1, &tileCache);
+	glBindTexture(GL_TEXTURE_2D, tileCache);
+	if (cacheCompression == TextureCompression::None)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	else
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, GetCompressedInternalFormat(cacheCompression), cacheSize, cacheSize, 0,
+			static_cast<GLsizei>(GetCompressedImageSize(cacheSize, cacheSize, cacheCompression)), nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// Each page table has one texel per tile of each level, so its levels are a mip chain large enough for the image
+	// with the most tiles (the tiles of a level never outnumber half of those of the level before, rounded up)
+	int mostTiles = 1;
+	for (const TiledTexture& texture : textures)
+	{
+		mostTiles = std::max({ mostTiles, texture.levels[0].tilesX, texture.levels[0].tilesY });
+	}
+	pageTableSize = 1;
+	int pageTableLevels = 1;
+	while (pageTableSize < mostTiles)
+	{
+		pageTableSize *= 2;
+		pageTableLevels++;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + PageTableTextureUnit);
+	glGenTextures(1, &pageTable);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, pageTable);
+	for (int level = 0; level < pageTableLevels; level++)
+	{
+		GLsizei levelSize = std::max(1, pageTableSize >> level);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, static_cast<GLsizei>(textures.size()), 0, GL_RGBA,
+			GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, pageTableLevels - 1);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glActiveTexture(GL_TEXTURE0);
+
+	pageEntries.assign(textures.size(), {});
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		for (const TiledTextureLevel& level : textures[i].levels)
+		{
+			pageEntries[i].emplace_back(static_cast<std::size_t>(level.tilesX) * level.tilesY * 4, 0);
+		}
+	}
+	pageTableChanged.assign(textures.size(), true);
+	slots.assign(static_cast<std::size_t>(settings.cacheTilesPerSide) * settings.cacheTilesPerSide, CacheSlot());
+	stats.cacheTiles = slots.size();
+
+	// The coarsest tile of each image covers all of it, so it is read right away and kept in the cache for good
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		std::unique_ptr<LoadedTile> tile = LoadTile(MakeTileKey(i, static_cast<int>(textures[i].levels.size()) - 1, 0, 0));
+		if (!UploadTile(*tile, true))
+		{
+			std::cerr << "The virtual texture cache has no room for the coarsest tile of every image" << std::endl;
+			return false;
+		}
+	}
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		UpdatePageTable(i);
+	}
+
+	// The feedback is drawn to integer texels, so that tile positions come back exactly
+	glGenFramebuffers(1, &feedbackFramebuffer);
+	glGenRenderbuffers(1, &feedbackColor);
+	glGenRenderbuffers(1, &feedbackDepth);
+	glGenBuffers(2, feedbackBuffers);
+	ResizeFeedback(windowWidth, windowHeight);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, feedbackColor);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+	GLenum framebufferStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (framebufferStatus != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "The virtual texture feedback framebuffer is incomplete: " << framebufferStatus << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void VirtualTextures::Destroy()
+{
+	glDeleteTextures(1, &tileCache);
+	glDeleteTextures(1, &pageTable);
+	glDeleteFramebuffers(1, &feedbackFramebuffer);
+	glDeleteRenderbuffers(1, &feedbackColor);
+	glDeleteRenderbuffers(1, &feedbackDepth);
+	glDeleteBuffers(2, feedbackBuffers);
+
+	tileCache = 0;
+	pageTable = 0;
+	feedbackFramebuffer = 0;
+	feedbackColor = 0;
+	feedbackDepth = 0;
+	feedbackBuffers[0] = 0;
+	feedbackBuffers[1] = 0;
+}
+
+void VirtualTextures::BeginFeedback(int windowWidth, int windowHeight)
+{
+	ResizeFeedback(windowWidth, windowHeight);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+	glViewport(0, 0, feedbackWidth, feedbackHeight);
+
+	// Texels that no virtual texture covers ask for nothing
+	const GLuint noTile[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, noTile);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTextures::EndFeedback()
+{
+	// The copy runs on the GPU; the buffer is only mapped two frames later, by which time it is done
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[nextFeedbackBuffer]);
+	glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	feedbackBufferFilled[nextFeedbackBuffer] = true;
+	nextFeedbackBuffer = 1 - nextFeedbackBuffer;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void VirtualTextures::Update()
+{
+	if (tileCache == 0)
+	{
+		return;
+	}
+	frame++;
+
+	// The coarser tiles over each requested one are asked for too, so that a tile that is still on its way
+	// has the best stand-in there can be
+	std::vector<std::uint64_t> requests;
+	ReadFeedback(requests);
+	std::sort(requests.begin(), requests.end());
+	requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+	std::size_t feedbackRequests = requests.size();
+	for (std::size_t i = 0; i < feedbackRequests; i++)
+	{
+		std::size_t textureIndex = GetKeyTexture(requests[i]);
+		const TiledTexture& texture = textures[textureIndex];
+		int x = GetKeyX(requests[i]);
+		int y = GetKeyY(requests[i]);
+		for (int level = GetKeyLevel(requests[i]) + 1; level < static_cast<int>(texture.levels.size()); level++)
+		{
+			x = std::min(x / 2, texture.levels[level].tilesX - 1);
+			y = std::min(y / 2, texture.levels[level].tilesY - 1);
+			requests.push_back(MakeTileKey(textureIndex, level, x, y));
+		}
+	}
+	std::sort(requests.begin(), requests.end(), IsCoarserTile);
+	requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+	stats.requestedTiles = requests.size();
+
+	// Tiles in the cache are kept there for another frame, and the others are read on the worker threads
+	for (std::uint64_t key : requests)
+	{
+		std::unordered_map<std::uint64_t, std::size_t>::const_iterator resident = residentTiles.find(key);
+		if (resident != residentTiles.end())
+		{
+			slots[resident->second].lastUsed = frame;
+			continue;
+		}
+		if (loadingTiles.size() >= settings.maxLoadsInFlight || !loadingTiles.insert(key).second)
+		{
+			continue;
+		}
+
+		loadsInFlight++;
+		threadPool.Enqueue([this, key]()
+			{
+				loaded.Push(LoadTile(key));
+				loadsInFlight--;
+			});
+	}
+
+	// The tiles that arrived go into the cache a few at a time, coarsest first, so that no frame spends long uploading
+	loaded.PopAll(arrived);
+	std::sort(arrived.begin(), arrived.end(),
+		[](const std::unique_ptr<LoadedTile>& a, const std::unique_ptr<LoadedTile>& b) { return IsCoarserTile(a->key, b->key); });
+	std::size_t uploadCount = std::min(arrived.size(), settings.maxUploadsPerFrame);
+	for (std::size_t i = 0; i < uploadCount; i++)
+	{
+		// A tile with no room left (every slot is needed by this frame) is dropped, to be asked for again
+		loadingTiles.erase(arrived[i]->key);
+		UploadTile(*arrived[i], false);
+	}
+	arrived.erase(arrived.begin(), arrived.begin() + uploadCount);
+
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		if (pageTableChanged[i])
+		{
+			UpdatePageTable(i);
+		}
+	}
+	stats.residentTiles = residentTiles.size();
+}
+
+void VirtualTextures::Bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + PageTableTextureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, pageTable);
+	glActiveTexture(GL_TEXTURE0 + TileCacheTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, tileCache);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void VirtualTextures::SetUniforms(const ShaderUniforms& uniforms, GLint firstLayer, bool feedback) const
+{
+	uniforms.useVirtualTextures.Set(true);
+	uniforms.firstVirtualLayer.Set(static_cast<GLfloat>(firstLayer));
+
+	// Size of each image and the number of its levels
+	glm::vec3 sizes[MaxVirtualTextures] = {};
+	for (std::size_t i = 0; i < textures.size(); i++)
+	{
+		sizes[i] = glm::vec3(static_cast<GLfloat>(textures[i].width), static_cast<GLfloat>(textures[i].height),
+			static_cast<GLfloat>(textures[i].levels.size()));
+	}
+	uniforms.virtualTextureSize.Set(sizes, static_cast<GLsizei>(textures.size()));
+
+	// A feedback texel covers feedbackDivisor x feedbackDivisor pixels of the window, so its UV derivatives are that much larger
+	uniforms.virtualLevelBias.Set(feedback ? -std::log2(static_cast<float>(settings.feedbackDivisor)) : 0.0f);
+}
+
+VirtualTextureStats VirtualTextures::GetStats() const
+{
+	return stats;
+}
+
+std::unique_ptr<VirtualTextures::LoadedTile> VirtualTextures::LoadTile(std::uint64_t key) const
+{
+	const TiledTexture& texture = textures[GetKeyTexture(key)];
+	const unsigned char* tilePixels = GetTile(texture, GetKeyLevel(key), GetKeyX(key), GetKeyY(key));
+
+	// Copying the tile here is what reads it from the disk, so the OpenGL thread never waits on the mapping
+	std::unique_ptr<LoadedTile> tile = std::make_unique<LoadedTile>();
+	tile->key = key;
+	if (cacheCompression == TextureCompression::None && texture.compression == TextureCompression::None && texture.channels == 3)
+	{
+		// RGB tiles are widened on the way, so every upload into the RGBA cache has 4-byte pixels
+		tile->channels = 4;
+		tile->pixels.resize(static_cast<std::size_t>(TileSize) * TileSize * 4);
+		ExpandRgbToRgba(tilePixels, static_cast<std::size_t>(TileSize) * TileSize, tile->pixels.data());
+	}
+	else if (texture.compression == cacheCompression)
+	{
+		tile->channels = texture.channels;
+		tile->pixels.assign(tilePixels, tilePixels + texture.tileBytes);
+	}
+	else
+	{
+		tile->channels = 4;
+		tile->pixels.resize(static_cast<std::size_t>(TileSize) * TileSize * 4);
+		DecompressImage(tilePixels, TileSize, TileSize, texture.compression, tile->pixels.data());
+	}
+	return tile;
+}
+
+void VirtualTextures::ResizeFeedback(int width, int height)
+{
+	windowWidth = width;
+	windowHeight = height;
+
+	int newWidth = std::max(1, width / settings.feedbackDivisor);
+	int newHeight = std::max(1, height / settings.feedbackDivisor);
+	if (newWidth == feedbackWidth && newHeight == feedbackHeight)
+	{
+		return;
+	}
+	feedbackWidth = newWidth;
+	feedbackHeight = newHeight;
+
+	glBindRenderbuffer(GL_RENDERBUFFER, feedbackColor);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA16UI, feedbackWidth, feedbackHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, feedbackWidth, feedbackHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// Feedback of the old size is thrown away
+	for (int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(feedbackWidth) * feedbackHeight * 4 * sizeof(GLushort), nullptr,
+			GL_STREAM_READ);
+		feedbackBufferFilled[i] = false;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void VirtualTextures::ReadFeedback(std::vector<std::uint64_t>& requests)
+{
+	// The older of the two buffers, which EndFeedback is about to fill again
+	int bufferIndex = nextFeedbackBuffer;
+	if (!feedbackBufferFilled[bufferIndex])
+	{
+		return;
+	}
+	feedbackBufferFilled[bufferIndex] = false;
+
+	std::size_t texelCount = static_cast<std::size_t>(feedbackWidth) * feedbackHeight;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[bufferIndex]);
+	const GLushort* texels = static_cast<const GLushort*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		static_cast<GLsizeiptr>(texelCount * 4 * sizeof(GLushort)), GL_MAP_READ_BIT));
+	if (texels != nullptr)
+	{
+		// Each texel holds the tile's column, row and level, and the image + 1; anything out of range is clamped
+		for (std::size_t i = 0; i < texelCount; i++)
+		{
+			const GLushort* texel = texels + i * 4;
+			if (texel[3] == 0 || texel[3] > textures.size())
+			{
+				continue;
+			}
+
+			std::size_t textureIndex = texel[3] - 1u;
+			const TiledTexture& texture = textures[textureIndex];
+			int level = std::min(static_cast<int>(texel[2]), static_cast<int>(texture.levels.size()) - 1);
+			int x = std::min(static_cast<int>(texel[0]), texture.levels[level].tilesX - 1);
+			int y = std::min(static_cast<int>(texel[1]), texture.levels[level].tilesY - 1);
+			requests.push_back(MakeTileKey(textureIndex, level, x, y));
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool VirtualTextures::UploadTile(const LoadedTile& tile, bool pinned)
+{
+	// A free slot if there is one, otherwise the one asked for the longest ago that this frame did not ask for
+	std::size_t slotIndex = slots.size();
+	for (std::size_t i = 0; i < slots.size(); i++)
+	{
+		const CacheSlot& slot = slots[i];
+		if (!slot.occupied)
+		{
+			slotIndex = i;
+			break;
+		}
+		if (!slot.pinned && slot.lastUsed < frame && (slotIndex == slots.size() || slot.lastUsed < slots[slotIndex].lastUsed))
+		{
+			slotIndex = i;
+		}
+	}
+	if (slotIndex == slots.size())
+	{
+		return false;
+	}
+
+	CacheSlot& slot = slots[slotIndex];
+	if (slot.occupied)
+	{
+		residentTiles.erase(slot.key);
+		pageTableChanged[GetKeyTexture(slot.key)] = true;
+		stats.evictedTiles++;
+	}
+	slot.key = tile.key;
+	slot.lastUsed = frame;
+	slot.occupied = true;
+	slot.pinned = pinned;
+	residentTiles[tile.key] = slotIndex;
+	pageTableChanged[GetKeyTexture(tile.key)] = true;
+
+	GLint x = static_cast<GLint>(slotIndex % settings.cacheTilesPerSide) * TileSize;
+	GLint y = static_cast<GLint>(slotIndex / settings.cacheTilesPerSide) * TileSize;
+	glActiveTexture(GL_TEXTURE0 + TileCacheTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, tileCache);
+	if (cacheCompression == TextureCompression::None)
+	{
+		// Tiles arrive as RGBA (see LoadTile), whose rows need no padding whatever the unpack alignment
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, TileSize, TileSize, GetTextureFormat(tile.channels), GL_UNSIGNED_BYTE, tile.pixels.data());
+	}
+	else
+	{
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, x, y, TileSize, TileSize, GetCompressedInternalFormat(cacheCompression),
+			static_cast<GLsizei>(tile.pixels.size()), tile.pixels.data());
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	stats.loadedTiles++;
+	return true;
+}
+
+void VirtualTextures::UpdatePageTable(std::size_t textureIndex)
+{
+	const TiledTexture& texture = textures[textureIndex];
+	std::vector<std::vector<unsigned char>>& levelEntries = pageEntries[textureIndex];
+
+	// Each entry is the slot of the tile and the level it is from: the tile itself if it is in the cache,
+	// otherwise whatever stands in for the tile over it in the next level up (the coarsest tile is always there)
+	glActiveTexture(GL_TEXTURE0 + PageTableTextureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, pageTable);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int level = static_cast<int>(texture.levels.size()) - 1; level >= 0; level--)
+	{
+		const TiledTextureLevel& tiledLevel = texture.levels[level];
+		for (int y = 0; y < tiledLevel.tilesY; y++)
+		{
+			for (int x = 0; x < tiledLevel.tilesX; x++)
+			{
+				unsigned char* entry = &levelEntries[level][(static_cast<std::size_t>(y) * tiledLevel.tilesX + x) * 4];
+				std::unordered_map<std::uint64_t, std::size_t>::const_iterator resident = residentTiles.find(MakeTileKey(textureIndex, level, x, y));
+				if (resident != residentTiles.end())
+				{
+					entry[0] = static_cast<unsigned char>(resident->second % settings.cacheTilesPerSide);
+					entry[1] = static_cast<unsigned char>(resident->second / settings.cacheTilesPerSide);
+					entry[2] = static_cast<unsigned char>(level);
+					entry[3] = 255;
+				}
+				else if (level + 1 < static_cast<int>(texture.levels.size()))
+				{
+					const TiledTextureLevel& parentLevel = texture.levels[level + 1];
+					int parentX = std::min(x / 2, parentLevel.tilesX - 1);
+					int parentY = std::min(y / 2, parentLevel.tilesY - 1);
+					std::memcpy(entry, &levelEntries[level + 1][(static_cast<std::size_t>(parentY) * parentLevel.tilesX + parentX) * 4], 4);
+				}
+			}
+		}
+
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(textureIndex), tiledLevel.tilesX, tiledLevel.tilesY, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, levelEntries[level].data());
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	pageTableChanged[textureIndex] = false;
+}
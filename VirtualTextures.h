@@ -0,0 +1,201 @@
+#pragma once
+
+#include "AssetArchive.h"
+#include "MpscQueue.h"
+#include "ShaderUniforms.h"
+#include "TiledTexture.h"
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class ThreadPool;
+
+/// <summary>
+/// Most virtual textures that can be drawn at once (the size of virtualTextureSize in main.fsh and feedback.fsh)
+/// </summary>
+const int MaxVirtualTextures = 8;
+
+/// <summary>
+/// Texture units the page table and the tile cache are bound to (pageTable and tileCache in main.fsh and feedback.fsh)
+/// </summary>
+const GLint PageTableTextureUnit = 2;
+const GLint TileCacheTextureUnit = 3;
+
+/// <summary>
+/// Size of the tile cache, and how quickly tiles are paged into it
+/// </summary>
+struct VirtualTextureSettings
+{
+	int cacheTilesPerSide = 16;				// Tiles along each side of the cache texture (2048 x 2048 pixels for 16, whatever the size of the paintings)
+	int feedbackDivisor = 8;				// The feedback pass is drawn at the size of the window divided by this
+	std::size_t maxLoadsInFlight = 64;		// Most tiles the worker threads read at once
+	std::size_t maxUploadsPerFrame = 16;	// Most tiles copied into the cache per frame
+};
+
+/// <summary>
+/// What the virtual textures hold, for the window title
+/// </summary>
+struct VirtualTextureStats
+{
+	std::size_t residentTiles = 0;		// Tiles in the cache
+	std::size_t cacheTiles = 0;			// Tiles the cache has room for
+	std::size_t requestedTiles = 0;		// Tiles the last feedback pass asked for, with the coarser tiles that stand in for them
+	std::size_t loadedTiles = 0;		// Tiles uploaded since the start
+	std::size_t evictedTiles = 0;		// Tiles dropped from the cache since the start, to make room for others
+};
+
+/// <summary>
+/// Draws very large images (the paintings) without ever loading them whole. Each image is cooked into a tiled texture
+/// (see CookTiledTexture), and only the tiles of the levels that are seen get read, on the worker threads, and copied into
+/// a cache texture of fixed size; a page table per image tells the fragment shader where each tile is in the cache,
+/// or which coarser tile stands in for it until it arrives. A low-resolution feedback pass records every frame which tiles
+/// and levels the visible surfaces need, so the memory used stays the same however large the images are.
+/// </summary>
+class VirtualTextures
+{
+public:
+	/// <summary>
+	/// Creates virtual textures with no images.
+	/// </summary>
+	/// <param name="threadPool">Worker threads that read the tiles</param>
+	/// <param name="settings">Size of the cache and how quickly tiles are paged in</param>
+	explicit VirtualTextures(ThreadPool& threadPool, const VirtualTextureSettings& settings = VirtualTextureSettings());
+
+	/// <summary>
+	/// Waits for the worker threads to finish the tiles they are still reading.
+	/// </summary>
+	~VirtualTextures();
+
+	VirtualTextures(const VirtualTextures&) = delete;
+	VirtualTextures& operator=(const VirtualTextures&) = delete;
+
+	/// <summary>
+	/// Finds the tiled texture of every image in the asset archive. Does not need an OpenGL context.
+	/// Either all of them are found or none is used, so the images can be drawn the usual way instead.
+	/// </summary>
+	/// <param name="archive">Archive of cooked assets</param>
+	/// <param name="imageFilePaths">Paths to the images, in the order of their virtual texture index (at most MaxVirtualTextures)</param>
+	/// <returns>True if every image has a tiled texture</returns>
+	bool Open(AssetArchive& archive, const std::vector<std::string>& imageFilePaths);
+
+	/// <summary>
+	/// Creates the tile cache, the page tables and the feedback buffers, and uploads the coarsest tile of every image,
+	/// which stays in the cache so that every part of every image always has something to show. Must be called on the OpenGL thread.
+	/// </summary>
+	/// <param name="windowWidth">Width of the window in pixels</param>
+	/// <param name="windowHeight">Height of the window in pixels</param>
+	/// <returns>True if the virtual textures can be drawn</returns>
+	bool Create(int windowWidth, int windowHeight);
+
+	/// <summary>
+	/// Deletes the OpenGL objects. Must be called on the OpenGL thread while the context is still there.
+	/// </summary>
+	void Destroy();
+
+	/// <summary>
+	/// Binds the feedback framebuffer and clears it, so the surfaces drawn next record the tiles they need (with feedback.fsh).
+	/// </summary>
+	/// <param name="windowWidth">Width of the window in pixels</param>
+	/// <param name="windowHeight">Height of the window in pixels</param>
+	void BeginFeedback(int windowWidth, int windowHeight);
+
+	/// <summary>
+	/// Starts copying the feedback into a pixel buffer, to be read by Update a frame later so that nothing waits for the GPU,
+	/// and goes back to drawing to the window.
+	/// </summary>
+	void EndFeedback();
+
+	/// <summary>
+	/// Reads the latest feedback that is done, starts reading the tiles it asks for that are not in the cache (coarsest first),
+	/// copies the tiles the worker threads finished into the cache in place of the ones used the longest ago,
+	/// and updates the page tables. Must be called on the OpenGL thread once per frame.
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// Binds the page tables and the tile cache to their texture units.
+	/// </summary>
+	void Bind() const;
+
+	/// <summary>
+	/// Sets the uniforms of a program drawn with main.fsh or feedback.fsh that describe the virtual textures, and turns them on.
+	/// </summary>
+	/// <param name="uniforms">Uniforms of the program in use</param>
+	/// <param name="firstLayer">Layer of the first virtual texture: surfaces with this layer or a higher one sample a virtual texture</param>
+	/// <param name="feedback">Indicates if the program draws the feedback pass, whose lower resolution the level of detail makes up for</param>
+	void SetUniforms(const ShaderUniforms& uniforms, GLint firstLayer, bool feedback) const;
+
+	/// <summary>
+	/// What the virtual textures hold.
+	/// </summary>
+	/// <returns>Counts of tiles</returns>
+	VirtualTextureStats GetStats() const;
+
+private:
+	/// <summary>
+	/// Tile read by a worker thread, waiting to be copied into the cache
+	/// </summary>
+	struct LoadedTile
+	{
+		std::uint64_t key = 0;					// Image, level and position of the tile (see MakeTileKey)
+		int channels = 0;						// Bytes per pixel of uncompressed pixels
+		std::vector<unsigned char> pixels;		// Pixels of the tile, in the format of the cache
+	};
+
+	/// <summary>
+	/// Place for one tile in the cache texture
+	/// </summary>
+	struct CacheSlot
+	{
+		std::uint64_t key = 0;			// Tile in the slot
+		std::uint64_t lastUsed = 0;		// Last frame the tile was asked for
+		bool occupied = false;			// Indicates if the slot holds a tile
+		bool pinned = false;			// Indicates if the tile is never evicted (the coarsest tile of an image)
+	};
+
+	std::unique_ptr<LoadedTile> LoadTile(std::uint64_t key) const;
+	void ResizeFeedback(int width, int height);
+	void ReadFeedback(std::vector<std::uint64_t>& requests);
+	bool UploadTile(const LoadedTile& tile, bool pinned);
+	void UpdatePageTable(std::size_t textureIndex);
+
+	ThreadPool& threadPool;
+	VirtualTextureSettings settings;
+
+	std::vector<TiledTexture> textures;				// Tiled texture of each image
+	TextureCompression cacheCompression = TextureCompression::None;	// Format of the cache (tiles in another format are decompressed)
+	GLuint tileCache = 0;							// Cache texture, a grid of cacheTilesPerSide x cacheTilesPerSide tiles
+	GLuint pageTable = 0;							// Page tables, one layer per image and one mip level per level of its tiles
+	int pageTableSize = 0;							// Size of the page tables' largest level
+	std::vector<std::vector<std::vector<unsigned char>>> pageEntries;	// Entries of every level of every page table, as uploaded
+	std::vector<bool> pageTableChanged;				// Indicates which page tables need to be updated
+
+	std::vector<CacheSlot> slots;					// Every place in the cache
+	std::unordered_map<std::uint64_t, std::size_t> residentTiles;	// Slot of every tile in the cache
+	std::unordered_set<std::uint64_t> loadingTiles;	// Tiles the worker threads are reading, or have read but are not yet in the cache
+	MpscQueue<std::unique_ptr<LoadedTile>> loaded;	// Tiles handed over by the worker threads
+	std::vector<std::unique_ptr<LoadedTile>> arrived;	// Tiles handed over but not yet copied into the cache
+	std::atomic<std::size_t> loadsInFlight{ 0 };	// Jobs still running on the worker threads
+	std::uint64_t frame = 0;
+
+	GLuint feedbackFramebuffer = 0;
+	GLuint feedbackColor = 0;						// Renderbuffer of RGBA16UI texels: tile column, tile row, level, image + 1 (0 for none)
+	GLuint feedbackDepth = 0;
+	GLuint feedbackBuffers[2] = {};					// Pixel buffers the feedback is copied into, in turn
+	bool feedbackBufferFilled[2] = {};
+	int nextFeedbackBuffer = 0;
+	int feedbackWidth = 0;
+	int feedbackHeight = 0;
+	int windowWidth = 0;
+	int windowHeight = 0;
+
+	VirtualTextureStats stats;
+};